@@ -57,9 +57,19 @@ function(common_target_properties target_name)
             "$<$<BOOL:{WITH_FAST_MATH}>:-ffast-math>"
             "$<$<BOOL:${WITH_WERROR}>:-Werror>"
             "$<$<BOOL:${WITH_MARCH_NATIVE}>:-march=native>"
-            "$<$<BOOL:${WITH_SSE42}>:-msse4.2>"
             "$<$<BOOL:${WITH_AVX}>:-mavx>"
-            "$<$<BOOL:${WITH_AVX2}>:-mavx2>"
+            )
+    # The SIMD kernels are compiled with function-level target attributes
+    # and are selected at runtime, the options only gate the compile support.
+    target_compile_definitions(${target_name}
+        PRIVATE
+            "$<$<BOOL:${WITH_SSE42}>:SENS_LOC_SIMD_SSE42=1>"
+            "$<$<BOOL:${WITH_AVX2}>:SENS_LOC_SIMD_AVX2=1>"
+            )
+    # Without tracing the trace points of the stages compile to nothing.
+    target_compile_definitions(${target_name}
+        PRIVATE
+            "$<$<BOOL:${WITH_TRACING}>:SENS_LOC_TRACING=1>"
             )
 
     sanitizer_config(${target_name})
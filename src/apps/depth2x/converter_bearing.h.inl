@@ -1,23 +1,48 @@
 template <typename Intrinsic>
 bool bearing_converter<Intrinsic>::process_file(
-    const math::image<float>& depth_image, int idx) const noexcept {
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
     Expects(!this->_files.horizontal.empty() ||
             !this->_files.vertical.empty() || !this->_files.diagonal.empty() ||
             !this->_files.antidiagonal.empty());
     using namespace sens_loc::conversion;
 
-    bool final_result = true;
+    // All selected directions are calculated in one pass over the image and
+    // are quantized to 16-bit while they are calculated.
+    using target_image = quantized_image<ushort, float>;
+    multi_images<float, target_image> out;
 
-#define BEARING_PROCESS(DIRECTION)                                             \
+#define BEARING_SELECT(DIRECTION)                                              \
+    std::optional<math::image<ushort>> DIRECTION;                              \
+    std::optional<target_image>        DIRECTION##_target;                     \
     if (!this->_files.DIRECTION.empty()) {                                     \
-        math::image<float> bearing = depth_to_bearing<direction::DIRECTION>(   \
-            depth_image, this->intrinsic);                                     \
-        bool success =                                                         \
-            cv::imwrite(fmt::format(this->_files.DIRECTION, idx),              \
-                        convert_bearing<float, ushort>(bearing).data());       \
-        final_result &= success;                                               \
+        DIRECTION =                                                            \
+            frame.pool.get<ushort>(depth_image.w(), depth_image.h());          \
+        DIRECTION##_target.emplace(*DIRECTION,                                 \
+                                   bearing_quantization<ushort, float>());     \
+        DIRECTION##_target->clear();                                           \
+        out.DIRECTION = &*DIRECTION##_target;                                  \
     }
 
+    BEARING_SELECT(horizontal)
+    BEARING_SELECT(vertical)
+    BEARING_SELECT(diagonal)
+    BEARING_SELECT(antidiagonal)
+
+#undef BEARING_SELECT
+
+    frame.convert(
+        [&]() { depth_to_multi(depth_image, angles, this->rays, out); },
+        [&](tf::Taskflow& flow) {
+            par_depth_to_multi(depth_image, angles, this->rays, out, flow);
+        });
+
+#define BEARING_PROCESS(DIRECTION)                                             \
+    if (DIRECTION)                                                             \
+        frame.write(fmt::format(this->_files.DIRECTION, idx),                  \
+                    DIRECTION->data());
+
     BEARING_PROCESS(horizontal)
     BEARING_PROCESS(vertical)
     BEARING_PROCESS(diagonal)
@@ -25,5 +50,5 @@ bool bearing_converter<Intrinsic>::process_file(
 
 #undef BEARING_PROCESS
 
-    return final_result;
+    return true;
 }
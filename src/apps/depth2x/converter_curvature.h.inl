@@ -1,30 +1,40 @@
 template <typename Intrinsic>
 bool gauss_curv_converter<Intrinsic>::process_file(
-    const math::image<float>& depth_image, int idx) const noexcept {
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
     Expects(!this->_files.output.empty());
     using namespace conversion;
 
-    const auto gauss =
-        depth_to_gaussian_curvature(depth_image, this->intrinsic);
-    const auto converted = conversion::curvature_to_image<ushort>(
-        gauss, depth_image, {lower_bound}, {upper_bound});
-    const bool success =
-        cv::imwrite(fmt::format(this->_files.output, idx), converted.data());
-
-    return success;
+    const curvature_quantization<ushort, float> q{float(lower_bound),
+                                                 float(upper_bound)};
+    auto gauss = frame.pool.get<ushort>(depth_image.w(), depth_image.h());
+    frame.convert(
+        [&]() { depth_to_gaussian_curvature(depth_image, angles, q, gauss); },
+        [&](tf::Taskflow& flow) {
+            par_depth_to_gaussian_curvature(depth_image, angles, q, gauss,
+                                            flow);
+        });
+    frame.write(fmt::format(this->_files.output, idx), gauss.data());
+    return true;
 }
 
 template <typename Intrinsic>
 bool mean_curv_converter<Intrinsic>::process_file(
-    const math::image<float>& depth_image, int idx) const noexcept {
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
     Expects(!this->_files.output.empty());
     using namespace conversion;
 
-    const auto mean = depth_to_mean_curvature(depth_image, this->intrinsic);
-    const auto converted = conversion::curvature_to_image<ushort>(
-        mean, depth_image, {lower_bound}, {upper_bound});
-    const bool success =
-        cv::imwrite(fmt::format(this->_files.output, idx), converted.data());
-
-    return success;
+    const curvature_quantization<ushort, float> q{float(lower_bound),
+                                                 float(upper_bound)};
+    auto mean = frame.pool.get<ushort>(depth_image.w(), depth_image.h());
+    frame.convert(
+        [&]() { depth_to_mean_curvature(depth_image, angles, q, mean); },
+        [&](tf::Taskflow& flow) {
+            par_depth_to_mean_curvature(depth_image, angles, q, mean, flow);
+        });
+    frame.write(fmt::format(this->_files.output, idx), mean.data());
+    return true;
 }
@@ -1,12 +1,18 @@
 template <typename Intrinsic>
 bool flexion_converter<Intrinsic>::process_file(
-    const math::image<float>& depth_image, int idx) const noexcept {
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
     Expects(!this->_files.output.empty());
     using namespace conversion;
 
-    const auto flexion = depth_to_flexion(depth_image, this->intrinsic);
-    const bool success = cv::imwrite(fmt::format(this->_files.output, idx),
-                                     convert_flexion<ushort>(flexion).data());
-
-    return success;
+    auto flexion = frame.pool.get<ushort>(depth_image.w(), depth_image.h());
+    const auto q = flexion_quantization<ushort, float>();
+    frame.convert(
+        [&]() { depth_to_flexion(depth_image, this->rays, q, flexion); },
+        [&](tf::Taskflow& flow) {
+            par_depth_to_flexion(depth_image, this->rays, q, flexion, flow);
+        });
+    frame.write(fmt::format(this->_files.output, idx), flexion.data());
+    return true;
 }
@@ -1,13 +1,18 @@
 template <typename Intrinsic>
 bool max_curve_converter<Intrinsic>::process_file(
-    const math::image<float>& depth_image, int idx) const noexcept {
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
     Expects(!this->_files.output.empty());
     using namespace conversion;
 
-    const auto max_curve = depth_to_max_curve(depth_image, this->intrinsic);
-    const bool success =
-        cv::imwrite(fmt::format(this->_files.output, idx),
-                    convert_max_curve<ushort>(max_curve).data());
-
-    return success;
+    auto max_curve = frame.pool.get<ushort>(depth_image.w(), depth_image.h());
+    const auto q = max_curve_quantization<ushort, float>();
+    frame.convert(
+        [&]() { depth_to_max_curve(depth_image, angles, q, max_curve); },
+        [&](tf::Taskflow& flow) {
+            par_depth_to_max_curve(depth_image, angles, q, max_curve, flow);
+        });
+    frame.write(fmt::format(this->_files.output, idx), max_curve.data());
+    return true;
 }
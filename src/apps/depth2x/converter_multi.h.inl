@@ -0,0 +1,52 @@
+template <typename Intrinsic>
+bool multi_converter<Intrinsic>::process_file(
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
+    using namespace sens_loc::conversion;
+
+    // Each result is quantized to 16-bit while it is calculated.
+    using target_image = quantized_image<ushort, float>;
+    multi_images<float, target_image> out;
+
+#define MULTI_SELECT(TYPE, QUANTIZATION)                                       \
+    std::optional<math::image<ushort>> TYPE;                                   \
+    std::optional<target_image>        TYPE##_target;                          \
+    if (!this->_files.TYPE.empty()) {                                          \
+        TYPE = frame.pool.get<ushort>(depth_image.w(), depth_image.h());       \
+        TYPE##_target.emplace(*TYPE, QUANTIZATION<ushort, float>());           \
+        TYPE##_target->clear();                                                \
+        out.TYPE = &*TYPE##_target;                                            \
+    }
+
+    MULTI_SELECT(horizontal, bearing_quantization)
+    MULTI_SELECT(vertical, bearing_quantization)
+    MULTI_SELECT(diagonal, bearing_quantization)
+    MULTI_SELECT(antidiagonal, bearing_quantization)
+    MULTI_SELECT(flexion, flexion_quantization)
+    MULTI_SELECT(max_curve, max_curve_quantization)
+
+#undef MULTI_SELECT
+
+    Expects(!out.empty());
+    frame.convert(
+        [&]() { depth_to_multi(depth_image, angles, this->rays, out); },
+        [&](tf::Taskflow& flow) {
+            par_depth_to_multi(depth_image, angles, this->rays, out, flow);
+        });
+
+#define MULTI_PROCESS(TYPE)                                                    \
+    if (TYPE)                                                                  \
+        frame.write(fmt::format(this->_files.TYPE, idx), TYPE->data());
+
+    MULTI_PROCESS(horizontal)
+    MULTI_PROCESS(vertical)
+    MULTI_PROCESS(diagonal)
+    MULTI_PROCESS(antidiagonal)
+    MULTI_PROCESS(flexion)
+    MULTI_PROCESS(max_curve)
+
+#undef MULTI_PROCESS
+
+    return true;
+}
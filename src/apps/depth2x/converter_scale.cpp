@@ -6,16 +6,18 @@
 
 namespace sens_loc::apps {
 
-bool scale_converter::process_file(const math::image<float>& depth_image,
-                                   int idx) const noexcept {
+bool scale_converter::process_file(
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
     Expects(!_files.output.empty());
     using namespace sens_loc::conversion;
-    const auto res = depth_scaling(depth_image, _scale, _offset);
-    cv::Mat    depth_16bit(depth_image.h(), depth_image.w(), CV_16U);
-    res.data().convertTo(depth_16bit, CV_16U);
-    bool success = cv::imwrite(fmt::format(_files.output, idx), depth_16bit);
-
-    return success;
+    auto res = frame.pool.get<float>(depth_image.w(), depth_image.h());
+    depth_scaling(depth_image, _scale, _offset, res);
+    auto depth_16bit = frame.pool.get<ushort>(depth_image.w(), depth_image.h());
+    math::convert(res, depth_16bit);
+    frame.write(fmt::format(_files.output, idx), depth_16bit.data());
+    return true;
 }
 
 }  // namespace sens_loc::apps
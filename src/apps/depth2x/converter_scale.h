@@ -26,8 +26,10 @@ class scale_converter : public batch_converter {
     double _scale  = 1.0;
     double _offset = 0.0;
 
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
 };
 /// @}
 }  // namespace sens_loc::apps
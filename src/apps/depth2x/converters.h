@@ -4,11 +4,13 @@
 #include <fmt/core.h>
 #include <gsl/gsl>
 #include <opencv2/imgcodecs.hpp>
+#include <optional>
 #include <sens_loc/conversion/depth_to_bearing.h>
 #include <sens_loc/conversion/depth_to_curvature.h>
 #include <sens_loc/conversion/depth_to_flexion.h>
 #include <sens_loc/conversion/depth_to_laserscan.h>
 #include <sens_loc/conversion/depth_to_max_curve.h>
+#include <sens_loc/conversion/depth_to_multi.h>
 #include <util/batch_converter.h>
 
 namespace sens_loc::apps {
@@ -24,7 +26,8 @@ class bearing_converter : public batch_sensor_converter<Intrinsic> {
     bearing_converter(const file_patterns& files,
                       depth_type           t,
                       Intrinsic            intrinsic)
-        : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic)) {
+        : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic))
+        , angles{this->intrinsic} {
         if (files.horizontal.empty() && files.vertical.empty() &&
             files.diagonal.empty() && files.antidiagonal.empty()) {
             throw std::invalid_argument{
@@ -38,8 +41,13 @@ class bearing_converter : public batch_sensor_converter<Intrinsic> {
     ~bearing_converter() override                     = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
+
+    /// Angles between neighbouring pixels, shared by all images.
+    conversion::bearing_angles<Intrinsic> angles;
 };
 #include "converter_bearing.h.inl"
 
@@ -59,8 +67,10 @@ class range_converter : public batch_sensor_converter<Intrinsic> {
     ~range_converter() override                   = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
 };
 #include "converter_laserscan.h.inl"
 
@@ -78,6 +88,7 @@ class gauss_curv_converter : public batch_sensor_converter<Intrinsic> {
                          double               lower_bound,
                          double               upper_bound)
         : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic))
+        , angles{this->intrinsic}
         , lower_bound{lower_bound}
         , upper_bound{upper_bound} {}
     gauss_curv_converter(const gauss_curv_converter&) = default;
@@ -87,11 +98,15 @@ class gauss_curv_converter : public batch_sensor_converter<Intrinsic> {
     ~gauss_curv_converter() override                        = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
-
-    double lower_bound;
-    double upper_bound;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
+
+    /// Angles between the pixels of the finite differences.
+    conversion::curvature_angles<Intrinsic> angles;
+    double                                  lower_bound;
+    double                                  upper_bound;
 };
 
 /// Convert range-images to mean curvature images.
@@ -108,6 +123,7 @@ class mean_curv_converter : public batch_sensor_converter<Intrinsic> {
                         double               lower_bound,
                         double               upper_bound)
         : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic))
+        , angles{this->intrinsic}
         , lower_bound{lower_bound}
         , upper_bound{upper_bound} {}
     mean_curv_converter(const mean_curv_converter&) = default;
@@ -117,11 +133,15 @@ class mean_curv_converter : public batch_sensor_converter<Intrinsic> {
     ~mean_curv_converter() override                       = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
-
-    double lower_bound;
-    double upper_bound;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
+
+    /// Angles between the pixels of the finite differences.
+    conversion::curvature_angles<Intrinsic> angles;
+    double                                  lower_bound;
+    double                                  upper_bound;
 };
 #include "converter_curvature.h.inl"
 
@@ -133,7 +153,8 @@ class max_curve_converter : public batch_sensor_converter<Intrinsic> {
     max_curve_converter(const file_patterns& files,
                         depth_type           t,
                         Intrinsic            intrinsic)
-        : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic)) {}
+        : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic))
+        , angles{this->intrinsic} {}
     max_curve_converter(const max_curve_converter&) = default;
     max_curve_converter(max_curve_converter&&)      = default;
     max_curve_converter& operator=(const max_curve_converter&) = default;
@@ -141,8 +162,13 @@ class max_curve_converter : public batch_sensor_converter<Intrinsic> {
     ~max_curve_converter() override                       = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
+
+    /// Angles between neighbouring pixels, shared by all images.
+    conversion::bearing_angles<Intrinsic> angles;
 };
 #include "converter_max_curve.h.inl"
 
@@ -162,11 +188,51 @@ class flexion_converter : public batch_sensor_converter<Intrinsic> {
     ~flexion_converter() override                     = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
 };
 #include "converter_flexion.h.inl"
 
+/// Convert range-images to multiple derived images in one pass.
+///
+/// Any subset of the bearing angle images, the flexion image and the
+/// max-curve image can be requested and all of them are calculated with one
+/// traversal of the range image.
+/// \sa conversion::depth_to_multi
+template <typename Intrinsic>
+class multi_converter : public batch_sensor_converter<Intrinsic> {
+  public:
+    multi_converter(const file_patterns& files,
+                    depth_type           t,
+                    Intrinsic            intrinsic)
+        : batch_sensor_converter<Intrinsic>(files, t, std::move(intrinsic))
+        , angles{this->intrinsic} {
+        if (files.horizontal.empty() && files.vertical.empty() &&
+            files.diagonal.empty() && files.antidiagonal.empty() &&
+            files.flexion.empty() && files.max_curve.empty()) {
+            throw std::invalid_argument{
+                "Missing output pattern for at least one image type"};
+        }
+    }
+    multi_converter(const multi_converter&) = default;
+    multi_converter(multi_converter&&)      = default;
+    multi_converter& operator=(const multi_converter&) = default;
+    multi_converter& operator=(multi_converter&&) = default;
+    ~multi_converter() override                   = default;
+
+  private:
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
+
+    /// Angles between neighbouring pixels, shared by all images.
+    conversion::bearing_angles<Intrinsic> angles;
+};
+#include "converter_multi.h.inl"
+
 /// @}
 
 }  // namespace sens_loc::apps
@@ -9,15 +9,25 @@
 #include <memory>
 #include <rang.hpp>
 #include <sens_loc/io/intrinsics.h>
+#include <sens_loc/io/manifest.h>
+#include <sens_loc/io/sequence.h>
+#include <sens_loc/io/stream.h>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/correctness_util.h>
 #include <sens_loc/version.h>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/incremental.h>
+#include <util/shard.h>
 #include <util/tool_macro.h>
+#include <util/tracing.h>
 #include <util/version_printer.h>
 #include <variant>
+#include <vector>
 
 namespace detail {
 
@@ -101,7 +111,8 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
 
     string calibration_file;
     app.add_option("-c,--calibration", calibration_file,
-                   "File that contains calibration parameters for the camera")
+                   "File that contains calibration parameters for the camera, "
+                   "optional for archives that contain the calibration")
         ->check(CLI::ExistingFile);
 
     string camera_model = "pinhole";
@@ -112,9 +123,10 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
                 /*defaulted=*/true);
 
     file_patterns files;
-    app.add_option("-i,--input", files.input,
-                   "Input pattern for image, e.g. \"depth-{}.png\"")
-        ->required();
+    CLI::Option*  input_opt = app.add_option(
+        "-i,--input", files.input,
+        "Input pattern for image, e.g. \"depth-{}.png\", or a depth "
+        "sequence archive, e.g. \"depth.dseq\"");
 
     string input_type = "pinhole-depth";
     app.add_set("-t,--type", input_type, {"pinhole-depth", "pinhole-range"},
@@ -122,12 +134,67 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
                 "(pinhole-range) or orthographic depths (pinhole-depth)",
                 /*defaulted=*/true);
 
-    int start_idx = 0;
-    app.add_option("-s,--start", start_idx, "Start index of batch, inclusive")
-        ->required();
-    int end_idx = 0;
-    app.add_option("-e,--end", end_idx, "End index of batch, inclusive")
-        ->required();
+    int          start_idx = 0;
+    CLI::Option* start_opt = app.add_option("-s,--start", start_idx,
+                                            "Start index of batch, inclusive");
+    int          end_idx   = 0;
+    CLI::Option* end_opt =
+        app.add_option("-e,--end", end_idx, "End index of batch, inclusive");
+
+    string       stream_input;
+    CLI::Option* stream_opt =
+        app.add_option(
+               "--stream-input", stream_input,
+               "Convert the length-prefixed images of a stream instead of a "
+               "batch of files until the stream ends. '-' reads from stdin, "
+               "'unix:PATH' creates the Unix-domain socket PATH and waits "
+               "for a client, every other value is a file or FIFO. The "
+               "output patterns only select the result images, that are "
+               "sent as numbered parts in the order of the conversion, e.g. "
+               "bearing angles, flexion and max-curve for 'multi'.")
+            ->excludes(input_opt)
+            ->excludes(start_opt)
+            ->excludes(end_opt);
+    string stream_output = "-";
+    app.add_option("--stream-output", stream_output,
+                   "Destination of the converted stream, like "
+                   "'--stream-input'. The same socket as the input answers "
+                   "the client on its connection.",
+                   /*defaulted=*/true)
+        ->needs(stream_opt);
+    bool pipeline = false;
+    app.add_flag("--pipeline", pipeline,
+                 "Overlap reading and writing files with the processing in "
+                 "separate pipeline stages");
+    string intra_image_parallel = "auto";
+    app.add_set("--intra-image-parallel", intra_image_parallel,
+                {"auto", "on", "off"},
+                "Split the rows of each image between threads. 'auto' does "
+                "this for batches with fewer images than hardware threads.",
+                /*defaulted=*/true);
+    app.add_option("--output-compression", files.output_compression,
+                   "Compression level of the output images, 0-9 for PNG and "
+                   "0 for uncompressed TIFF. The codec is selected by the "
+                   "extension of the output pattern, e.g. '.pgm' writes "
+                   "uncompressed raw images. Lower levels write faster.")
+        ->check(CLI::Range(0, 9));
+    bool         incremental     = false;
+    CLI::Option* incremental_opt =
+        app.add_flag("--incremental", incremental,
+                     "Skip indices whose outputs exist and are newer than "
+                     "their input, the calibration and the configuration of "
+                     "the tool. Interrupted batches resume with the indices "
+                     "that are not finished.")
+            ->excludes(stream_opt);
+    string manifest_file = "depth2x.manifest";
+    app.add_option("--manifest", manifest_file,
+                   "Sidecar file of '--incremental' that records the "
+                   "configuration and the outputs of the finished indices. "
+                   "Each configuration needs its own manifest.",
+                   /*defaulted=*/true)
+        ->needs(incremental_opt);
+    shard part;
+    add_shard_option(app, part)->excludes(stream_opt);
 
     // Bearing angle images territory
     CLI::App* bearing_cmd = app.add_subcommand(
@@ -279,6 +346,44 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
                      "Output pattern for the flexion images.")
         ->required();
 
+    // Multiple image types in one pass
+    CLI::App* multi_cmd = app.add_subcommand(
+        "multi",
+        "Convert depth images into bearing angle, flexion and max-curve images "
+        "in one pass");
+    multi_cmd->footer("\n\n"
+                      "An example invocation of the tool is:\n"
+                      "\n"
+                      "depth2x multi --calibration intrinsic.txt \\\n"
+                      "              --input depth_{:04d}.png \\\n"
+                      "              --start 0 \\\n"
+                      "              --end 100 \\\n"
+                      "              --horizontal horizontal_{:04d}.png \\\n"
+                      "              --flexion flexion_{:04d}.png \\\n"
+                      "              --max-curve max_curve_{:04d}.png\n"
+                      "\n"
+                      "This will read 'depth_0000.png ...' and create "
+                      "'horizontal_0000.png flexion_0000.png "
+                      "max_curve_0000.png ...' \n"
+                      "in the working directory");
+    multi_cmd->add_option(
+        "--horizontal", files.horizontal,
+        "Calculate horizontal bearing angle image and write to this pattern");
+    multi_cmd->add_option(
+        "--vertical", files.vertical,
+        "Calculate vertical bearing angle and write to this pattern");
+    multi_cmd->add_option(
+        "--diagonal", files.diagonal,
+        "Calculate diagonal bearing angle and write to this pattern");
+    multi_cmd->add_option(
+        "--anti-diagonal", files.antidiagonal,
+        "Calculate anti-diagonal bearing angle and write to this pattern");
+    multi_cmd->add_option("--flexion", files.flexion,
+                          "Calculate flexion image and write to this pattern");
+    multi_cmd->add_option(
+        "--max-curve", files.max_curve,
+        "Calculate max-curve image and write to this pattern");
+
     // Flexion images
     CLI::App* scale_cmd = app.add_subcommand(
         "scale", "Scale depth images and add an optional offset.");
@@ -308,8 +413,28 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
 
     COLORED_APP_PARSE(app, argc, argv);
 
+    if (!*stream_opt && (!*input_opt || !*start_opt || !*end_opt)) {
+        cerr << util::err{}
+             << "Either '--input', '--start' and '--end' or '--stream-input' "
+                "are required!\n";
+        return 1;
+    }
+    // The converters expect an input, that is the stream in this case.
+    if (*stream_opt)
+        files.input = stream_input;
+
     // Options that are always required are checked first.
-    ifstream cali_fstream{calibration_file};
+    // Archives contain the intrinsic of their sensor, that is used if no
+    // calibration file is provided.
+    ifstream      cali_fstream{calibration_file};
+    istringstream archive_intrinsic;
+    if (calibration_file.empty() && batch_converter::is_archive(files.input)) {
+        if (auto archive = io::depth_sequence::open(files.input))
+            archive_intrinsic.str(string(archive->intrinsic()));
+    }
+    istream& cali_stream = calibration_file.empty()
+                               ? static_cast<istream&>(archive_intrinsic)
+                               : cali_fstream;
 
     const auto potential_intrinsic =
         [&]() -> optional<detail::intrinsic_variant> {
@@ -318,7 +443,7 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
 
 #define LOAD_INTRINSIC(model_name)                                             \
     if (camera_model == #model_name) {                                         \
-        auto r = io::camera<float, model_name>::load_intrinsic(cali_fstream);  \
+        auto r = io::camera<float, model_name>::load_intrinsic(cali_stream);   \
         if (r)                                                                 \
             return *r;                                                         \
         return nullopt;                                                        \
@@ -363,6 +488,9 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
         if (*max_curve_cmd)
             return detail::make_converter<max_curve_converter>(
                 files, input_enum, *potential_intrinsic);
+        if (*multi_cmd)
+            return detail::make_converter<multi_converter>(
+                files, input_enum, *potential_intrinsic);
         if (*mean_curv_cmd)
             return detail::make_converter<mean_curv_converter>(
                 files, input_enum, *potential_intrinsic, lower_bound,
@@ -373,6 +501,55 @@ MAIN_HEAD("Batch-conversion of depth images to various derived image-types.") {
 
         UNREACHABLE("unexpected conversion");  // LCOV_EXCL_LINE
     }();
-    return c->process_batch(start_idx, end_idx) ? 0 : 1;
+    const batch_mode mode =
+        pipeline ? batch_mode::pipelined : batch_mode::per_index;
+    const intra_image intra = intra_image_parallel == "on"
+                                  ? intra_image::enabled
+                                  : intra_image_parallel == "off"
+                                        ? intra_image::disabled
+                                        : intra_image::automatic;
+    if (!*stream_opt) {
+        const auto indices = select_shard(part, start_idx, end_idx);
+        if (!indices)
+            return 0;
+        tie(start_idx, end_idx) = *indices;
+
+        unique_ptr<io::batch_manifest> manifest;
+        if (incremental) {
+            vector<string> dependencies;
+            if (!calibration_file.empty())
+                dependencies.push_back(calibration_file);
+            manifest = open_manifest(manifest_file, app, dependencies);
+            if (!manifest)
+                return 1;
+        }
+        return c->process_batch(start_idx, end_idx, mode, intra,
+                                manifest.get())
+                   ? 0
+                   : 1;
+    }
+
+    optional<io::frame_stream> in =
+        io::frame_stream::open(stream_input, io::stream_mode::read);
+    if (!in) {
+        cerr << util::err{} << "Could not open the input stream \""
+             << rang::style::bold << stream_input << rang::style::reset
+             << "\"!\n";
+        return 1;
+    }
+    const bool same_socket = stream_output == stream_input &&
+                             io::frame_stream::is_socket(stream_input);
+    if (same_socket)
+        return c->process_stream(*in, *in, intra) ? 0 : 1;
+
+    optional<io::frame_stream> out =
+        io::frame_stream::open(stream_output, io::stream_mode::write);
+    if (!out) {
+        cerr << util::err{} << "Could not open the output stream \""
+             << rang::style::bold << stream_output << rang::style::reset
+             << "\"!\n";
+        return 1;
+    }
+    return c->process_stream(*in, *out, intra) ? 0 : 1;
 }
 MAIN_TAIL
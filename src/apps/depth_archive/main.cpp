@@ -0,0 +1,211 @@
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+#include <fstream>
+#include <optional>
+#include <rang.hpp>
+#include <sens_loc/io/image.h>
+#include <sens_loc/io/pose.h>
+#include <sens_loc/io/sequence.h>
+#include <sens_loc/util/console.h>
+#include <sens_loc/version.h>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <util/batch_converter.h>
+#include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/tool_macro.h>
+#include <util/tracing.h>
+#include <util/version_printer.h>
+#include <vector>
+
+/// \defgroup archive-driver depth sequence archives
+///
+/// Tool to pack a sequence of depth images into a single archive and to
+/// unpack it again.
+
+namespace {
+using namespace sens_loc;
+
+/// Pack the depth images \p input_pattern in [start, end] into \p output.
+/// \returns 0 on success, otherwise 1
+int create_archive(const std::string&                input_pattern,
+                   int                               start,
+                   int                               end,
+                   const std::string&                output,
+                   io::sequence_encoding             encoding,
+                   const std::string&                calibration_file,
+                   const std::optional<std::string>& pose_pattern) {
+    std::string intrinsic;
+    if (!calibration_file.empty()) {
+        std::ifstream     cali{calibration_file};
+        std::stringstream content;
+        content << cali.rdbuf();
+        intrinsic = content.str();
+    }
+
+    io::depth_sequence_writer writer(output, end - start + 1, encoding,
+                                     intrinsic, pose_pattern.has_value());
+    std::vector<uchar>        file_buffer;
+    math::image<ushort>       depth;
+    std::pair<int, int>       dimension;
+    for (int idx = start; idx <= end; ++idx) {
+        const std::string input = fmt::format(input_pattern, idx);
+        if (!io::load_image(input, cv::IMREAD_UNCHANGED, file_buffer, depth)) {
+            std::cerr << util::err{} << "Could not load depth image \""
+                      << rang::style::bold << input << rang::style::reset
+                      << "\"!\n";
+            return 1;
+        }
+
+        math::pose_t pose = math::pose_t::Identity();
+        if (pose_pattern) {
+            const std::string pose_file = fmt::format(*pose_pattern, idx);
+            std::ifstream     pose_stream{pose_file};
+            const auto        p = io::load_pose(pose_stream);
+            if (!p) {
+                std::cerr << util::err{} << "Could not load pose \""
+                          << rang::style::bold << pose_file
+                          << rang::style::reset << "\"!\n";
+                return 1;
+            }
+            pose = *p;
+        }
+
+        // All frames of an archive share the dimension of the first one.
+        if (idx == start)
+            dimension = {depth.w(), depth.h()};
+        if (dimension != std::pair{depth.w(), depth.h()} ||
+            !writer.add(depth, pose)) {
+            std::cerr << util::err{} << "Could not write frame " << idx
+                      << " to the archive!\n";
+            return 1;
+        }
+    }
+    if (!writer.finish()) {
+        std::cerr << util::err{} << "Could not write the archive \""
+                  << rang::style::bold << output << rang::style::reset
+                  << "\"!\n";
+        return 1;
+    }
+    return 0;
+}
+
+/// Unpack the frames of the archive \p input into \p output_pattern.
+/// \returns 0 on success, otherwise 1
+int extract_archive(const std::string& input,
+                    const std::string& output_pattern,
+                    int                compression) {
+    const auto archive = io::depth_sequence::open(input);
+    if (!archive) {
+        std::cerr << util::err{} << "Could not open the archive \""
+                  << rang::style::bold << input << rang::style::reset
+                  << "\"!\n";
+        return 1;
+    }
+
+    math::image<ushort> depth;
+    for (int idx = 0; idx < archive->size(); ++idx) {
+        const std::string output = fmt::format(output_pattern, idx);
+        if (!archive->read(idx, depth) ||
+            !io::write_image(output, depth.data(), compression)) {
+            std::cerr << util::err{} << "Could not extract frame " << idx
+                      << " to \"" << rang::style::bold << output
+                      << rang::style::reset << "\"!\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+}  // namespace
+
+/// Driver to create and extract depth sequence archives.
+/// \sa sens_loc::io::depth_sequence
+/// \ingroup archive-driver
+/// \returns 0 on success, 1 on any failure
+MAIN_HEAD("Pack depth image sequences into a single archive file") {
+    app.require_subcommand(1);
+    app.footer("\n\n"
+               "An example invocation of the tool is:\n"
+               "\n"
+               "depth_archive create --input depth_{:04d}.png \\\n"
+               "                     --start 0 \\\n"
+               "                     --end 100 \\\n"
+               "                     --calibration intrinsic.txt \\\n"
+               "                     --output depth.dseq\n"
+               "\n"
+               "The batch tools accept the archive as input, e.g. "
+               "'depth2x --input depth.dseq'.");
+
+    CLI::App* create_cmd = app.add_subcommand(
+        "create", "Pack a sequence of depth images into an archive");
+    string input_pattern;
+    create_cmd
+        ->add_option("-i,--input", input_pattern,
+                     "Input pattern for the depth images, e.g. "
+                     "\"depth-{}.png\"")
+        ->required();
+    int start_idx = 0;
+    create_cmd
+        ->add_option("-s,--start", start_idx,
+                     "Start index of the sequence, inclusive")
+        ->required();
+    int end_idx = 0;
+    create_cmd
+        ->add_option("-e,--end", end_idx,
+                     "End index of the sequence, inclusive")
+        ->required();
+    string archive_file;
+    create_cmd
+        ->add_option("-o,--output", archive_file,
+                     "Archive file to create, e.g. \"depth.dseq\"")
+        ->required();
+    string calibration_file;
+    create_cmd
+        ->add_option("-c,--calibration", calibration_file,
+                     "Calibration of the sensor that is stored in the archive")
+        ->check(CLI::ExistingFile);
+    optional<string> pose_pattern;
+    create_cmd->add_option("-p,--poses", pose_pattern,
+                           "Input pattern for the pose of each image, e.g. "
+                           "\"pose-{}.pose\"");
+    string encoding = "delta";
+    create_cmd->add_set("--encoding", encoding, {"delta", "raw"},
+                        "Storage of the frames. 'raw' frames are read "
+                        "without any decoding, 'delta' frames are "
+                        "smaller.",
+                        /*defaulted=*/true);
+
+    CLI::App* extract_cmd = app.add_subcommand(
+        "extract", "Write the frames of an archive as images");
+    string archive_input;
+    extract_cmd
+        ->add_option("-i,--input", archive_input,
+                     "Archive file to extract, e.g. \"depth.dseq\"")
+        ->required()
+        ->check(CLI::ExistingFile);
+    string output_pattern;
+    extract_cmd
+        ->add_option("-o,--output", output_pattern,
+                     "Output pattern for the depth images, e.g. "
+                     "\"depth-{}.png\"")
+        ->required();
+    int output_compression = -1;
+    extract_cmd
+        ->add_option("--output-compression", output_compression,
+                     "Compression level of the output images, see depth2x")
+        ->check(CLI::Range(0, 9));
+
+    COLORED_APP_PARSE(app, argc, argv);
+
+    if (*create_cmd) {
+        if (start_idx > end_idx)
+            swap(start_idx, end_idx);
+        return create_archive(input_pattern, start_idx, end_idx, archive_file,
+                              encoding == "raw" ? io::sequence_encoding::raw
+                                                : io::sequence_encoding::delta,
+                              calibration_file, pose_pattern);
+    }
+    return extract_archive(archive_input, output_pattern, output_compression);
+}
+MAIN_TAIL
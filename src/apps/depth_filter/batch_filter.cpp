@@ -3,11 +3,15 @@
 #include <fmt/core.h>
 #include <opencv2/imgcodecs.hpp>
 #include <sens_loc/preprocess/filter.h>
+#include <sens_loc/util/trace.h>
 
 namespace sens_loc::apps {
 
-bool batch_filter::process_file(const math::image<float>& depth_image,
-                                int                       idx) const noexcept {
+bool batch_filter::process_file(
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
+    SENS_LOC_TRACE_SCOPE("filter");
     // Thats a NO-OP because the type already matches, 'convert' short
     // circuits that.
     math::image<float> result = math::convert<float>(depth_image);
@@ -15,9 +19,10 @@ bool batch_filter::process_file(const math::image<float>& depth_image,
     std::for_each(std::begin(_operations), std::end(_operations),
                   [&](auto&& op) { result = op->filter(result); });
 
-    const bool success = cv::imwrite(fmt::format(_files.output, idx),
-                                     math::convert<ushort>(result).data());
-    return success;
+    auto depth_16bit = frame.pool.get<ushort>(result.w(), result.h());
+    math::convert(result, depth_16bit);
+    frame.write(fmt::format(_files.output, idx), depth_16bit.data());
+    return true;
 }
 
 }  // namespace sens_loc::apps
@@ -21,8 +21,10 @@ class batch_filter : public batch_converter {
     ~batch_filter() override = default;
 
   private:
-    [[nodiscard]] bool process_file(const math::image<float>& depth_image,
-                                    int idx) const noexcept override;
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
 
     const std::vector<std::unique_ptr<abstract_filter>>& _operations;
 };
@@ -5,14 +5,20 @@
 #include <cmath>
 #include <memory>
 #include <rang.hpp>
+#include <sens_loc/io/manifest.h>
 #include <sens_loc/preprocess/filter.h>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/correctness_util.h>
 #include <sens_loc/version.h>
 #include <stdexcept>
+#include <tuple>
 #include <util/batch_converter.h>
 #include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/incremental.h>
+#include <util/shard.h>
 #include <util/tool_macro.h>
+#include <util/tracing.h>
 #include <util/version_printer.h>
 #include <vector>
 
@@ -27,14 +33,6 @@
 /// \returns 0 if all images could be converted, 1 if any image fails
 MAIN_HEAD("Batch-processing tool to filter depth images and maps") {
 
-    // Explicitly disable threading from OpenCV functions, as the
-    // parallelization is done at a higher level.
-    // That means, that each filter application is not multithreaded, but each
-    // image modification is. This is necessary as "TaskFlow" does not play
-    // nice with OpenCV threading and they introduce data races in the program
-    // because of that.
-    cv::setNumThreads(0);
-
     app.require_subcommand();  // Expect one or more filter commands
     app.footer("\n\n"
                "An example invocation of the tool is:\n"
@@ -53,7 +51,8 @@ MAIN_HEAD("Batch-processing tool to filter depth images and maps") {
 
     file_patterns files;
     app.add_option("-i,--input", files.input,
-                   "Input pattern for images to filter; e.g. \"depth-{}.png\"")
+                   "Input pattern for images to filter; e.g. \"depth-{}.png\" "
+                   "or a depth sequence archive, e.g. \"depth.dseq\"")
         ->required();
     app.add_option(
            "-o,--output", files.output,
@@ -65,6 +64,39 @@ MAIN_HEAD("Batch-processing tool to filter depth images and maps") {
     int end_idx = 0;
     app.add_option("-e,--end", end_idx, "End index of batch, inclusive")
         ->required();
+    bool pipeline = false;
+    app.add_flag("--pipeline", pipeline,
+                 "Overlap reading and writing files with the processing in "
+                 "separate pipeline stages");
+    string thread_policy = "outer";
+    app.add_set("--thread-policy", thread_policy, {"outer", "inner", "hybrid"},
+                "Distribution of the threads between the images and the "
+                "OpenCV functions. 'outer' processes the images in parallel "
+                "with sequential OpenCV functions, 'inner' processes one "
+                "image at a time with parallel OpenCV functions and "
+                "'hybrid' selects one of both by the size of the batch.",
+                /*defaulted=*/true);
+    app.add_option("--output-compression", files.output_compression,
+                   "Compression level of the output images, 0-9 for PNG and "
+                   "0 for uncompressed TIFF. The codec is selected by the "
+                   "extension of the output pattern, e.g. '.pgm' writes "
+                   "uncompressed raw images. Lower levels write faster.")
+        ->check(CLI::Range(0, 9));
+    bool         incremental     = false;
+    CLI::Option* incremental_opt = app.add_flag(
+        "--incremental", incremental,
+        "Skip indices whose outputs exist and are newer than their input "
+        "and the configuration of the tool. Interrupted batches resume with "
+        "the indices that are not finished.");
+    string manifest_file = "depth_filter.manifest";
+    app.add_option("--manifest", manifest_file,
+                   "Sidecar file of '--incremental' that records the "
+                   "configuration and the outputs of the finished indices. "
+                   "Each configuration needs its own manifest.",
+                   /*defaulted=*/true)
+        ->needs(incremental_opt);
+    shard part;
+    add_shard_option(app, part);
 
     CLI::App* bilateral_cmd = app.add_subcommand(
         "bilateral", "Apply the bilateral filter to the input.");
@@ -120,6 +152,21 @@ MAIN_HEAD("Batch-processing tool to filter depth images and maps") {
 
     COLORED_APP_PARSE(app, argc, argv);
 
+    const auto indices = select_shard(part, start_idx, end_idx);
+    if (!indices)
+        return 0;
+    tie(start_idx, end_idx) = *indices;
+
+    // Explicitly disable threading from OpenCV functions, as the
+    // parallelization is done at a higher level, unless the images are
+    // processed one after another by the thread policy.
+    // That means, that each filter application is not multithreaded, but each
+    // image modification is. This is necessary as "TaskFlow" does not play
+    // nice with OpenCV threading and they introduce data races in the program
+    // because of that.
+    // The threads are split once the batch skipped the up-to-date images.
+    set_thread_policy(thread_policy);
+
     if (app.got_subcommand(bilateral_cmd) && distance_option->count() == 0U &&
         sigma_space_option->count() == 0U) {
         cerr << util::err{}
@@ -163,6 +210,17 @@ MAIN_HEAD("Batch-processing tool to filter depth images and maps") {
     // The final step is conversion to U16 and writing to disk.
     batch_filter process(files, commands);
 
-    return process.process_batch(start_idx, end_idx) ? 0 : 1;
+    unique_ptr<io::batch_manifest> manifest;
+    if (incremental) {
+        manifest = open_manifest(manifest_file, app);
+        if (!manifest)
+            return 1;
+    }
+    const batch_mode mode =
+        pipeline ? batch_mode::pipelined : batch_mode::per_index;
+    return process.process_batch(start_idx, end_idx, mode,
+                                 intra_image::automatic, manifest.get())
+               ? 0
+               : 1;
 }
 MAIN_TAIL
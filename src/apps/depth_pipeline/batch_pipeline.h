@@ -0,0 +1,349 @@
+#ifndef BATCH_PIPELINE_H_QM4RZ8TD
+#define BATCH_PIPELINE_H_QM4RZ8TD
+
+#include <algorithm>
+#include <depth_filter/filter_functor.h>
+#include <feature_performance/keypoint_distribution.h>
+#include <feature_performance/min_dist.h>
+#include <fmt/core.h>
+#include <functional>
+#include <gsl/gsl>
+#include <memory>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/persistence.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <optional>
+#include <sens_loc/camera_models/ray_cache.h>
+#include <sens_loc/conversion/depth_to_laserscan.h>
+#include <sens_loc/conversion/depth_to_multi.h>
+#include <sens_loc/io/feature.h>
+#include <sens_loc/math/image.h>
+#include <sens_loc/util/correctness_util.h>
+#include <sens_loc/util/trace.h>
+#include <string>
+#include <string_view>
+#include <util/batch_converter.h>
+#include <util/instance_pool.h>
+#include <utility>
+#include <vector>
+
+namespace sens_loc::apps {
+
+/// \addtogroup pipeline-driver
+/// @{
+
+/// Derived image type that the features are detected on.
+enum class feature_image {
+    horizontal,    ///< Horizontal bearing angle image.
+    vertical,      ///< Vertical bearing angle image.
+    diagonal,      ///< Diagonal bearing angle image.
+    antidiagonal,  ///< Antidiagonal bearing angle image.
+    flexion,       ///< Flexion image.
+    max_curve,     ///< Max-curve image.
+};
+
+/// Convert the command line argument to the typesafe enumeration.
+/// \pre \p option is one of the names of the derived images in depth2x
+inline feature_image str_to_feature_image(std::string_view option) {
+    if (option == "horizontal")
+        return feature_image::horizontal;
+    if (option == "vertical")
+        return feature_image::vertical;
+    if (option == "diagonal")
+        return feature_image::diagonal;
+    if (option == "anti-diagonal")
+        return feature_image::antidiagonal;
+    if (option == "flexion")
+        return feature_image::flexion;
+    if (option == "max-curve")
+        return feature_image::max_curve;
+
+    UNREACHABLE("no other derived images are allowed");  // LCOV_EXCL_LINE
+}
+
+/// \returns the transformation of the values of the derived image \p f to
+/// 16-bit pixels, the same as for the images of depth2x.
+inline conversion::quantization<ushort, float>
+feature_quantization(feature_image f) noexcept {
+    using namespace conversion;
+    switch (f) {
+    case feature_image::horizontal:
+    case feature_image::vertical:
+    case feature_image::diagonal:
+    case feature_image::antidiagonal:
+        return bearing_quantization<ushort, float>();
+    case feature_image::flexion: return flexion_quantization<ushort, float>();
+    case feature_image::max_curve:
+        return max_curve_quantization<ushort, float>();
+    }
+    UNREACHABLE("Switch is exhaustive");  // LCOV_EXCL_LINE
+}
+
+/// Configuration of the stages that are applied to each depth image and of
+/// the artifacts that are written. Empty output patterns are not written.
+struct pipeline_stages {
+    /// Filters for the depth image, applied in order.
+    std::vector<std::unique_ptr<abstract_filter>> filters;
+    /// Derived image the features are detected on.
+    feature_image feature = feature_image::flexion;
+    /// Creates the detector for the keypoints, that must not be empty. Each
+    /// worker thread uses its own detector.
+    std::function<cv::Ptr<cv::Feature2D>()> detector;
+    /// Creates the descriptor for the keypoints, no descriptors are
+    /// calculated if it is empty.
+    std::function<cv::Ptr<cv::Feature2D>()> descriptor;
+    /// Detect and describe the keypoints with the detector in a single pass,
+    /// because the descriptor is the same algorithm.
+    /// \pre \c keypoint_count is 0, because the strongest keypoints are
+    /// selected before the description
+    bool single_pass = false;
+    /// Keep only the keypoints with the highest response, 0 keeps all.
+    unsigned int keypoint_count = 0;
+    /// Norm to compare the descriptors, e.g. \c cv::NORM_HAMMING for binary
+    /// descriptors.
+    cv::NormTypes descriptor_norm = cv::NORM_L2;
+
+    std::string filtered_output;  ///< Filtered 16-bit depth images.
+    std::string feature_output;   ///< Derived 16-bit images, like depth2x.
+    std::string keypoint_output;  ///< YAML-files, like feature_extractor.
+    std::string plot_output;      ///< Plotted keypoints, like keypoint_plotter.
+};
+
+/// Filter, convert, detect and analyze each depth image without writing
+/// the intermediate results to disk.
+///
+/// The stages are the same as in \c depth_filter, \c depth2x,
+/// \c feature_extractor and the keypoint distribution and minimal descriptor
+/// distance of \c feature_performance. Both analyses work on the features
+/// of single images, the other analyses need pairs of images. The filtered
+/// depth image and the derived image stay floating-point images and are
+/// quantized only once for the detector.
+template <typename Intrinsic>
+class batch_pipeline : public batch_converter {
+  public:
+    /// \param files input images and the compression of the written images
+    /// \param t,intrinsic semantic of the depth images and the sensor model
+    /// \param stages configuration of the stages, must outlive the object
+    /// \param distribution accumulation of the keypoints for the
+    /// keypoint distribution, \c nullptr to skip the analysis
+    /// \param min_distances accumulation of the minimal descriptor
+    /// distances, \c nullptr to skip the analysis
+    batch_pipeline(const file_patterns&   files,
+                   depth_type             t,
+                   Intrinsic              intrinsic,
+                   const pipeline_stages& stages,
+                   keypoint_stat_data*    distribution,
+                   distance_stat_data*    min_distances)
+        : batch_converter(files)
+        , intrinsic{std::move(intrinsic)}
+        , rays{this->intrinsic}
+        , angles{this->intrinsic}
+        , _input_depth_type{t}
+        , _stages{stages}
+        , _distribution{distribution}
+        , _min_distances{min_distances}
+        , _detectors{_stages.detector}
+        , _descriptors{_stages.descriptor} {
+        // The first instance stays in the pool for the first worker.
+        const bool has_detector = !_detectors.acquire()->empty();
+        Expects(has_detector);
+        Expects(!_stages.single_pass || _stages.keypoint_count == 0U);
+    }
+
+  private:
+    [[nodiscard]] bool
+    process_file(const math::image<float>& depth_image,
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept override;
+
+    /// Convert the filtered \p depth into a range image.
+    [[nodiscard]] math::image<float>
+    to_range(const math::image<float>& depth, conversion_frame& frame) const
+        noexcept;
+
+    /// Detect and describe the features of \p image and write the requested
+    /// artifacts.
+    [[nodiscard]] bool detect(const math::image<uchar>& image,
+                              int                       idx,
+                              conversion_frame&         frame) const;
+
+    Intrinsic                              intrinsic;
+    camera_models::ray_cache<Intrinsic>    rays;
+    conversion::bearing_angles<Intrinsic> angles;
+    depth_type                             _input_depth_type;
+    const pipeline_stages&                 _stages;
+    keypoint_stat_data*                    _distribution;
+    distance_stat_data*                    _min_distances;
+
+    // The detectors and descriptors are not safe to use concurrently.
+    mutable instance_pool<cv::Ptr<cv::Feature2D>> _detectors;
+    mutable instance_pool<cv::Ptr<cv::Feature2D>> _descriptors;
+};
+
+template <typename Intrinsic>
+bool batch_pipeline<Intrinsic>::process_file(
+    const math::image<float>& depth_image,
+    int                       idx,
+    conversion_frame&         frame) const noexcept {
+    if (depth_image.w() != intrinsic.w() || depth_image.h() != intrinsic.h())
+        return false;
+
+    try {
+        const int w = depth_image.w();
+        const int h = depth_image.h();
+
+        math::image<float> depth = depth_image;
+        if (!_stages.filters.empty()) {
+            SENS_LOC_TRACE_SCOPE("filter");
+            for (const auto& op : _stages.filters)
+                depth = op->filter(depth);
+        }
+        if (!_stages.filtered_output.empty()) {
+            auto depth_16bit = frame.pool.get<ushort>(w, h);
+            math::convert(depth, depth_16bit);
+            frame.write(fmt::format(_stages.filtered_output, idx),
+                        depth_16bit.data());
+        }
+
+        const math::image<float> range = to_range(depth, frame);
+
+        // Pixels without the neighbours for a result are not written.
+        math::image<float> feature = frame.pool.get<float>(w, h);
+        cv::Mat            feature_pixels = feature.data();
+        feature_pixels                    = 0.F;
+
+        conversion::multi_images<float> out;
+        switch (_stages.feature) {
+        case feature_image::horizontal: out.horizontal = &feature; break;
+        case feature_image::vertical: out.vertical = &feature; break;
+        case feature_image::diagonal: out.diagonal = &feature; break;
+        case feature_image::antidiagonal: out.antidiagonal = &feature; break;
+        case feature_image::flexion: out.flexion = &feature; break;
+        case feature_image::max_curve: out.max_curve = &feature; break;
+        }
+        frame.convert(
+            [&]() { conversion::depth_to_multi(range, angles, rays, out); },
+            [&](tf::Taskflow& flow) {
+                conversion::par_depth_to_multi(range, angles, rays, out, flow);
+            });
+
+        const auto q = feature_quantization(_stages.feature);
+        if (!_stages.feature_output.empty()) {
+            auto    feature_16bit = frame.pool.get<ushort>(w, h);
+            cv::Mat target        = feature_16bit.data();
+            feature.data().convertTo(target, CV_16U, q.scale, q.offset);
+            frame.write(fmt::format(_stages.feature_output, idx),
+                        feature_16bit.data());
+        }
+
+        // The feature_extractor reads the 16-bit images and divides them by
+        // 255. The same scale keeps the thresholds of the detectors valid.
+        auto    gray        = frame.pool.get<uchar>(w, h);
+        cv::Mat gray_pixels = gray.data();
+        feature.data().convertTo(gray_pixels, CV_8U, q.scale / 255.,
+                                 q.offset / 255.);
+
+        return detect(gray, idx, frame);
+    } catch (...) { return false; }
+}
+
+template <typename Intrinsic>
+math::image<float>
+batch_pipeline<Intrinsic>::to_range(const math::image<float>& depth,
+                                    conversion_frame&         frame) const
+    noexcept {
+    switch (_input_depth_type) {
+    case depth_type::orthografic: {
+        math::image<float> result = frame.pool.get<float>(depth.w(), depth.h());
+        frame.convert(
+            [&]() {
+                conversion::depth_to_laserscan<float, float>(depth, rays,
+                                                             result);
+            },
+            [&](tf::Taskflow& flow) {
+                conversion::par_depth_to_laserscan<float, float>(
+                    depth, rays, result, flow);
+            });
+        return result;
+    }
+    case depth_type::euclidean: return depth;
+    }
+    UNREACHABLE("Switch is exhaustive");  // LCOV_EXCL_LINE
+}
+
+template <typename Intrinsic>
+bool batch_pipeline<Intrinsic>::detect(const math::image<uchar>& image,
+                                       int                       idx,
+                                       conversion_frame&         frame) const {
+    // The image itself is the mask for the detection, pixels without depth
+    // do not contain any geometry.
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat                   descriptors;
+    auto                      detector = _detectors.acquire();
+    if (_stages.single_pass) {
+        SENS_LOC_TRACE_SCOPE("detect_describe");
+        (*detector)->detectAndCompute(image.data(), image.data(), keypoints,
+                                      descriptors);
+    } else {
+        {
+            SENS_LOC_TRACE_SCOPE("detect");
+            (*detector)->detect(image.data(), keypoints, image.data());
+        }
+
+        if (_stages.keypoint_count != 0U &&
+            keypoints.size() > _stages.keypoint_count) {
+            auto c_it = keypoints.begin() + _stages.keypoint_count;
+            std::nth_element(
+                keypoints.begin(), c_it, keypoints.end(),
+                [](const cv::KeyPoint& kp1, const cv::KeyPoint& kp2) {
+                    return kp1.response > kp2.response;
+                });
+            keypoints.erase(c_it, keypoints.end());
+        }
+
+        if (auto descriptor = _descriptors.acquire(); !descriptor->empty()) {
+            SENS_LOC_TRACE_SCOPE("describe");
+            (*descriptor)->compute(image.data(), keypoints, descriptors);
+        }
+    }
+
+    if (!_stages.keypoint_output.empty()) {
+        SENS_LOC_TRACE_SCOPE("write");
+        const std::string source = _stages.feature_output.empty()
+                                       ? std::string{}
+                                       : fmt::format(_stages.feature_output,
+                                                     idx);
+        if (!io::write_features(fmt::format(_stages.keypoint_output, idx),
+                                source, keypoints, descriptors))
+            return false;
+    }
+
+    if (!_stages.plot_output.empty()) {
+        SENS_LOC_TRACE_SCOPE("plot");
+        cv::Mat plot;
+        cv::cvtColor(image.data(), plot, cv::COLOR_GRAY2BGR);
+        cv::drawKeypoints(plot, keypoints, plot, cv::Scalar::all(-1),
+                          cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS |
+                              cv::DrawMatchesFlags::DRAW_OVER_OUTIMG);
+        frame.write(fmt::format(_stages.plot_output, idx), plot);
+    }
+
+    if (_min_distances != nullptr) {
+        SENS_LOC_TRACE_SCOPE("analyze");
+        min_descriptor_distance{*_min_distances, _stages.descriptor_norm}(
+            idx, std::nullopt, descriptors);
+    }
+    if (_distribution != nullptr) {
+        SENS_LOC_TRACE_SCOPE("analyze");
+        keypoint_distribution{*_distribution}(idx, std::move(keypoints),
+                                              std::nullopt);
+    }
+    return true;
+}
+
+/// @}
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: BATCH_PIPELINE_H_QM4RZ8TD */
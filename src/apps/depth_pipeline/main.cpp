@@ -0,0 +1,392 @@
+#define _LIBCPP_ENABLE_THREAD_SAFETY_ANNOTATIONS
+#include "batch_pipeline.h"
+
+#define CLI11_HAS_FILESYSTEM 0
+#include <CLI/CLI.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <depth_filter/filter_functor.h>
+#include <feature_performance/keypoint_distribution.h>
+#include <feature_performance/min_dist.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <opencv2/features2d.hpp>
+#include <opencv2/xfeatures2d.hpp>
+#include <optional>
+#include <rang.hpp>
+#include <sens_loc/camera_models/equirectangular.h>
+#include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/io/intrinsics.h>
+#include <sens_loc/io/sequence.h>
+#include <sens_loc/util/console.h>
+#include <sens_loc/util/correctness_util.h>
+#include <sens_loc/version.h>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <util/batch_converter.h>
+#include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/shard.h>
+#include <util/tool_macro.h>
+#include <util/tracing.h>
+#include <util/version_printer.h>
+#include <variant>
+#include <vector>
+
+/// \defgroup pipeline-driver in-process processing pipeline
+///
+/// Tool that chains the filtering, conversion, feature detection and the
+/// analyses of single images in memory.
+
+namespace {
+using namespace sens_loc;
+
+using intrinsic_variant =
+    std::variant<camera_models::pinhole<float>,
+                 camera_models::equirectangular<float>>;
+
+/// Create the detector or descriptor \p name with its default parameters.
+/// \returns an empty pointer for "none".
+cv::Ptr<cv::Feature2D> make_feature2d(std::string_view name) {
+    using cv::AgastFeatureDetector;
+    using cv::AKAZE;
+    using cv::BRISK;
+    using cv::ORB;
+    using cv::xfeatures2d::SIFT;
+    using cv::xfeatures2d::SURF;
+
+    if (name == "orb")
+        return ORB::create();
+    if (name == "sift")
+        return SIFT::create();
+    if (name == "surf")
+        return SURF::create();
+    if (name == "akaze")
+        return AKAZE::create();
+    if (name == "brisk")
+        return BRISK::create();
+    if (name == "agast")
+        return AgastFeatureDetector::create();
+    if (name == "none")
+        return {};
+    UNREACHABLE("Unexpected detector/descriptor provided!");  // LCOV_EXCL_LINE
+}
+}  // namespace
+
+/// Driver that runs the whole processing of depth images in one process.
+/// \ingroup pipeline-driver
+/// \returns 0 if all images could be processed, 1 if any image fails
+MAIN_HEAD("Filter, convert and detect features in depth images in one pass.") {
+    app.set_config("--config", "",
+                   "INI-file with the options of the pipeline, one "
+                   "'option = value' per line, e.g. 'feature = flexion'");
+    app.footer("\n\n"
+               "An example invocation of the tool is:\n"
+               "\n"
+               "depth_pipeline --config pipeline.ini\n"
+               "\n"
+               "with 'pipeline.ini' containing:\n"
+               "\n"
+               "calibration = intrinsic.txt\n"
+               "input = depth_{:04d}.png\n"
+               "start = 0\n"
+               "end = 100\n"
+               "filter = median-blur\n"
+               "feature = flexion\n"
+               "detector = orb\n"
+               "descriptor = orb\n"
+               "keypoint-output = features_{:04d}.yaml\n"
+               "\n"
+               "This will read 'depth_0000.png ...', filter them, convert "
+               "them to flexion images and write the ORB-features to "
+               "'features_0000.yaml ...'.\n"
+               "No intermediate image is written, unless requested.\n"
+               "The analyses of single images run within the pipeline. "
+               "The matching and the recognition performance compare pairs "
+               "of images, they analyze the files of '--keypoint-output' "
+               "with 'feature_performance'.");
+
+    string calibration_file;
+    app.add_option("-c,--calibration", calibration_file,
+                   "File that contains calibration parameters for the camera, "
+                   "optional for archives that contain the calibration")
+        ->check(CLI::ExistingFile);
+    string camera_model = "pinhole";
+    app.add_set("-m,--model", camera_model, {"pinhole", "equirectangular"},
+                "Camera model that describes the project of the pixels "
+                "into cartesian space", /*defaulted=*/true);
+
+    file_patterns files;
+    app.add_option("-i,--input", files.input,
+                   "Input pattern for image, e.g. \"depth-{}.png\", or a depth "
+                   "sequence archive, e.g. \"depth.dseq\"")
+        ->required();
+    string input_type = "pinhole-depth";
+    app.add_set("-t,--type", input_type, {"pinhole-depth", "pinhole-range"},
+                "Type of input depth images, either euclidean depths "
+                "(pinhole-range) or orthographic depths (pinhole-depth)",
+                /*defaulted=*/true);
+    int start_idx = 0;
+    app.add_option("-s,--start", start_idx, "Start index of batch, inclusive")
+        ->required();
+    int end_idx = 0;
+    app.add_option("-e,--end", end_idx, "End index of batch, inclusive")
+        ->required();
+    bool pipeline = false;
+    app.add_flag("--pipeline", pipeline,
+                 "Overlap reading and writing files with the processing in "
+                 "separate pipeline stages");
+    shard part;
+    add_shard_option(app, part);
+    string thread_policy = "outer";
+    app.add_set("--thread-policy", thread_policy, {"outer", "inner", "hybrid"},
+                "Distribution of the threads between the images and the "
+                "OpenCV functions, see 'depth_filter'",
+                /*defaulted=*/true);
+
+    // Filter stage
+    string filter = "none";
+    app.add_set("--filter", filter, {"none", "bilateral", "median-blur"},
+                "Filter that is applied to the depth images",
+                /*defaulted=*/true);
+    double       sigma_color = NAN;
+    CLI::Option* sigma_color_option =
+        app.add_option("--bilateral-sigma-color", sigma_color,
+                       "Threshold for depth similarity of the bilateral "
+                       "filter");
+    int          distance        = 0;
+    CLI::Option* distance_option = app.add_option(
+        "--bilateral-distance", distance,
+        "Neighbourhood of the bilateral filter, diameter in pixel");
+    double       sigma_space = NAN;
+    CLI::Option* sigma_space_option =
+        app.add_option("--bilateral-sigma-space", sigma_space,
+                       "Neighbourhood of the bilateral filter, closeness is "
+                       "computed from that value");
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    int kernel_size_median = 5;
+    app.add_set("--median-distance", kernel_size_median,
+                {3, 5},  // NOLINT(cppcoreguidelines-avoid-magic-numbers)
+                "Distance of the pixels for the median-blur",
+                /*defaulted=*/true);
+
+    // Conversion stage
+    string feature = "flexion";
+    app.add_set("--feature", feature,
+                {"horizontal", "vertical", "diagonal", "anti-diagonal",
+                 "flexion", "max-curve"},
+                "Derived image that the features are detected on",
+                /*defaulted=*/true);
+
+    // Extraction stage
+    string detector = "orb";
+    app.add_set("--detector", detector,
+                {"orb", "sift", "surf", "akaze", "brisk", "agast"},
+                "Keypoint detector with its default parameters",
+                /*defaulted=*/true);
+    string descriptor = "none";
+    app.add_set("--descriptor", descriptor,
+                {"none", "orb", "sift", "surf", "akaze", "brisk"},
+                "Keypoint descriptor with its default parameters",
+                /*defaulted=*/true);
+    unsigned int keypoint_count = 0;
+    app.add_option("--keypoint-count", keypoint_count,
+                   "Keep only the keypoints with the highest response, 0 "
+                   "keeps all keypoints. A limit detects and describes the "
+                   "keypoints in separate passes",
+                   /*defaulted=*/true);
+
+    // Artifacts, only the requested ones are written.
+    pipeline_stages stages;
+    app.add_option("--filtered-output", stages.filtered_output,
+                   "Output pattern for the filtered 16-bit depth images");
+    app.add_option("--feature-output", stages.feature_output,
+                   "Output pattern for the derived 16-bit images");
+    app.add_option("--keypoint-output", stages.keypoint_output,
+                   "Output pattern for the feature files with keypoints and "
+                   "descriptors, e.g. \"features-{}.feature\" for the binary "
+                   "or \"features-{}.yaml\" for the YAML format");
+    app.add_option("--plot-output", stages.plot_output,
+                   "Output pattern for the images with plotted keypoints");
+    app.add_option("--output-compression", files.output_compression,
+                   "Compression level of the output images, see depth2x")
+        ->check(CLI::Range(0, 9));
+
+    // Analysis stage
+    optional<string> distribution_output;
+    CLI::Option*     distribution_option = app.add_option(
+        "--distribution-output", distribution_output,
+        "Analyze the keypoint distribution of all images and write the "
+        "statistics to this YAML-file");
+    optional<string> response_histo;
+    app.add_option("--response-histo", response_histo,
+                   "Histogram of the keypoint responses")
+        ->needs(distribution_option);
+    optional<string> size_histo;
+    app.add_option("--size-histo", size_histo,
+                   "Histogram of the keypoint sizes")
+        ->needs(distribution_option);
+    optional<string> kp_distance_histo;
+    app.add_option("--kp-distance-histo", kp_distance_histo,
+                   "Histogram of the minimal distance between keypoints")
+        ->needs(distribution_option);
+    optional<string> kp_distribution_histo;
+    app.add_option("--kp-distribution-histo", kp_distribution_histo,
+                   "2D-Histogram of the keypoint locations")
+        ->needs(distribution_option);
+    optional<string> min_distance_output;
+    CLI::Option*     min_distance_option = app.add_option(
+        "--min-distance-output", min_distance_output,
+        "Analyze the minimal distance between the descriptors within each "
+        "image and write the statistics to this YAML-file. Binary "
+        "descriptors are compared with the hamming norm, the others with L2");
+    optional<string> min_distance_histo;
+    app.add_option("--min-distance-histo", min_distance_histo,
+                   "Histogram of the minimal descriptor distances")
+        ->needs(min_distance_option);
+
+    COLORED_APP_PARSE(app, argc, argv);
+
+    if (stages.filtered_output.empty() && stages.feature_output.empty() &&
+        stages.keypoint_output.empty() && stages.plot_output.empty() &&
+        !distribution_output && !min_distance_output) {
+        cerr << util::err{} << "Request at least one output of the pipeline!\n";
+        return 1;
+    }
+    if (min_distance_output && descriptor == "none") {
+        cerr << util::err{}
+             << "The minimal descriptor distance requires a descriptor!\n";
+        return 1;
+    }
+
+    const auto indices = select_shard(part, start_idx, end_idx);
+    if (!indices)
+        return 0;
+    tie(start_idx, end_idx) = *indices;
+
+    // Explicitly disable threading from OpenCV functions, as the
+    // parallelization is done at a higher level, unless the images are
+    // processed one after another by the thread policy.
+    // That means, that each filter application is not multithreaded, but each
+    // image modification is. This is necessary as "TaskFlow" does not play
+    // nice with OpenCV threading and they introduce data races in the program
+    // because of that.
+    // The threads are split once the batch skipped the up-to-date images.
+    set_thread_policy(thread_policy);
+
+    if (filter == "bilateral") {
+        if (sigma_color_option->count() == 0U ||
+            (distance_option->count() == 0U &&
+             sigma_space_option->count() == 0U)) {
+            cerr << util::err{} << "Provide a depth similarity and a "
+                                   "proximity-measure for the bilateral "
+                                   "filter!\n";
+            return 1;
+        }
+        if (distance_option->count() > 0U)
+            stages.filters.push_back(
+                make_unique<bilateral_filter>(sigma_color, distance));
+        else
+            stages.filters.push_back(
+                make_unique<bilateral_filter>(sigma_color, sigma_space));
+    } else if (filter == "median-blur")
+        stages.filters.push_back(
+            make_unique<median_blur_filter>(kernel_size_median));
+
+    stages.feature        = str_to_feature_image(feature);
+    stages.keypoint_count = keypoint_count;
+    // The other descriptors are vectors of floating point numbers.
+    const bool binary_descriptor =
+        descriptor == "orb" || descriptor == "akaze" || descriptor == "brisk";
+    stages.descriptor_norm =
+        binary_descriptor ? cv::NORM_HAMMING : cv::NORM_L2;
+
+    // Each worker creates its own detector and descriptor.
+    stages.detector   = [detector]() { return make_feature2d(detector); };
+    stages.descriptor = [descriptor]() { return make_feature2d(descriptor); };
+    // The default configurations of the same algorithm are identical.
+    // The strongest keypoints must be selected before the descriptor drops
+    // keypoints, which requires separate passes.
+    stages.single_pass = detector == descriptor && keypoint_count == 0U;
+
+    // Archives contain the intrinsic of their sensor, that is used if no
+    // calibration file is provided.
+    ifstream      cali_fstream{calibration_file};
+    istringstream archive_intrinsic;
+    if (calibration_file.empty() && batch_converter::is_archive(files.input)) {
+        if (auto archive = io::depth_sequence::open(files.input))
+            archive_intrinsic.str(string(archive->intrinsic()));
+    }
+    istream& cali_stream = calibration_file.empty()
+                               ? static_cast<istream&>(archive_intrinsic)
+                               : cali_fstream;
+
+    const auto potential_intrinsic = [&]() -> optional<intrinsic_variant> {
+        using camera_models::equirectangular;
+        using camera_models::pinhole;
+
+#define LOAD_INTRINSIC(model_name)                                             \
+    if (camera_model == #model_name) {                                         \
+        auto r = io::camera<float, model_name>::load_intrinsic(cali_stream);   \
+        if (r)                                                                 \
+            return *r;                                                         \
+        return nullopt;                                                        \
+    }
+        LOAD_INTRINSIC(pinhole);
+        LOAD_INTRINSIC(equirectangular);
+
+#undef LOAD_INTRINSIC
+        UNREACHABLE("unexpected camera model received "  // LCOV_EXCL_LINE
+                    "from command line parsing");        // LCOV_EXCL_LINE
+    }();
+
+    if (!potential_intrinsic) {
+        cerr << util::err{};
+        cerr << "Could not load intrinsic calibration \"" << rang::style::bold
+             << calibration_file << rang::style::reset << "\"!\n";
+        return 1;
+    }
+
+    keypoint_stat_data distribution_data;
+    distance_stat_data min_distance_data;
+    const batch_mode   mode =
+        pipeline ? batch_mode::pipelined : batch_mode::per_index;
+
+    const auto [success, w, h] = std::visit(
+        [&](auto&& intrinsic) {
+            using Intrinsic = std::decay_t<decltype(intrinsic)>;
+            const batch_pipeline<Intrinsic> p(
+                files, str_to_depth_type(input_type), intrinsic, stages,
+                distribution_output ? &distribution_data : nullptr,
+                min_distance_output ? &min_distance_data : nullptr);
+            return std::make_tuple(p.process_batch(start_idx, end_idx, mode),
+                                   intrinsic.w(), intrinsic.h());
+        },
+        *potential_intrinsic);
+
+    if (distribution_output) {
+        const size_t n_keypoints =
+            keypoint_distribution{distribution_data}.postprocess(
+                gsl::narrow<unsigned int>(w), gsl::narrow<unsigned int>(h),
+                distribution_output, response_histo, size_histo,
+                kp_distance_histo, kp_distribution_histo);
+        if (n_keypoints == 0UL) {
+            cerr << util::err{} << "No keypoints for the distribution!\n";
+            return 1;
+        }
+    }
+    if (min_distance_output) {
+        const size_t n_distances =
+            min_descriptor_distance{min_distance_data, stages.descriptor_norm}
+                .postprocess(min_distance_output, min_distance_histo);
+        if (n_distances == 0UL) {
+            cerr << util::err{} << "No descriptors for the minimal distance!\n";
+            return 1;
+        }
+    }
+    return success ? 0 : 1;
+}
+MAIN_TAIL
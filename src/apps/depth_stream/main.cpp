@@ -0,0 +1,182 @@
+#include <CLI/CLI.hpp>
+#include <atomic>
+#include <fmt/core.h>
+#include <opencv2/imgcodecs.hpp>
+#include <optional>
+#include <rang.hpp>
+#include <sens_loc/io/image.h>
+#include <sens_loc/io/stream.h>
+#include <sens_loc/util/console.h>
+#include <sens_loc/version.h>
+#include <string>
+#include <thread>
+#include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/tool_macro.h>
+#include <util/tracing.h>
+#include <util/version_printer.h>
+
+/// \defgroup stream-driver frame stream client
+///
+/// Tool to send images to the streaming mode of the batch tools and to
+/// receive their results.
+
+namespace {
+using namespace sens_loc;
+
+/// Send the images \p input_pattern in [start, end] to \p stream.
+/// The images are numbered from 0 in the order they are sent.
+/// \returns \c true if all images were sent.
+bool send_images(io::frame_stream&  stream,
+                 const std::string& input_pattern,
+                 int                start,
+                 int                end) {
+    bool success = true;
+    for (int idx = start; idx <= end && success; ++idx) {
+        const std::string input = fmt::format(input_pattern, idx);
+        const cv::Mat     image = cv::imread(input, cv::IMREAD_UNCHANGED);
+        if (image.empty()) {
+            std::cerr << util::err{} << "Could not load image \""
+                      << rang::style::bold << input << rang::style::reset
+                      << "\"!\n";
+            success = false;
+            break;
+        }
+        success = stream.write(static_cast<std::uint32_t>(idx - start), 0, 1,
+                               image);
+        if (!success && stream.peer_closed())
+            std::cerr << util::err{} << "The reader closed the stream before "
+                      << "image \"" << rang::style::bold << input
+                      << rang::style::reset << "\" was sent!\n";
+        else if (!success)
+            std::cerr << util::err{} << "Could not send image \""
+                      << rang::style::bold << input << rang::style::reset
+                      << "\"!\n";
+    }
+    stream.shutdown_write();
+    return success;
+}
+
+/// Write all images of \p stream to \p output_pattern until it ends.
+/// The pattern is formatted with the index, that is \p start plus the
+/// sequence number, and the part of each image.
+/// \returns \c true if the stream ended regularly and all images were
+/// written.
+bool receive_images(io::frame_stream&  stream,
+                    const std::string& output_pattern,
+                    int                start) {
+    io::stream_header header;
+    cv::Mat           image;
+    io::stream_status status = io::stream_status::frame;
+    while ((status = stream.read(header, image)) == io::stream_status::frame) {
+        const std::string output = fmt::format(
+            output_pattern, start + static_cast<int>(header.sequence),
+            header.part);
+        if (!io::write_image(output, image, -1)) {
+            std::cerr << util::err{} << "Could not write image \""
+                      << rang::style::bold << output << rang::style::reset
+                      << "\"!\n";
+            return false;
+        }
+    }
+    if (status == io::stream_status::error) {
+        std::cerr << util::err{} << "The received stream is broken!\n";
+        return false;
+    }
+    return true;
+}
+}  // namespace
+
+/// Client for the streaming mode of the batch tools.
+/// \sa sens_loc::io::frame_stream
+/// \ingroup stream-driver
+/// \returns 0 on success, 1 on any failure
+MAIN_HEAD("Send images to a frame stream and receive the results") {
+    app.footer("\n\n"
+               "An example invocation of the tool is:\n"
+               "\n"
+               "depth_stream --input depth_{:04d}.png \\\n"
+               "             --start 0 \\\n"
+               "             --end 100 \\\n"
+               "             --connect unix:/tmp/depth2x.sock \\\n"
+               "             --output flexion_{:04d}_{}.png\n"
+               "\n"
+               "This sends 'depth_0000.png ...' to a tool that listens on "
+               "the socket, e.g. 'depth2x --stream-input "
+               "unix:/tmp/depth2x.sock flexion ...',\n"
+               "and writes the results to 'flexion_0000_0.png ...'.\n"
+               "With '--connect -' the images are sent to stdout and the "
+               "results read from stdin.");
+
+    string input_pattern;
+    CLI::Option* input_opt = app.add_option(
+        "-i,--input", input_pattern,
+        "Input pattern for the images that are sent, e.g. \"depth-{}.png\"");
+    int start_idx = 0;
+    app.add_option("-s,--start", start_idx,
+                   "Start index of the images, inclusive. Received images "
+                   "are numbered from this index, too.",
+                   /*defaulted=*/true);
+    int end_idx = 0;
+    app.add_option("-e,--end", end_idx, "End index of the images, inclusive")
+        ->needs(input_opt);
+    string output_pattern;
+    CLI::Option* output_opt = app.add_option(
+        "-o,--output", output_pattern,
+        "Output pattern for the received images with the index and the part "
+        "of each image, e.g. \"result-{}-{}.png\"");
+    string connect = "-";
+    app.add_option("-c,--connect", connect,
+                   "Stream to use, '-' for stdout and stdin, 'unix:PATH' to "
+                   "connect to the Unix-domain socket PATH or a file or FIFO",
+                   /*defaulted=*/true);
+
+    COLORED_APP_PARSE(app, argc, argv);
+
+    if (!*input_opt && !*output_opt) {
+        cerr << util::err{} << "Nothing to do, provide '--input' or "
+                               "'--output'!\n";
+        return 1;
+    }
+    if (*input_opt && start_idx > end_idx)
+        swap(start_idx, end_idx);
+
+    // A socket is a single connection in both directions, other streams
+    // are opened for each direction.
+    const bool                 socket = io::frame_stream::is_socket(connect);
+    optional<io::frame_stream> sending;
+    optional<io::frame_stream> receiving;
+    if (*input_opt)
+        sending = io::frame_stream::open(connect, io::stream_mode::write,
+                                         io::socket_role::connect);
+    if (*output_opt && !(socket && sending))
+        receiving = io::frame_stream::open(connect, io::stream_mode::read,
+                                           io::socket_role::connect);
+    io::frame_stream* in = socket && sending ? &*sending
+                           : receiving       ? &*receiving
+                                             : nullptr;
+
+    if ((*input_opt && !sending) || (*output_opt && in == nullptr)) {
+        cerr << util::err{} << "Could not open the stream \""
+             << rang::style::bold << connect << rang::style::reset
+             << "\"!\n";
+        return 1;
+    }
+
+    // The results are received while sending, otherwise both sides could
+    // wait for the other to read.
+    atomic<bool> received{true};
+    thread       receiver;
+    if (*output_opt)
+        receiver = thread([&]() {
+            received = receive_images(*in, output_pattern, start_idx);
+        });
+    const bool sent =
+        !*input_opt || send_images(*sending, input_pattern, start_idx,
+                                   end_idx);
+    if (receiver.joinable())
+        receiver.join();
+
+    return sent && received ? 0 : 1;
+}
+MAIN_TAIL
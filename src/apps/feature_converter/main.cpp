@@ -0,0 +1,97 @@
+#include <CLI/CLI.hpp>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <iostream>
+#include <rang.hpp>
+#include <sens_loc/io/feature.h>
+#include <sens_loc/util/console.h>
+#include <string>
+#include <tuple>
+#include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/parallel_processing.h>
+#include <util/shard.h>
+#include <util/tool_macro.h>
+#include <util/tracing.h>
+#include <util/version_printer.h>
+
+/// \defgroup feature-converter-driver Conversion of feature files
+///
+/// Tool to migrate feature files between the YAML and the binary format.
+
+namespace {
+using namespace sens_loc;
+
+/// Convert the feature file \p idx of \p input_pattern into the file of
+/// \p output_pattern in the format of its extension.
+/// \ingroup feature-converter-driver
+bool convert_index(const std::string& input_pattern,
+                   const std::string& output_pattern,
+                   int                idx) noexcept {
+    try {
+        const std::string      input = fmt::format(input_pattern, idx);
+        const io::feature_file in    = io::open_feature_file(input);
+        if (!in.is_open()) {
+            auto s = synced();
+            std::cerr << util::err{} << "Could not open the feature file \""
+                      << rang::style::bold << input << rang::style::reset
+                      << "\"!\n";
+            return false;
+        }
+        return io::write_features(fmt::format(output_pattern, idx),
+                                  in.source_path(), in.keypoints(),
+                                  in.descriptors());
+    } catch (...) { return false; }
+}
+}  // namespace
+
+/// Parallelized driver to convert feature files between the formats.
+/// \ingroup feature-converter-driver
+/// \returns 0 if all files could be converted, 1 if any file fails
+MAIN_HEAD("Batch-processing tool to convert feature files") {
+    app.footer("\n\n"
+               "An example invocation of the tool is:\n"
+               "\n"
+               "feature_converter --input  'sift-{}.feature.gz' \\\n"
+               "                  --output 'sift-{}.feature'    \\\n"
+               "                  --start 0 --end 100\n"
+               "\n"
+               "The output format is selected by the extension of the "
+               "output pattern.\n"
+               "'.yml', '.yaml' and '.gz' files are written as YAML, all "
+               "other files\n"
+               "in the binary format. The input format is detected "
+               "automatically.\n");
+
+    string input_pattern;
+    app.add_option("-i,--input", input_pattern,
+                   "Input pattern for the feature files, e.g. "
+                   "\"sift-{}.feature.gz\"")
+        ->required();
+    string output_pattern;
+    app.add_option("-o,--output", output_pattern,
+                   "Output pattern for the converted feature files")
+        ->required();
+    int start_idx = 0;
+    app.add_option("-s,--start", start_idx, "Start index of batch, inclusive")
+        ->required();
+    int end_idx = 0;
+    app.add_option("-e,--end", end_idx, "End index of batch, inclusive")
+        ->required();
+    shard part;
+    add_shard_option(app, part);
+
+    COLORED_APP_PARSE(app, argc, argv);
+
+    const auto indices = select_shard(part, start_idx, end_idx);
+    if (!indices)
+        return 0;
+    tie(start_idx, end_idx) = *indices;
+
+    const bool success = parallel_indexed_file_processing(
+        start_idx, end_idx, [&](int idx) noexcept {
+            return convert_index(input_pattern, output_pattern, idx);
+        });
+    return success ? 0 : 1;
+}
+MAIN_TAIL
@@ -1,82 +1,155 @@
 #include "batch_extractor.h"
+#include "keypoint_selection.h"
 
 #include <algorithm>
 #include <chrono>
 #include <fmt/core.h>
+#include <gsl/gsl>
 #include <opencv2/core.hpp>
-#include <opencv2/core/persistence.hpp>
 #include <opencv2/features2d.hpp>
+#include <sens_loc/io/feature.h>
 #include <sens_loc/io/image.h>
+#include <sens_loc/io/manifest.h>
 #include <sens_loc/math/image.h>
 #include <sens_loc/util/console.h>
+#include <sens_loc/util/trace.h>
 #include <taskflow/taskflow.hpp>
+#include <util/executor.h>
+#include <util/incremental.h>
 #include <util/parallel_processing.h>
 #include <utility>
 
 namespace sens_loc::apps {
 
-bool batch_extractor::process_batch(int start, int end) const noexcept {
+bool batch_extractor::process_batch(int                 start,
+                                    int                 end,
+                                    batch_mode          mode,
+                                    io::batch_manifest* manifest) const
+    noexcept {
+    std::vector<int> indices;
+    try {
+        indices = pending_indices(index_range(start, end), manifest,
+                                  [this](int idx) {
+                                      return fmt::format(_input_pattern, idx);
+                                  });
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in batch processing!\n";
+        return false;
+    }
+    if (indices.empty())
+        return true;
+    apply_thread_policy(gsl::narrow<int>(indices.size()));
+
+    if (mode == batch_mode::pipelined)
+        return pipelined_indexed_file_processing<feature_frame>(
+            indices,
+            [this](int idx, feature_frame& f) noexcept {
+                return decode_index(idx, f);
+            },
+            [this](int idx, feature_frame& f) noexcept {
+                return compute_index(idx, f);
+            },
+            [this, manifest](int idx, feature_frame& f) noexcept {
+                return encode_index(idx, f, manifest);
+            });
+
     return parallel_indexed_file_processing(
-        start, end, [this](int idx) noexcept { return process_index(idx); });
+        indices, [this, manifest](int idx) noexcept {
+            return process_index(idx, manifest);
+        });
 }
 
-bool batch_extractor::process_index(int idx) const noexcept {
-    const std::string                 p = fmt::format(_input_pattern, idx);
-    std::optional<math::image<uchar>> f = io::load_as_8bit_gray(p);
+bool batch_extractor::process_index(int                 idx,
+                                    io::batch_manifest* manifest) const
+    noexcept {
+    feature_frame f;
+    return decode_index(idx, f) && compute_index(idx, f) &&
+           encode_index(idx, f, manifest);
+}
+
+bool batch_extractor::decode_index(int idx, feature_frame& f) const noexcept {
+    SENS_LOC_TRACE_SCOPE("load");
+    f.in_file = fmt::format(_input_pattern, idx);
+    std::optional<math::image<uchar>> image = io::load_as_8bit_gray(f.in_file);
 
-    if (!f)
+    if (!image)
         return false;
 
-    return process_detector(*f, fmt::format(_ouput_pattern, idx), p);
+    f.image = std::move(*image);
+    return true;
 }
 
-/// Applies \c detector to each image loaded from \c in_pattern, substituted
-/// with \c idx.
-/// The keypoints and descriptors are detected and written in a YAML-file
+bool batch_extractor::compute_index(int /*idx*/,
+                                    feature_frame& f) const noexcept {
+    try {
+        compute_features(f.image, f.keypoints, f.descriptors);
+        return true;
+    } catch (...) { return false; }
+}
+
+/// The keypoints and descriptors are written in a feature file
 /// in \c out_pattern, substituted with \c idx.
-bool batch_extractor::process_detector(const math::image<uchar>& image,
-                                       const std::string&        out_file,
-                                       const std::string&        in_file) const
+/// \sa io::feature_format_for
+bool batch_extractor::encode_index(int                 idx,
+                                   feature_frame&      f,
+                                   io::batch_manifest* manifest) const
     noexcept {
-
-    const auto [keypoints, descriptors] = compute_features(image);
-
+    SENS_LOC_TRACE_SCOPE("write");
     try {
-        using cv::FileNode;
-        using cv::FileStorage;
+        const string out_file = fmt::format(_ouput_pattern, idx);
+        if (!io::write_features(out_file, f.in_file, f.keypoints,
+                                f.descriptors))
+            return false;
 
-        FileStorage fs{out_file, FileStorage::WRITE | FileStorage::FORMAT_YAML};
-        cv::write(fs, "source_path", in_file);
-        cv::write(fs, "keypoints", keypoints);
-        cv::write(fs, "descriptors", descriptors);
-
-        return true;
+        // The file is complete once it is closed.
+        return manifest == nullptr || manifest->record(idx, {out_file});
     } catch (...) {
         return false;
     }
 }
 
-std::pair<std::vector<cv::KeyPoint>, cv::Mat>
-batch_extractor::compute_features(const math::image<uchar>& img) const
-    noexcept {
+void batch_extractor::compute_features(const math::image<uchar>& img,
+                                       std::vector<cv::KeyPoint>& keypoints,
+                                       cv::Mat& descriptors) const {
     using namespace std;
 
+    // Removes every keypoint that is matched by the '_keypoint_filter'.
+    auto filter_keypoints = [this](vector<cv::KeyPoint>& kps) {
+        for (auto&& f : _keypoint_filter) {
+            auto new_end = f(kps);
+            kps.erase(new_end, end(kps));
+        }
+    };
+
     // The image itself is the mask for feature detection.
     // That is the reason, because the pixels with 0 as value do not contain
     // any information on the geometry.
-    vector<cv::KeyPoint> keypoints;
-    _detector->detect(img.data(), keypoints, img.data());
-
-    // Removes every keypoint that is matched by the '_keypoint_filter'.
-    for (auto&& f : _keypoint_filter) {
-        auto new_end = f(keypoints);
-        keypoints.erase(new_end, end(keypoints));
+    keypoints.clear();
+    auto detector = _detectors.acquire();
+
+    if (_single_pass) {
+        {
+            SENS_LOC_TRACE_SCOPE("detect_describe");
+            (*detector)->detectAndCompute(img.data(), img.data(), keypoints,
+                                          descriptors);
+        }
+        select_described_keypoints(keypoints, descriptors, filter_keypoints);
+        return;
     }
 
-    cv::Mat descriptors;
-    if (!_descriptor.empty())
-        _descriptor->compute(img.data(), keypoints, descriptors);
+    {
+        SENS_LOC_TRACE_SCOPE("detect");
+        (*detector)->detect(img.data(), keypoints, img.data());
+    }
+    filter_keypoints(keypoints);
 
-    return make_pair(move(keypoints), move(descriptors));
+    auto descriptor = _descriptors.acquire();
+    if (descriptor->empty()) {
+        descriptors.release();
+        return;
+    }
+    SENS_LOC_TRACE_SCOPE("describe");
+    (*descriptor)->compute(img.data(), keypoints, descriptors);
 }
 }  // namespace sens_loc::apps
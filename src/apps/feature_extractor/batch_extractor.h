@@ -7,7 +7,13 @@
 #include <opencv2/features2d.hpp>
 #include <opencv2/xfeatures2d.hpp>
 #include <optional>
+#include <sens_loc/io/manifest.h>
+#include <sens_loc/math/image.h>
 #include <sens_loc/util/correctness_util.h>
+#include <string>
+#include <util/instance_pool.h>
+#include <util/parallel_processing.h>
+#include <vector>
 
 using namespace std;
 using namespace cv;
@@ -20,51 +26,91 @@ namespace sens_loc::apps {
 class batch_extractor {
   public:
     using filter_func = function<vector<KeyPoint>::iterator(vector<KeyPoint>&)>;
+    using feature_pool    = instance_pool<Ptr<Feature2D>>;
+    using feature_factory = feature_pool::factory;
 
-    /// \param detector,descriptor Algorithms used for detection and
-    /// description.
+    /// \param detector,descriptor Factories for the algorithms used for
+    /// detection and description. Each worker thread uses its own instances,
+    /// because the algorithms are not safe to use concurrently. The
+    /// descriptor factory returns an empty pointer if no descriptors are
+    /// calculated.
+    /// \param single_pass detect and describe the features with the detector
+    /// in a single pass, because the descriptor is the same algorithm with
+    /// the same configuration. The keypoint filters are applied afterwards,
+    /// so they must only drop keypoints by their own properties.
     /// \param input_pattern,output_pattern Formattable string for IO.
     /// \param keypoint_filter Callable that determines if a keypoint shall be
     /// dropped from consideration. All keypoints with 'keypoint_filter(kp) ==
     /// true' are removed.
-    batch_extractor(Ptr<Feature2D>      detector,
-                    Ptr<Feature2D>      descriptor,
+    batch_extractor(feature_factory     detector,
+                    feature_factory     descriptor,
+                    bool                single_pass,
                     string_view         input_pattern,
                     string_view         output_pattern,
                     vector<filter_func> keypoint_filter)
-        : _detector{move(detector)}
-        , _descriptor{move(descriptor)}
+        : _detectors{move(detector)}
+        , _descriptors{move(descriptor)}
+        , _single_pass{single_pass}
         , _input_pattern{input_pattern}
         , _ouput_pattern{output_pattern}
         , _keypoint_filter{move(keypoint_filter)} {
         Expects(!_input_pattern.empty());
         Expects(!_ouput_pattern.empty());
-        Expects(!_detector.empty());
+        // The first instance stays in the pool for the first worker.
+        const bool has_detector = !_detectors.acquire()->empty();
+        Expects(has_detector);
     }
 
     /// Process a whole batch of files in the range [start, end].
-    [[nodiscard]] bool process_batch(int start, int end) const noexcept;
+    /// \param mode process each index in one task or in a pipeline that
+    /// overlaps reading and writing files with the feature detection
+    /// \param manifest skip the indices that are up to date in the manifest
+    /// and record the finished ones, \c nullptr processes all indices
+    [[nodiscard]] bool
+    process_batch(int                 start,
+                  int                 end,
+                  batch_mode          mode     = batch_mode::per_index,
+                  io::batch_manifest* manifest = nullptr) const noexcept;
 
   private:
+    /// Input and results of one index while it is processed.
+    struct feature_frame {
+        string             in_file;
+        math::image<uchar> image;
+        vector<KeyPoint>   keypoints;
+        Mat                descriptors;
+    };
+
     /// Detect and describe one single index. Handles the IO as well.
-    [[nodiscard]] bool process_index(int idx) const noexcept;
+    [[nodiscard]] bool process_index(int                 idx,
+                                     io::batch_manifest* manifest) const
+        noexcept;
 
-    /// Do IO and handle detection down to \c compute_features.
-    bool process_detector(const math::image<uchar>& image,
-                          const string&             out_file,
-                          const string&             in_file) const noexcept;
+    /// Decode stage: load the image of \p idx as 8-bit gray image.
+    [[nodiscard]] bool decode_index(int idx, feature_frame& f) const noexcept;
+    /// Compute stage: detect and describe the features with
+    /// \c compute_features.
+    [[nodiscard]] bool compute_index(int idx, feature_frame& f) const noexcept;
+    /// Encode stage: write keypoints and descriptors to the YAML-file of
+    /// \p idx and record it in \p manifest, if it is not \c nullptr.
+    [[nodiscard]] bool encode_index(int                 idx,
+                                    feature_frame&      f,
+                                    io::batch_manifest* manifest) const
+        noexcept;
 
     /// Compute and filter keypoints and run the descriptor on them
-    /// afterwards.
-    [[nodiscard]] pair<vector<KeyPoint>, Mat>
-    compute_features(const math::image<uchar>& img) const noexcept;
-
+    /// afterwards. The results are written into \p keypoints and
+    /// \p descriptors to reuse their memory, if the frame is reused.
+    void compute_features(const math::image<uchar>& img,
+                          vector<KeyPoint>&         keypoints,
+                          Mat&                      descriptors) const;
 
-    mutable Ptr<Feature2D> _detector;
-    mutable Ptr<Feature2D> _descriptor;
-    string_view            _input_pattern;
-    string_view            _ouput_pattern;
-    vector<filter_func>    _keypoint_filter;
+    mutable feature_pool _detectors;
+    mutable feature_pool _descriptors;
+    bool                 _single_pass;
+    string_view          _input_pattern;
+    string_view          _ouput_pattern;
+    vector<filter_func>  _keypoint_filter;
 };
 }  // namespace sens_loc::apps
 
@@ -0,0 +1,61 @@
+#ifndef KEYPOINT_SELECTION_H_T2PW9HNE
+#define KEYPOINT_SELECTION_H_T2PW9HNE
+
+#include <cstddef>
+#include <gsl/gsl>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <vector>
+
+namespace sens_loc::apps {
+
+/// Remove keypoints from \p keypoints with \p select and keep the rows of
+/// \p descriptors in line with the remaining keypoints.
+///
+/// This allows to detect and describe the features in a single pass, e.g.
+/// with \c cv::Feature2D::detectAndCompute, and to filter them afterwards.
+/// The descriptor of a keypoint only depends on the keypoint and the image,
+/// so the result is the same as filtering the keypoints before describing
+/// them, if \p select keeps or drops each keypoint by its own properties.
+/// The description drops keypoints as well, e.g. close to the border. A
+/// selection that depends on the other keypoints, like the strongest
+/// keypoints, gives a different result after the description.
+///
+/// \tparam Select functor \c void(std::vector<cv::KeyPoint>&) that removes
+/// and reorders the keypoints, but does not modify them otherwise
+/// \pre row \c i of \p descriptors describes keypoint \c i
+template <typename Select>
+void select_described_keypoints(std::vector<cv::KeyPoint>& keypoints,
+                                cv::Mat&                   descriptors,
+                                Select&&                   select) {
+    Expects(descriptors.empty() ||
+            gsl::narrow<std::size_t>(descriptors.rows) == keypoints.size());
+
+    if (descriptors.empty()) {
+        select(keypoints);
+        return;
+    }
+
+    // The class id of each keypoint temporarily refers to its descriptor.
+    std::vector<int> class_ids;
+    class_ids.reserve(keypoints.size());
+    for (std::size_t i = 0; i < keypoints.size(); ++i) {
+        class_ids.push_back(keypoints[i].class_id);
+        keypoints[i].class_id = gsl::narrow_cast<int>(i);
+    }
+
+    select(keypoints);
+
+    cv::Mat selected(gsl::narrow<int>(keypoints.size()), descriptors.cols,
+                     descriptors.type());
+    for (std::size_t i = 0; i < keypoints.size(); ++i) {
+        const int row = keypoints[i].class_id;
+        descriptors.row(row).copyTo(selected.row(gsl::narrow_cast<int>(i)));
+        keypoints[i].class_id = class_ids[gsl::narrow_cast<std::size_t>(row)];
+    }
+    descriptors = selected;
+}
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: KEYPOINT_SELECTION_H_T2PW9HNE */
@@ -1,18 +1,25 @@
 #include "batch_extractor.h"
 
 #include <CLI/CLI.hpp>
+#include <cstdlib>
 #include <memory>
 #include <opencv2/core/types.hpp>
 #include <opencv2/features2d.hpp>
 #include <opencv2/xfeatures2d.hpp>
+#include <sens_loc/io/manifest.h>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/correctness_util.h>
 #include <sens_loc/util/overloaded.h>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/incremental.h>
+#include <util/shard.h>
 #include <util/tool_macro.h>
+#include <util/tracing.h>
 #include <util/version_printer.h>
 #include <variant>
 #include <vector>
@@ -59,6 +66,12 @@ struct SURFArgs {
     int  octave_layers     = 3;
     bool extended          = false;
     bool upright           = false;
+
+    bool operator==(const SURFArgs& o) const noexcept {
+        return tie(hessian_threshold, n_octaves, octave_layers, extended,
+                   upright) == tie(o.hessian_threshold, o.n_octaves,
+                                   o.octave_layers, o.extended, o.upright);
+    }
 };
 
 /// \ingroup feature-extractor-driver
@@ -92,6 +105,13 @@ struct SIFTArgs {
     double contrast_threshold = 0.04;
     double edge_threshold     = 10.;
     double sigma              = 1.6;
+
+    bool operator==(const SIFTArgs& o) const noexcept {
+        return tie(feature_count, octave_layers, contrast_threshold,
+                   edge_threshold, sigma) ==
+               tie(o.feature_count, o.octave_layers, o.contrast_threshold,
+                   o.edge_threshold, o.sigma);
+    }
 };
 
 /// \ingroup feature-extractor-driver
@@ -149,6 +169,15 @@ struct ORBArgs {
     string score_type     = "HARRIS";
     int    path_size      = 31;
     int    fast_threshold = 20;
+
+    bool operator==(const ORBArgs& o) const noexcept {
+        return tie(feature_count, scale_factor, n_levels, edge_threshold,
+                   first_level, WTA_K, score_type, path_size,
+                   fast_threshold) ==
+               tie(o.feature_count, o.scale_factor, o.n_levels,
+                   o.edge_threshold, o.first_level, o.WTA_K, o.score_type,
+                   o.path_size, o.fast_threshold);
+    }
 };
 
 /// \ingroup feature-extractor-driver
@@ -220,6 +249,14 @@ struct AKAZEArgs {
     int    n_octaves           = 4;
     int    n_octave_layers     = 4;
     string diffusivity         = "PM_G2";
+
+    bool operator==(const AKAZEArgs& o) const noexcept {
+        return tie(descriptor_type, descriptor_size, descriptor_channels,
+                   threshold, n_octaves, n_octave_layers, diffusivity) ==
+               tie(o.descriptor_type, o.descriptor_size, o.descriptor_channels,
+                   o.threshold, o.n_octaves, o.n_octave_layers,
+                   o.diffusivity);
+    }
 };
 
 struct AGASTArgs {
@@ -230,6 +267,10 @@ struct AGASTArgs {
                         /*defaulted=*/true);
     }
     int threshold = 50;
+
+    bool operator==(const AGASTArgs& o) const noexcept {
+        return threshold == o.threshold;
+    }
 };
 
 struct BRISKArgs {
@@ -246,11 +287,18 @@ struct BRISKArgs {
     int   n_octaves     = 3;
     int   threshold     = 30;
     float pattern_scale = 1.0F;
+
+    bool operator==(const BRISKArgs& o) const noexcept {
+        return tie(n_octaves, threshold, pattern_scale) ==
+               tie(o.n_octaves, o.threshold, o.pattern_scale);
+    }
 };
 
 struct NULLArgs {
     NULLArgs() = default;
     NULLArgs(CLI::App* /*cmd*/) {}
+
+    bool operator==(const NULLArgs& /*o*/) const noexcept { return true; }
 };
 
 /// Helper enum to provide information on the capability of an algorithm.
@@ -280,14 +328,6 @@ constexpr capability operator&(capability element1,
 /// \ingroup feature-extractor-driver
 /// \returns 0 if all images could be processed, 1 if any image fails
 MAIN_HEAD("Batch-processing tool to extract visual features") {
-    // Explicitly disable threading from OpenCV functions, as the
-    // parallelization is done at a higher level.
-    // That means, that each filter application is not multithreaded, but each
-    // image modification is. This is necessary as "TaskFlow" does not play
-    // nice with OpenCV threading and they introduce data races in the program
-    // because of that.
-    cv::setNumThreads(0);
-
     app.require_subcommand(2);
     app.footer("\n\n"
                "An example invocation of the tool is:\n"
@@ -307,7 +347,9 @@ MAIN_HEAD("Batch-processing tool to extract visual features") {
         ->required();
     string arg_out_path;
     app.add_option("-o,--output", arg_out_path,
-                   "Output file-pattern for the feature information")
+                   "Output file-pattern for the feature information. "
+                   "'.yml', '.yaml' and '.gz' files are written as YAML, all "
+                   "other files in the faster binary format")
         ->required();
     int start_idx = 0;
     app.add_option("-s,--start", start_idx, "Start index of batch, inclusive")
@@ -315,6 +357,33 @@ MAIN_HEAD("Batch-processing tool to extract visual features") {
     int end_idx = 0;
     app.add_option("-e,--end", end_idx, "End index of batch, inclusive")
         ->required();
+    bool pipeline = false;
+    app.add_flag("--pipeline", pipeline,
+                 "Overlap reading and writing files with the processing in "
+                 "separate pipeline stages");
+    shard part;
+    add_shard_option(app, part);
+    bool         incremental     = false;
+    CLI::Option* incremental_opt = app.add_flag(
+        "--incremental", incremental,
+        "Skip indices whose outputs exist and are newer than their input "
+        "and the configuration of the tool. Interrupted batches resume with "
+        "the indices that are not finished.");
+    string manifest_file = "feature_extractor.manifest";
+    app.add_option("--manifest", manifest_file,
+                   "Sidecar file of '--incremental' that records the "
+                   "configuration and the feature files of the finished "
+                   "indices. Each configuration needs its own manifest.",
+                   /*defaulted=*/true)
+        ->needs(incremental_opt);
+    string thread_policy = "outer";
+    app.add_set("--thread-policy", thread_policy, {"outer", "inner", "hybrid"},
+                "Distribution of the threads between the images and the "
+                "OpenCV functions. 'outer' processes the images in parallel "
+                "with sequential OpenCV functions, 'inner' processes one "
+                "image at a time with parallel OpenCV functions and "
+                "'hybrid' selects one of both by the size of the batch.",
+                /*defaulted=*/true);
 
     CLI::App* detector_cmd =
         app.add_subcommand("detector", "Configure the detector");
@@ -329,7 +398,8 @@ MAIN_HEAD("Batch-processing tool to extract visual features") {
     unsigned int keypoint_count = 3000U;
     detector_cmd->add_option("--kp-count", keypoint_count,
                              "Set a maximum number of extracted keypoints. "
-                             "Filtered by response. Disabled with '0'",
+                             "Filtered by response before the description. "
+                             "Disabled with '0'",
                              /*defaulted=*/true);
     detector_cmd->require_subcommand(1);
 
@@ -394,6 +464,21 @@ MAIN_HEAD("Batch-processing tool to extract visual features") {
 
     COLORED_APP_PARSE(app, argc, argv);
 
+    const auto indices = select_shard(part, start_idx, end_idx);
+    if (!indices)
+        return 0;
+    tie(start_idx, end_idx) = *indices;
+
+    // Explicitly disable threading from OpenCV functions, as the
+    // parallelization is done at a higher level, unless the images are
+    // processed one after another by the thread policy.
+    // That means, that each filter application is not multithreaded, but each
+    // image modification is. This is necessary as "TaskFlow" does not play
+    // nice with OpenCV threading and they introduce data races in the program
+    // because of that.
+    // The threads are split once the batch skipped the up-to-date images.
+    set_thread_policy(thread_policy);
+
     Ensures(descriptor_cmd->get_subcommands().size() == 1);
     Ensures(detector_cmd->get_subcommands().size() == 1);
 
@@ -489,11 +574,38 @@ MAIN_HEAD("Batch-processing tool to extract visual features") {
             return kps.end();
         });
 
-    const batch_extractor extractor(visit(argument_visitor, det_args),
-                                    visit(argument_visitor, desc_args),
-                                    arg_input_files, arg_out_path, filter);
-
-    const bool success = extractor.process_batch(start_idx, end_idx);
+    // The same algorithm with the same configuration for detection and
+    // description builds its scale space only once per image.
+    // The descriptor drops keypoints, e.g. close to the border. The strongest
+    // keypoints must be selected before that, so the keypoint count requires
+    // the separate passes.
+    const bool single_pass = keypoint_count == 0U && visit(
+        [](const auto& det, const auto& desc) {
+            using det_t  = decay_t<decltype(*det)>;
+            using desc_t = decay_t<decltype(*desc)>;
+            if constexpr (is_same_v<det_t, desc_t>)
+                return *det == *desc;
+            else
+                return false;
+        },
+        det_args, desc_args);
+
+    // Each worker creates its own detector and descriptor from the arguments.
+    const batch_extractor extractor(
+        [&]() { return visit(argument_visitor, det_args); },
+        [&]() { return visit(argument_visitor, desc_args); }, single_pass,
+        arg_input_files, arg_out_path, filter);
+
+    unique_ptr<io::batch_manifest> manifest;
+    if (incremental) {
+        manifest = open_manifest(manifest_file, app);
+        if (!manifest)
+            return 1;
+    }
+    const batch_mode mode =
+        pipeline ? batch_mode::pipelined : batch_mode::per_index;
+    const bool       success =
+        extractor.process_batch(start_idx, end_idx, mode, manifest.get());
     return success ? 0 : 1;
 }
 MAIN_TAIL
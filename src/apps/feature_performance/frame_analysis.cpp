@@ -0,0 +1,129 @@
+#include "frame_analysis.h"
+
+#include <algorithm>
+#include <fmt/core.h>
+#include <iostream>
+#include <sens_loc/io/feature.h>
+#include <sens_loc/util/console.h>
+#include <util/batch_visitor.h>
+
+namespace sens_loc::apps {
+
+frame_analysis::frame_analysis(std::string_view              name,
+                               const util::processing_input& in,
+                               const partial_options&        partial,
+                               required_data                 required,
+                               bool                          pairwise)
+    : _batch{name, in, partial}
+    , _required{required}
+    , _pairwise{pairwise}
+    , _range{_batch.visited_range(pairwise ? in.start + 1 : in.start)} {}
+
+namespace {
+using analysis_list = std::vector<std::unique_ptr<frame_analysis>>;
+
+/// Functor for \c parallel_visitation, that feeds the frames of the cache to
+/// all analyses, that visit the index.
+class traversal {
+  public:
+    traversal(feature_frame_cache& frames,
+              const analysis_list& analyses) noexcept
+        : _frames{frames}
+        , _analyses{analyses} {}
+
+    void operator()(int idx) noexcept {
+        const bool visits_pair =
+            std::any_of(_analyses.begin(), _analyses.end(),
+                        [idx](const std::unique_ptr<frame_analysis>& a) {
+                            return a->pairwise() && a->visits(idx);
+                        });
+
+        feature_frame_cache::handle current;
+        try {
+            current = _frames.get(idx);
+        } catch (...) {
+            auto s = synced();
+            std::cerr << util::clear_line{}
+                      << "Could not initialize data for idx: " << idx << "\n";
+            return;
+        }
+
+        // A missing predecessor only skips the pairwise analyses, the other
+        // analyses still visit the frame.
+        feature_frame_cache::handle previous;
+        if (visits_pair) {
+            try {
+                previous = _frames.get(idx - 1);
+            } catch (...) {
+                auto s = synced();
+                std::cerr << util::clear_line{}
+                          << "Could not initialize data for idx: " << idx - 1
+                          << "\n";
+            }
+        }
+
+        for (const std::unique_ptr<frame_analysis>& a : _analyses) {
+            if (!a->visits(idx))
+                continue;
+            if (!a->pairwise())
+                a->visit(idx, nullptr, *current);
+            else if (previous)
+                a->visit(idx, previous.get(), *current);
+        }
+    }
+
+  private:
+    feature_frame_cache& _frames;
+    const analysis_list& _analyses;
+};
+}  // namespace
+
+int run_analyses(const util::processing_input& in,
+                 const analysis_list&          analyses) {
+    Expects(!analyses.empty());
+
+    // All analyses are fed by one traversal over the union of their ranges.
+    std::optional<std::pair<int, int>> range;
+    required_data                      required = required_data::none;
+    bool                               pairwise = false;
+    for (const std::unique_ptr<frame_analysis>& a : analyses) {
+        required = required | a->required();
+        if (!a->visited_range())
+            continue;
+        const std::pair<int, int>& r = *a->visited_range();
+        pairwise = pairwise || a->pairwise();
+        range    = range ? std::pair{std::min(range->first, r.first),
+                                     std::max(range->second, r.second)}
+                         : r;
+    }
+
+    if (range) {
+        // Each frame is requested once as the current frame and once more as
+        // the previous frame of a pair, if any analysis is pairwise.
+        feature_frame_cache frames{
+            [&in, required](int idx) {
+                const io::feature_file f =
+                    io::open_feature_file(fmt::format(in.input_pattern, idx));
+                feature_frame frame;
+                if ((required & required_data::keypoints) !=
+                    required_data::none)
+                    frame.keypoints = io::load_keypoints(f);
+                if ((required & required_data::descriptors) !=
+                    required_data::none)
+                    frame.descriptors = io::load_descriptors(f);
+                return frame;
+            },
+            pairwise ? 2 : 1};
+        parallel_visitation(range->first, range->second,
+                            traversal{frames, analyses});
+    }
+
+    int result = 0;
+    for (const std::unique_ptr<frame_analysis>& a : analyses) {
+        if (a->finish() != 0)
+            result = 1;
+    }
+    return result;
+}
+
+}  // namespace sens_loc::apps
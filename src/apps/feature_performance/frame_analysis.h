@@ -0,0 +1,104 @@
+#ifndef FRAME_ANALYSIS_H_B8MWK3TX
+#define FRAME_ANALYSIS_H_B8MWK3TX
+
+#include "partial_result.h"
+
+#include <memory>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <util/common_structures.h>
+#include <util/frame_cache.h>
+#include <util/statistic_visitor.h>
+#include <vector>
+
+namespace sens_loc::apps {
+
+/// Keypoints and descriptors of one feature file. Only the data that the
+/// analyses require is loaded.
+struct feature_frame {
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat                   descriptors;
+};
+using feature_frame_cache = frame_cache<feature_frame>;
+
+/// Analysis of the feature files, that is fed by a shared traversal of the
+/// dataset with \c run_analyses.
+///
+/// Each analysis accumulates the data of the visited frames and writes its
+/// own report or partial result in \c finish.
+class frame_analysis {
+  public:
+    /// \param name name of the analysis, that is the subcommand
+    /// \param in the whole batch, that might be split into shards
+    /// \param partial sharding and merging of the analysis
+    /// \param required data of each frame that the analysis uses
+    /// \param pairwise \c true if each frame is analyzed together with its
+    /// predecessor, the first frame of the batch is not visited then
+    frame_analysis(std::string_view              name,
+                   const util::processing_input& in,
+                   const partial_options&        partial,
+                   required_data                 required,
+                   bool                          pairwise);
+
+    frame_analysis(const frame_analysis&) = delete;
+    frame_analysis(frame_analysis&&)      = delete;
+    frame_analysis& operator=(const frame_analysis&) = delete;
+    frame_analysis& operator=(frame_analysis&&) = delete;
+    virtual ~frame_analysis()                   = default;
+
+    [[nodiscard]] required_data required() const noexcept {
+        return _required;
+    }
+    [[nodiscard]] bool pairwise() const noexcept { return _pairwise; }
+
+    /// \returns the inclusive range of indices that are visited or
+    /// \c std::nullopt if no index is visited.
+    [[nodiscard]] const std::optional<std::pair<int, int>>&
+    visited_range() const noexcept {
+        return _range;
+    }
+    [[nodiscard]] bool visits(int idx) const noexcept {
+        return _range && _range->first <= idx && idx <= _range->second;
+    }
+
+    /// Analyze the frame \p idx.
+    /// \param previous frame \c idx-1 for pairwise analyses, otherwise
+    /// \c nullptr
+    /// \param current frame \c idx
+    /// \note This method is called concurrently for different indices.
+    virtual void visit(int                  idx,
+                       const feature_frame* previous,
+                       const feature_frame& current) noexcept = 0;
+
+    /// Merge the partial results and write the report or the partial result
+    /// of the accumulated data.
+    /// \returns the exit code of the analysis.
+    /// \throws std::runtime_error if the partial results can not be merged
+    /// or written.
+    virtual int finish() = 0;
+
+  protected:
+    partial_batch _batch;
+
+  private:
+    required_data                      _required;
+    bool                               _pairwise;
+    std::optional<std::pair<int, int>> _range;
+};
+
+/// Run all \p analyses in a single traversal of \p in.
+///
+/// The feature file of each index is loaded once with the data that any of
+/// the analyses requires. Every analysis that visits the index is fed with
+/// the frame, pairwise analyses with the frame of the previous index as well.
+/// Afterwards each analysis writes its own report.
+/// \returns 0 if all analyses succeeded, 1 otherwise.
+int run_analyses(const util::processing_input&                       in,
+                 const std::vector<std::unique_ptr<frame_analysis>>& analyses);
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: FRAME_ANALYSIS_H_B8MWK3TX */
@@ -1,21 +1,89 @@
 #ifndef KEYPOINT_DISTRIBUTION_H_K2G0XHSJ
 #define KEYPOINT_DISTRIBUTION_H_K2G0XHSJ
 
+#include "frame_analysis.h"
+#include "partial_result.h"
+
+#include <cstddef>
+#include <gsl/gsl>
+#include <memory>
+#include <mutex>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
 #include <optional>
+#include <sens_loc/util/thread_analysis.h>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <util/common_structures.h>
+#include <vector>
 
 namespace sens_loc::apps {
 
-int analyze_keypoint_distribution(
-    util::processing_input            in,
-    unsigned int                      image_width,
-    unsigned int                      image_height,
-    const std::optional<std::string>& stat_file,
-    const std::optional<std::string>& response_histo,
-    const std::optional<std::string>& size_histo,
-    const std::optional<std::string>& kp_distance_histo,
-    const std::optional<std::string>& kp_distribution_histo);
+/// Keypoints and minimal keypoint distances of all images of a dataset,
+/// that are inserted concurrently.
+struct keypoint_stat_data {
+    keypoint_stat_data() = default;
+
+    void insert_points(gsl::span<cv::KeyPoint> points) noexcept;
+    void insert_distances(gsl::span<float> distances) noexcept;
+
+    /// Move all inserted keypoints and distances out of the object.
+    std::pair<std::vector<cv::KeyPoint>, std::vector<float>> extract() noexcept;
+
+  private:
+    std::mutex                                  _keypoint_mutex;
+    std::vector<cv::KeyPoint> _global_keypoints GUARDED_BY(_keypoint_mutex);
+
+    std::mutex                                   _distance_mutex;
+    std::vector<float> _global_minimal_distances GUARDED_BY(_distance_mutex);
+};
+
+/// Calculate the 2-dimensional distribution of the keypoints for a dataset.
+/// The keypoints of each image are accumulated in a \c keypoint_stat_data.
+class keypoint_distribution {
+  public:
+    keypoint_distribution(keypoint_stat_data& d) noexcept
+        : accumulated_data{d} {}
+
+    void operator()(int                                      idx,
+                    std::optional<std::vector<cv::KeyPoint>> keypoints,
+                    std::optional<cv::Mat> descriptors) noexcept;
+
+    /// Analyze the accumulated keypoints and write the statistics and the
+    /// histograms. Results without file are printed to \c stdout.
+    /// \returns the number of analyzed keypoints.
+    std::size_t postprocess(
+        unsigned int                      image_width,
+        unsigned int                      image_height,
+        const std::optional<std::string>& stat_file,
+        const std::optional<std::string>& response_histo,
+        const std::optional<std::string>& size_histo,
+        const std::optional<std::string>& kp_distance_histo,
+        const std::optional<std::string>& kp_distribution_histo);
+
+  private:
+    keypoint_stat_data& accumulated_data;
+};
+
+/// Files for the results of the keypoint distribution. Results without file
+/// are printed to \c stdout.
+struct keypoint_distribution_output {
+    std::optional<std::string> stat_file;
+    std::optional<std::string> response_histo;
+    std::optional<std::string> size_histo;
+    std::optional<std::string> kp_distance_histo;
+    std::optional<std::string> kp_distribution_histo;
+};
+
+/// Analysis of the keypoint distribution over all images.
+/// \sa keypoint_distribution
+std::unique_ptr<frame_analysis> make_keypoint_distribution_analysis(
+    const util::processing_input&       in,
+    unsigned int                        image_width,
+    unsigned int                        image_height,
+    const keypoint_distribution_output& output,
+    const partial_options&              partial);
 }  // namespace sens_loc::apps
 
 #endif /* end of include guard: KEYPOINT_DISTRIBUTION_H_K2G0XHSJ */
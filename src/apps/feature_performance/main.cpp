@@ -4,17 +4,22 @@
 #include "recognition_performance.h"
 
 #include <CLI/CLI.hpp>
+#include <cstdlib>
 #include <boost/histogram.hpp>
+#include <memory>
 #include <opencv2/core/base.hpp>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/correctness_util.h>
 #include <stdexcept>
 #include <string>
-#include <util/batch_visitor.h>
 #include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/shard.h>
 #include <util/common_structures.h>
 #include <util/tool_macro.h>
+#include <util/tracing.h>
 #include <util/version_printer.h>
+#include <vector>
 
 static cv::NormTypes str_to_norm(std::string_view n) {
 
@@ -31,16 +36,20 @@ static cv::NormTypes str_to_norm(std::string_view n) {
 }
 
 MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
-    // Explicitly disable threading from OpenCV functions, as the
-    // parallelization is done at a higher level.
-    // That means, that each filter application is not multithreaded, but each
-    // image modification is. This is necessary as "TaskFlow" does not play
-    // nice with OpenCV threading and they introduce data races in the program
-    // because of that.
-    cv::setNumThreads(0);
-
-    // Require exactly one subcommand.
-    app.require_subcommand(1);
+    // Require at least one analysis, that may follow 'merge'. All analyses
+    // are run in a single traversal of the feature files.
+    app.require_subcommand(1, 5);
+    app.footer("\n\n"
+               "An example invocation of the tool is:\n"
+               "\n"
+               "feature_performance -i features-{}.yml -s 0 -e 100 \\\n"
+               "    min-distance --norm L2 -o min-distance.stat \\\n"
+               "    matching --distance-norm L2 -o matching.stat\n"
+               "\n"
+               "Each feature file is loaded once for all analyses. Each "
+               "analysis writes its own\n"
+               "results, the statistics file is given with the option "
+               "'--output' of each analysis.\n");
 
     string feature_file_input_pattern;
     app.add_option("-i,--input", feature_file_input_pattern,
@@ -52,10 +61,51 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
     int end_idx = 0;
     app.add_option("-e,--end", end_idx, "End index for processing.")
         ->required();
+    string thread_policy = "outer";
+    app.add_set("--thread-policy", thread_policy, {"outer", "inner", "hybrid"},
+                "Distribution of the threads between the images and the "
+                "OpenCV functions. 'outer' processes the images in parallel "
+                "with sequential OpenCV functions, 'inner' processes one "
+                "image at a time with parallel OpenCV functions and "
+                "'hybrid' selects one of both by the size of the batch.",
+                /*defaulted=*/true);
     optional<string> statistics_file;
     app.add_option(
         "-o,--output", statistics_file,
-        "Write the result of the analysis into a yaml-file instead to stdout");
+        "Write the result of the analysis into a yaml-file instead to stdout. "
+        "Requires a single analysis.");
+    partial_options partial;
+    CLI::Option*    partial_opt = app.add_option(
+        "--partial", partial.output,
+        "Write the accumulated data of the analysis into this yaml-file "
+        "instead of the report. The subcommand 'merge' combines the partial "
+        "results of all shards into the report. Requires a single analysis.");
+    CLI::Option* shard_opt =
+        add_shard_option(app, partial.part)->needs(partial_opt);
+
+    CLI::App* cmd_merge = app.add_subcommand(
+        "merge", "Merge the partial results of the shards of an analysis "
+                 "instead of analyzing the feature files. The analysis "
+                 "follows as subcommand with the options of the shards.");
+    cmd_merge->footer("\n\n"
+                      "An example invocation of the tool is:\n"
+                      "\n"
+                      "feature_performance -i features-{}.yml -s 0 -e 100 \\\n"
+                      "    merge shard-0.yml shard-1.yml \\\n"
+                      "    min-distance --norm L2\n"
+                      "\n"
+                      "The shards were analyzed with:\n"
+                      "\n"
+                      "feature_performance -i features-{}.yml -s 0 -e 100 \\\n"
+                      "    --shard 0/2 --partial shard-0.yml \\\n"
+                      "    min-distance --norm L2\n");
+    cmd_merge->excludes(shard_opt);
+    cmd_merge
+        ->add_option("partial-results", partial.merge,
+                     "Partial results of the shards, that were written with "
+                     "'--partial'")
+        ->required()
+        ->check(CLI::ExistingFile);
 
     CLI::App* cmd_keypoint_dist = app.add_subcommand(
         "keypoint-distribution",
@@ -74,6 +124,10 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
                      "the intrinsic!")
         ->required()
         ->check(CLI::Range(65'535));
+    optional<string> kp_dist_output;
+    cmd_keypoint_dist->add_option(
+        "-o,--output", kp_dist_output,
+        "Write the result of this analysis into a yaml-file instead to stdout");
     optional<string> response_histo;
     cmd_keypoint_dist->add_option(
         "--response-histo", response_histo,
@@ -96,11 +150,15 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
     CLI::App* cmd_min_dist = app.add_subcommand(
         "min-distance", "Calculate the minimum distance of descriptors within "
                         "one image and analyze that.");
-    string norm_name = "L2";
-    cmd_min_dist->add_set("-n,--norm", norm_name,
+    string min_dist_norm = "L2";
+    cmd_min_dist->add_set("-n,--norm", min_dist_norm,
                           {"L1", "L2", "L2SQR", "HAMMING", "HAMMING2"},
                           "Set the norm that shall be used as distance measure",
                           /*defaulted=*/true);
+    optional<string> min_dist_output;
+    cmd_min_dist->add_option(
+        "-o,--output", min_dist_output,
+        "Write the result of this analysis into a yaml-file instead to stdout");
     optional<string> min_distance_histo;
     cmd_min_dist->add_option(
         "--min-distance-histo", min_distance_histo,
@@ -109,21 +167,26 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
     CLI::App* cmd_matcher = app.add_subcommand(
         "matching",
         "Analyze the matchability of the descriptors with consecutive images.");
-    cmd_matcher->add_set("-d,--distance-norm", norm_name,
+    string match_norm = "L2";
+    cmd_matcher->add_set("-d,--distance-norm", match_norm,
                          {"L1", "L2", "L2SQR", "HAMMING", "HAMMING2"},
                          "Set the norm that shall be used as distance measure",
                          /*defaulted=*/true);
     bool no_crosscheck = false;
     cmd_matcher->add_flag("--no-crosscheck", no_crosscheck,
                           "Disable crosschecking");
+    optional<string> match_stat_output;
+    cmd_matcher->add_option(
+        "-o,--output", match_stat_output,
+        "Write the result of this analysis into a yaml-file instead to stdout");
     optional<string> match_output;
     CLI::Option*     match_output_opt = cmd_matcher->add_option(
         "--match-output", match_output,
         "Provide a filename for drawing the matches onto an image.");
-    optional<string> original_images;
+    optional<string> match_original_images;
     CLI::Option*     orig_imgs_opt =
         cmd_matcher
-            ->add_option("--original-images", original_images,
+            ->add_option("--original-images", match_original_images,
                          "Provide the file pattern for the original image "
                          "the features were calculated on. Must be provided "
                          "for plotting.")
@@ -160,7 +223,8 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
         "means the camera has no vision there. White means, the "
         "camera sees these pixels. Use for distortion masking."
         "(8-bit grayscale png!)");
-    cmd_rec_perf->add_set("-d,--match-norm", norm_name,
+    string rec_norm = "L2";
+    cmd_rec_perf->add_set("-d,--match-norm", rec_norm,
                           {"L1", "L2", "L2SQR", "HAMMING", "HAMMING2"},
                           "Set the norm that shall be used as distance measure",
                           /*defaulted=*/true);
@@ -170,14 +234,19 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
                              "Threshold for the reprojection error of "
                              "keypoints to be considered a correspondence",
                              /*defaulted=*/true);
+    optional<string> rec_output;
+    cmd_rec_perf->add_option(
+        "-o,--output", rec_output,
+        "Write the result of this analysis into a yaml-file instead to stdout");
     optional<string> backproject_pattern;
     CLI::Option*     backproject_opt = cmd_rec_perf->add_option(
         "--backprojection", backproject_pattern,
         "Provide a file-pattern to optionally print the "
         "backprojection for matched keypoints");
-    CLI::Option* orig_imgs =
+    optional<string> rec_original_images;
+    CLI::Option*     orig_imgs =
         cmd_rec_perf
-            ->add_option("--orig-images", original_images,
+            ->add_option("--orig-images", rec_original_images,
                          "Provide the file pattern for the original image "
                          "the features were calculated on. Must be provided "
                          "for plotting.")
@@ -256,52 +325,92 @@ MAIN_HEAD("Determine Statistical Characteristica of the Descriptors") {
 
     COLORED_APP_PARSE(app, argc, argv);
 
-    util::processing_input in{feature_file_input_pattern, start_idx, end_idx};
-
-    if (*cmd_min_dist) {
-        return analyze_min_distance(in, str_to_norm(norm_name), statistics_file,
-                                    min_distance_histo);
+    const size_t analysis_count =
+        app.get_subcommands().size() - (*cmd_merge ? 1U : 0U);
+    if (analysis_count == 0U) {
+        cerr << util::err{} << "Provide at least one analysis!\n";
+        return 1;
+    }
+    if (analysis_count > 1U && (partial_opt->count() > 0U || *cmd_merge)) {
+        cerr << util::err{}
+             << "Partial results can only be written and merged for a "
+                "single analysis!\n";
+        return 1;
     }
+    if (analysis_count > 1U && statistics_file) {
+        cerr << util::err{}
+             << "Provide the statistics file with '--output' of each "
+                "analysis!\n";
+        return 1;
+    }
+    // The option of the analysis takes precedence over the global option.
+    const auto stat_file = [&statistics_file](const optional<string>& o) {
+        return o ? o : statistics_file;
+    };
 
-    if (*cmd_keypoint_dist)
-        return analyze_keypoint_distribution(
-            in, image_width, image_height, statistics_file, response_histo,
-            size_histo, kp_distance_histo, kp_distribution_histo);
+    // Explicitly disable threading from OpenCV functions, as the
+    // parallelization is done at a higher level, unless the images are
+    // processed one after another by the thread policy.
+    // That means, that each filter application is not multithreaded, but each
+    // image modification is. This is necessary as "TaskFlow" does not play
+    // nice with OpenCV threading and they introduce data races in the program
+    // because of that.
+    set_thread_policy(thread_policy);
+    apply_thread_policy(std::abs(end_idx - start_idx) + 1);
+
+    util::processing_input in{feature_file_input_pattern, start_idx, end_idx};
 
-    if (*cmd_matcher)
-        return analyze_matching(in, str_to_norm(norm_name), !no_crosscheck,
-                                statistics_file, matched_distance_histo,
-                                match_output, original_images);
+    // The analyses keep references to their configuration, that must outlive
+    // them.
+    recognition_analysis_input rec_in{
+        /*depth_image_pattern=*/depth_image_path,
+        /*pose_file_pattern=*/pose_file_pattern,
+        /*intrinsic_file=*/intrinsic_file,
+        /*mask_file=*/mask_file,
+        /*matching_norm=*/str_to_norm(rec_norm),
+        /*keypoint_distance_threshold=*/keypoint_distance_threshold};
+    recognition_analysis_output_options out_opts{
+        /*backproject_pattern=*/backproject_pattern,
+        /*original_files=*/rec_original_images,
+        /*stat_file=*/stat_file(rec_output),
+        /*backprojection_selected_histo=*/backprojection_selected_histo,
+        /*relevant_histo=*/relevant_histo,
+        /*true_positive_histo=*/true_positive_histo,
+        /*false_positive_histo=*/false_positive_histo,
+        /*true_positive_distance_histo=*/true_positive_distance_histo,
+        /*false_positive_distance_histo=*/false_positive_distance_histo};
+    const backproject_config backproject{
+        backproject_style(tp_rgb[0], tp_rgb[1], tp_rgb[2],
+                          gsl::narrow<int>(tp_strength)),
+        backproject_style(fn_rgb[0], fn_rgb[1], fn_rgb[2],
+                          gsl::narrow<int>(fn_strength)),
+        backproject_style(fp_rgb[0], fp_rgb[1], fp_rgb[2],
+                          gsl::narrow<int>(fp_strength))};
 
-    if (*cmd_rec_perf) {
-        recognition_analysis_input rec_in{
-            /*depth_image_pattern=*/depth_image_path,
-            /*pose_file_pattern=*/pose_file_pattern,
-            /*intrinsic_file=*/intrinsic_file,
-            /*mask_file=*/mask_file,
-            /*matching_norm=*/str_to_norm(norm_name),
-            /*keypoint_distance_threshold=*/keypoint_distance_threshold};
-        recognition_analysis_output_options out_opts{
-            /*backproject_pattern=*/backproject_pattern,
-            /*original_files=*/original_images,
-            /*stat_file=*/statistics_file,
-            /*backprojection_selected_histo=*/backprojection_selected_histo,
-            /*relevant_histo=*/relevant_histo,
-            /*true_positive_histo=*/true_positive_histo,
-            /*false_positive_histo=*/false_positive_histo,
-            /*true_positive_distance_histo=*/true_positive_distance_histo,
-            /*false_positive_distance_histo=*/false_positive_distance_histo};
-        backproject_style tp_style(tp_rgb[0], tp_rgb[1], tp_rgb[2],
-                                   gsl::narrow<int>(tp_strength));
-        backproject_style fn_style(fn_rgb[0], fn_rgb[1], fn_rgb[2],
-                                   gsl::narrow<int>(fn_strength));
-        backproject_style fp_style(fp_rgb[0], fp_rgb[1], fp_rgb[2],
-                                   gsl::narrow<int>(fp_strength));
-        return analyze_recognition_performance(in, rec_in, out_opts,
-                                               {tp_style, fn_style, fp_style});
+    // The analyses are reported in the order of the command line.
+    vector<unique_ptr<frame_analysis>> analyses;
+    for (const CLI::App* cmd : app.get_subcommands()) {
+        if (cmd == cmd_min_dist)
+            analyses.push_back(make_min_distance_analysis(
+                in, str_to_norm(min_dist_norm), stat_file(min_dist_output),
+                min_distance_histo, partial));
+        else if (cmd == cmd_keypoint_dist)
+            analyses.push_back(make_keypoint_distribution_analysis(
+                in, image_width, image_height,
+                {stat_file(kp_dist_output), response_histo, size_histo,
+                 kp_distance_histo, kp_distribution_histo},
+                partial));
+        else if (cmd == cmd_matcher)
+            analyses.push_back(make_matching_analysis(
+                in, str_to_norm(match_norm), !no_crosscheck,
+                stat_file(match_stat_output), matched_distance_histo,
+                match_output, match_original_images, partial));
+        else if (cmd == cmd_rec_perf)
+            analyses.push_back(make_recognition_performance_analysis(
+                in, rec_in, out_opts, backproject, partial));
     }
+    Ensures(analyses.size() == analysis_count);
 
-    UNREACHABLE("Expected to end program with "  // LCOV_EXCL_LINE
-                "subcommand processing");        // LCOV_EXCL_LINE
+    return run_analyses(in, analyses);
 }
 MAIN_TAIL
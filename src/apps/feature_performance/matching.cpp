@@ -3,9 +3,11 @@
 
 #include <boost/histogram/ostream.hpp>
 #include <cstdint>
+#include <fmt/core.h>
 #include <fstream>
 #include <gsl/gsl>
 #include <iterator>
+#include <memory>
 #include <opencv2/core/base.hpp>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/types.hpp>
@@ -17,12 +19,15 @@
 #include <sens_loc/io/image.h>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/thread_analysis.h>
-#include <util/batch_visitor.h>
-#include <util/statistic_visitor.h>
 
 using namespace cv;
 using namespace std;
 using namespace gsl;
+using sens_loc::apps::feature_frame;
+using sens_loc::apps::frame_analysis;
+using sens_loc::apps::partial_options;
+using sens_loc::apps::required_data;
+using sens_loc::util::processing_input;
 
 namespace {
 
@@ -38,6 +43,14 @@ struct descriptor_stat_data {
         _total_descriptors += descriptor_count;
     }
 
+    void insert_distances(gsl::span<float> distances,
+                          int64_t          descriptor_count) noexcept {
+        lock_guard l{_mutex};
+        _global_minimal_distances.insert(_global_minimal_distances.end(),
+                                         begin(distances), end(distances));
+        _total_descriptors += descriptor_count;
+    }
+
     pair<vector<float>, int64_t> extract() noexcept {
         lock_guard                   l{_mutex};
         pair<vector<float>, int64_t> p{move(_global_minimal_distances),
@@ -53,17 +66,28 @@ struct descriptor_stat_data {
     int64_t _total_descriptors              GUARDED_BY(_mutex) = 0L;
 };
 
-class matching {
+class matching : public frame_analysis {
   public:
-    matching(descriptor_stat_data& accumulated_data,
-             NormTypes             norm_to_use,
-             bool                  crosscheck,
-             string_view           input_pattern,
-             optional<string_view> output_pattern,
-             optional<string_view> original_files) noexcept
-        : accumulated_data{accumulated_data}
+    matching(const processing_input& in,
+             NormTypes               norm_to_use,
+             bool                    crosscheck,
+             optional<string>        stat_file,
+             optional<string>        matched_distance_histo,
+             optional<string_view>   output_pattern,
+             optional<string_view>   original_files,
+             const partial_options&  partial)
+        : frame_analysis{"matching", in, partial,
+                         // Keypoints are only required to plot the matches.
+                         output_pattern ? required_data::keypoints |
+                                              required_data::descriptors
+                                        : required_data::descriptors,
+                         // Because two consecutive images are matched, the
+                         // first index is skipped. This requires "backwards"
+                         // matching.
+                         /*pairwise=*/true}
         , matcher{BFMatcher::create(norm_to_use, crosscheck)}
-        , input_pattern{input_pattern}
+        , stat_file{move(stat_file)}
+        , matched_distance_histo{move(matched_distance_histo)}
         , output_pattern{output_pattern}
         , original_images{original_files} {
         // XOR is true if both operands have the same value.
@@ -71,36 +95,22 @@ class matching {
                 "Either both or none are set");
     }
 
-    void operator()(int idx,
-                    optional<vector<KeyPoint>> /*keypoints*/,  // NOLINT
-                    optional<Mat> descriptors) noexcept {
-        Expects(descriptors.has_value());
-        if (descriptors->rows == 0)
+    void visit(int                  idx,
+               const feature_frame* previous,
+               const feature_frame& current) noexcept override {
+        Expects(previous != nullptr);
+        if (current.descriptors.rows == 0)
             return;
 
         try {
-            const int         previous_idx = idx - 1;
-            const FileStorage previous_img = sens_loc::io::open_feature_file(
-                fmt::format(input_pattern, previous_idx));
-            Mat previous_descriptors =
-                sens_loc::io::load_descriptors(previous_img);
-
             vector<DMatch> matches;
-            matcher->match(*descriptors, previous_descriptors, matches);
-            accumulated_data.insert_matches(matches, descriptors->rows);
+            matcher->match(current.descriptors, previous->descriptors,
+                           matches);
+            accumulated_data.insert_matches(matches, current.descriptors.rows);
 
             // Plot the matching between the descriptors of the previous and the
             // current frame.
             if (output_pattern) {
-                const vector<KeyPoint> previous_keypoints =
-                    sens_loc::io::load_keypoints(previous_img);
-
-                const FileStorage this_feature =
-                    sens_loc::io::open_feature_file(
-                        fmt::format(input_pattern, idx));
-                const vector<KeyPoint> this_keypoints =
-                    sens_loc::io::load_keypoints(this_feature);
-
                 const string img_p1 = fmt::format(*original_images, idx - 1);
                 const string img_p2 = fmt::format(*original_images, idx);
                 auto         img1   = sens_loc::io::load_as_8bit_gray(img_p1);
@@ -110,8 +120,8 @@ class matching {
                     return;
 
                 Mat out_img;
-                drawMatches(img2->data(), this_keypoints, img1->data(),
-                            previous_keypoints, matches, out_img,
+                drawMatches(img2->data(), current.keypoints, img1->data(),
+                            previous->keypoints, matches, out_img,
                             Scalar(0, 0, 255), Scalar(255, 0, 0));
 
                 const string output = fmt::format(*output_pattern, idx);
@@ -124,8 +134,29 @@ class matching {
         }
     }
 
-    size_t postprocess(const optional<string>& stat_file,
-                       const optional<string>& matched_distance_histo) {
+    int finish() override {
+        _batch.merge([this](const FileStorage& fs) {
+            vector<float> distances;
+            int           total_descriptors = 0;
+            read(fs["distances"], distances);
+            read(fs["total_descriptors"], total_descriptors, 0);
+            accumulated_data.insert_distances(distances, total_descriptors);
+        });
+
+        if (_batch.writes_partial()) {
+            auto [distances, total_descriptors] = accumulated_data.extract();
+
+            FileStorage out = _batch.create_partial();
+            out << "distances" << distances;
+            out << "total_descriptors" << narrow<int>(total_descriptors);
+            return 0;
+        }
+
+        return postprocess() > 0UL ? 0 : 1;
+    }
+
+  private:
+    size_t postprocess() {
         auto [distances, total_descriptors] = accumulated_data.extract();
         if (distances.empty())
             return 0UL;
@@ -170,41 +201,29 @@ class matching {
         return distances.size();
     }
 
-  private:
-    descriptor_stat_data& accumulated_data;
+    descriptor_stat_data accumulated_data;
 
     Ptr<BFMatcher>        matcher;
-    string_view           input_pattern;
+    optional<string>      stat_file;
+    optional<string>      matched_distance_histo;
     optional<string_view> output_pattern;
     optional<string_view> original_images;
 };
 }  // namespace
 
 namespace sens_loc::apps {
-int analyze_matching(util::processing_input       in,
-                     NormTypes                    norm_to_use,
-                     bool                         crosscheck,
-                     const optional<string>&      stat_file,
-                     const optional<string>&      matched_distance_histo,
-                     const optional<string_view>& output_pattern,
-                     const optional<string_view>& original_files) {
+unique_ptr<frame_analysis>
+make_matching_analysis(const util::processing_input& in,
+                       NormTypes                     norm_to_use,
+                       bool                          crosscheck,
+                       const optional<string>&       stat_file,
+                       const optional<string>&       matched_distance_histo,
+                       const optional<string_view>&  output_pattern,
+                       const optional<string_view>&  original_files,
+                       const partial_options&        partial) {
     Expects(in.start < in.end && "Matching requires at least 2 images");
-    using visitor = statistic_visitor<matching, required_data::descriptors>;
-    descriptor_stat_data data;
-    auto analysis_v = visitor{/*input_pattern=*/in.input_pattern,
-                              /*accumulated_data=*/data,
-                              /*norm_to_use=*/norm_to_use,
-                              /*crosscheck=*/crosscheck,
-                              /*input_pattern=*/in.input_pattern,
-                              /*output_pattern=*/output_pattern,
-                              /*original_files=*/original_files};
-
-    auto f = parallel_visitation(
-        in.start + 1,  // Because two consecutive images are matched, the first
-                       // index is skipped. This requires "backwards" matching.
-        in.end, analysis_v);
-    size_t n_elements = f.postprocess(stat_file, matched_distance_histo);
-
-    return n_elements > 0UL ? 0 : 1;
+    return make_unique<matching>(in, norm_to_use, crosscheck, stat_file,
+                                 matched_distance_histo, output_pattern,
+                                 original_files, partial);
 }
 }  // namespace sens_loc::apps
@@ -1,16 +1,76 @@
 #ifndef MIN_DIST_H_AHV2P7Y1
 #define MIN_DIST_H_AHV2P7Y1
 
+#include "frame_analysis.h"
+#include "partial_result.h"
+
+#include <cstddef>
+#include <gsl/gsl>
+#include <memory>
+#include <mutex>
 #include <opencv2/core/base.hpp>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
 #include <optional>
+#include <sens_loc/util/thread_analysis.h>
+#include <string>
 #include <string_view>
 #include <util/common_structures.h>
+#include <vector>
 
 namespace sens_loc::apps {
-int analyze_min_distance(util::processing_input            in,
-                         cv::NormTypes                     norm_to_use,
-                         const std::optional<std::string>& stat_file,
-                         const std::optional<std::string>& min_dist_histo);
+
+/// Minimal descriptor distances of all images of a dataset, that are
+/// inserted concurrently.
+struct distance_stat_data {
+    distance_stat_data() = default;
+
+    void insert_distances(gsl::span<float> distances) noexcept;
+
+    /// Move all inserted distances out of the object.
+    std::vector<float> extract() noexcept;
+
+  private:
+    std::mutex                               _process_mutex;
+    std::vector<float> _global_min_distances GUARDED_BY(_process_mutex);
+};
+
+/// Calculate the minimal distance between descriptors within one image
+/// and save this minimal distance.
+/// This gives an overall idea of the spread of descriptors within an image.
+/// The distances of each image are accumulated in a \c distance_stat_data.
+class min_descriptor_distance {
+  public:
+    /// \pre \p norm is one of \c NORM_L1, \c NORM_L2, \c NORM_L2SQR,
+    /// \c NORM_HAMMING or \c NORM_HAMMING2
+    min_descriptor_distance(distance_stat_data& data,
+                            cv::NormTypes       norm) noexcept;
+
+    void operator()(int                                      idx,
+                    std::optional<std::vector<cv::KeyPoint>> keypoints,
+                    std::optional<cv::Mat> descriptors) noexcept;
+
+    /// Postprocess the findings of the minimal distances for each image to
+    /// a coherent statistical finding. Results without file are printed to
+    /// \c stdout.
+    /// \returns the number of analyzed distances.
+    std::size_t
+    postprocess(const std::optional<std::string>& stat_file,
+                const std::optional<std::string>& min_dist_histo) noexcept;
+
+  private:
+    distance_stat_data& accumulated_data;
+    cv::NormTypes       _norm;
+};
+
+/// Analysis of the minimal distance between the descriptors of each image.
+/// \sa min_descriptor_distance
+std::unique_ptr<frame_analysis>
+make_min_distance_analysis(const util::processing_input&     in,
+                           cv::NormTypes                     norm_to_use,
+                           const std::optional<std::string>& stat_file,
+                           const std::optional<std::string>& min_dist_histo,
+                           const partial_options&            partial);
 }  // namespace sens_loc::apps
 
 #endif /* end of include guard: MIN_DIST_H_AHV2P7Y1 */
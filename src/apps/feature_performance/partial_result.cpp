@@ -0,0 +1,101 @@
+#include "partial_result.h"
+
+#include <algorithm>
+#include <gsl/gsl>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace sens_loc::apps {
+
+partial_batch::partial_batch(std::string_view              analysis,
+                             const util::processing_input& in,
+                             const partial_options&        options) noexcept
+    : _analysis{analysis}
+    , _in{in}
+    , _options{options}
+    , _shard_count{0} {
+    if (_options.merge.empty()) {
+        _shards.push_back(_options.part.index);
+        _shard_count = _options.part.count;
+    }
+}
+
+std::optional<std::pair<int, int>>
+partial_batch::visited_range(int first) const {
+    if (!_options.merge.empty())
+        return std::nullopt;
+    return select_shard(_options.part, first, _in.end);
+}
+
+void partial_batch::merge(
+    const std::function<void(const cv::FileStorage&)>& load) {
+    for (const std::string& file : _options.merge) {
+        const cv::FileStorage fs{file, cv::FileStorage::READ |
+                                           cv::FileStorage::FORMAT_YAML};
+        if (!fs.isOpened())
+            throw std::runtime_error{"Could not read the partial result " +
+                                     file};
+
+        std::string      analysis;
+        std::string      input;
+        int              start       = 0;
+        int              end         = 0;
+        int              shard_count = 0;
+        std::vector<int> shards;
+        cv::read(fs["analysis"], analysis, "");
+        cv::read(fs["input"], input, "");
+        cv::read(fs["start"], start, 0);
+        cv::read(fs["end"], end, 0);
+        cv::read(fs["shard_count"], shard_count, 0);
+        cv::read(fs["shards"], shards);
+
+        if (analysis != _analysis || input != _in.input_pattern ||
+            start != _in.start || end != _in.end)
+            throw std::runtime_error{"The partial result " + file +
+                                     " belongs to another analysis or batch"};
+        if (_shard_count == 0)
+            _shard_count = shard_count;
+        if (shard_count != _shard_count)
+            throw std::runtime_error{"The partial result " + file +
+                                     " has another number of shards"};
+        for (int s : shards) {
+            if (std::find(_shards.begin(), _shards.end(), s) != _shards.end())
+                throw std::runtime_error{"The shard " + std::to_string(s) +
+                                         " is merged twice"};
+            _shards.push_back(s);
+        }
+
+        load(fs);
+    }
+
+    if (!writes_partial() && gsl::narrow<int>(_shards.size()) != _shard_count) {
+        std::ostringstream oss;
+        oss << "The report requires all shards, but the partial results "
+               "contain only "
+            << _shards.size() << " of " << _shard_count << " shards";
+        throw std::runtime_error{oss.str()};
+    }
+}
+
+cv::FileStorage partial_batch::create_partial() const {
+    Expects(writes_partial());
+
+    cv::FileStorage fs{*_options.output,
+                       cv::FileStorage::WRITE | cv::FileStorage::FORMAT_YAML};
+    if (!fs.isOpened())
+        throw std::runtime_error{"Could not write the partial result " +
+                                 *_options.output};
+
+    std::vector<int> shards = _shards;
+    std::sort(shards.begin(), shards.end());
+    fs << "analysis" << std::string(_analysis);
+    fs << "input" << std::string(_in.input_pattern);
+    fs << "start" << _in.start;
+    fs << "end" << _in.end;
+    fs << "shard_count" << _shard_count;
+    fs << "shards" << shards;
+    return fs;
+}
+
+}  // namespace sens_loc::apps
@@ -0,0 +1,96 @@
+#ifndef PARTIAL_RESULT_H_QH3T6WZE
+#define PARTIAL_RESULT_H_QH3T6WZE
+
+#include <functional>
+#include <opencv2/core/persistence.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <util/common_structures.h>
+#include <util/shard.h>
+#include <vector>
+
+namespace sens_loc::apps {
+
+/// Distribution of an analysis over multiple processes.
+///
+/// Each shard of the batch writes the accumulated data of its analysis, e.g.
+/// all distances, into a partial result instead of creating the report.
+/// Merging the partial results of all shards restores the accumulated data
+/// of the whole batch and creates the same report as a single process.
+struct partial_options {
+    /// Part of the batch that is analyzed by this process.
+    shard part;
+    /// Write the accumulated data into this partial result instead of the
+    /// report.
+    std::optional<std::string> output;
+    /// Load the accumulated data from these partial results instead of
+    /// analyzing the feature files.
+    std::vector<std::string> merge;
+};
+
+/// Source and destination of the accumulated data of one analysis.
+///
+/// A partial result is a yaml-file that identifies the analysis, the batch
+/// and the shards it contains. The accumulated data of the analysis follows
+/// this header.
+/// ```
+/// analysis: "min-distance"
+/// input: "features-{}.yml"
+/// start: 0
+/// end: 100
+/// shard_count: 4
+/// shards: [ 0, 2 ]
+/// ```
+/// Partial results can be merged into partial results again, e.g. to
+/// combine the shards of each machine first.
+class partial_batch {
+  public:
+    /// \param analysis name of the analysis, that is the subcommand
+    /// \param in the whole batch, that is split into shards
+    /// \param options sharding and merging of the analysis
+    partial_batch(std::string_view              analysis,
+                  const util::processing_input& in,
+                  const partial_options&        options) noexcept;
+
+    /// \returns the inclusive range of indices that this process analyzes
+    /// or \c std::nullopt if the accumulated data is merged from partial
+    /// results or the shard is empty.
+    /// \param first first index of the batch that is analyzed, e.g.
+    /// \c in.start + 1 if each index is analyzed with its predecessor.
+    [[nodiscard]] std::optional<std::pair<int, int>>
+    visited_range(int first) const;
+
+    /// Call \p load with each partial result that shall be merged.
+    /// \throws std::runtime_error if a partial result can not be read,
+    /// belongs to another analysis or batch or contains a shard twice.
+    /// A report requires the partial results of all shards.
+    void merge(const std::function<void(const cv::FileStorage&)>& load);
+
+    /// \returns \c true if the accumulated data is written into a partial
+    /// result instead of the report.
+    [[nodiscard]] bool writes_partial() const noexcept {
+        return _options.output.has_value();
+    }
+
+    /// \returns the partial result with its header, that receives the
+    /// accumulated data.
+    /// \pre writes_partial()
+    /// \throws std::runtime_error if the file can not be written.
+    [[nodiscard]] cv::FileStorage create_partial() const;
+
+  private:
+    std::string_view              _analysis;
+    const util::processing_input& _in;
+    const partial_options&        _options;
+
+    /// Shards whose data is accumulated.
+    std::vector<int> _shards;
+    /// Total number of shards of the batch.
+    int _shard_count;
+};
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: PARTIAL_RESULT_H_QH3T6WZE */
@@ -5,9 +5,11 @@
 #include "keypoint_transform.h"
 
 #include <boost/histogram/ostream.hpp>
+#include <fmt/core.h>
 #include <fstream>
 #include <gsl/gsl>
 #include <iterator>
+#include <memory>
 #include <opencv2/core/hal/interface.h>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/types.hpp>
@@ -29,8 +31,7 @@
 #include <sens_loc/plot/backprojection.h>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/thread_analysis.h>
-#include <util/batch_visitor.h>
-#include <util/statistic_visitor.h>
+#include <util/frame_cache.h>
 
 using namespace std;
 using namespace sens_loc;
@@ -39,21 +40,14 @@ using namespace cv;
 
 namespace {
 
-/// Capsulate all required data for back-and-forth projection as well
-/// as precision-recall computation.
+/// Capsulate the data for back-and-forth projection, that is required in
+/// addition to the keypoints and descriptors of a frame.
 struct reprojection_data {
-    vector<cv::KeyPoint> keypoints;
-    cv::Mat              descriptors;
-    math::image<ushort>  depth_image;
-    math::pose_t         absolute_pose;
+    math::image<ushort> depth_image;
+    math::pose_t        absolute_pose;
 
-    reprojection_data(string_view feature_path,
-                      string_view depth_path,
+    reprojection_data(string_view depth_path,
                       string_view pose_path) noexcept(false) {
-        const FileStorage fs = io::open_feature_file(string(feature_path));
-        keypoints            = io::load_keypoints(fs);
-        descriptors          = io::load_descriptors(fs);
-
         optional<math::image<ushort>> d_img =
             io::load_image<ushort>(string(depth_path), IMREAD_UNCHANGED);
         if (!d_img) {
@@ -74,6 +68,9 @@ struct reprojection_data {
     }
 };
 
+/// Each frame is loaded once and shared by the two pairs it belongs to.
+using reprojection_cache = apps::frame_cache<reprojection_data>;
+
 size_t mask_backprojection(const math::image<uchar>& mask,
                            math::imagepoints_t&      points) noexcept {
     size_t counter = 0UL;
@@ -102,6 +99,17 @@ struct recognition_data {
         _totally_masked += narrow<int>(masked_points);
     }
 
+    void insert_partial(span<float>                            distances,
+                        const analysis::recognition_statistic& stats,
+                        int64_t masked_points) noexcept {
+        lock_guard l{_mutex};
+
+        _selected_elements_distance.insert(_selected_elements_distance.end(),
+                                           begin(distances), end(distances));
+        _stats.merge(stats);
+        _totally_masked += masked_points;
+    }
+
     tuple<vector<float>, analysis::recognition_statistic, int64_t>
     extract() noexcept {
         lock_guard l{_mutex};
@@ -123,23 +131,29 @@ struct recognition_data {
 
 template <template <typename> typename Model = sens_loc::camera_models::pinhole,
           typename Real                      = float>
-class prec_recall_analysis {
+class prec_recall_analysis : public apps::frame_analysis {
   public:
     prec_recall_analysis(
-        string_view                                      feature_file_pattern,
+        const util::processing_input&                    in,
         const apps::recognition_analysis_input&          input,
         const apps::recognition_analysis_output_options& output_options,
-        recognition_data&                                accumulated_data,
-        const apps::backproject_config&                  backproject_config)
-        : _feature_file_pattern{feature_file_pattern}
+        const apps::backproject_config&                  backproject_config,
+        const apps::partial_options&                     partial)
+        : frame_analysis{"recognition-performance", in, partial,
+                         apps::required_data::keypoints |
+                             apps::required_data::descriptors,
+                         /*pairwise=*/true}
+        , _frames{[this](int idx) {
+            return reprojection_data{
+                fmt::format(_input.depth_image_pattern, idx),
+                fmt::format(_input.pose_file_pattern, idx)};
+        }}
         , _input{input}
         , _output_options{output_options}
         , _matcher{cv::BFMatcher::create(_input.matching_norm,
                                          /*crosscheck=*/true)}
         , _mask{nullopt}
-        , _accumulated_data{accumulated_data}
         , _backprojection_config{backproject_config} {
-        Expects(!_feature_file_pattern.empty());
         Expects(!_input.depth_image_pattern.empty());
         Expects(!_input.pose_file_pattern.empty());
         Expects(!_input.intrinsic_file.empty());
@@ -192,37 +206,30 @@ class prec_recall_analysis {
         }
     }
 
-    void operator()(int idx,
-                    // NOLINTNEXTLINE(performance-unnecessary-value-param)
-                    optional<vector<KeyPoint>> keypoints,
-                    // NOLINTNEXTLINE(performance-unnecessary-value-param)
-                    optional<Mat> descriptors) noexcept try {
-        Expects(!keypoints);
-        Expects(!descriptors);
+    void visit(int                        idx,
+               const apps::feature_frame* previous,
+               const apps::feature_frame& current) noexcept override try {
+        Expects(previous != nullptr);
 
         const int previous_idx = idx - 1;
 
         using namespace math;
         using namespace apps;
 
-        reprojection_data prev{
-            fmt::format(_feature_file_pattern, previous_idx),
-            fmt::format(_input.depth_image_pattern, previous_idx),
-            fmt::format(_input.pose_file_pattern, previous_idx)};
-        reprojection_data curr{fmt::format(_feature_file_pattern, idx),
-                               fmt::format(_input.depth_image_pattern, idx),
-                               fmt::format(_input.pose_file_pattern, idx)};
-
-        if (prev.keypoints.empty() || curr.keypoints.empty())
+        if (previous->keypoints.empty() || current.keypoints.empty())
             return;
 
+        const reprojection_cache::handle prev = _frames.get(previous_idx);
+        const reprojection_cache::handle curr = _frames.get(idx);
+
         // == Calculate relative pose between the two frames.
-        pose_t rel_pose = relative_pose(prev.absolute_pose, curr.absolute_pose);
+        pose_t rel_pose =
+            relative_pose(prev->absolute_pose, curr->absolute_pose);
 
         // Refine that pose with an ICP if possible.
         if (_icp) {
             auto [icp_pose, icp_success] =
-                refine_pose(*_icp, prev.depth_image, curr.depth_image,
+                refine_pose(*_icp, prev->depth_image, curr->depth_image,
                             _input.unit_factor, rel_pose);
             if (icp_success) {
                 rel_pose = icp_pose;
@@ -234,8 +241,9 @@ class prec_recall_analysis {
         }
 
         // == get keypoints as world points
-        pointcloud_t prev_points = keypoints_to_pointcloud(
-            prev.keypoints, prev.depth_image, _intrinsic, _input.unit_factor);
+        pointcloud_t prev_points =
+            keypoints_to_pointcloud(previous->keypoints, prev->depth_image,
+                                    _intrinsic, _input.unit_factor);
 
         imagepoints_t prev_in_img =
             project_to_other_camera(rel_pose, prev_points, _intrinsic);
@@ -246,17 +254,18 @@ class prec_recall_analysis {
         // Such points are set to {-1, -1} to be recognizable invalid.
         const size_t masked_points =
             _mask ? mask_backprojection(*_mask, prev_in_img) : 0UL;
-        Expects(prev_in_img.size() == prev.keypoints.size());
+        Expects(prev_in_img.size() == previous->keypoints.size());
 
         // == Match the keypoints with cross-checking.
         vector<DMatch> matches;
         // QueryDescriptors: first argument
         // TrainDescriptors: second argument
-        _matcher->match(curr.descriptors, prev.descriptors, matches);
+        _matcher->match(current.descriptors, previous->descriptors, matches);
 
         using analysis::element_categories;
         using camera_models::keypoint_to_coords;
-        const imagepoints_t curr_keypoints = keypoint_to_coords(curr.keypoints);
+        const imagepoints_t curr_keypoints =
+            keypoint_to_coords(current.keypoints);
 
         const element_categories classification(
             curr_keypoints, prev_in_img, matches,
@@ -327,6 +336,34 @@ class prec_recall_analysis {
         return;
     }
 
+    int finish() override {
+        _batch.merge([this](const FileStorage& fs) {
+            vector<float> distances;
+            int           masked_points = 0;
+            read(fs["distances"], distances);
+            read(fs["masked_points"], masked_points, 0);
+            _accumulated_data.insert_partial(
+                distances,
+                analysis::recognition_statistic::read_tallies(
+                    fs["classification"]),
+                masked_points);
+        });
+
+        if (_batch.writes_partial()) {
+            auto [distances, classification, masked_points] =
+                _accumulated_data.extract();
+
+            FileStorage out = _batch.create_partial();
+            out << "distances" << distances;
+            classification.write_tallies(out, "classification");
+            out << "masked_points" << narrow<int>(masked_points);
+            return 0;
+        }
+
+        return postprocess() > 0UL ? 0 : 1;
+    }
+
+  private:
     size_t postprocess() {
         auto [distances, classification, masked_point_count] =
             _accumulated_data.extract();
@@ -455,8 +492,7 @@ class prec_recall_analysis {
         return classification.total_elements();
     }
 
-  private:
-    std::string_view                                 _feature_file_pattern;
+    reprojection_cache                               _frames;
     const apps::recognition_analysis_input&          _input;
     const apps::recognition_analysis_output_options& _output_options;
 
@@ -464,40 +500,23 @@ class prec_recall_analysis {
     Ptr<rgbd::Odometry>          _icp;
     Ptr<BFMatcher>               _matcher;
     optional<math::image<uchar>> _mask;
-    recognition_data&            _accumulated_data;
+    recognition_data             _accumulated_data;
 
     const apps::backproject_config& _backprojection_config;
 };
 }  // namespace
 
 namespace sens_loc::apps {
-int analyze_recognition_performance(
-    util::processing_input                     in,
+unique_ptr<frame_analysis> make_recognition_performance_analysis(
+    const util::processing_input&              in,
     const recognition_analysis_input&          required_data,
     const recognition_analysis_output_options& output_options,
-    const backproject_config&                  backproject_config) {
+    const backproject_config&                  backproject_config,
+    const partial_options&                     partial) {
     Expects(in.start < in.end &&
             "Recognition Performance calculation requires at least two images");
-
-    // The code will load all data directly and does not rely on loading through
-    // the statistics code.
-    using visitor =
-        statistic_visitor<prec_recall_analysis<>, required_data::none>;
-
-    recognition_data accumulator;
-    // The odd-looking double arguments comes from the genericity of the
-    // statistic-visitation. The first argument goes to \c statistic_visitor
-    // and the second one to \c prec_recall_analysis
-    auto analysis_v =
-        visitor{in.input_pattern, in.input_pattern, required_data,
-                output_options,   accumulator,      backproject_config};
-
-    // Consecutive images are matched and analysed, therefore the first
-    // index must be skipped.
-    auto   f          = parallel_visitation(in.start + 1, in.end, analysis_v);
-    size_t n_elements = f.postprocess();
-
-    return n_elements > 0L ? 0 : 1;
+    return make_unique<prec_recall_analysis<>>(
+        in, required_data, output_options, backproject_config, partial);
 }
 
 }  // namespace sens_loc::apps
@@ -1,7 +1,11 @@
 #ifndef PRECISION_RECALL_H_G2FJDYVV
 #define PRECISION_RECALL_H_G2FJDYVV
 
+#include "frame_analysis.h"
+#include "partial_result.h"
+
 #include <gsl/gsl>
+#include <memory>
 #include <opencv2/core/base.hpp>
 #include <opencv2/core/types.hpp>
 #include <opencv2/imgproc.hpp>
@@ -63,11 +67,14 @@ struct recognition_analysis_output_options {
     std::optional<std::string> false_positive_distance_histo;
 };
 
-int analyze_recognition_performance(
-    util::processing_input                     in,
+/// Analysis of precision and recall for the matching of consecutive images.
+/// \note The analysis keeps references to the arguments.
+std::unique_ptr<frame_analysis> make_recognition_performance_analysis(
+    const util::processing_input&              in,
     const recognition_analysis_input&          required_data,
     const recognition_analysis_output_options& output_options,
-    const backproject_config&                  backproject_config);
+    const backproject_config&                  backproject_config,
+    const partial_options&                     partial);
 
 }  // namespace sens_loc::apps
 
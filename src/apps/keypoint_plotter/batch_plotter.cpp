@@ -1,43 +1,81 @@
 #include "batch_plotter.h"
 
-#include "util/parallel_processing.h"
-
+#include <cstdlib>
 #include <fmt/core.h>
 #include <opencv2/core/mat.hpp>
-#include <opencv2/core/persistence.hpp>
 #include <opencv2/features2d.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
+#include <sens_loc/io/feature.h>
+#include <sens_loc/io/image.h>
+#include <sens_loc/util/console.h>
+#include <sens_loc/util/trace.h>
+#include <util/executor.h>
 
 namespace sens_loc::apps {
-bool batch_plotter::process_batch(int start, int end) const noexcept {
+namespace {
+/// Call \p stage and report exceptions as failure of \p idx.
+template <typename Stage>
+bool guarded(int idx, Stage&& stage) noexcept {
+    try {
+        return stage();
+    } catch (const std::exception& e) {
+        std::cerr << util::err{} << "Error occured while processing index "
+                  << idx << "!\n"
+                  << e.what() << "\n";
+        return false;
+    } catch (...) {
+        std::cerr << util::err{}
+                  << "Unspecified error occured while processing index " << idx
+                  << "!\n";
+        return false;
+    }
+}
+}  // namespace
+
+bool batch_plotter::process_batch(int        start,
+                                  int        end,
+                                  batch_mode mode) const noexcept {
+    apply_thread_policy(std::abs(end - start) + 1);
+
+    if (mode == batch_mode::pipelined)
+        return pipelined_indexed_file_processing<plot_frame>(
+            start, end,
+            [this](int idx, plot_frame& f) noexcept {
+                return decode_index(idx, f);
+            },
+            [this](int idx, plot_frame& f) noexcept {
+                return compute_index(idx, f);
+            },
+            [this](int idx, plot_frame& f) noexcept {
+                return encode_index(idx, f);
+            });
+
     return parallel_indexed_file_processing(
         start, end,
         [this](int idx) noexcept -> bool { return process_index(idx); });
 }
 
 bool batch_plotter::process_index(int idx) const noexcept {
-    try {
-        using cv::FileNode;
-        using cv::FileStorage;
-        using cv::read;
+    plot_frame f;
+    return decode_index(idx, f) && compute_index(idx, f) &&
+           encode_index(idx, f);
+}
 
+bool batch_plotter::decode_index(int idx, plot_frame& f) const noexcept {
+    SENS_LOC_TRACE_SCOPE("load");
+    return guarded(idx, [&]() {
         const std::string input_file = fmt::format(_feature_file_pattern, idx);
 
-        const FileStorage fs{input_file,
-                             FileStorage::READ | FileStorage::FORMAT_YAML};
+        const io::feature_file fs = io::open_feature_file(input_file);
 
         // if 'keypoints'-key does not exist give an error.
-        const FileNode            keypoints_node = fs["keypoints"];
-        std::vector<cv::KeyPoint> keypoints;
-        read(keypoints_node, keypoints);
+        f.keypoints = io::load_keypoints(fs);
 
-        if (keypoints.empty())
+        if (f.keypoints.empty())
             return false;
 
-        std::string    original_image;
-        const FileNode file_path_node = fs["source_path"];
-        read(file_path_node, original_image, "");
+        std::string original_image = fs.source_path();
 
         if (_target_image_file_pattern || original_image.empty()) {
             // If the feature file does not contain a path to file the features
@@ -51,46 +89,41 @@ bool batch_plotter::process_index(int idx) const noexcept {
         }
         Ensures(!original_image.empty());
 
-        const cv::Mat source_image =
-            cv::imread(original_image, cv::IMREAD_UNCHANGED);
-        if (source_image.empty())
-            return false;
-
-        cv::Mat converted_source;
+        f.source_image = cv::imread(original_image, cv::IMREAD_UNCHANGED);
+        return !f.source_image.empty();
+    });
+}
 
+bool batch_plotter::compute_index(int idx, plot_frame& f) const noexcept {
+    SENS_LOC_TRACE_SCOPE("plot");
+    return guarded(idx, [&]() {
         // Transform possible input images into the correct COLOR_BGR 8bit
         // color space.
-        if (source_image.type() == CV_16UC1) {
+        if (f.source_image.type() == CV_16UC1) {
             cv::Mat intermediate;
-            source_image.convertTo(intermediate, CV_8UC1, 1. / 255.);
-            cv::cvtColor(intermediate, converted_source, cv::COLOR_GRAY2BGR);
-        } else if (source_image.type() == CV_8UC1) {
-            cv::cvtColor(source_image, converted_source, cv::COLOR_GRAY2BGR);
-        } else if (source_image.type() == CV_8UC3) {
-            source_image.copyTo(converted_source);
+            f.source_image.convertTo(intermediate, CV_8UC1, 1. / 255.);
+            cv::cvtColor(intermediate, f.plot, cv::COLOR_GRAY2BGR);
+        } else if (f.source_image.type() == CV_8UC1) {
+            cv::cvtColor(f.source_image, f.plot, cv::COLOR_GRAY2BGR);
+        } else if (f.source_image.type() == CV_8UC3) {
+            f.source_image.copyTo(f.plot);
         } else {
             return false;
         }
 
-        cv::drawKeypoints(converted_source, keypoints, converted_source,
+        cv::drawKeypoints(f.plot, f.keypoints, f.plot,
                           color_to_bgr::convert(_color),
                           cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS |
                               cv::DrawMatchesFlags::DRAW_OVER_OUTIMG);
+        return true;
+    });
+}
 
+bool batch_plotter::encode_index(int idx, plot_frame& f) const noexcept {
+    SENS_LOC_TRACE_SCOPE("write");
+    return guarded(idx, [&]() {
         const std::string output_file = fmt::format(_ouput_file_pattern, idx);
-        const bool write_success = cv::imwrite(output_file, converted_source);
-
-        return write_success;
-    } catch (const std::exception& e) {
-        std::cerr << util::err{} << "Error occured while processing index "
-                  << idx << "!\n"
-                  << e.what() << "\n";
-        return false;
-    } catch (...) {
-        std::cerr << util::err{}
-                  << "Unspecified error occured while processing index " << idx
-                  << "!\n";
-        return false;
-    }
-}  // namespace sens_loc::apps
+        return io::write_image(output_file, f.plot, _output_compression);
+    });
+}
 }  // namespace sens_loc::apps
@@ -2,9 +2,13 @@
 #define BATCH_EXTRACTOR_H_IVH3CLLQ
 
 #include <gsl/gsl>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
 #include <optional>
 #include <sens_loc/util/correctness_util.h>
 #include <string_view>
+#include <util/parallel_processing.h>
+#include <vector>
 
 namespace sens_loc::apps {
 
@@ -60,14 +64,19 @@ struct color_to_bgr {
 /// \ingroup feature-plotter-driver
 class batch_plotter {
   public:
+    /// \param output_compression compression level of the plots, negative
+    /// for the codec default
+    /// \sa io::write_parameters
     batch_plotter(std::string_view                feature_file_pattern,
                   std::string_view                output_file_pattern,
                   feature_color                   color,
-                  std::optional<std::string_view> target_image_file_pattern)
+                  std::optional<std::string_view> target_image_file_pattern,
+                  int                             output_compression = -1)
         : _feature_file_pattern{feature_file_pattern}
         , _ouput_file_pattern{output_file_pattern}
         , _color{color}
-        , _target_image_file_pattern{target_image_file_pattern} {
+        , _target_image_file_pattern{target_image_file_pattern}
+        , _output_compression{output_compression} {
         Expects(!_feature_file_pattern.empty());
         Expects(!_ouput_file_pattern.empty());
         if (_target_image_file_pattern)
@@ -75,12 +84,31 @@ class batch_plotter {
     }
 
     /// Process a whole batch of files in the range [start, end].
-    [[nodiscard]] bool process_batch(int start, int end) const noexcept;
+    /// \param mode process each index in one task or in a pipeline that
+    /// overlaps reading and writing files with the plotting
+    [[nodiscard]] bool
+    process_batch(int        start,
+                  int        end,
+                  batch_mode mode = batch_mode::per_index) const noexcept;
 
   private:
+    /// Keypoints and image of one index while it is processed.
+    struct plot_frame {
+        std::vector<cv::KeyPoint> keypoints;
+        cv::Mat                   source_image;
+        cv::Mat                   plot;
+    };
+
     /// Process a single feature file. Called in parallel from \c process_batch.
     [[nodiscard]] bool process_index(int idx) const noexcept;
 
+    /// Decode stage: read the keypoints and the image to plot them on.
+    [[nodiscard]] bool decode_index(int idx, plot_frame& f) const noexcept;
+    /// Compute stage: convert the image to BGR and draw the keypoints.
+    [[nodiscard]] bool compute_index(int idx, plot_frame& f) const noexcept;
+    /// Encode stage: write the plot to the output file.
+    [[nodiscard]] bool encode_index(int idx, plot_frame& f) const noexcept;
+
     /// The feature-detector creates files with the keypoints. This file-pattern
     /// needs to be provided in order to plot those keypoints.
     std::string_view _feature_file_pattern;
@@ -97,6 +125,9 @@ class batch_plotter {
     /// for plotting. This is the case for plotting multiple feature keypoints
     /// or if the path to the file is incorrect.
     std::optional<std::string_view> _target_image_file_pattern;
+
+    /// Compression level for the output images.
+    int _output_compression;
 };
 }  // namespace sens_loc::apps
 
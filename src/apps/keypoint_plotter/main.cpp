@@ -1,12 +1,17 @@
 #include "batch_plotter.h"
 
 #include <CLI/CLI.hpp>
+#include <cstdlib>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/correctness_util.h>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <util/colored_parse.h>
+#include <util/executor.h>
+#include <util/shard.h>
 #include <util/tool_macro.h>
+#include <util/tracing.h>
 #include <util/version_printer.h>
 #include <vector>
 
@@ -48,6 +53,27 @@ MAIN_HEAD("Batch-processing tool to plot keypoints and matches") {
     int end_idx = 0;
     app.add_option("-e,--end", end_idx, "End index for processing.")
         ->required();
+    bool pipeline = false;
+    app.add_flag("--pipeline", pipeline,
+                 "Overlap reading and writing files with the processing in "
+                 "separate pipeline stages");
+    shard part;
+    add_shard_option(app, part);
+    string thread_policy = "outer";
+    app.add_set("--thread-policy", thread_policy, {"outer", "inner", "hybrid"},
+                "Distribution of the threads between the images and the "
+                "OpenCV functions. 'outer' processes the images in parallel "
+                "with sequential OpenCV functions, 'inner' processes one "
+                "image at a time with parallel OpenCV functions and "
+                "'hybrid' selects one of both by the size of the batch.",
+                /*defaulted=*/true);
+    int output_compression = -1;
+    app.add_option("--output-compression", output_compression,
+                   "Compression level of the output images, 0-9 for PNG and "
+                   "0 for uncompressed TIFF. The codec is selected by the "
+                   "extension of the output pattern, e.g. '.pgm' writes "
+                   "uncompressed raw images. Lower levels write faster.")
+        ->check(CLI::Range(0, 9));
 
     string color = "purple";
     app.add_set("-c,--color", color,
@@ -57,17 +83,27 @@ MAIN_HEAD("Batch-processing tool to plot keypoints and matches") {
 
     COLORED_APP_PARSE(app, argc, argv);
 
+    const auto indices = select_shard(part, start_idx, end_idx);
+    if (!indices)
+        return 0;
+    tie(start_idx, end_idx) = *indices;
+
     // Explicitly disable threading from OpenCV functions, as the
-    // parallelization is done at a higher level.
+    // parallelization is done at a higher level, unless the images are
+    // processed one after another by the thread policy.
     // That means, that each filter application is not multithreaded, but each
     // image modification is. This is necessary as "TaskFlow" does not play
     // nice with OpenCV threading and they introduce data races in the program
     // because of that.
-    cv::setNumThreads(0);
+    // The threads are split once the batch skipped the up-to-date images.
+    set_thread_policy(thread_policy);
 
     batch_plotter plotter(feature_file_input_pattern, output_pattern,
-                          str_to_color(color), original_image_input_pattern);
+                          str_to_color(color), original_image_input_pattern,
+                          output_compression);
 
-    return plotter.process_batch(start_idx, end_idx) ? 0 : 1;
+    const batch_mode mode =
+        pipeline ? batch_mode::pipelined : batch_mode::per_index;
+    return plotter.process_batch(start_idx, end_idx, mode) ? 0 : 1;
 }
 MAIN_TAIL
@@ -1,42 +1,251 @@
 #include "batch_converter.h"
 
+#include "executor.h"
+#include "incremental.h"
 #include "parallel_processing.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <fmt/core.h>
 #include <gsl/gsl>
+#include <opencv2/core/mat.hpp>
+#include <optional>
 #include <sens_loc/io/image.h>
+#include <sens_loc/io/manifest.h>
+#include <sens_loc/io/stream.h>
 #include <sens_loc/math/image.h>
+#include <sens_loc/util/image_pool.h>
+#include <sens_loc/util/trace.h>
+#include <string>
+#include <vector>
 
 namespace sens_loc::apps {
 
-bool batch_converter::process_index(int idx) const noexcept {
+namespace {
+/// Conversion of one image of a stream.
+struct stream_frame {
+    conversion_frame conversion;
+    cv::Mat          input;  ///< Received image before its type is checked.
+};
+}  // namespace
+
+bool conversion_frame::flush(int compression) noexcept {
+    SENS_LOC_TRACE_SCOPE("write");
+    bool success = true;
+    for (const auto& [file_name, image] : outputs) {
+        try {
+            success &= io::write_image(file_name, image, compression);
+        } catch (...) { success = false; }
+    }
+    outputs.clear();
+    return success;
+}
+
+bool batch_converter::process_index(int                 idx,
+                                    tf::Executor*       rows,
+                                    io::batch_manifest* manifest) const
+    noexcept {
+    // The taskflow workers are threads that live for the whole batch, so
+    // a 'thread_local' frame is owned by exactly one worker.
+    thread_local conversion_frame frame;
+    frame.rows = rows;
+
+    // Results of a failed conversion are written, but not recorded.
+    const bool success =
+        decode_index(idx, frame) && compute_index(idx, frame);
+    return encode_index(idx, frame, success ? manifest : nullptr) && success;
+}
+
+std::string batch_converter::input_file(int idx) const {
+    if (is_archive(_files.input))
+        return _files.input;
+    return fmt::format(_files.input, idx);
+}
+
+bool batch_converter::decode_index(int               idx,
+                                   conversion_frame& frame) const noexcept {
     Expects(!_files.input.empty());
-    const std::string input_file = fmt::format(_files.input, idx);
-    std::optional<math::image<ushort>> depth_image =
-        io::load_image<ushort>(input_file, cv::IMREAD_UNCHANGED);
+    SENS_LOC_TRACE_SCOPE("load");
 
-    if (!depth_image)
-        return false;
+    // The results of the previous index in this frame are written already.
+    frame.pool.recycle();
+
+    if (_sequence) {
+        if (idx < 0 || idx >= _sequence->size())
+            return false;
+        return _sequence->read(idx, frame.depth);
+    }
 
-    std::optional<math::image<float>> pp_image =
-        this->preprocess_depth(*depth_image);
+    const std::string input_file = fmt::format(_files.input, idx);
+    return io::load_image(input_file, cv::IMREAD_UNCHANGED, frame.file,
+                          frame.depth);
+}
+
+bool batch_converter::compute_index(int               idx,
+                                    conversion_frame& frame) const noexcept {
+    std::optional<math::image<float>> pp_image;
+    {
+        SENS_LOC_TRACE_SCOPE("preprocess");
+        pp_image = this->preprocess_depth(frame.depth, frame);
+    }
 
     if (!pp_image)
         return false;
 
-    return this->process_file(*pp_image, idx);
+    return this->process_file(*pp_image, idx, frame);
+}
+
+bool batch_converter::encode_index(int                 idx,
+                                   conversion_frame&   frame,
+                                   io::batch_manifest* manifest) const
+    noexcept {
+    std::vector<std::string> files;
+    try {
+        if (manifest != nullptr)
+            for (const auto& output : frame.outputs)
+                files.push_back(output.first);
+    } catch (...) { manifest = nullptr; }
+
+    const bool success = frame.flush(_files.output_compression);
+    if (!success || manifest == nullptr)
+        return success;
+    return manifest->record(idx, files);
 }
 
 std::optional<math::image<float>>
-batch_converter::preprocess_depth(const math::image<ushort>& depth_image) const
+batch_converter::preprocess_depth(const math::image<ushort>& depth_image,
+                                  conversion_frame&          frame) const
     noexcept {
-    return math::convert<float>(depth_image);
+    math::image<float> result =
+        frame.pool.get<float>(depth_image.w(), depth_image.h());
+    math::convert(depth_image, result);
+    return result;
 }
 
-bool batch_converter::process_batch(int start, int end) const noexcept {
+bool batch_converter::process_batch(int                 start,
+                                    int                 end,
+                                    batch_mode          mode,
+                                    intra_image         intra,
+                                    io::batch_manifest* manifest) const
+    noexcept {
+    if (is_archive(_files.input) && !_sequence) {
+        auto s = synced();
+        std::cerr << util::err{} << "Could not open the archive \""
+                  << rang::style::bold << _files.input << rang::style::reset
+                  << "\"!\n";
+        return false;
+    }
+
+    // The rows of an image are processed by their own workers. The file
+    // workers only wait for the rows and the threads are split between both,
+    // so that the cores are not oversubscribed.
+    tf::Executor*    rows = nullptr;
+    std::vector<int> indices;
+    try {
+        indices = pending_indices(
+            index_range(start, end), manifest,
+            [this](int idx) { return this->input_file(idx); });
+        if (indices.empty())
+            return true;
+
+        const int tasks = gsl::narrow<int>(indices.size());
+        apply_thread_policy(tasks);
+
+        // The pipeline runs at least a decoding, a computing and an encoding
+        // thread.
+        if (use_intra_image(intra, tasks)) {
+            split_row_workers(mode == batch_mode::pipelined ? std::max(tasks, 3)
+                                                            : tasks);
+            rows = &row_executor();
+        }
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in batch processing!\n";
+        return false;
+    }
+
+    if (mode == batch_mode::pipelined)
+        return pipelined_indexed_file_processing<conversion_frame>(
+            indices,
+            [this](int idx, conversion_frame& f) noexcept -> bool {
+                return this->decode_index(idx, f);
+            },
+            [this, rows](int idx, conversion_frame& f) noexcept -> bool {
+                f.rows = rows;
+                return this->compute_index(idx, f);
+            },
+            [this, manifest](int idx, conversion_frame& f) noexcept -> bool {
+                return this->encode_index(idx, f, manifest);
+            });
+
     return parallel_indexed_file_processing(
-        start, end,
-        [this](int idx) noexcept -> bool { return this->process_index(idx); });
+        indices, [this, rows, manifest](int idx) noexcept -> bool {
+            return this->process_index(idx, rows, manifest);
+        });
+}
+
+bool batch_converter::process_stream(io::frame_stream& in,
+                                     io::frame_stream& out,
+                                     intra_image       intra) const noexcept {
+    // The images of a stream arrive one by one and each result is awaited
+    // by the client. Splitting the rows of each image reduces this latency,
+    // as long as there is more than one worker.
+    tf::Executor* rows = nullptr;
+    try {
+        apply_thread_policy(1);
+
+        // The reading, computing and writing thread of the stream.
+        if (use_intra_image(intra, 1)) {
+            split_row_workers(3);
+            rows = &row_executor();
+        }
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in stream processing!\n";
+        return false;
+    }
+
+    const bool success = ordered_stream_processing<stream_frame>(
+        [&in](stream_frame& f) noexcept -> stream_read {
+            SENS_LOC_TRACE_SCOPE("read");
+            // The results of the previous image in this frame are written
+            // already and the buffer of its input is reused.
+            f.conversion.pool.recycle();
+            io::stream_header header;
+            switch (in.read(header, f.input)) {
+            case io::stream_status::frame: return stream_read::frame;
+            case io::stream_status::end: return stream_read::end;
+            case io::stream_status::error: return stream_read::error;
+            }
+            UNREACHABLE("Switch is exhaustive");  // LCOV_EXCL_LINE
+        },
+        [this, rows](int seq, stream_frame& f) noexcept -> bool {
+            if (f.input.type() != CV_16UC1)
+                return false;
+            f.conversion.depth = math::image<ushort>(f.input);
+            f.conversion.rows  = rows;
+            return this->compute_index(seq, f.conversion);
+        },
+        [&out](int seq, stream_frame& f) noexcept -> bool {
+            SENS_LOC_TRACE_SCOPE("write");
+            auto&      outputs = f.conversion.outputs;
+            const auto parts =
+                gsl::narrow_cast<std::uint32_t>(outputs.size());
+            bool success = true;
+            for (std::uint32_t part = 0; part < parts && success; ++part)
+                success = out.write(gsl::narrow_cast<std::uint32_t>(seq),
+                                    part, parts, outputs[part].second);
+            outputs.clear();
+            if (!success && out.peer_closed()) {
+                auto s = synced();
+                std::cerr << util::err{}
+                          << "The reader closed the output stream!\n";
+            }
+            return success;
+        });
+    out.shutdown_write();
+    return success;
 }
 
 }  // namespace sens_loc::apps
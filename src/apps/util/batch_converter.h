@@ -1,15 +1,28 @@
 #ifndef BATCH_CONVERTER_H_XDIRBPHG
 #define BATCH_CONVERTER_H_XDIRBPHG
 
+#include "parallel_processing.h"
+
+#include <memory>
+#include <opencv2/core/mat.hpp>
 #include <optional>
 #include <sens_loc/camera_models/concepts.h>
+#include <sens_loc/camera_models/ray_cache.h>
 #include <sens_loc/conversion/depth_to_laserscan.h>
+#include <sens_loc/io/image.h>
+#include <sens_loc/io/manifest.h>
+#include <sens_loc/io/sequence.h>
+#include <sens_loc/io/stream.h>
 #include <sens_loc/math/image.h>
 #include <sens_loc/util/correctness_util.h>
+#include <sens_loc/util/image_pool.h>
+#include <sens_loc/util/trace.h>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace sens_loc {
 
@@ -49,6 +62,8 @@ inline depth_type str_to_depth_type(std::string_view option) {
 /// Helper struct to contain path specification for input and output files.
 /// The paths can be patterns like \c "depth-{}.png" where curly braces are
 /// substituted with an index.
+/// The input can be a depth sequence archive (".dseq") as well, whose frames
+/// are accessed by their index.
 struct file_patterns {
     std::string input;         ///< Input file pattern specification.
     std::string output;        ///< Output file pattern specification.
@@ -60,6 +75,66 @@ struct file_patterns {
                                ///< diagonal images.
     std::string antidiagonal;  ///< Only relevant for bearing angles, output for
                                ///< antidiagonal images.
+    std::string flexion;       ///< Only relevant for fused conversions, output
+                               ///< for flexion images.
+    std::string max_curve;     ///< Only relevant for fused conversions, output
+                               ///< for max-curve images.
+    int output_compression = -1;  ///< Compression level for all outputs,
+                                  ///< negative for the codec default.
+                                  ///< \sa io::write_parameters
+};
+
+/// Buffers and results of one index while it is converted.
+///
+/// A frame is reused for many indices and its buffers keep their memory, so
+/// that a batch of equally sized images reaches a state without allocations.
+/// The result images are not written immediately, but queued with \c write.
+/// This allows writing them in a separate stage of the batch processing.
+struct conversion_frame {
+    std::vector<uchar>  file;   ///< Encoded content of the input file.
+    math::image<ushort> depth;  ///< Decoded input image.
+    util::image_pool    pool;   ///< Intermediate and result images.
+
+    /// Queue \p image to be written to \p file_name by \c flush.
+    /// \note \p image shares its memory and must not be modified until
+    /// \c flush.
+    void write(std::string file_name, const cv::Mat& image) {
+        outputs.emplace_back(std::move(file_name), image);
+    }
+
+    /// Encode and write all queued images and clear the queue.
+    /// \param compression compression level for the codecs of the images
+    /// \sa io::write_parameters
+    /// \returns \c true if all images were written successfully.
+    [[nodiscard]] bool flush(int compression) noexcept;
+
+    /// Run a conversion of the current image.
+    ///
+    /// If \c rows is set, \p parallel adds the row-parallel conversion to
+    /// a taskflow that is executed by \c rows and this function waits for
+    /// it. Otherwise \p sequential converts the image on the calling thread.
+    /// The conversion is traced as the stage "convert".
+    /// \param sequential callable \c void()
+    /// \param parallel callable \c void(tf::Taskflow&)
+    template <typename Sequential, typename Parallel>
+    void convert(Sequential&& sequential, Parallel&& parallel) {
+        SENS_LOC_TRACE_SCOPE("convert");
+        if (rows == nullptr) {
+            sequential();
+            return;
+        }
+        tf::Taskflow flow;
+        parallel(flow);
+        rows->run(flow).wait();
+    }
+
+    /// Images that still need to be written with their file names.
+    std::vector<std::pair<std::string, cv::Mat>> outputs;
+
+    /// Workers for the rows of the current image, \c nullptr if each image
+    /// is converted by a single thread.
+    /// \sa intra_image
+    tf::Executor* rows = nullptr;
 };
 
 /// Just local helper for batch conversion tasks over a given index range.
@@ -70,6 +145,17 @@ class batch_converter {
     batch_converter(const file_patterns& files)
         : _files{files} {
         Expects(!_files.input.empty());
+        if (is_archive(_files.input)) {
+            if (auto s = io::depth_sequence::open(_files.input))
+                _sequence =
+                    std::make_shared<const io::depth_sequence>(std::move(*s));
+        }
+    }
+
+    /// \returns \c true if \p input refers to a depth sequence archive
+    /// instead of a file pattern.
+    static bool is_archive(std::string_view input) noexcept {
+        return io::detail::has_extension(input, ".dseq");
     }
 
     batch_converter(const batch_converter&)            = default;
@@ -81,8 +167,38 @@ class batch_converter {
     /// \note This function does parallel batch processing.
     /// \note As a high level function it catches all exceptions and provides
     /// human readable error message to std-out.
+    /// \param start,end inclusive range of indices
+    /// \param mode process each index in one task or in a pipeline that
+    /// overlaps reading and writing files with the conversion
+    /// \param intra parallelize the conversion of each image over its rows
+    /// \param manifest skip the indices that are up to date in the manifest
+    /// and record the finished ones, \c nullptr processes all indices
     /// \returns 'false' if any of the indices fails.
-    [[nodiscard]] bool process_batch(int start, int end) const noexcept;
+    [[nodiscard]] bool
+    process_batch(int                 start,
+                  int                 end,
+                  batch_mode          mode     = batch_mode::per_index,
+                  intra_image         intra    = intra_image::automatic,
+                  io::batch_manifest* manifest = nullptr) const noexcept;
+
+    /// Convert the images of the stream \p in and write the results to
+    /// \p out until \p in ends.
+    ///
+    /// Each input must be a 16-bit, single channel image and is answered with
+    /// all result images of its conversion in the order they are written in
+    /// \c process_file. The results keep the order of the inputs, even though
+    /// the images are converted in parallel. An input that can not be
+    /// converted is skipped and has no results.
+    /// \note \p in and \p out may refer to the same socket.
+    /// \param intra parallelize the conversion of each image over its rows,
+    /// for \c intra_image::automatic only if the stream does not keep all
+    /// worker threads busy
+    /// \returns \c false if any image fails or a stream breaks.
+    [[nodiscard]] bool
+    process_stream(io::frame_stream& in,
+                   io::frame_stream& out,
+                   intra_image       intra = intra_image::automatic) const
+        noexcept;
 
     virtual ~batch_converter() = default;
 
@@ -90,6 +206,9 @@ class batch_converter {
     file_patterns _files;  ///< File patterns that shall be processed.
 
   private:
+    /// Archive of the input images, if \c _files.input is an archive.
+    std::shared_ptr<const io::depth_sequence> _sequence;
+
     /// Function that does the management-tasks for the conversion job, like
     /// file-io and error handling.
     ///
@@ -100,22 +219,58 @@ class batch_converter {
     /// On success it calls \p process_file which implements the actual
     /// conversion in each subclass.
     ///
+    /// Each taskflow worker owns one \c conversion_frame that is reused for
+    /// every index the worker processes.
+    ///
     /// \sa process_file
+    /// \param rows workers for the rows of the image, may be \c nullptr
+    /// \param manifest records the outputs of the index, may be \c nullptr
     /// \pre \p _files.input is not empty
     /// \returns \c true on success, otherwise \c false.
-    [[nodiscard]] bool process_index(int idx) const noexcept;
+    [[nodiscard]] bool process_index(int                 idx,
+                                     tf::Executor*       rows,
+                                     io::batch_manifest* manifest) const
+        noexcept;
+
+    /// \returns the input file of \p idx, the archive for all indices if
+    /// the input is an archive.
+    [[nodiscard]] std::string input_file(int idx) const;
+
+    /// Decode stage: read the input file of \p idx into \p frame.
+    /// Frames of raw archives are not copied.
+    [[nodiscard]] bool decode_index(int               idx,
+                                    conversion_frame& frame) const noexcept;
+
+    /// Compute stage: preprocess the decoded image and convert it.
+    [[nodiscard]] bool compute_index(int               idx,
+                                     conversion_frame& frame) const noexcept;
+
+    /// Encode stage: write the results of \p idx and record them in
+    /// \p manifest, if it is not \c nullptr.
+    [[nodiscard]] bool encode_index(int                 idx,
+                                    conversion_frame&   frame,
+                                    io::batch_manifest* manifest) const
+        noexcept;
 
     /// Function to potentially convert orthographic images into range images.
+    /// \param depth_image loaded input image
+    /// \param frame buffers of the worker, the result is taken from its pool
     /// \returns \c cv::Mat with proper input data for the conversion process.
     [[nodiscard]] virtual std::optional<math::image<float>>
-    preprocess_depth(const math::image<ushort>& depth_image) const noexcept;
+    preprocess_depth(const math::image<ushort>& depth_image,
+                     conversion_frame&          frame) const noexcept;
 
     /// Method to process exactly one file. This method is expected to have
     /// no sideeffects and is called in parallel.
+    /// \param depth_image preprocessed input image
+    /// \param idx index of the file
+    /// \param frame buffers for the results, that are written with
+    /// \c conversion_frame::write
     /// \returns \c true on success, otherwise \c false.
     [[nodiscard]] virtual bool
     process_file(const math::image<float>& depth_image,
-                 int                       idx) const noexcept = 0;
+                 int                       idx,
+                 conversion_frame&         frame) const noexcept = 0;
 };
 
 /// This class provides common data and depth-image conversion for all
@@ -128,6 +283,7 @@ class batch_sensor_converter : public batch_converter {
                            Intrinsic            intrinsic)
         : batch_converter(files)
         , intrinsic{std::move(intrinsic)}
+        , rays{this->intrinsic}
         , _input_depth_type{t} {}
 
     batch_sensor_converter(const batch_sensor_converter&)            = default;
@@ -139,6 +295,8 @@ class batch_sensor_converter : public batch_converter {
   protected:
     /// pinhole-camera-model parameters used in the whole conversion.
     Intrinsic intrinsic;
+    /// Lightrays of \c intrinsic, calculated once for the whole batch.
+    camera_models::ray_cache<Intrinsic> rays;
     /// Discriminate input type of the images.
     depth_type _input_depth_type;
 
@@ -147,17 +305,30 @@ class batch_sensor_converter : public batch_converter {
     /// model.
     /// \sa conversion::depth_to_laserscan
     /// \returns \c cv::Mat with one channel and double as data type.
-    [[nodiscard]] std::optional<math::image<float>> preprocess_depth(
-        const math::image<ushort>& depth_image) const noexcept override {
+    [[nodiscard]] std::optional<math::image<float>>
+    preprocess_depth(const math::image<ushort>& depth_image,
+                     conversion_frame&          frame) const noexcept override {
         if ((depth_image.w() != intrinsic.w()) ||
             depth_image.h() != intrinsic.h())
             return std::nullopt;
 
+        math::image<float> result =
+            frame.pool.get<float>(depth_image.w(), depth_image.h());
         switch (_input_depth_type) {
         case depth_type::orthografic:
-            return conversion::depth_to_laserscan<float, ushort>(depth_image,
-                                                                 intrinsic);
-        case depth_type::euclidean: return math::convert<float>(depth_image);
+            frame.convert(
+                [&]() {
+                    conversion::depth_to_laserscan<float, ushort>(
+                        depth_image, rays, result);
+                },
+                [&](tf::Taskflow& flow) {
+                    conversion::par_depth_to_laserscan<float, ushort>(
+                        depth_image, rays, result, flow);
+                });
+            return result;
+        case depth_type::euclidean:
+            math::convert(depth_image, result);
+            return result;
         }
         UNREACHABLE("Switch is exhaustive");  // LCOV_EXCL_LINE
     }
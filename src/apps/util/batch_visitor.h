@@ -1,9 +1,16 @@
 #ifndef BATCH_VISITOR_H_WIWKQDOS
 #define BATCH_VISITOR_H_WIWKQDOS
 
+#include "executor.h"
+
 #include <chrono>
+#include <gsl/gsl>
 #include <iomanip>
+#include <iostream>
+#include <rang.hpp>
+#include <sens_loc/util/console.h>
 #include <sens_loc/util/progress_bar_observer.h>
+#include <sens_loc/util/trace.h>
 #include <system_error>
 #include <taskflow/taskflow.hpp>
 #include <type_traits>
@@ -12,6 +19,7 @@ namespace sens_loc::apps {
 
 /// General purpose function to execute a specific visitor in parallel
 /// in order to determine some statistical insight.
+/// The indices are processed by the workers of \c shared_executor.
 /// \tparam Functor Apply this functor for each index.
 /// \param start,end inclusive range of integers for the files to be accessed.
 /// \param f functor that is applied for each index
@@ -24,12 +32,18 @@ Functor parallel_visitation(int start, int end, Functor&& f) noexcept {
     if (start > end)
         std::swap(start, end);
 
-    tf::Executor executor;
+    tf::Executor& executor = shared_executor();
 
     int total_tasks = end - start + 1;
     executor.make_observer<util::progress_bar_observer>(total_tasks);
+    auto remove_progress =
+        gsl::finally([&executor]() { executor.remove_observer(); });
     tf::Taskflow tf;
-    tf.parallel_for(start, end + 1, 1, std::forward<Functor>(f));
+    // Each task works on its own copy of the functor.
+    tf.parallel_for(start, end + 1, 1, [f](int idx) mutable {
+        SENS_LOC_TRACE_SCOPE("index");
+        f(idx);
+    });
     const auto before = std::chrono::steady_clock::now();
     executor.run(tf).wait();
     const auto after = std::chrono::steady_clock::now();
@@ -0,0 +1,82 @@
+#ifndef BOUNDED_QUEUE_H_K8WQ3ZJD
+#define BOUNDED_QUEUE_H_K8WQ3ZJD
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <gsl/gsl>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace sens_loc::apps {
+
+/// Thread-safe FIFO-queue with a maximum number of elements.
+///
+/// \c push blocks while the queue is full and \c pop blocks while the queue
+/// is empty. This connects the stages of a pipeline and limits the amount of
+/// work that a fast stage can queue up for a slower stage.
+/// After \c close no more elements can be pushed and \c pop returns
+/// \c std::nullopt once the queue is drained.
+template <typename T>
+class bounded_queue {
+  public:
+    /// \pre \p capacity is positive
+    explicit bounded_queue(std::size_t capacity) noexcept
+        : _capacity{capacity} {
+        Expects(capacity > 0);
+    }
+
+    bounded_queue(const bounded_queue&) = delete;
+    bounded_queue(bounded_queue&&)      = delete;
+    bounded_queue& operator=(const bounded_queue&) = delete;
+    bounded_queue& operator=(bounded_queue&&) = delete;
+    ~bounded_queue()                          = default;
+
+    /// Append \p element and block while the queue is full.
+    /// \pre the queue is not closed
+    void push(T element) {
+        std::unique_lock<std::mutex> l{_mutex};
+        _not_full.wait(l, [this] { return _elements.size() < _capacity; });
+        Expects(!_closed);
+        _elements.push_back(std::move(element));
+        l.unlock();
+        _not_empty.notify_one();
+    }
+
+    /// Remove the first element and block while the queue is empty.
+    /// \returns \c std::nullopt if the queue is closed and empty.
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> l{_mutex};
+        _not_empty.wait(l, [this] { return !_elements.empty() || _closed; });
+        if (_elements.empty())
+            return std::nullopt;
+
+        T element = std::move(_elements.front());
+        _elements.pop_front();
+        l.unlock();
+        _not_full.notify_one();
+        return element;
+    }
+
+    /// Signal that no more elements will be pushed and wake up all consumers.
+    void close() noexcept {
+        {
+            std::lock_guard<std::mutex> l{_mutex};
+            _closed = true;
+        }
+        _not_empty.notify_all();
+    }
+
+  private:
+    std::mutex              _mutex;
+    std::condition_variable _not_full;
+    std::condition_variable _not_empty;
+    std::deque<T>           _elements;
+    std::size_t             _capacity;
+    bool                    _closed = false;
+};
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: BOUNDED_QUEUE_H_K8WQ3ZJD */
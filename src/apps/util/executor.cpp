@@ -0,0 +1,94 @@
+#include "executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <gsl/gsl>
+#include <optional>
+#include <sens_loc/util/affinity.h>
+#include <sens_loc/util/thread_budget.h>
+#include <stdexcept>
+
+namespace sens_loc::apps {
+
+namespace {
+std::atomic<int>  configured_workers{0};
+std::atomic<int>  row_workers{0};
+std::atomic<bool> executor_created{false};
+
+std::optional<util::thread_policy> configured_policy;
+}  // namespace
+
+void set_worker_count(int threads) noexcept {
+    Expects(threads >= 0);
+    Expects(!executor_created);
+    configured_workers = threads;
+}
+
+int worker_count() noexcept {
+    const int threads = configured_workers;
+    return threads > 0 ? threads : util::available_cpus();
+}
+
+void split_row_workers(int outer) noexcept {
+    Expects(outer > 0);
+    Expects(!executor_created);
+    const int total = worker_count();
+    row_workers     = std::max(1, total - std::min(outer, total - 1));
+}
+
+int batch_worker_count() noexcept {
+    const int rows = row_workers;
+    return rows > 0 ? std::max(1, worker_count() - rows) : worker_count();
+}
+
+tf::Executor& shared_executor() {
+    executor_created = true;
+    static tf::Executor executor(
+        gsl::narrow_cast<unsigned>(batch_worker_count()));
+    return executor;
+}
+
+tf::Executor& row_executor() {
+    Expects(row_workers > 0);
+    executor_created = true;
+    static tf::Executor executor(gsl::narrow_cast<unsigned>(row_workers));
+    return executor;
+}
+
+void set_thread_policy(const std::string& policy) noexcept {
+    Expects(policy == "outer" || policy == "inner" || policy == "hybrid");
+    Expects(!executor_created);
+    configured_policy = policy == "inner"
+                            ? util::thread_policy::inner
+                            : policy == "hybrid" ? util::thread_policy::hybrid
+                                                 : util::thread_policy::outer;
+}
+
+void apply_thread_policy(int tasks) noexcept {
+    if (!configured_policy)
+        return;
+    const util::thread_budget budget = util::split_threads(
+        *configured_policy, worker_count(), std::max(1, tasks));
+    configured_policy.reset();
+    set_worker_count(budget.workers);
+    util::apply_opencv_threads(budget);
+}
+
+void set_threads::operator()(int threads) const { set_worker_count(threads); }
+
+void set_affinity::operator()(const std::string& cpus) const {
+    // The worker threads inherit the affinity, they must not exist yet.
+    Expects(!executor_created);
+    const auto list = util::parse_cpu_list(cpus);
+    if (!list || !util::set_cpu_affinity(*list))
+        throw std::runtime_error{"Could not pin the process to the CPUs " +
+                                 cpus};
+}
+
+std::string check_cpu_list(const std::string& cpus) {
+    if (util::parse_cpu_list(cpus))
+        return {};
+    return "Invalid CPU list \"" + cpus + "\", expected e.g. \"0-7,16\"";
+}
+
+}  // namespace sens_loc::apps
@@ -0,0 +1,98 @@
+#ifndef EXECUTOR_H_T7NQ2VXA
+#define EXECUTOR_H_T7NQ2VXA
+
+#include <string>
+#include <taskflow/taskflow.hpp>
+
+namespace sens_loc::apps {
+
+/// Set the number of worker threads of the batch processing.
+/// \param threads number of workers, 0 for one per available CPU
+/// \pre \p threads is not negative
+/// \pre \c shared_executor was not used yet
+void set_worker_count(int threads) noexcept;
+
+/// \returns the number of worker threads of the batch processing. Without
+/// configuration this is the number of CPUs the process may run on.
+/// \sa util::available_cpus
+[[nodiscard]] int worker_count() noexcept;
+
+/// Split the workers of \c worker_count between \c shared_executor and
+/// \c row_executor, so that both executors together do not exceed the
+/// configured number of threads.
+///
+/// The outer workers decode and encode images while the row workers convert
+/// the rows of other images. \p outer of the workers stay with
+/// \c shared_executor, the rest processes the rows. Each executor keeps at
+/// least one worker, which exceeds a single configured thread.
+/// \param outer number of images that are processed at the same time
+/// \pre \p outer is positive
+/// \pre no executor was used yet
+void split_row_workers(int outer) noexcept;
+
+/// \returns the number of workers of \c shared_executor. This is
+/// \c worker_count unless the rows are split with \c split_row_workers.
+[[nodiscard]] int batch_worker_count() noexcept;
+
+/// Executor that runs all batch processing of the tool.
+///
+/// The executor is created with \c batch_worker_count workers on first use
+/// and lives until the end of the program. Creating an executor for each batch
+/// would start and join all worker threads again.
+/// \note Only one batch may run on the executor at a time, because each batch
+/// installs its own progress observer.
+[[nodiscard]] tf::Executor& shared_executor();
+
+/// Executor for the rows of single images, that has the workers that
+/// \c split_row_workers assigns to the rows.
+///
+/// A task of \c shared_executor that waits for the rows of its image blocks
+/// its worker. If the rows ran on the same executor, all workers could end
+/// up waiting and none would be left to process the rows.
+/// \pre \c split_row_workers was called
+[[nodiscard]] tf::Executor& row_executor();
+
+/// Record the '--thread-policy' option of the tool.
+/// The threads are split by \c apply_thread_policy once the batch knows the
+/// number of images it processes.
+///
+/// \param policy value of the '--thread-policy' option, one of "outer",
+/// "inner" or "hybrid"
+/// \pre \c shared_executor was not used yet
+void set_thread_policy(const std::string& policy) noexcept;
+
+/// Split the threads of \c worker_count between the workers of the batch
+/// processing and the internal parallelism of OpenCV with the policy of
+/// \c set_thread_policy. Nothing happens without a policy and the policy is
+/// applied only once.
+/// OpenCV only uses multiple threads if there is a single worker, because
+/// its thread pool is global and races with the workers otherwise.
+///
+/// \param tasks number of images that are processed, without the images
+/// that an incremental batch skips
+/// \pre \c shared_executor was not used yet
+/// \sa util::split_threads
+void apply_thread_policy(int tasks) noexcept;
+
+/// Helper functor for the '--threads' option of each program.
+struct set_threads {
+    void operator()(int threads) const;
+};
+
+/// Helper functor for the '--cpu-affinity' option of each program.
+/// Pins the whole process, including all worker threads, to the CPUs of the
+/// list.
+/// \sa util::parse_cpu_list
+/// \throws std::runtime_error if the affinity can not be set
+struct set_affinity {
+    void operator()(const std::string& cpus) const;
+};
+
+/// Validation of the '--cpu-affinity' option.
+/// \returns an error message if \p cpus is not a valid CPU list, otherwise
+/// an empty string.
+std::string check_cpu_list(const std::string& cpus);
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: EXECUTOR_H_T7NQ2VXA */
@@ -0,0 +1,165 @@
+#ifndef FRAME_CACHE_H_Q4DN8ZRC
+#define FRAME_CACHE_H_Q4DN8ZRC
+
+#include "executor.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <gsl/gsl>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace sens_loc::apps {
+
+/// Thread-safe cache of the loaded data of single frames for analyses that
+/// visit multiple frames per index, e.g. consecutive pairs of frames.
+///
+/// Each frame is loaded once with the loader and handed out as shared,
+/// immutable data. Concurrent requests of a frame that is still loading wait
+/// for the first loader instead of loading the frame again.
+/// A frame is dropped from the cache after it was requested \c uses times.
+/// Additionally the cache holds at most \c capacity frames. If it grows
+/// larger, the frames that were loaded first and are not in use by any
+/// caller are dropped. Dropped frames are loaded again on the next request,
+/// so the window bounds the memory without changing the results.
+/// \tparam Frame data of one frame, e.g. keypoints and descriptors
+template <typename Frame>
+class frame_cache {
+  public:
+    /// Callable that loads the frame of an index.
+    /// Exceptions of the loader are passed on to all requesters of the frame.
+    using loader = std::function<Frame(int)>;
+    /// Reference counted handle of a loaded frame. The frame stays valid
+    /// while the handle exists, even if the cache drops it.
+    using handle = std::shared_ptr<const Frame>;
+
+    /// \param load callable that loads a frame
+    /// \param uses number of requests of each frame until it is dropped,
+    /// e.g. 2 if the frames are visited as consecutive pairs
+    /// \param capacity maximum number of frames in the cache, defaults to
+    /// four frames per worker of \c shared_executor
+    /// \pre \p load is callable
+    /// \pre \p uses and \p capacity are positive
+    explicit frame_cache(loader      load,
+                         int         uses     = 2,
+                         std::size_t capacity = 0)
+        : _load{std::move(load)}
+        , _uses{uses}
+        , _capacity{capacity > 0UL ? capacity
+                                   : 4UL * shared_executor().num_workers()} {
+        Expects(static_cast<bool>(_load));
+        Expects(_uses > 0);
+        Expects(_capacity > 0UL);
+    }
+
+    frame_cache(const frame_cache&) = delete;
+    frame_cache(frame_cache&&)      = delete;
+    frame_cache& operator=(const frame_cache&) = delete;
+    frame_cache& operator=(frame_cache&&) = delete;
+    ~frame_cache()                        = default;
+
+    /// \returns the frame \p idx, loaded by this or a concurrent call.
+    /// \throws whatever the loader throws for this frame.
+    [[nodiscard]] handle get(int idx) {
+        std::unique_lock<std::mutex> l{_mutex};
+
+        std::shared_ptr<entry>& slot = _entries[idx];
+        if (!slot) {
+            slot           = std::make_shared<entry>();
+            slot->sequence = _sequence++;
+            std::shared_ptr<entry> e = slot;
+
+            // Loading runs without the lock, other frames are loaded in
+            // parallel.
+            l.unlock();
+            handle             frame;
+            std::exception_ptr error;
+            try {
+                frame = std::make_shared<const Frame>(_load(idx));
+            } catch (...) { error = std::current_exception(); }
+            l.lock();
+
+            e->frame  = std::move(frame);
+            e->error  = std::move(error);
+            e->loaded = true;
+            _loaded.notify_all();
+            return finish_request(idx, e, l);
+        }
+
+        std::shared_ptr<entry> e = slot;
+        _loaded.wait(l, [&e]() { return e->loaded; });
+        return finish_request(idx, e, l);
+    }
+
+    /// \returns the number of frames in the cache.
+    [[nodiscard]] std::size_t size() const {
+        std::lock_guard<std::mutex> l{_mutex};
+        return _entries.size();
+    }
+
+  private:
+    struct entry {
+        handle             frame;
+        std::exception_ptr error;
+        bool               loaded   = false;
+        int                requests = 0;
+        std::uint64_t      sequence = 0;
+    };
+
+    /// Account the request of the loaded entry \p e and drop frames that are
+    /// not required anymore.
+    handle finish_request(int                           idx,
+                          const std::shared_ptr<entry>& e,
+                          std::unique_lock<std::mutex>& /*locked*/) {
+        handle             frame = e->frame;
+        std::exception_ptr error = e->error;
+
+        // The entry might have been dropped and replaced by a new one, that
+        // counts its own requests.
+        const auto it = _entries.find(idx);
+        if (++e->requests >= _uses && it != _entries.end() && it->second == e)
+            _entries.erase(it);
+        shrink();
+
+        if (error)
+            std::rethrow_exception(error);
+        return frame;
+    }
+
+    /// Drop the oldest unused frames until the cache fits its capacity.
+    void shrink() noexcept {
+        while (_entries.size() > _capacity) {
+            auto oldest = _entries.end();
+            for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+                const entry& e = *it->second;
+                // Frames that are loading or in use stay in the cache.
+                const bool unused =
+                    e.loaded && (!e.frame || e.frame.use_count() == 1);
+                if (unused && (oldest == _entries.end() ||
+                               e.sequence < oldest->second->sequence))
+                    oldest = it;
+            }
+            if (oldest == _entries.end())
+                return;
+            _entries.erase(oldest);
+        }
+    }
+
+    loader      _load;
+    int         _uses;
+    std::size_t _capacity;
+
+    mutable std::mutex                    _mutex;
+    std::condition_variable               _loaded;
+    std::map<int, std::shared_ptr<entry>> _entries;
+    std::uint64_t                         _sequence = 0;
+};
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: FRAME_CACHE_H_Q4DN8ZRC */
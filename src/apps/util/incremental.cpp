@@ -0,0 +1,74 @@
+#include "incremental.h"
+
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <rang.hpp>
+#include <sens_loc/util/console.h>
+#include <sstream>
+#include <string_view>
+
+namespace sens_loc::apps {
+
+std::string result_configuration(const CLI::App& app) {
+    // Long names of the options that do not change the results.
+    constexpr std::array<std::string_view, 12> run_options = {
+        "version",              "threads",
+        "cpu-affinity",         "trace",
+        "start",                "end",
+        "shard",                "pipeline",
+        "thread-policy",        "incremental",
+        "manifest",             "intra-image-parallel"};
+
+    std::istringstream all{app.config_to_str(/*default_also=*/true)};
+    std::string        result;
+    std::string        line;
+    while (std::getline(all, line)) {
+        const std::string_view name =
+            std::string_view{line}.substr(0, line.find('='));
+        if (std::find(run_options.begin(), run_options.end(), name) ==
+            run_options.end())
+            result += line + '\n';
+    }
+    return result;
+}
+
+std::unique_ptr<io::batch_manifest>
+open_manifest(const std::string&       path,
+              const CLI::App&          app,
+              std::vector<std::string> dependencies) {
+    auto m = io::batch_manifest::open(path, result_configuration(app),
+                                      std::move(dependencies));
+    if (!m) {
+        auto s = synced();
+        std::cerr << util::err{} << "Could not write the manifest \""
+                  << rang::style::bold << path << rang::style::reset
+                  << "\"!\n";
+    }
+    return m;
+}
+
+std::vector<int>
+pending_indices(std::vector<int>                        indices,
+                const io::batch_manifest*               manifest,
+                const std::function<std::string(int)>& input_file) {
+    if (manifest == nullptr)
+        return indices;
+
+    const std::size_t total = indices.size();
+    indices.erase(std::remove_if(indices.begin(), indices.end(),
+                                 [&](int idx) {
+                                     return manifest->up_to_date(
+                                         idx, input_file(idx));
+                                 }),
+                  indices.end());
+
+    auto s = synced();
+    std::cerr << util::info{} << "Skipping " << rang::style::bold
+              << total - indices.size() << rang::style::reset << " of "
+              << total << " indices with up to date outputs.\n";
+    return indices;
+}
+
+}  // namespace sens_loc::apps
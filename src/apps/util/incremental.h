@@ -0,0 +1,44 @@
+#ifndef INCREMENTAL_H_P5KVB2RN
+#define INCREMENTAL_H_P5KVB2RN
+
+#include <functional>
+#include <memory>
+#include <sens_loc/io/manifest.h>
+#include <string>
+#include <vector>
+
+namespace CLI {
+class App;
+}  // namespace CLI
+
+namespace sens_loc::apps {
+
+/// \returns the options of \p app that determine the results of a tool,
+/// one 'option=value' per line.
+/// Options that only change how a batch runs, e.g. the index range or the
+/// number of threads, are left out. The manifest of an incremental batch
+/// stays valid if only these options change.
+std::string result_configuration(const CLI::App& app);
+
+/// Open the manifest \p path of the incremental batch of \p app and print
+/// an error if that fails.
+/// \param dependencies files that all outputs depend on, e.g. the
+/// calibration file
+/// \sa io::batch_manifest
+std::unique_ptr<io::batch_manifest>
+open_manifest(const std::string&       path,
+              const CLI::App&          app,
+              std::vector<std::string> dependencies = {});
+
+/// \returns the indices in \p indices whose outputs are not up to date
+/// according to \p manifest and prints the number of skipped indices.
+/// All indices are returned if \p manifest is \c nullptr.
+/// \param input_file input file of an index
+std::vector<int>
+pending_indices(std::vector<int>                        indices,
+                const io::batch_manifest*               manifest,
+                const std::function<std::string(int)>& input_file);
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: INCREMENTAL_H_P5KVB2RN */
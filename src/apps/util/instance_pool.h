@@ -0,0 +1,97 @@
+#ifndef INSTANCE_POOL_H_R7VJ2MXK
+#define INSTANCE_POOL_H_R7VJ2MXK
+
+#include <functional>
+#include <gsl/gsl>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace sens_loc::apps {
+
+/// Thread-safe pool of instances of an object that must not be used by
+/// multiple threads at the same time, e.g. a \c cv::Feature2D.
+///
+/// Each worker leases an instance for the processing of one index and returns
+/// it afterwards. New instances are created with the factory only if all
+/// existing instances are leased, so the pool grows to one instance per
+/// concurrent worker. Each instance is reused for many indices and keeps its
+/// internal buffers. The mutex is only locked to lease and return instances,
+/// the instances themselves are used without synchronization.
+template <typename T>
+class instance_pool {
+  public:
+    /// Callable that creates a new, configured instance.
+    using factory = std::function<T()>;
+
+    /// Exclusive access to one instance of the pool. The instance is returned
+    /// to the pool on destruction.
+    class lease {
+      public:
+        lease(const lease&) = delete;
+        lease(lease&&)      = delete;
+        lease& operator=(const lease&) = delete;
+        lease& operator=(lease&&) = delete;
+        ~lease() { _pool.release(std::move(_instance)); }
+
+        T&       operator*() noexcept { return _instance; }
+        T*       operator->() noexcept { return &_instance; }
+        const T& operator*() const noexcept { return _instance; }
+        const T* operator->() const noexcept { return &_instance; }
+
+      private:
+        friend class instance_pool;
+        lease(instance_pool& pool, T instance) noexcept
+            : _pool{pool}
+            , _instance{std::move(instance)} {}
+
+        instance_pool& _pool;
+        T              _instance;
+    };
+
+    /// \pre \p create is callable
+    explicit instance_pool(factory create) noexcept
+        : _create{std::move(create)} {
+        Expects(static_cast<bool>(_create));
+    }
+
+    instance_pool(const instance_pool&) = delete;
+    instance_pool(instance_pool&&)      = delete;
+    instance_pool& operator=(const instance_pool&) = delete;
+    instance_pool& operator=(instance_pool&&) = delete;
+    ~instance_pool()                          = default;
+
+    /// \returns an instance that no other thread uses until the lease is
+    /// destroyed. Creates a new instance if all instances are leased.
+    /// \throws whatever the factory throws.
+    [[nodiscard]] lease acquire() {
+        {
+            std::lock_guard<std::mutex> l{_mutex};
+            if (!_free.empty()) {
+                T instance = std::move(_free.back());
+                _free.pop_back();
+                return lease{*this, std::move(instance)};
+            }
+        }
+        // The factory might be expensive and runs without the lock.
+        return lease{*this, _create()};
+    }
+
+  private:
+    void release(T instance) noexcept {
+        try {
+            std::lock_guard<std::mutex> l{_mutex};
+            _free.push_back(std::move(instance));
+        } catch (...) {
+            // The instance is dropped and recreated once it is needed.
+        }
+    }
+
+    factory        _create;
+    std::mutex     _mutex;
+    std::vector<T> _free;
+};
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: INSTANCE_POOL_H_R7VJ2MXK */
@@ -1,55 +1,154 @@
 #ifndef PARALLEL_PROCESSING_H_2FVRLMCH
 #define PARALLEL_PROCESSING_H_2FVRLMCH
 
+#include "bounded_queue.h"
+#include "executor.h"
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <gsl/gsl>
 #include <iomanip>
 #include <ios>
 #include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
 #include <sens_loc/util/console.h>
 #include <sens_loc/util/progress_bar_observer.h>
+#include <sens_loc/util/trace.h>
 #include <taskflow/taskflow.hpp>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 namespace sens_loc::apps {
 
-/// Helper function that processes a range of files based on index.
+/// Scheduling of the work for each index in a batch.
+enum class batch_mode {
+    per_index,  ///< One task per index that reads, processes and writes.
+    pipelined,  ///< Separate decode, compute and encode stages that overlap.
+};
+
+/// Parallelization of the conversion of a single image.
+enum class intra_image {
+    automatic,  ///< Split the rows of each image if the batch has fewer
+                ///< indices than worker threads.
+    enabled,    ///< Always split the rows of each image.
+    disabled,   ///< Each image is converted by a single thread.
+};
+
+/// \returns \c true if the images of a batch with \p indices indices
+/// are converted with row-parallelism.
+/// Large batches keep all cores busy with one image per thread, which avoids
+/// the synchronization of the rows. Batches with fewer images than worker
+/// threads would leave cores idle.
+inline bool use_intra_image(intra_image mode, int indices) noexcept {
+    switch (mode) {
+    case intra_image::enabled: return true;
+    case intra_image::disabled: return false;
+    case intra_image::automatic: return indices < worker_count();
+    }
+    return false;
+}
+
+/// Configuration of the pipelined batch processing.
+/// \sa pipelined_indexed_file_processing
+struct pipeline_config {
+    /// Number of threads for the decode and encode stage each. Decoding and
+    /// encoding the images keeps the cores busy as well. Without an explicit
+    /// \c compute_threads this is the upper limit and fewer threads are used
+    /// if the worker threads do not suffice.
+    int io_threads = 2;
+    /// Number of threads for the compute stage, 0 for the worker threads
+    /// that are left by the other stages, but at least one.
+    /// \sa batch_worker_count
+    int compute_threads = 0;
+    /// Number of indices that are in flight at the same time, 0 for twice
+    /// the number of all threads. Each index in flight needs its own frame.
+    int frames = 0;
+};
+
+/// Print the error message for an index that could not be processed.
+inline void report_index_failure(int idx) {
+    auto s = synced();
+    std::cerr << util::err{};
+    std::cerr << "Could not process index \"" << rang::style::bold << idx
+              << "\"" << rang::style::reset << "!" << std::endl;
+}
+
+/// Print the summary of a batch with \p total indices.
+template <typename Duration>
+void report_batch_summary(int total, int fails, Duration duration) {
+    const auto dur_deci_seconds =
+        std::chrono::duration_cast<std::chrono::duration<long, std::centi>>(
+            duration);
+    std::cout << std::endl;
+
+    {
+        auto s = synced();
+        std::cerr << util::info{};
+        std::cerr << "Processing " << rang::style::bold << total - fails
+                  << rang::style::reset << " images took " << rang::style::bold
+                  << std::fixed << std::setprecision(2)
+                  << (dur_deci_seconds.count() / 100.) << rang::style::reset
+                  << " seconds!\n";
+    }
+
+    if (fails > 0) {
+        auto s = synced();
+        std::cerr << util::warn{} << "Encountered " << rang::style::bold
+                  << fails << rang::style::reset << " problematic files!\n";
+    }
+}
+
+/// \returns the indices of the inclusive range \p start, \p end in ascending
+/// order. The bounds may be given in any order.
+inline std::vector<int> index_range(int start, int end) {
+    if (start > end)
+        std::swap(start, end);
+    std::vector<int> indices(gsl::narrow_cast<std::size_t>(end - start + 1));
+    std::iota(indices.begin(), indices.end(), start);
+    return indices;
+}
+
+/// Helper function that processes a list of files based on index.
 /// The boolean function \c f is applied to each function. Error handling
 /// and reporting is done if \c f returns \c false.
+/// The indices are processed by the workers of \c shared_executor.
 ///
 /// \tparam BoolFunction Apply this functor for each index.
-/// \param start,end inclusive range of integers for the files
+/// \param indices indices of the files, e.g. \c index_range
 /// \param f functor that is applied for each index
+/// \pre \p indices is not empty
 template <typename BoolFunction>
-bool parallel_indexed_file_processing(int          start,
-                                      int          end,
-                                      BoolFunction f) noexcept {
+bool parallel_indexed_file_processing(const std::vector<int>& indices,
+                                      BoolFunction            f) noexcept {
     static_assert(std::is_nothrow_invocable_r_v<bool, BoolFunction, int>,
                   "Functor needs to be noexcept callable and return bool!");
+    Expects(!indices.empty());
 
     try {
-        if (start > end)
-            std::swap(start, end);
-
-        int total_tasks = end - start + 1;
+        const int total_tasks = gsl::narrow<int>(indices.size());
 
-        tf::Executor executor;
+        tf::Executor& executor = shared_executor();
         executor.make_observer<util::progress_bar_observer>(total_tasks);
+        auto remove_progress =
+            gsl::finally([&executor]() { executor.remove_observer(); });
         tf::Taskflow tf;
 
         bool batch_success = true;
         int  fails         = 0;
 
         tf.parallel_for(
-            start, end + 1, 1, [&batch_success, &fails, &f](int idx) {
+            indices.begin(), indices.end(),
+            [&batch_success, &fails, &f](int idx) {
+                SENS_LOC_TRACE_SCOPE("index");
                 const bool success = f(idx);
                 if (!success) {
+                    report_index_failure(idx);
                     auto s = synced();
                     fails++;
-                    std::cerr << util::err{};
-                    std::cerr << "Could not process index \""
-                              << rang::style::bold << idx << "\""
-                              << rang::style::reset << "!" << std::endl;
                     batch_success = false;
                 }
             });
@@ -57,32 +156,192 @@ bool parallel_indexed_file_processing(int          start,
         const auto before = std::chrono::steady_clock::now();
         executor.run(tf).wait();
         const auto after = std::chrono::steady_clock::now();
-        const auto dur_deci_seconds =
-            std::chrono::duration_cast<std::chrono::duration<long, std::centi>>(
-                after - before);
-        std::cout << std::endl;
 
         Ensures(fails >= 0);
+        report_batch_summary(total_tasks, fails, after - before);
 
-        using namespace std::chrono;
-        {
-            auto s = synced();
-            std::cerr << util::info{};
-            std::cerr << "Processing " << rang::style::bold
-                      << std::abs(end - start) + 1 - fails << rang::style::reset
-                      << " images took " << rang::style::bold << std::fixed
-                      << std::setprecision(2)
-                      << (dur_deci_seconds.count() / 100.) << rang::style::reset
-                      << " seconds!\n";
+        return batch_success;
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in batch processing!\n";
+        return false;
+    }
+}
+
+/// Process the inclusive range \p start, \p end of indices.
+/// \sa parallel_indexed_file_processing
+template <typename BoolFunction>
+bool parallel_indexed_file_processing(int          start,
+                                      int          end,
+                                      BoolFunction f) noexcept {
+    try {
+        return parallel_indexed_file_processing(index_range(start, end),
+                                                std::move(f));
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in batch processing!\n";
+        return false;
+    }
+}
+
+/// Process a list of files in a pipeline of three stages.
+///
+/// The work for each index is split into a \p decode stage that reads the
+/// input files, a \p compute stage and an \p encode stage that writes the
+/// results. Each stage runs on its own threads and the stages are connected
+/// with bounded queues. The file-io for the next indices overlaps with the
+/// computation of the current ones and waiting for the disk does not leave
+/// the cores idle.
+///
+/// The state of an index is kept in a \p Frame. A fixed number of frames
+/// circulates through the pipeline and a frame is reused for a later index
+/// once its results are written. This limits the memory usage and allows the
+/// stages to reuse the buffers within the frame.
+///
+/// Each stage is a functor \c bool(int idx, Frame& frame) that returns
+/// \c false on failure. The later stages are skipped for failed indices.
+/// Error handling and reporting is the same as in
+/// \c parallel_indexed_file_processing.
+///
+/// \tparam Frame default constructible state of one index in flight
+/// \param indices indices of the files, e.g. \c index_range
+/// \param decode,compute,encode functors for the stages
+/// \param config number of threads and frames
+/// \pre \p indices is not empty
+/// \sa parallel_indexed_file_processing
+template <typename Frame, typename Decode, typename Compute, typename Encode>
+bool pipelined_indexed_file_processing(const std::vector<int>& indices,
+                                       Decode                  decode,
+                                       Compute                 compute,
+                                       Encode                  encode,
+                                       pipeline_config config = {}) noexcept {
+    static_assert(std::is_nothrow_invocable_r_v<bool, Decode, int, Frame&>,
+                  "Decode needs to be noexcept callable and return bool!");
+    static_assert(std::is_nothrow_invocable_r_v<bool, Compute, int, Frame&>,
+                  "Compute needs to be noexcept callable and return bool!");
+    static_assert(std::is_nothrow_invocable_r_v<bool, Encode, int, Frame&>,
+                  "Encode needs to be noexcept callable and return bool!");
+    Expects(!indices.empty());
+    Expects(config.io_threads > 0);
+    Expects(config.compute_threads >= 0);
+    Expects(config.frames >= 0);
+
+    try {
+        const int total_tasks = gsl::narrow<int>(indices.size());
+
+        // All stages together stay within the worker threads, just like the
+        // processing with one task per index.
+        int io_threads      = config.io_threads;
+        int compute_threads = config.compute_threads;
+        if (compute_threads == 0) {
+            const int budget = batch_worker_count();
+            io_threads = std::clamp((budget - 1) / 2, 1, config.io_threads);
+            compute_threads = std::max(1, budget - 2 * io_threads);
         }
 
-        if (fails > 0) {
-            auto s = synced();
-            std::cerr << util::warn{} << "Encountered " << rang::style::bold
-                      << fails << rang::style::reset << " problematic files!\n";
+        int frame_count = config.frames;
+        if (frame_count == 0)
+            frame_count = 2 * (2 * io_threads + compute_threads);
+
+        /// An index on its way through the pipeline.
+        struct item {
+            int                                   idx;
+            Frame*                                frame;
+            bool                                  success;
+            std::chrono::steady_clock::time_point begin;
+        };
+        std::vector<Frame> frames(gsl::narrow_cast<std::size_t>(frame_count));
+
+        // There are never more items in flight than frames, so that the
+        // queues between the stages can not overflow.
+        const std::size_t     capacity = frames.size();
+        bounded_queue<Frame*> free_frames{capacity};
+        bounded_queue<item>   decoded{capacity};
+        bounded_queue<item>   computed{capacity};
+        for (Frame& f : frames)
+            free_frames.push(&f);
+
+        util::progress_bar_observer progress{total_tasks};
+        std::atomic<std::size_t>    next_position{0};
+        std::atomic<int>            fails{0};
+        std::atomic<int>            decoders{io_threads};
+        std::atomic<int>            computers{compute_threads};
+
+        // The last thread of a stage closes the queue to the next stage.
+        auto decode_stage = [&]() {
+            for (std::size_t p = next_position++; p < indices.size();
+                 p = next_position++) {
+                const int  idx   = indices[p];
+                Frame*     f     = *free_frames.pop();
+                const auto begin = std::chrono::steady_clock::now();
+                decoded.push({idx, f, decode(idx, *f), begin});
+            }
+            if (--decoders == 0)
+                decoded.close();
+        };
+        auto compute_stage = [&]() {
+            while (std::optional<item> i = decoded.pop()) {
+                if (i->success)
+                    i->success = compute(i->idx, *i->frame);
+                computed.push(*i);
+            }
+            if (--computers == 0)
+                computed.close();
+        };
+        auto encode_stage = [&]() {
+            while (std::optional<item> i = computed.pop()) {
+                if (i->success)
+                    i->success = encode(i->idx, *i->frame);
+                free_frames.push(i->frame);
+
+                if (!i->success) {
+                    report_index_failure(i->idx);
+                    fails++;
+                }
+                // The latency includes the time in the queues.
+                progress.finish_task(std::chrono::steady_clock::now() -
+                                     i->begin);
+            }
+        };
+
+        const auto before = std::chrono::steady_clock::now();
+        {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < io_threads; ++i) {
+                threads.emplace_back(decode_stage);
+                threads.emplace_back(encode_stage);
+            }
+            for (int i = 0; i < compute_threads; ++i)
+                threads.emplace_back(compute_stage);
+            for (std::thread& t : threads)
+                t.join();
         }
+        const auto after = std::chrono::steady_clock::now();
 
-        return batch_success;
+        Ensures(fails >= 0);
+        report_batch_summary(total_tasks, fails, after - before);
+
+        return fails == 0;
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in batch processing!\n";
+        return false;
+    }
+}
+
+/// Process the inclusive range \p start, \p end of indices in a pipeline.
+/// \sa pipelined_indexed_file_processing
+template <typename Frame, typename Decode, typename Compute, typename Encode>
+bool pipelined_indexed_file_processing(int             start,
+                                       int             end,
+                                       Decode          decode,
+                                       Compute         compute,
+                                       Encode          encode,
+                                       pipeline_config config = {}) noexcept {
+    try {
+        return pipelined_indexed_file_processing<Frame>(
+            index_range(start, end), std::move(decode), std::move(compute),
+            std::move(encode), config);
     } catch (...) {
         auto s = synced();
         std::cerr << util::err{} << "System error in batch processing!\n";
@@ -90,6 +349,155 @@ bool parallel_indexed_file_processing(int          start,
     }
 }
 
+/// Result of reading the next element of a stream.
+enum class stream_read {
+    frame,  ///< The next frame was read.
+    end,    ///< The stream ended regularly.
+    error,  ///< The stream is broken, no more frames can be read.
+};
+
+/// Process an unbounded stream of frames and write the results in the order
+/// of the input.
+///
+/// A single thread reads the frames with \p read, the \p compute stage runs
+/// on \c config.compute_threads threads and a single thread writes the
+/// results with \p write. The frames are numbered in the order they are read.
+/// Frames that are computed early wait in a reorder buffer until all prior
+/// frames are written. As in \c pipelined_indexed_file_processing a fixed
+/// number of frames circulates, so a slow consumer slows down the reading.
+///
+/// - \p read is a functor \c stream_read(Frame&)
+/// - \p compute is a functor \c bool(int seq, Frame&)
+/// - \p write is a functor \c bool(int seq, Frame&) and is skipped for frames
+///   that failed in \p compute
+///
+/// Once \p write fails the remaining frames are discarded, the consumer is
+/// gone. Nothing is printed to \c stdout, which might be the output stream.
+///
+/// \tparam Frame default constructible state of one frame in flight
+/// \returns \c true if the stream ended regularly and all frames were
+/// processed successfully.
+template <typename Frame, typename Read, typename Compute, typename Write>
+bool ordered_stream_processing(Read            read,
+                               Compute         compute,
+                               Write           write,
+                               pipeline_config config = {}) noexcept {
+    static_assert(std::is_nothrow_invocable_r_v<stream_read, Read, Frame&>,
+                  "Read needs to be noexcept callable and return stream_read!");
+    static_assert(std::is_nothrow_invocable_r_v<bool, Compute, int, Frame&>,
+                  "Compute needs to be noexcept callable and return bool!");
+    static_assert(std::is_nothrow_invocable_r_v<bool, Write, int, Frame&>,
+                  "Write needs to be noexcept callable and return bool!");
+    Expects(config.compute_threads >= 0);
+    Expects(config.frames >= 0);
+
+    try {
+        // The reading and writing thread count to the worker threads.
+        int compute_threads = config.compute_threads;
+        if (compute_threads == 0)
+            compute_threads = std::max(1, batch_worker_count() - 2);
+
+        int frame_count = config.frames;
+        if (frame_count == 0)
+            frame_count = 2 * (compute_threads + 2);
+
+        /// A frame on its way through the pipeline.
+        struct item {
+            int    seq;
+            Frame* frame;
+            bool   success;
+        };
+        std::vector<Frame> frames(gsl::narrow_cast<std::size_t>(frame_count));
+
+        const std::size_t     capacity = frames.size();
+        bounded_queue<Frame*> free_frames{capacity};
+        bounded_queue<item>   decoded{capacity};
+        bounded_queue<item>   computed{capacity};
+        for (Frame& f : frames)
+            free_frames.push(&f);
+
+        std::atomic<int>  fails{0};
+        std::atomic<int>  computers{compute_threads};
+        std::atomic<bool> consumer_gone{false};
+        bool              stream_ok = true;
+        int               processed = 0;
+
+        auto read_stage = [&]() {
+            for (int seq = 0; !consumer_gone; ++seq) {
+                Frame*            f      = *free_frames.pop();
+                const stream_read result = read(*f);
+                if (result != stream_read::frame) {
+                    stream_ok = result == stream_read::end;
+                    break;
+                }
+                decoded.push({seq, f, true});
+            }
+            decoded.close();
+        };
+        auto compute_stage = [&]() {
+            while (std::optional<item> i = decoded.pop()) {
+                i->success = compute(i->seq, *i->frame);
+                computed.push(*i);
+            }
+            if (--computers == 0)
+                computed.close();
+        };
+        auto write_stage = [&]() {
+            // Frames that overtook an earlier frame, by sequence number.
+            std::map<int, item> reorder;
+            int                 next = 0;
+            while (std::optional<item> i = computed.pop()) {
+                reorder.emplace(i->seq, *i);
+                for (auto it = reorder.find(next); it != reorder.end();
+                     it      = reorder.find(++next)) {
+                    item& e = it->second;
+                    if (!e.success) {
+                        report_index_failure(e.seq);
+                        fails++;
+                    } else if (!consumer_gone && !write(e.seq, *e.frame)) {
+                        consumer_gone = true;
+                        fails++;
+                    }
+                    processed++;
+                    free_frames.push(e.frame);
+                    reorder.erase(it);
+                }
+            }
+            Ensures(reorder.empty());
+        };
+
+        const auto before = std::chrono::steady_clock::now();
+        {
+            std::vector<std::thread> threads;
+            threads.emplace_back(read_stage);
+            threads.emplace_back(write_stage);
+            for (int i = 0; i < compute_threads; ++i)
+                threads.emplace_back(compute_stage);
+            for (std::thread& t : threads)
+                t.join();
+        }
+        const auto after = std::chrono::steady_clock::now();
+
+        auto s = synced();
+        if (!stream_ok)
+            std::cerr << util::err{} << "The input stream is broken!\n";
+        if (consumer_gone)
+            std::cerr << util::err{} << "Could not write the output stream!\n";
+        std::cerr << util::info{} << "Processing " << rang::style::bold
+                  << processed - fails << rang::style::reset
+                  << " frames of the stream took " << rang::style::bold
+                  << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double>(after - before).count()
+                  << rang::style::reset << " seconds!\n";
+
+        return stream_ok && fails == 0;
+    } catch (...) {
+        auto s = synced();
+        std::cerr << util::err{} << "System error in stream processing!\n";
+        return false;
+    }
+}
+
 }  // namespace sens_loc::apps
 
 #endif /* end of include guard: PARALLEL_PROCESSING_H_2FVRLMCH */
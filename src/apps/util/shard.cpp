@@ -0,0 +1,83 @@
+#include "shard.h"
+
+#include <CLI/CLI.hpp>
+#include <charconv>
+#include <cstdint>
+#include <gsl/gsl>
+#include <iostream>
+#include <rang.hpp>
+#include <sens_loc/util/console.h>
+
+namespace sens_loc::apps {
+
+std::optional<std::pair<int, int>> shard::range(int start, int end) const
+    noexcept {
+    Expects(start <= end);
+    Expects(0 <= index && index < count);
+
+    // 64-bit arithmetic, because 'length * index' overflows for long
+    // batches.
+    const std::int64_t length = std::int64_t{end} - start + 1;
+    const std::int64_t first  = start + length * index / count;
+    const std::int64_t last   = start + length * (index + 1) / count - 1;
+
+    if (first > last)
+        return std::nullopt;
+    return std::pair{gsl::narrow_cast<int>(first),
+                     gsl::narrow_cast<int>(last)};
+}
+
+std::optional<shard> parse_shard(std::string_view s) noexcept {
+    const auto parse_int = [](std::string_view n) -> std::optional<int> {
+        int value = 0;
+        const auto [ptr, ec] =
+            std::from_chars(n.data(), n.data() + n.size(), value);
+        if (n.empty() || ec != std::errc{} || ptr != n.data() + n.size())
+            return std::nullopt;
+        return value;
+    };
+
+    const std::size_t slash = s.find('/');
+    if (slash == std::string_view::npos)
+        return std::nullopt;
+
+    const auto index = parse_int(s.substr(0, slash));
+    const auto count = parse_int(s.substr(slash + 1));
+    if (!index || !count || *count < 1 || *index < 0 || *index >= *count)
+        return std::nullopt;
+    return shard{*index, *count};
+}
+
+CLI::Option* add_shard_option(CLI::App& app, shard& part) {
+    return app
+        .add_option_function<std::string>(
+            "--shard",
+            [&part](const std::string& s) { part = *parse_shard(s); },
+            "Process only the part 'i/N' of the indices, e.g. '1/4' for the "
+            "second quarter, to distribute the batch over N machines")
+        ->check(CLI::Validator(
+            [](const std::string& s) -> std::string {
+                if (parse_shard(s))
+                    return {};
+                return "Invalid shard \"" + s + "\", expected e.g. \"0/4\"";
+            },
+            "I/N"));
+}
+
+std::optional<std::pair<int, int>>
+select_shard(const shard& part, int start, int end) {
+    if (start > end)
+        std::swap(start, end);
+
+    auto r = part.range(start, end);
+    if (!r) {
+        auto s = synced();
+        std::cerr << util::info{} << "Shard " << rang::style::bold
+                  << part.index << "/" << part.count << rang::style::reset
+                  << " of the indices " << start << " to " << end
+                  << " is empty.\n";
+    }
+    return r;
+}
+
+}  // namespace sens_loc::apps
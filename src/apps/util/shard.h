@@ -0,0 +1,59 @@
+#ifndef SHARD_H_X4NQ8ZTB
+#define SHARD_H_X4NQ8ZTB
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace CLI {
+class App;
+class Option;
+}  // namespace CLI
+
+namespace sens_loc::apps {
+
+/// Deterministic part of a batch, that allows to distribute one batch over
+/// multiple processes or machines.
+///
+/// The index range of the batch is split into \c count contiguous parts of
+/// the same length (+- 1) and the shard processes the part \c index.
+/// Each shard only depends on the range and the shard itself, so that all
+/// machines agree on the split without communication. Contiguous parts keep
+/// consecutive indices, e.g. the pairs of frames that are matched, on the
+/// same machine.
+struct shard {
+    /// Number of the part of this shard, `0 <= index < count`.
+    int index = 0;
+    /// Total number of parts of the batch.
+    int count = 1;
+
+    /// \returns the inclusive part of the inclusive range \p start, \p end
+    /// that belongs to this shard or \c std::nullopt if the part is empty,
+    /// because there are more shards than indices.
+    /// \pre start <= end
+    [[nodiscard]] std::optional<std::pair<int, int>> range(int start,
+                                                           int end) const
+        noexcept;
+
+    /// \returns \c true if the shard is the whole batch.
+    [[nodiscard]] bool whole() const noexcept { return count == 1; }
+};
+
+/// Parse a shard in the form "i/N", e.g. "0/4" for the first of four shards.
+/// \returns \c std::nullopt if \p s is not a valid shard.
+std::optional<shard> parse_shard(std::string_view s) noexcept;
+
+/// Add the option '--shard' of the batch tools to \p app, that sets
+/// \p part.
+CLI::Option* add_shard_option(CLI::App& app, shard& part);
+
+/// \returns the part of \p part of the inclusive range \p start, \p end,
+/// whose bounds may be given in any order, or \c std::nullopt if the part is
+/// empty. An empty part is reported on \c stderr.
+std::optional<std::pair<int, int>>
+select_shard(const shard& part, int start, int end);
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: SHARD_H_X4NQ8ZTB */
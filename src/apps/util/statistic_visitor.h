@@ -54,8 +54,14 @@ struct statistic_visitor : Analysor {
         , input_pattern{input_pattern} {}
 
     void operator()(int i) noexcept {
+        // Analyses without required data load their files themselves.
+        if constexpr (data_elements == required_data::none) {
+            Analysor::operator()(i, std::nullopt, std::nullopt);
+            return;
+        }
+
         try {
-            const cv::FileStorage fs =
+            const io::feature_file fs =
                 io::open_feature_file(fmt::format(input_pattern, i));
 
             std::optional<std::vector<cv::KeyPoint>> keypoints   = std::nullopt;
@@ -6,6 +6,10 @@
  * tool. Use \c MAIN_HEAD and \c MAIN_TAIL to wrap the main-function with
  * proper exception handling for the whole program and to enfore consistent
  * error messages on system failure.
+ * Each tool provides the options '--threads' and '--cpu-affinity' to control
+ * the worker threads of the batch processing, see \c util/executor.h, and
+ * the option '--trace' to record the processing stages, see
+ * \c util/tracing.h.
  */
 
 #define MAIN_HEAD(TOOL_DESCRIPTION)                                            \
@@ -18,6 +22,20 @@
             gsl::finally([] { cout << rang::style::reset << flush; });         \
         app.add_flag_function("-v,--version", print_version(*argv),            \
                               "Print version and exit");                       \
+        app.add_option_function<int>(                                          \
+            "--threads", set_threads{},                                        \
+            "Number of worker threads, 0 for one per available CPU")           \
+            ->check(CLI::NonNegativeNumber);                                   \
+        app.add_option_function<std::string>(                                  \
+            "--cpu-affinity", set_affinity{},                                  \
+            "Pin all threads to the CPUs of the list, e.g. \"0-7,16\" "        \
+            "to stay on one NUMA node")                                        \
+            ->check(CLI::Validator(check_cpu_list, "CPU-LIST"));               \
+        app.add_option_function<std::string>(                                  \
+            "--trace", set_trace_file{},                                       \
+            "Record the duration of the processing stages in a JSON-file "     \
+            "in the trace event format of Chrome and print a summary");        \
+        auto write_trace = gsl::finally([] { finish_trace(); });               \
         do
 
 
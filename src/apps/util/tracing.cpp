@@ -0,0 +1,46 @@
+#include "tracing.h"
+
+#include <iostream>
+#include <rang.hpp>
+#include <sens_loc/util/console.h>
+#include <sens_loc/util/trace.h>
+
+namespace sens_loc::apps {
+
+namespace {
+std::string trace_file;
+}  // namespace
+
+void set_trace_file::operator()(const std::string& path) const {
+#if !SENS_LOC_TRACING
+    std::cerr << util::warn{}
+              << "This build does not record traces, see 'WITH_TRACING'!\n";
+#endif
+    trace_file = path;
+    util::enable_tracing();
+}
+
+void finish_trace() noexcept {
+    if (trace_file.empty())
+        return;
+
+    try {
+        const std::vector<util::trace_event> events = util::recorded_spans();
+        auto                                 s      = synced();
+        if (!util::write_chrome_trace(trace_file, events)) {
+            std::cerr << util::err{} << "Could not write the trace \""
+                      << rang::style::bold << trace_file << rang::style::reset
+                      << "\"!\n";
+            return;
+        }
+        std::cerr << util::info{} << "Wrote the trace with "
+                  << rang::style::bold << events.size() << rang::style::reset
+                  << " spans to \"" << rang::style::bold << trace_file
+                  << rang::style::reset << "\"\n";
+        util::print_trace_summary(std::cerr, events);
+    } catch (...) {
+        // The trace is only diagnostic output and must not abort the tool.
+    }
+}
+
+}  // namespace sens_loc::apps
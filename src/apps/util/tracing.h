@@ -0,0 +1,22 @@
+#ifndef TRACING_H_C3LQ8MVD
+#define TRACING_H_C3LQ8MVD
+
+#include <string>
+
+namespace sens_loc::apps {
+
+/// Helper functor for the '--trace' option of each program.
+/// Enables the recording of the processing stages.
+/// \sa util::enable_tracing
+struct set_trace_file {
+    void operator()(const std::string& path) const;
+};
+
+/// Write the recorded stages to the file of the '--trace' option and print a
+/// summary of them.
+/// Does nothing if the option was not provided.
+void finish_trace() noexcept;
+
+}  // namespace sens_loc::apps
+
+#endif /* end of include guard: TRACING_H_C3LQ8MVD */
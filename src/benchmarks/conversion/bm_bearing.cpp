@@ -59,3 +59,28 @@ NONIUS_BENCHMARK("Depth2Bearing Laserscan Parallel",
                          flow.clear();
                      });
                  })
+
+NONIUS_BENCHMARK("Depth2Bearing AngleTable Diagonal",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto in = euclid;
+                     const bearing_angles<camera_models::pinhole<float>> angles{
+                         p};
+                     meter.measure([&] {
+                         return depth_to_bearing<direction::diagonal>(
+                             in, angles.diagonal);
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Bearing Laserscan AngleTable",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+                     auto       in          = euclid;
+                     const bearing_angles<camera_models::equirectangular<float>>
+                         angles{p};
+                     meter.measure([&] {
+                         return depth_to_bearing<direction::diagonal>(
+                             in, angles.diagonal);
+                     });
+                 })
@@ -24,6 +24,38 @@ NONIUS_BENCHMARK("Depth2Curvature Mean", [](nonius::chronometer meter) {
     meter.measure([&] { return depth_to_mean_curvature(in, cali); });
 })
 
+NONIUS_BENCHMARK("Depth2Curvature Parallel Gaussian",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto         in   = euclid;
+                     auto         out  = euclid;
+                     auto         cali = p;
+                     tf::Executor exe;
+                     tf::Taskflow flow;
+                     meter.measure([&] {
+                         par_depth_to_gaussian_curvature(in, cali, out, flow);
+                         exe.run(flow).wait();
+                         flow.clear();
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Curvature Parallel Mean",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto         in   = euclid;
+                     auto         out  = euclid;
+                     auto         cali = p;
+                     tf::Executor exe;
+                     tf::Taskflow flow;
+                     meter.measure([&] {
+                         par_depth_to_mean_curvature(in, cali, out, flow);
+                         exe.run(flow).wait();
+                         flow.clear();
+                     });
+                 })
+
 NONIUS_BENCHMARK("Depth2Curvature Laserscan Gaussian", [](nonius::chronometer meter) {
     const auto [euclid, p] = get_data_laserscan();
     auto in   = euclid;
@@ -37,3 +69,60 @@ NONIUS_BENCHMARK("Depth2Curvature Laserscan Mean", [](nonius::chronometer meter)
     auto cali = p;
     meter.measure([&] { return depth_to_mean_curvature(in, cali); });
 })
+
+NONIUS_BENCHMARK("Depth2Curvature Laserscan Parallel Gaussian",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+
+                     auto         in   = euclid;
+                     auto         out  = euclid;
+                     auto         cali = p;
+                     tf::Executor exe;
+                     tf::Taskflow flow;
+
+                     meter.measure([&] {
+                         par_depth_to_gaussian_curvature(in, cali, out, flow);
+                         exe.run(flow).wait();
+                         flow.clear();
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Curvature Laserscan Parallel Mean",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+
+                     auto         in   = euclid;
+                     auto         out  = euclid;
+                     auto         cali = p;
+                     tf::Executor exe;
+                     tf::Taskflow flow;
+
+                     meter.measure([&] {
+                         par_depth_to_mean_curvature(in, cali, out, flow);
+                         exe.run(flow).wait();
+                         flow.clear();
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Curvature AngleTable Gaussian",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto in = euclid;
+                     const curvature_angles<camera_models::pinhole<float>>
+                         angles{p};
+                     meter.measure([&] {
+                         return depth_to_gaussian_curvature(in, angles);
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Curvature Laserscan AngleTable Mean",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+                     auto       in          = euclid;
+                     const curvature_angles<
+                         camera_models::equirectangular<float>>
+                         angles{p};
+                     meter.measure(
+                         [&] { return depth_to_mean_curvature(in, angles); });
+                 })
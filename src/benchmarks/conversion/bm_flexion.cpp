@@ -55,3 +55,64 @@ NONIUS_BENCHMARK("Depth2Flexion Laserscan Parallel",
                          flow.clear();
                      });
                  })
+
+NONIUS_BENCHMARK("Depth2Flexion RayCache", [](nonius::chronometer meter) {
+    const auto [_, euclid, p] = get_data();
+    (void) _;
+    auto in = euclid;
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{p};
+    meter.measure([&] { return depth_to_flexion(in, rays); });
+})
+
+NONIUS_BENCHMARK("Depth2Flexion Laserscan RayCache",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+                     auto       in          = euclid;
+                     const camera_models::ray_cache<
+                         camera_models::equirectangular<float>>
+                         rays{p};
+                     meter.measure([&] { return depth_to_flexion(in, rays); });
+                 })
+
+NONIUS_BENCHMARK("Depth2Flexion RayCache Scalar",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto in  = euclid;
+                     auto out = euclid;
+                     const camera_models::ray_cache<
+                         camera_models::pinhole<float>>
+                         rays{p};
+                     meter.measure([&] {
+                         for (int v = 1; v < in.h() - 1; ++v)
+                             detail::flexion_row(v, in, rays, out,
+                                                 util::simd_level::none);
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Flexion RayCache Convert",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto in = euclid;
+                     const camera_models::ray_cache<
+                         camera_models::pinhole<float>>
+                         rays{p};
+                     meter.measure([&] {
+                         return convert_flexion<ushort>(
+                             depth_to_flexion(in, rays));
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2Flexion RayCache Quantized",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     auto in = euclid;
+                     const camera_models::ray_cache<
+                         camera_models::pinhole<float>>
+                         rays{p};
+                     const auto q = flexion_quantization<ushort, float>();
+                     meter.measure(
+                         [&] { return depth_to_flexion(in, rays, q); });
+                 })
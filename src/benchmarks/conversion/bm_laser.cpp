@@ -29,3 +29,11 @@ NONIUS_BENCHMARK("Depth2Euclidean parallel", [](nonius::chronometer meter) {
         flow.clear();
     });
 })
+
+NONIUS_BENCHMARK("Depth2Euclidean RayCache", [](nonius::chronometer meter) {
+    const auto [depth, _, p] = get_data();
+    (void) _;
+    auto in = depth;
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{p};
+    meter.measure([&] { return depth_to_laserscan(in, rays); });
+})
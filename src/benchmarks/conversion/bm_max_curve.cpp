@@ -0,0 +1,98 @@
+#define NONIUS_RUNNER 1
+#include "util.h"
+
+#include <nonius/nonius_single.h++>
+#include <sens_loc/conversion/depth_to_max_curve.h>
+
+using namespace sens_loc;
+using namespace conversion;
+
+NONIUS_BENCHMARK("Depth2MaxCurve", [](nonius::chronometer meter) {
+    const auto [_, euclid, p] = get_data();
+    (void) _;
+    auto in   = euclid;
+    auto cali = p;
+    meter.measure([&] { return depth_to_max_curve(in, cali); });
+})
+
+NONIUS_BENCHMARK("Depth2MaxCurve Parallel", [](nonius::chronometer meter) {
+    const auto [_, euclid, p] = get_data();
+    (void) _;
+    auto         in   = euclid;
+    auto         out  = euclid;
+    auto         cali = p;
+    tf::Executor exe;
+    tf::Taskflow flow;
+    meter.measure([&] {
+        par_depth_to_max_curve(in, cali, out, flow);
+        exe.run(flow).wait();
+        flow.clear();
+    });
+})
+
+NONIUS_BENCHMARK("Depth2MaxCurve Laserscan", [](nonius::chronometer meter) {
+    const auto [euclid, p] = get_data_laserscan();
+    auto in                = euclid;
+    auto cali              = p;
+    meter.measure([&] { return depth_to_max_curve(in, cali); });
+})
+
+NONIUS_BENCHMARK("Depth2MaxCurve Laserscan Parallel",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+
+                     auto         in   = euclid;
+                     auto         out  = euclid;
+                     auto         cali = p;
+                     tf::Executor exe;
+                     tf::Taskflow flow;
+
+                     meter.measure([&] {
+                         par_depth_to_max_curve(in, cali, out, flow);
+                         exe.run(flow).wait();
+                         flow.clear();
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2MaxCurve Laserscan AngleTable Parallel",
+                 [](nonius::chronometer meter) {
+                     const auto [euclid, p] = get_data_laserscan();
+                     const bearing_angles<camera_models::equirectangular<float>>
+                         angles{p};
+
+                     auto         in  = euclid;
+                     auto         out = euclid;
+                     tf::Executor exe;
+                     tf::Taskflow flow;
+
+                     meter.measure([&] {
+                         par_depth_to_max_curve(in, angles, out, flow);
+                         exe.run(flow).wait();
+                         flow.clear();
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2MaxCurve AngleTable Convert",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     const bearing_angles<camera_models::pinhole<float>> angles{
+                         p};
+                     auto in = euclid;
+                     meter.measure([&] {
+                         return convert_max_curve<ushort>(
+                             depth_to_max_curve(in, angles));
+                     });
+                 })
+
+NONIUS_BENCHMARK("Depth2MaxCurve AngleTable Quantized",
+                 [](nonius::chronometer meter) {
+                     const auto [_, euclid, p] = get_data();
+                     (void) _;
+                     const bearing_angles<camera_models::pinhole<float>> angles{
+                         p};
+                     auto       in = euclid;
+                     const auto q  = max_curve_quantization<ushort, float>();
+                     meter.measure(
+                         [&] { return depth_to_max_curve(in, angles, q); });
+                 })
@@ -0,0 +1,82 @@
+#define NONIUS_RUNNER 1
+#include "util.h"
+
+#include <nonius/nonius_single.h++>
+#include <sens_loc/conversion/depth_to_multi.h>
+
+using namespace sens_loc;
+using namespace conversion;
+
+NONIUS_BENCHMARK("Separate Passes", [](nonius::chronometer meter) {
+    const auto [_, euclid, p] = get_data();
+    (void) _;
+    auto in = euclid;
+    const bearing_angles<camera_models::pinhole<float>>           angles{p};
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{p};
+    meter.measure([&] {
+        auto hor =
+            depth_to_bearing<direction::horizontal>(in, angles.horizontal);
+        auto ver = depth_to_bearing<direction::vertical>(in, angles.vertical);
+        auto dia = depth_to_bearing<direction::diagonal>(in, angles.diagonal);
+        auto ant =
+            depth_to_bearing<direction::antidiagonal>(in, angles.antidiagonal);
+        auto flexion   = depth_to_flexion(in, rays);
+        auto max_curve = depth_to_max_curve(in, angles);
+        return hor.w() + ver.w() + dia.w() + ant.w() + flexion.w() +
+               max_curve.w();
+    });
+})
+
+NONIUS_BENCHMARK("Fused", [](nonius::chronometer meter) {
+    const auto [_, euclid, p] = get_data();
+    (void) _;
+    auto in        = euclid;
+    auto hor       = euclid;
+    auto ver       = euclid;
+    auto dia       = euclid;
+    auto ant       = euclid;
+    auto flexion   = euclid;
+    auto max_curve = euclid;
+    const bearing_angles<camera_models::pinhole<float>>           angles{p};
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{p};
+    const multi_images<float> out{&hor, &ver, &dia, &ant, &flexion, &max_curve};
+    meter.measure([&] { depth_to_multi(in, angles, rays, out); });
+})
+
+NONIUS_BENCHMARK("Fused Parallel", [](nonius::chronometer meter) {
+    const auto [_, euclid, p] = get_data();
+    (void) _;
+    auto in        = euclid;
+    auto hor       = euclid;
+    auto ver       = euclid;
+    auto dia       = euclid;
+    auto ant       = euclid;
+    auto flexion   = euclid;
+    auto max_curve = euclid;
+    const bearing_angles<camera_models::pinhole<float>>           angles{p};
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{p};
+    const multi_images<float> out{&hor, &ver, &dia, &ant, &flexion, &max_curve};
+    tf::Executor              exe;
+    tf::Taskflow              flow;
+    meter.measure([&] {
+        par_depth_to_multi(in, angles, rays, out, flow);
+        exe.run(flow).wait();
+        flow.clear();
+    });
+})
+
+NONIUS_BENCHMARK("Fused Laserscan", [](nonius::chronometer meter) {
+    const auto [euclid, e] = get_data_laserscan();
+    auto in                = euclid;
+    auto hor               = euclid;
+    auto flexion           = euclid;
+    auto max_curve         = euclid;
+    const bearing_angles<camera_models::equirectangular<float>> angles{e};
+    const camera_models::ray_cache<camera_models::equirectangular<float>> rays{
+        e};
+    multi_images<float> out;
+    out.horizontal = &hor;
+    out.flexion    = &flexion;
+    out.max_curve  = &max_curve;
+    meter.measure([&] { depth_to_multi(in, angles, rays, out); });
+})
@@ -0,0 +1,95 @@
+#define NONIUS_RUNNER 1
+#include "../conversion/util.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <nonius/nonius_single.h++>
+#include <opencv2/imgcodecs.hpp>
+#include <sens_loc/io/image.h>
+#include <string>
+#include <vector>
+
+using namespace sens_loc;
+
+namespace {
+/// Accumulates the throughput of the encoders over all samples and prints it
+/// once all benchmarks are done, because nonius only reports the time.
+class throughput_report {
+  public:
+    void add(const std::string&                  codec,
+             std::size_t                         raw_bytes,
+             std::size_t                         encoded_bytes,
+             std::chrono::steady_clock::duration duration) {
+        entry& e = _entries[codec];
+        e.raw_bytes += raw_bytes;
+        e.encoded_bytes = encoded_bytes;
+        e.seconds += std::chrono::duration<double>(duration).count();
+    }
+
+    ~throughput_report() {
+        std::cout << "\nEncoder throughput of the raw 16-bit pixel data:\n";
+        for (const auto& [codec, e] : _entries) {
+            std::cout << std::setw(24) << std::left << codec << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(10)
+                      << (e.raw_bytes / e.seconds / 1e6) << " MB/s"
+                      << std::setw(10) << (e.encoded_bytes / 1e3) << " kB\n";
+        }
+    }
+
+  private:
+    struct entry {
+        std::size_t raw_bytes     = 0;
+        std::size_t encoded_bytes = 0;
+        double      seconds       = 0.;
+    };
+    std::map<std::string, entry> _entries;
+};
+throughput_report report;
+
+void encode(nonius::chronometer meter,
+            const std::string&  extension,
+            int                 compression) {
+    const auto [depth, euclid, p] = get_data();
+    (void) euclid;
+    (void) p;
+    const std::vector<int> params =
+        io::write_parameters(extension, compression);
+    std::vector<uchar> buffer;
+
+    const auto before = std::chrono::steady_clock::now();
+    meter.measure([&] {
+        cv::imencode(extension, depth.data(), buffer, params);
+        return buffer.size();
+    });
+    const auto after = std::chrono::steady_clock::now();
+
+    const std::size_t raw_bytes = depth.data().total() * sizeof(ushort);
+    report.add(extension + " " + std::to_string(compression),
+               raw_bytes * std::size_t(meter.runs()), buffer.size(),
+               after - before);
+}
+}  // namespace
+
+NONIUS_BENCHMARK("PNG default", [](nonius::chronometer meter) {
+    encode(meter, ".png", -1);
+})
+NONIUS_BENCHMARK("PNG level 0", [](nonius::chronometer meter) {
+    encode(meter, ".png", 0);
+})
+NONIUS_BENCHMARK("PNG level 1", [](nonius::chronometer meter) {
+    encode(meter, ".png", 1);
+})
+NONIUS_BENCHMARK("PNG level 9", [](nonius::chronometer meter) {
+    encode(meter, ".png", 9);
+})
+NONIUS_BENCHMARK("TIFF default", [](nonius::chronometer meter) {
+    encode(meter, ".tiff", -1);
+})
+NONIUS_BENCHMARK("TIFF uncompressed", [](nonius::chronometer meter) {
+    encode(meter, ".tiff", 0);
+})
+NONIUS_BENCHMARK("PGM raw", [](nonius::chronometer meter) {
+    encode(meter, ".pgm", 0);
+})
@@ -0,0 +1,119 @@
+#define NONIUS_RUNNER 1
+#include "../conversion/util.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <nonius/nonius_single.h++>
+#include <opencv2/core.hpp>
+#include <sens_loc/preprocess/filter.h>
+#include <sens_loc/util/affinity.h>
+#include <sens_loc/util/thread_budget.h>
+#include <string>
+#include <taskflow/taskflow.hpp>
+#include <vector>
+
+using namespace sens_loc;
+
+namespace {
+/// Number of images in each batch. Small compared to the usual sequences,
+/// the hybrid policy processes it in parallel on up to 16 CPUs.
+constexpr int batch_size = 16;
+
+/// Collects the throughput of each policy and prints it once all benchmarks
+/// are done. A policy that oversubscribes the CPUs shows up with a lower
+/// throughput for the same amount of threads.
+class policy_report {
+  public:
+    void add(const std::string&                  policy,
+             const util::thread_budget&          budget,
+             std::size_t                         images,
+             std::chrono::steady_clock::duration duration) {
+        entry& e  = _entries[policy];
+        e.budget  = budget;
+        e.images += images;
+        e.seconds += std::chrono::duration<double>(duration).count();
+    }
+
+    ~policy_report() {
+        std::cout << "\nBilateral filter throughput with "
+                  << util::available_cpus() << " threads:\n";
+        for (const auto& [policy, e] : _entries) {
+            std::cout << std::setw(24) << std::left << policy << std::right
+                      << std::setw(4) << e.budget.workers << " workers x"
+                      << std::setw(4) << e.budget.opencv_threads
+                      << " OpenCV threads" << std::fixed
+                      << std::setprecision(1) << std::setw(10)
+                      << (e.images / e.seconds) << " images/s\n";
+        }
+    }
+
+  private:
+    struct entry {
+        util::thread_budget budget{1, 1};
+        std::size_t         images  = 0;
+        double              seconds = 0.;
+    };
+    std::map<std::string, entry> _entries;
+};
+policy_report report;
+
+/// Filter a batch of images with the threads split by \p policy, like the
+/// batch processing of 'depth_filter' does.
+/// The oversubscribed variant uses all threads on both levels, which is the
+/// behaviour without any coordination.
+void filter_batch(nonius::chronometer meter,
+                  const std::string&  name,
+                  util::thread_policy policy,
+                  bool                oversubscribe = false) {
+    const auto [depth, euclid, p] = get_data();
+    (void) depth;
+    (void) p;
+
+    const int           threads = util::available_cpus();
+    util::thread_budget budget =
+        util::split_threads(policy, threads, batch_size);
+    if (oversubscribe) {
+        // The tools never run this configuration, because the global thread
+        // pool of OpenCV races with the workers. It is measured only as the
+        // baseline of uncoordinated threading.
+        budget = {threads, threads};
+        cv::setNumThreads(threads);
+    } else
+        util::apply_opencv_threads(budget);
+
+    tf::Executor                    executor(unsigned(budget.workers));
+    std::vector<math::image<float>> results(batch_size);
+
+    const auto before = std::chrono::steady_clock::now();
+    meter.measure([&] {
+        tf::Taskflow flow;
+        flow.parallel_for(0, batch_size, 1, [&](int i) {
+            results[i] = preprocess::bilateral_filter(euclid, 20., 5);
+        });
+        executor.run(flow).wait();
+        return results.front().w();
+    });
+    const auto after = std::chrono::steady_clock::now();
+
+    report.add(name, budget, std::size_t(batch_size) * meter.runs(),
+               after - before);
+    // Restore the default of the tools for the following benchmarks.
+    util::apply_opencv_threads({threads, 1});
+}
+}  // namespace
+
+NONIUS_BENCHMARK("Outer Parallelism", [](nonius::chronometer meter) {
+    filter_batch(meter, "outer", util::thread_policy::outer);
+})
+NONIUS_BENCHMARK("Inner Parallelism", [](nonius::chronometer meter) {
+    filter_batch(meter, "inner", util::thread_policy::inner);
+})
+NONIUS_BENCHMARK("Hybrid Parallelism", [](nonius::chronometer meter) {
+    filter_batch(meter, "hybrid", util::thread_policy::hybrid);
+})
+NONIUS_BENCHMARK("Oversubscribed", [](nonius::chronometer meter) {
+    filter_batch(meter, "oversubscribed", util::thread_policy::outer,
+                 /*oversubscribe=*/true);
+})
@@ -128,6 +128,22 @@ class recognition_statistic {
     /// Track true/false negative/positive for each image.
     void account(const element_categories& classification) noexcept;
 
+    /// Add the tallies of all images of \p other to this statistic, as if
+    /// they were accounted by this statistic.
+    /// This combines the statistics of parts of a dataset, e.g. of
+    /// different processes, into the statistic of the whole dataset.
+    void merge(const recognition_statistic& other) noexcept;
+
+    /// Write the tallies of the images, that restore the statistic with
+    /// \c read_tallies. The derived quantities are not written,
+    /// use \c write for them.
+    /// \sa merge
+    void write_tallies(cv::FileStorage& fs, const std::string& name) const;
+    /// \returns the statistic with the tallies that \c write_tallies wrote
+    /// into \p node.
+    /// \throws std::runtime_error if \p node does not contain the tallies
+    static recognition_statistic read_tallies(const cv::FileNode& node);
+
     /// Number \f$P\f$ of all keypoints that have a corresponding keypoint in
     /// another frame.
     [[nodiscard]] std::int64_t relevant_elements() const noexcept {
@@ -281,6 +297,12 @@ class recognition_statistic {
     }
 
   private:
+    /// Track the number of keypoints of each category of one image.
+    void account_image(std::int64_t true_pos,
+                       std::int64_t false_pos,
+                       std::int64_t true_neg,
+                       std::int64_t false_neg) noexcept;
+
     // Keep track on the true/false positives/negatives per image.
     std::vector<std::int64_t> t_p_per_image;
     std::vector<std::int64_t> f_p_per_image;
@@ -0,0 +1,189 @@
+#ifndef ANGLE_TABLE_H_P4TQ8XWD
+#define ANGLE_TABLE_H_P4TQ8XWD
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <gsl/gsl>
+#include <limits>
+#include <sens_loc/camera_models/equirectangular.h>
+#include <sens_loc/camera_models/utility.h>
+#include <sens_loc/math/coordinate.h>
+#include <type_traits>
+#include <vector>
+
+namespace sens_loc::camera_models {
+
+/// Precomputed angles between the lightrays of each pixel and its neighbour
+/// at a constant offset.
+///
+/// The bearing angle and curvature conversions need the angle \f$\varphi\f$
+/// between the rays of neighbouring pixels and its cosine for every pixel.
+/// These angles only depend on the camera model and are the same for every
+/// frame of a sensor. This class calculates them once with
+/// \c camera_models::phi and provides cheap lookups afterwards.
+///
+/// For the \c equirectangular model the angle only depends on the row of the
+/// pixel, because the increment in \f$\varphi\f$ is constant. The table is
+/// calculated in closed form and stores only one value per row.
+///
+/// \tparam Intrinsic camera model, e.g. \c pinhole<float>
+/// \sa camera_models::phi
+template <typename Intrinsic>
+class angle_table {
+  public:
+    using intrinsic_type = Intrinsic;
+    using real_type      = typename Intrinsic::real_type;
+    static_assert(std::is_floating_point_v<real_type>);
+
+    /// Calculate the angles between each pixel \c p and its neighbour
+    /// \c p + \p offset.
+    /// \pre \p offset is not zero
+    /// \post \c phi(p, p + offset) == \c camera_models::phi(intrinsic, p,
+    /// p + offset) for each pixel with a neighbour in the image, up to
+    /// rounding for the closed form.
+    angle_table(const Intrinsic& intrinsic, math::pixel_coord<int> offset)
+        : _w{intrinsic.w()}
+        , _h{intrinsic.h()}
+        , _offset{offset} {
+        Expects(_w > 0);
+        Expects(_h > 0);
+        Expects(offset.u() != 0 || offset.v() != 0);
+
+        if constexpr (std::is_same_v<Intrinsic, equirectangular<real_type>>)
+            fill_rows(intrinsic);
+        else
+            fill_pixels(intrinsic);
+
+        Ensures(_phi.size() == _cos_phi.size());
+    }
+
+    /// Return the width of the image corresponding to the intrinsic.
+    [[nodiscard]] int w() const noexcept { return _w; }
+    /// Return the height of the image corresponding to the intrinsic.
+    [[nodiscard]] int h() const noexcept { return _h; }
+    /// Return the offset between a pixel and its neighbour.
+    [[nodiscard]] const math::pixel_coord<int>& offset() const noexcept {
+        return _offset;
+    }
+
+    /// Lookup the angle between the lightrays of \p p1 and \p p2.
+    /// \pre \p p2 - \p p1 equals \c offset() or -\c offset()
+    /// \pre \p p1 and \p p2 are within the image dimensions
+    /// \sa camera_models::phi
+    [[nodiscard]] real_type phi(const math::pixel_coord<int>& p1,
+                                const math::pixel_coord<int>& p2) const
+        noexcept {
+        return _phi[index(p1, p2)];
+    }
+
+    /// Lookup the cosine of the angle between the lightrays of \p p1 and
+    /// \p p2.
+    /// \pre \p p2 - \p p1 equals \c offset() or -\c offset()
+    /// \pre \p p1 and \p p2 are within the image dimensions
+    [[nodiscard]] real_type cos_phi(const math::pixel_coord<int>& p1,
+                                    const math::pixel_coord<int>& p2) const
+        noexcept {
+        return _cos_phi[index(p1, p2)];
+    }
+
+  private:
+    /// Closed form for the equirectangular model. Both rays of a pixel pair
+    /// are separated by \f$\Delta\varphi = du \cdot d\varphi\f$ in azimuth,
+    /// which results in
+    /// \f$\cos\gamma = \sin\theta_1 \sin\theta_2 \cos\Delta\varphi +
+    /// \cos\theta_1 \cos\theta_2\f$.
+    void fill_rows(const Intrinsic& intrinsic) {
+        _row_invariant = true;
+        _phi.resize(gsl::narrow_cast<std::size_t>(_h), real_type(0.));
+        _cos_phi.resize(gsl::narrow_cast<std::size_t>(_h), real_type(0.));
+
+        const real_type cos_d_phi = std::cos(_offset.u() * intrinsic.d_phi());
+        const real_type delta =
+            real_type(10.) * std::numeric_limits<real_type>::epsilon();
+
+        for (int v = std::max(0, -_offset.v());
+             v < std::min(_h, _h - _offset.v()); ++v) {
+            const int       v_2 = v + _offset.v();
+            const real_type theta_1 =
+                intrinsic.theta_min() + (v * intrinsic.d_theta());
+            const real_type theta_2 =
+                intrinsic.theta_min() + (v_2 * intrinsic.d_theta());
+            const real_type cos_gamma = std::clamp(
+                std::sin(theta_1) * std::sin(theta_2) * cos_d_phi +
+                    std::cos(theta_1) * std::cos(theta_2),
+                real_type(-1.) + delta, real_type(1.) - delta);
+
+            const real_type angle = std::acos(cos_gamma);
+            const auto      i     = gsl::narrow_cast<std::size_t>(v);
+            _phi[i]               = angle;
+            _cos_phi[i]           = std::cos(angle);
+        }
+    }
+
+    /// General path that evaluates \c camera_models::phi for every pixel.
+    void fill_pixels(const Intrinsic& intrinsic) {
+        const std::size_t size = gsl::narrow_cast<std::size_t>(_w) *
+                                 gsl::narrow_cast<std::size_t>(_h);
+        _phi.resize(size, real_type(0.));
+        _cos_phi.resize(size, real_type(0.));
+
+        for (int v = std::max(0, -_offset.v());
+             v < std::min(_h, _h - _offset.v()); ++v) {
+            for (int u = std::max(0, -_offset.u());
+                 u < std::min(_w, _w - _offset.u()); ++u) {
+                const math::pixel_coord<int> p{u, v};
+                const math::pixel_coord<int> n{u + _offset.u(),
+                                               v + _offset.v()};
+
+                const real_type   angle = camera_models::phi(intrinsic, p, n);
+                const std::size_t i     = index(p);
+                _phi[i]                 = angle;
+                _cos_phi[i]             = std::cos(angle);
+            }
+        }
+    }
+
+    [[nodiscard]] std::size_t index(const math::pixel_coord<int>& p) const
+        noexcept {
+        if (_row_invariant)
+            return gsl::narrow_cast<std::size_t>(p.v());
+        return gsl::narrow_cast<std::size_t>(p.v()) *
+                   gsl::narrow_cast<std::size_t>(_w) +
+               gsl::narrow_cast<std::size_t>(p.u());
+    }
+
+    /// The angle is symmetric, the pair is stored at the pixel the offset
+    /// starts from.
+    [[nodiscard]] std::size_t index(const math::pixel_coord<int>& p1,
+                                    const math::pixel_coord<int>& p2) const
+        noexcept {
+        const bool forward = p2.u() - p1.u() == _offset.u() &&
+                             p2.v() - p1.v() == _offset.v();
+        const math::pixel_coord<int>& p = forward ? p1 : p2;
+
+        Expects(forward || (p1.u() - p2.u() == _offset.u() &&
+                            p1.v() - p2.v() == _offset.v()));
+        Expects(p.u() >= 0);
+        Expects(p.u() + _offset.u() >= 0);
+        Expects(p.u() < _w);
+        Expects(p.u() + _offset.u() < _w);
+        Expects(p.v() >= 0);
+        Expects(p.v() + _offset.v() >= 0);
+        Expects(p.v() < _h);
+        Expects(p.v() + _offset.v() < _h);
+
+        return index(p);
+    }
+
+    int                    _w;
+    int                    _h;
+    math::pixel_coord<int> _offset;
+    bool                   _row_invariant = false;
+    std::vector<real_type> _phi;
+    std::vector<real_type> _cos_phi;
+};
+
+}  // namespace sens_loc::camera_models
+
+#endif /* end of include guard: ANGLE_TABLE_H_P4TQ8XWD */
@@ -57,9 +57,9 @@ class equirectangular {
     equirectangular(int width, int height) noexcept
         : _w(width)
         , _h(height)
-        , d_phi(detail::get_d_phi<Real>(width))
-        , d_theta(math::pi<Real> / Real(height))
-        , theta_min(Real(0.)) {
+        , _d_phi(detail::get_d_phi<Real>(width))
+        , _d_theta(math::pi<Real> / Real(height))
+        , _theta_min(Real(0.)) {
         Expects(width > 0);
         Expects(height > 0);
         ensure_invariant();
@@ -76,9 +76,9 @@ class equirectangular {
                     math::numeric_range<Real> theta_range) noexcept
         : _w(width)
         , _h(height)
-        , d_phi(detail::get_d_phi<Real>(width))
-        , d_theta((theta_range.max - theta_range.min) / Real(height))
-        , theta_min(theta_range.min) {
+        , _d_phi(detail::get_d_phi<Real>(width))
+        , _d_theta((theta_range.max - theta_range.min) / Real(height))
+        , _theta_min(theta_range.min) {
         Expects(width > 0);
         Expects(height > 0);
         Expects(theta_range.min >= 0.);
@@ -96,9 +96,9 @@ class equirectangular {
     equirectangular(int width, int height, Real theta_min, Real d_theta)
         : _w(width)
         , _h(height)
-        , d_phi(detail::get_d_phi<Real>(width))
-        , d_theta(d_theta)
-        , theta_min(theta_min) {
+        , _d_phi(detail::get_d_phi<Real>(width))
+        , _d_theta(d_theta)
+        , _theta_min(theta_min) {
         const Real theta_max = theta_min + height * d_theta;
         if (theta_max > math::pi<Real>)
             throw std::invalid_argument("angle increment too big");
@@ -110,6 +110,13 @@ class equirectangular {
     /// Return the height of the image corresponding to this intrinsic.
     [[nodiscard]] int h() const noexcept { return _h; }
 
+    /// Return the constant angle increment between two columns.
+    [[nodiscard]] Real d_phi() const noexcept { return _d_phi; }
+    /// Return the constant angle increment between two rows.
+    [[nodiscard]] Real d_theta() const noexcept { return _d_theta; }
+    /// Return the \f$\theta\f$-angle of the first row.
+    [[nodiscard]] Real theta_min() const noexcept { return _theta_min; }
+
     /// This methods calculates the inverse projection of the equirectangular
     /// model to get the direction of the lightray for the pixel at \p p.
     ///
@@ -135,21 +142,21 @@ class equirectangular {
 
   private:
     void ensure_invariant() const noexcept {
-        Ensures(d_phi > Real(0.));
-        Ensures(d_theta > Real(0.));
-        Ensures(theta_min >= Real(0.));
+        Ensures(_d_phi > Real(0.));
+        Ensures(_d_theta > Real(0.));
+        Ensures(_theta_min >= Real(0.));
 
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-        Ensures(std::abs(d_phi * _w - Real(2.) * math::pi<Real>) < 0.00001);
+        Ensures(std::abs(_d_phi * _w - Real(2.) * math::pi<Real>) < 0.00001);
         // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-        Ensures(theta_min + _h * d_theta <= math::pi<Real> + 0.00001);
+        Ensures(_theta_min + _h * _d_theta <= math::pi<Real> + 0.00001);
     }
 
-    int  _w        = 0;   ///< width of a laser-scan image
-    int  _h        = 0;   ///< height of a laser-scan image.
-    Real d_phi     = 0.;  ///< Angle increment in u-direction.
-    Real d_theta   = 0.;  ///< Angle increment in v-direction.
-    Real theta_min = 0.;  ///< Smallest angle in v-direction.
+    int  _w         = 0;   ///< width of a laser-scan image
+    int  _h         = 0;   ///< height of a laser-scan image.
+    Real _d_phi     = 0.;  ///< Angle increment in u-direction.
+    Real _d_theta   = 0.;  ///< Angle increment in v-direction.
+    Real _theta_min = 0.;  ///< Smallest angle in v-direction.
 };
 
 template <typename Real>
@@ -163,8 +170,8 @@ equirectangular<Real>::pixel_to_sphere(const math::pixel_coord<_Real>& p) const
     Expects(p.u() >= Real(0.0));
     Expects(p.v() < Real(h()));
 
-    const Real phi   = p.u() * d_phi - math::pi<Real>;
-    const Real theta = theta_min + (p.v() * d_theta);
+    const Real phi   = p.u() * _d_phi - math::pi<Real>;
+    const Real theta = _theta_min + (p.v() * _d_theta);
 
     Ensures(phi >= -math::pi<Real>);
     Ensures(phi <= math::pi<Real>);
@@ -200,8 +207,8 @@ equirectangular<Real>::camera_to_pixel(const math::camera_coord<Real>& p) const
     Ensures(theta >= Real(0.));
     Ensures(theta <= math::pi<Real>);
 
-    const _Real u = gsl::narrow_cast<_Real>((phi + math::pi<Real>) / d_phi);
-    const _Real v = gsl::narrow_cast<_Real>(theta / d_theta);
+    const _Real u = gsl::narrow_cast<_Real>((phi + math::pi<Real>) / _d_phi);
+    const _Real v = gsl::narrow_cast<_Real>(theta / _d_theta);
 
     if (u < _Real(0.0) || u > gsl::narrow_cast<Real>(w()) || v < _Real(0.0) ||
         v > gsl::narrow_cast<Real>(h()))
@@ -4,6 +4,7 @@
 #include <opencv2/core/types.hpp>
 #include <sens_loc/camera_models/concepts.h>
 #include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/camera_models/ray_cache.h>
 #include <sens_loc/math/coordinate.h>
 #include <sens_loc/math/pointcloud.h>
 
@@ -69,6 +70,37 @@ project_to_sphere(const Model<Real>&             intrinsic,
     return sphere_coord;
 }
 
+/// Project \c pixel coordinates to the unit-sphere with precomputed rays.
+///
+/// Coordinates that lie exactly on a pixel use the cached ray. Subpixel
+/// coordinates are backprojected with the camera model of \p rays.
+/// \sa project_to_sphere
+/// \sa ray_cache
+template <template <typename> typename Model = pinhole, typename Real = float>
+math::pointcloud<Real>
+project_to_sphere(const ray_cache<Model<Real>>&  rays,
+                  const math::imagepoints<Real>& pixel) noexcept {
+    static_assert(is_intrinsic_v<Model, Real>);
+    math::pointcloud<Real> sphere_coord;
+    sphere_coord.reserve(pixel.size());
+
+    for (const auto& px : pixel) {
+        const math::pixel_coord<int> discrete(gsl::narrow_cast<int>(px.u()),
+                                              gsl::narrow_cast<int>(px.v()));
+        const bool on_grid = Real(discrete.u()) == px.u() &&
+                             Real(discrete.v()) == px.v();
+        if (on_grid)
+            sphere_coord.emplace_back(Real(1.0) *
+                                      rays.pixel_to_sphere(discrete));
+        else
+            sphere_coord.emplace_back(
+                Real(1.0) * rays.intrinsic().pixel_to_sphere(px));
+    }
+
+    Ensures(sphere_coord.size() == pixel.size());
+    return sphere_coord;
+}
+
 /// Convert keypoints to pixel coordinates.
 template <typename Real = float>
 math::imagepoints<Real>
@@ -0,0 +1,125 @@
+#ifndef RAY_CACHE_H_K3WQZB7N
+#define RAY_CACHE_H_K3WQZB7N
+
+#include <cstddef>
+#include <gsl/gsl>
+#include <sens_loc/math/coordinate.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sens_loc::camera_models {
+
+/// Precomputed grid of the unit rays for every pixel of a camera model.
+///
+/// Backprojecting a pixel to the unit sphere is the same operation for every
+/// frame that was taken with the same sensor. The conversions call
+/// \c pixel_to_sphere multiple times per pixel, which costs a square root
+/// (pinhole) or trigonometric functions (equirectangular) each time.
+/// This class calculates all rays once and provides cheap lookups afterwards.
+///
+/// The cache is immutable after construction and can be shared between
+/// threads and between all conversions of a batch.
+///
+/// \tparam Intrinsic camera model, e.g. \c pinhole<float>
+/// \invariant number of cached rays equals \c w() * \c h()
+/// \sa camera_models::is_intrinsic_v
+template <typename Intrinsic>
+class ray_cache {
+  public:
+    using intrinsic_type = Intrinsic;
+    using real_type      = typename Intrinsic::real_type;
+    static_assert(std::is_floating_point_v<real_type>);
+
+    /// Backproject every pixel of \p intrinsic to the unit sphere.
+    /// \post \c pixel_to_sphere(p) == \c intrinsic.pixel_to_sphere(p) for
+    /// each pixel \c p in the image.
+    explicit ray_cache(Intrinsic intrinsic)
+        : _intrinsic{std::move(intrinsic)} {
+        Expects(_intrinsic.w() > 0);
+        Expects(_intrinsic.h() > 0);
+
+        const std::size_t n = gsl::narrow_cast<std::size_t>(_intrinsic.w()) *
+                              gsl::narrow_cast<std::size_t>(_intrinsic.h());
+        _Xs.reserve(n);
+        _Ys.reserve(n);
+        _Zs.reserve(n);
+        for (int v = 0; v < _intrinsic.h(); ++v) {
+            for (int u = 0; u < _intrinsic.w(); ++u) {
+                const math::sphere_coord<real_type> s =
+                    _intrinsic.pixel_to_sphere({u, v});
+                _Xs.emplace_back(s.Xs());
+                _Ys.emplace_back(s.Ys());
+                _Zs.emplace_back(s.Zs());
+            }
+        }
+
+        Ensures(_Xs.size() == n);
+        Ensures(_Ys.size() == n);
+        Ensures(_Zs.size() == n);
+    }
+
+    /// Return the width of the image corresponding to the intrinsic.
+    [[nodiscard]] int w() const noexcept { return _intrinsic.w(); }
+    /// Return the height of the image corresponding to the intrinsic.
+    [[nodiscard]] int h() const noexcept { return _intrinsic.h(); }
+
+    /// Return the camera model the rays were calculated with.
+    [[nodiscard]] const Intrinsic& intrinsic() const noexcept {
+        return _intrinsic;
+    }
+
+    /// Lookup the precomputed lightray for the pixel \p p.
+    /// \pre \p p is within the image dimensions.
+    /// \post \f$\lVert result \rVert_2 = 1.\f$
+    /// \sa pinhole::pixel_to_sphere
+    /// \sa equirectangular::pixel_to_sphere
+    [[nodiscard]] math::sphere_coord<real_type>
+    pixel_to_sphere(const math::pixel_coord<int>& p) const noexcept {
+        Expects(p.u() >= 0);
+        Expects(p.u() < w());
+        Expects(p.v() >= 0);
+        Expects(p.v() < h());
+
+        const std::size_t i = gsl::narrow_cast<std::size_t>(p.v()) *
+                                  gsl::narrow_cast<std::size_t>(w()) +
+                              gsl::narrow_cast<std::size_t>(p.u());
+        return {_Xs[i], _Ys[i], _Zs[i]};
+    }
+
+    /// Return the \f$X_s\f$-components of all rays in row \p v.
+    /// The components are stored separately to allow vectorized processing
+    /// of consecutive pixels.
+    /// \pre \p v is within the image dimensions.
+    [[nodiscard]] gsl::span<const real_type> row_Xs(int v) const noexcept {
+        return row(_Xs, v);
+    }
+    /// Return the \f$Y_s\f$-components of all rays in row \p v.
+    /// \sa row_Xs
+    [[nodiscard]] gsl::span<const real_type> row_Ys(int v) const noexcept {
+        return row(_Ys, v);
+    }
+    /// Return the \f$Z_s\f$-components of all rays in row \p v.
+    /// \sa row_Xs
+    [[nodiscard]] gsl::span<const real_type> row_Zs(int v) const noexcept {
+        return row(_Zs, v);
+    }
+
+  private:
+    [[nodiscard]] gsl::span<const real_type>
+    row(const std::vector<real_type>& component, int v) const noexcept {
+        Expects(v >= 0);
+        Expects(v < h());
+        return gsl::span<const real_type>{component}.subspan(
+            std::ptrdiff_t(v) * std::ptrdiff_t(w()), w());
+    }
+
+    Intrinsic              _intrinsic;
+    std::vector<real_type> _Xs;  ///< Row-major \f$X_s\f$ of each ray.
+    std::vector<real_type> _Ys;  ///< Row-major \f$Y_s\f$ of each ray.
+    std::vector<real_type> _Zs;  ///< Row-major \f$Z_s\f$ of each ray.
+};
+
+}  // namespace sens_loc::camera_models
+
+#endif /* end of include guard: RAY_CACHE_H_K3WQZB7N */
@@ -30,6 +30,25 @@ math::image<PixelType> depth_scaling(const math::image<PixelType>& depth_image,
     return math::image<PixelType>(std::move(img));
 }
 
+/// Scale \p depth_image and write the result into \p scaled_image, that can
+/// be reused for multiple images.
+/// \sa depth_scaling
+/// \pre \p scaled_image has the same dimension as \p depth_image
+template <typename PixelType = ushort>
+void depth_scaling(const math::image<PixelType>& depth_image,
+                   double                        scale,
+                   double                        offset,
+                   math::image<PixelType>&       scaled_image) noexcept {
+    static_assert(std::is_arithmetic_v<PixelType>);
+    Expects(scaled_image.w() == depth_image.w());
+    Expects(scaled_image.h() == depth_image.h());
+
+    // 'img' shares the memory of 'scaled_image' and is not reallocated.
+    cv::Mat img = scaled_image.data();
+    depth_image.data().convertTo(
+        img, math::detail::get_opencv_type<PixelType>(), scale, offset);
+}
+
 }  // namespace sens_loc::conversion
 
 #endif /* end of include guard: DEPTH_SCALING_H_SHNMYLJV */
@@ -4,12 +4,14 @@
 #include <cmath>
 #include <gsl/gsl>
 #include <limits>
+#include <sens_loc/camera_models/angle_table.h>
 #include <sens_loc/camera_models/concepts.h>
 #include <sens_loc/camera_models/utility.h>
 #include <sens_loc/conversion/util.h>
 #include <sens_loc/math/constants.h>
 #include <sens_loc/math/coordinate.h>
 #include <sens_loc/math/image.h>
+#include <sens_loc/math/padded_image.h>
 #include <sens_loc/math/triangles.h>
 #include <sens_loc/util/correctness_util.h>
 #include <taskflow/taskflow.hpp>
@@ -72,6 +74,102 @@ par_depth_to_bearing(const math::image<Real>& depth_image,
                      math::image<Real>&       ba_image,
                      tf::Taskflow&            flow) noexcept;
 
+/// Convert the image \p depth_image to an bearing angle image with
+/// precomputed angles between the lightrays.
+///
+/// The result is the same as for the conversion with the intrinsic, but the
+/// angles between neighbouring pixels are looked up instead of calculated.
+/// \param depth_image range image that was taken by a sensor with the
+/// calibration the \p angles were created with
+/// \param angles angle table for the neighbourhood of \p Direction
+/// \pre \c angles.offset() matches \p Direction
+/// \sa bearing_angles
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real = float>
+math::image<Real> depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles) noexcept;
+
+/// Parallel version of the bearing angle conversion with precomputed angles.
+/// \sa depth_to_bearing
+/// \sa par_depth_to_bearing
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real = float>
+std::pair<tf::Task, tf::Task> par_depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles,
+    math::image<Real>&                                 ba_image,
+    tf::Taskflow&                                      flow) noexcept;
+
+/// Convert the padded image \p depth_image to an bearing angle image.
+///
+/// The halo of \p depth_image provides the prior pixel for every pixel of
+/// the image. A halo of zeros results in the same image as the conversion of
+/// \c depth_image.interior(), but the kernel iterates over the raw rows
+/// without special cases for the border.
+/// \param depth_image range image with a halo of at least one pixel
+/// \param angles angle table for the neighbourhood of \p Direction
+/// \pre \c depth_image.border() >= 1
+/// \pre \c angles.offset() matches \p Direction
+/// \sa math::padded_image
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real = float>
+math::image<Real> depth_to_bearing(
+    const math::padded_image<Real>&                    depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles) noexcept;
+
+/// Convert the image \p depth_image to a bearing angle image and quantize each
+/// angle to \p PixelType while it is calculated.
+///
+/// No intermediate image of \p Real is created. With
+/// \c bearing_quantization the result is the same as
+/// \c convert_bearing(depth_to_bearing(depth_image, angles)) up to rounding
+/// of the last bit.
+/// \param depth_image,angles same as in \c depth_to_bearing
+/// \param q transformation from angles to pixel values
+/// \sa bearing_quantization
+/// \sa quantized_image
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real,
+          typename PixelType>
+math::image<PixelType> depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&               q) noexcept;
+
+/// Convert the image \p depth_image to a quantized bearing angle image and
+/// write the result into \p ba_image.
+///
+/// Reusing \p ba_image for a sequence of images avoids the allocation of a
+/// new image for each conversion.
+/// \param[in] depth_image,angles,q same as in the allocating overload
+/// \param[out] ba_image resulting image, every pixel is overwritten
+/// \pre \p ba_image has the same dimension as \p depth_image
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real,
+          typename PixelType>
+void depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&               q,
+    math::image<PixelType>&                            ba_image) noexcept;
+
+/// Return the transformation of the bearing angles \f$[0, \pi)\f$ to the
+/// range \f$[PixelType_{min}, PixelType_{max}]\f$.
+/// \sa convert_bearing
+template <typename PixelType = ushort, typename Real = float>
+quantization<PixelType, Real> bearing_quantization() noexcept;
+
 /// Convert a bearing angle image to an image with integer types.
 /// This function scales the bearing angles between
 /// [PixelType::min, PixelType::max] for the angles in range (0, PI).
@@ -177,42 +275,116 @@ struct pixel_range {
     const int y_end;
 };
 
+/// Calculate the bearing angle between the \p central pixel with depth
+/// \p d_i and its \p prior neighbour with depth \p d_j.
+template <typename Real, typename Model>
+inline Real bearing_pixel(const Real                    d_i,
+                          const Real                    d_j,
+                          const Model&                  angles,
+                          const math::pixel_coord<int>& central,
+                          const math::pixel_coord<int>& prior) noexcept {
+    Expects(d_i >= Real(0.));
+    Expects(d_j >= Real(0.));
+
+    // A depth==0 means there is no measurement at this pixel.
+    const Real angle =
+        (d_i == Real(0.) || d_j == Real(0.))
+            ? Real(0.)
+            : math::bearing_angle<Real>(d_i, d_j,
+                                        cos_ray_angle(angles, central, prior));
+
+    Ensures(angle >= Real(0.));
+    Ensures(angle < math::pi<Real>);
+
+    return angle;
+}
+
 template <typename Real,
           typename RangeLimits,
           typename PriorAccess,
-          template <typename>
-          typename Intrinsic>
+          typename Model,
+          typename Output>
 inline void bearing_inner(const RangeLimits&       r,
                           const PriorAccess&       prior_accessor,
                           const int                v,
                           const math::image<Real>& depth_image,
-                          const Intrinsic<Real>&   intrinsic,
-                          math::image<Real>&       ba_image) {
+                          const Model&             angles,
+                          Output&                  ba_image) {
     for (int u = r.x_start; u < r.x_end; ++u) {
         const math::pixel_coord<int> central(u, v);
         const math::pixel_coord<int> prior = prior_accessor(central);
 
-        const auto d_i = depth_image.at(central);
-        const auto d_j = depth_image.at(prior);
-
-        Expects(d_i >= Real(0.));
-        Expects(d_j >= Real(0.));
+        ba_image.at(central) =
+            bearing_pixel(depth_image.at(central), depth_image.at(prior),
+                          angles, central, prior);
+    }
+}
 
-        const Real d_phi = camera_models::phi(intrinsic, central, prior);
+/// Calculate the bearing angles of row \p v with the raw rows of a padded
+/// image. The prior pixel of each pixel is at a constant offset in memory.
+template <direction Direction, typename Real, typename Model>
+inline void bearing_row(const int                       v,
+                        const math::padded_image<Real>& depth_image,
+                        const Model&                    angles,
+                        Real*                           result) noexcept {
+    const int   du    = get_du(Direction);
+    const int   dv    = get_dv(Direction);
+    const Real* d     = depth_image.row(v).data();
+    const Real* prior = d + du + std::ptrdiff_t(dv) * depth_image.stride();
+    const int   w     = depth_image.w();
+
+    for (int u = 0; u < w; ++u) {
+        const Real d_i = d[u];
+        const Real d_j = prior[u];
+        // Pixels in the halo have no depth, their angle is never looked up.
+        result[u] = (d_i == Real(0.) || d_j == Real(0.))
+                        ? Real(0.)
+                        : math::bearing_angle<Real>(
+                              d_i, d_j,
+                              cos_ray_angle(angles, {u, v}, {u + du, v + dv}));
+    }
+}
 
-        // A depth==0 means there is no measurement at this pixel.
-        const Real angle =
-            (d_i == Real(0.) || d_j == Real(0.))
-                ? Real(0.)
-                : math::bearing_angle<Real>(d_i, d_j, std::cos(d_phi));
+/// Return the neighbour offset of \p dir for the angle tables.
+inline math::pixel_coord<int> get_offset(direction dir) {
+    return {get_du(dir), get_dv(dir)};
+}
+}  // namespace detail
 
-        Ensures(angle >= Real(0.));
-        Ensures(angle < math::pi<Real>);
+/// Precomputed angles for the four direct neighbourhood relationships of a
+/// pixel.
+///
+/// These tables are shared by the bearing angle and max-curve conversions and
+/// can be reused for every image of a sensor.
+/// \sa camera_models::angle_table
+template <typename Intrinsic>
+struct bearing_angles {
+    explicit bearing_angles(const Intrinsic& intrinsic)
+        : horizontal{intrinsic, detail::get_offset(direction::horizontal)}
+        , vertical{intrinsic, detail::get_offset(direction::vertical)}
+        , diagonal{intrinsic, detail::get_offset(direction::diagonal)}
+        , antidiagonal{intrinsic, detail::get_offset(direction::antidiagonal)} {
+    }
 
-        ba_image.at(central) = angle;
+    /// Return the table for the neighbourhood of \p Direction.
+    template <direction Direction>
+    [[nodiscard]] const camera_models::angle_table<Intrinsic>& get() const
+        noexcept {
+        if constexpr (Direction == direction::horizontal)
+            return horizontal;
+        else if constexpr (Direction == direction::vertical)
+            return vertical;
+        else if constexpr (Direction == direction::diagonal)
+            return diagonal;
+        else
+            return antidiagonal;
     }
-}
-}  // namespace detail
+
+    camera_models::angle_table<Intrinsic> horizontal;
+    camera_models::angle_table<Intrinsic> vertical;
+    camera_models::angle_table<Intrinsic> diagonal;
+    camera_models::angle_table<Intrinsic> antidiagonal;
+};
 
 template <direction Direction,
           template <typename>
@@ -278,19 +450,169 @@ par_depth_to_bearing(const math::image<Real>& depth_image,
     return sync_points;
 }
 
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real>
+inline math::image<Real> depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    using namespace detail;
+    Expects(depth_image.w() == angles.w());
+    Expects(depth_image.h() == angles.h());
+    Expects(angles.offset().u() == get_du(Direction));
+    Expects(angles.offset().v() == get_dv(Direction));
+
+    const pixel<Real, Direction> prior_accessor;
+    const pixel_range<Direction> r{depth_image.data()};
+
+    cv::Mat ba(depth_image.h(), depth_image.w(),
+               math::detail::get_opencv_type<Real>());
+    ba = Real(0.);
+    math::image<Real> ba_image(std::move(ba));
+
+    for (int v = r.y_start; v < r.y_end; ++v)
+        detail::bearing_inner(r, prior_accessor, v, depth_image, angles,
+                              ba_image);
+
+    Ensures(ba_image.h() == depth_image.h());
+    Ensures(ba_image.w() == depth_image.w());
+
+    return ba_image;
+}
+
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real>
+inline std::pair<tf::Task, tf::Task> par_depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles,
+    math::image<Real>&                                 ba_image,
+    tf::Taskflow&                                      flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    using namespace detail;
+    Expects(depth_image.w() == angles.w());
+    Expects(depth_image.h() == angles.h());
+    Expects(angles.offset().u() == get_du(Direction));
+    Expects(angles.offset().v() == get_dv(Direction));
+    Expects(ba_image.w() == depth_image.w());
+    Expects(ba_image.h() == depth_image.h());
+
+    const pixel<Real, Direction> prior_accessor;
+    const pixel_range<Direction> r{depth_image.data()};
+
+    auto sync_points = flow.parallel_for(
+        r.y_start, r.y_end, 1,
+        [prior_accessor, r, &depth_image, &angles, &ba_image](int v) {
+            detail::bearing_inner(r, prior_accessor, v, depth_image, angles,
+                                  ba_image);
+        });
+
+    return sync_points;
+}
+
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real>
+inline math::image<Real> depth_to_bearing(
+    const math::padded_image<Real>&                    depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    using namespace detail;
+    Expects(depth_image.border() >= 1);
+    Expects(depth_image.w() == angles.w());
+    Expects(depth_image.h() == angles.h());
+    Expects(angles.offset().u() == get_du(Direction));
+    Expects(angles.offset().v() == get_dv(Direction));
+
+    cv::Mat ba(depth_image.h(), depth_image.w(),
+               math::detail::get_opencv_type<Real>());
+
+    math::image<Real> ba_image(std::move(ba));
+    for (int v = 0; v < depth_image.h(); ++v)
+        detail::bearing_row<Direction>(v, depth_image, angles,
+                                       &ba_image.at({0, v}));
+
+    Ensures(ba_image.h() == depth_image.h());
+    Ensures(ba_image.w() == depth_image.w());
+
+    return ba_image;
+}
+
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline math::image<PixelType> depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&               q) noexcept {
+    math::image<PixelType> ba_image =
+        detail::quantized_target<PixelType>(depth_image);
+    depth_to_bearing<Direction>(depth_image, angles, q, ba_image);
+    return ba_image;
+}
+
+template <direction Direction,
+          template <typename>
+          typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline void depth_to_bearing(
+    const math::image<Real>&                           depth_image,
+    const camera_models::angle_table<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&               q,
+    math::image<PixelType>&                            ba_image) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    using namespace detail;
+    Expects(depth_image.w() == angles.w());
+    Expects(depth_image.h() == angles.h());
+    Expects(ba_image.w() == depth_image.w());
+    Expects(ba_image.h() == depth_image.h());
+    Expects(angles.offset().u() == get_du(Direction));
+    Expects(angles.offset().v() == get_dv(Direction));
+
+    const pixel<Real, Direction> prior_accessor;
+    const pixel_range<Direction> r{depth_image.data()};
+
+    quantized_image<PixelType, Real> out(ba_image, q);
+    out.clear();
+
+    for (int v = r.y_start; v < r.y_end; ++v)
+        detail::bearing_inner(r, prior_accessor, v, depth_image, angles, out);
+}
+
+template <typename PixelType, typename Real>
+inline quantization<PixelType, Real> bearing_quantization() noexcept {
+    const auto [scale, offset] = detail::scaling_factor<Real, PixelType>(
+        /*max_angle = */ math::pi<Real>);
+    return {scale, offset};
+}
+
 template <typename Real, typename PixelType>
 inline math::image<PixelType>
 convert_bearing(const math::image<Real>& bearing_image) noexcept {
     static_assert(std::is_floating_point_v<Real>);
     static_assert(std::is_arithmetic_v<PixelType>);
 
-    using detail::scaling_factor;
     cv::Mat img(bearing_image.h(), bearing_image.w(),
                 math::detail::get_opencv_type<PixelType>());
-    auto [scale, offset] =
-        scaling_factor<Real, PixelType>(/*max_angle = */ math::pi<Real>);
+    const auto q = bearing_quantization<PixelType, Real>();
     bearing_image.data().convertTo(
-        img, math::detail::get_opencv_type<PixelType>(), scale, offset);
+        img, math::detail::get_opencv_type<PixelType>(), q.scale, q.offset);
 
     Ensures(img.cols == bearing_image.w());
     Ensures(img.rows == bearing_image.h());
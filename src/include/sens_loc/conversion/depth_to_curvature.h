@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <limits>
 #include <optional>
+#include <sens_loc/camera_models/angle_table.h>
 #include <sens_loc/camera_models/pinhole.h>
 #include <sens_loc/camera_models/utility.h>
 #include <sens_loc/conversion/util.h>
@@ -12,6 +13,7 @@
 #include <sens_loc/math/derivatives.h>
 #include <sens_loc/math/image.h>
 #include <sens_loc/math/scaling.h>
+#include <taskflow/taskflow.hpp>
 
 namespace sens_loc::conversion {
 
@@ -56,6 +58,214 @@ math::image<Real>
 depth_to_mean_curvature(const math::image<Real>& depth_image,
                         const Intrinsic<Real>&   intrinsic) noexcept;
 
+/// This function provides a parallelized version of the gaussian curvature
+/// conversion.
+///
+/// This function creates a taskflow for the row-wise parallel calculation
+/// of the curvature image.
+/// Only differences are documented here.
+/// \param[in] depth_image,intrinsic the same
+/// \param[out] gauss_image result image that will be created with parallel
+/// processing
+/// \param[inout] flow parallel flow type that is used to parallelize the outer
+/// for loop over all rows.
+/// \returns synchronization points before and after the calculation of the
+/// curvature image.
+/// \pre \p gauss_image has the same dimension as \p depth_image
+/// \note the border pixels of \p gauss_image are not written.
+/// \sa depth_to_gaussian_curvature
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task>
+par_depth_to_gaussian_curvature(const math::image<Real>& depth_image,
+                                const Intrinsic<Real>&   intrinsic,
+                                math::image<Real>&       gauss_image,
+                                tf::Taskflow&            flow) noexcept;
+
+/// This function provides a parallelized version of the mean curvature
+/// conversion.
+/// \sa par_depth_to_gaussian_curvature
+/// \sa depth_to_mean_curvature
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task>
+par_depth_to_mean_curvature(const math::image<Real>& depth_image,
+                            const Intrinsic<Real>&   intrinsic,
+                            math::image<Real>&       mean_image,
+                            tf::Taskflow&            flow) noexcept;
+
+/// Precomputed angles between the lightrays of the pixels that span the
+/// finite differences of the curvature conversions.
+///
+/// The derivatives use the neighbours on both sides of the central pixel.
+/// Therefore the angles span two pixels in horizontal, vertical and diagonal
+/// direction. The tables can be reused for every image of a sensor.
+/// \sa camera_models::angle_table
+template <typename Intrinsic>
+struct curvature_angles {
+    explicit curvature_angles(const Intrinsic& intrinsic)
+        : horizontal{intrinsic, {2, 0}}
+        , vertical{intrinsic, {0, 2}}
+        , diagonal{intrinsic, {2, 2}} {}
+
+    camera_models::angle_table<Intrinsic> horizontal;
+    camera_models::angle_table<Intrinsic> vertical;
+    camera_models::angle_table<Intrinsic> diagonal;
+};
+
+/// Convert the range image \p depth_image to a gaussian curvature image with
+/// precomputed angles between the lightrays.
+/// \param depth_image range image that will be converted
+/// \param angles angle tables for the sensor that took the image
+/// \sa depth_to_gaussian_curvature
+template <template <typename> typename Intrinsic, typename Real = float>
+math::image<Real> depth_to_gaussian_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles) noexcept;
+
+/// Convert the range image \p depth_image to a mean curvature image with
+/// precomputed angles between the lightrays.
+/// \param depth_image range image that will be converted
+/// \param angles angle tables for the sensor that took the image
+/// \sa depth_to_mean_curvature
+template <template <typename> typename Intrinsic, typename Real = float>
+math::image<Real> depth_to_mean_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles) noexcept;
+
+/// Parallel version of the gaussian curvature conversion with precomputed
+/// angles.
+/// \sa par_depth_to_gaussian_curvature
+/// \pre \p angles outlives the execution of \p flow
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task> par_depth_to_gaussian_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles,
+    math::image<Real>&                       gauss_image,
+    tf::Taskflow&                            flow) noexcept;
+
+/// Parallel version of the mean curvature conversion with precomputed
+/// angles.
+/// \sa par_depth_to_mean_curvature
+/// \pre \p angles outlives the execution of \p flow
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task> par_depth_to_mean_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles,
+    math::image<Real>&                       mean_image,
+    tf::Taskflow&                            flow) noexcept;
+
+/// Transformation of curvature values to the range of \p PixelType.
+///
+/// Values in \f$[lower, upper]\f$ are scaled linearly to
+/// \f$[PixelType_{min}, PixelType_{max}]\f$, values outside of the range are
+/// clamped. This is the same transformation \c curvature_to_image applies.
+/// \pre \p lower is smaller than \p upper
+/// \sa curvature_to_image
+/// \sa quantized_image
+template <typename PixelType, typename Real>
+struct curvature_quantization {
+    static_assert(std::is_arithmetic_v<PixelType>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Real lower;  ///< Curvature that maps to \f$PixelType_{min}\f$.
+    Real upper;  ///< Curvature that maps to \f$PixelType_{max}\f$.
+
+    [[nodiscard]] PixelType operator()(Real value) const noexcept {
+        const Real target_min = std::numeric_limits<PixelType>::min();
+        const Real target_max = std::numeric_limits<PixelType>::max();
+        return gsl::narrow_cast<PixelType>(
+            math::scale({lower, upper}, {target_min, target_max}, value));
+    }
+};
+
+/// Convert the range image \p depth_image to a gaussian curvature image and
+/// quantize each pixel to \p PixelType while it is calculated.
+///
+/// No intermediate image of \p Real is created. The result is the same as
+/// \c curvature_to_image(depth_to_gaussian_curvature(depth_image, angles),
+/// depth_image, q.lower, q.upper).
+/// \param depth_image,angles same as in \c depth_to_gaussian_curvature
+/// \param q clamping range of the curvature values
+/// \note pixels without depth are 0 in the result
+/// \sa curvature_quantization
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+math::image<PixelType> depth_to_gaussian_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q) noexcept;
+
+/// Convert the range image \p depth_image to a mean curvature image and
+/// quantize each pixel to \p PixelType while it is calculated.
+/// \sa depth_to_mean_curvature
+/// \sa curvature_quantization
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+math::image<PixelType> depth_to_mean_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q) noexcept;
+
+/// Convert the range image \p depth_image to a quantized gaussian curvature
+/// image and write the result into \p gauss_image.
+///
+/// Reusing \p gauss_image for a sequence of images avoids the allocation of a
+/// new image for each conversion.
+/// \param[in] depth_image,angles,q same as in the allocating overload
+/// \param[out] gauss_image resulting image, every pixel is overwritten
+/// \pre \p gauss_image has the same dimension as \p depth_image
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+void depth_to_gaussian_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        gauss_image) noexcept;
+
+/// Convert the range image \p depth_image to a quantized mean curvature
+/// image and write the result into \p mean_image.
+/// \sa depth_to_gaussian_curvature
+/// \pre \p mean_image has the same dimension as \p depth_image
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+void depth_to_mean_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        mean_image) noexcept;
+
+/// Parallel versions of the quantized curvature conversions that process the
+/// rows of the image concurrently.
+/// \param[inout] flow taskgraph that will be used for the parallel jobs
+/// \returns synchronization tasks before and after the conversion.
+/// \pre \p depth_image, \p angles and the result image outlive the
+/// execution of \p flow
+/// \sa depth_to_gaussian_curvature
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+std::pair<tf::Task, tf::Task> par_depth_to_gaussian_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        gauss_image,
+    tf::Taskflow&                                  flow) noexcept;
+
+/// \sa par_depth_to_gaussian_curvature
+/// \sa depth_to_mean_curvature
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+std::pair<tf::Task, tf::Task> par_depth_to_mean_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        mean_image,
+    tf::Taskflow&                                  flow) noexcept;
+
 /// Convert the curvature images to presentable images.
 ///
 /// The issue with the curvature images is that the result can be any real
@@ -110,22 +320,28 @@ namespace detail {
     if (d__1__1 == 0. || d__1__0 == 0. || d__1_1 == 0. || d__0__1 == 0. ||     \
         d__0__0 == 0. || d__0_1 == 0. || d_1__1 == 0. || d_1__0 == 0. ||       \
         d_1_1 == 0.) {                                                         \
-        (curv_image).at({u, v}) = 0.;                                          \
+        (curv_image).at({u, v}) = Real(0.);                                    \
         continue;                                                              \
     }
 
-template <template <typename> typename Intrinsic, typename Real>
+template <typename Real,
+          typename Horizontal,
+          typename Vertical,
+          typename Diagonal,
+          typename Output>
 void gaussian_inner(const int                v,
                     const math::image<Real>& depth_image,
-                    const Intrinsic<Real>&   intrinsic,
-                    math::image<Real>&       target_img) noexcept {
+                    const Horizontal&        horizontal,
+                    const Vertical&          vertical,
+                    const Diagonal&          diagonal,
+                    Output&                  target_img) noexcept {
     for (int u = 1; u < depth_image.w() - 1; ++u) {
         DIFF_STAR(depth_image, target_img)
 
-        using camera_models::phi;
-        const Real d_phi       = phi(intrinsic, {u - 1, v}, {u + 1, v});
-        const Real d_theta     = phi(intrinsic, {u, v - 1}, {u, v + 1});
-        const Real d_phi_theta = phi(intrinsic, {u - 1, v - 1}, {u + 1, v + 1});
+        const Real d_phi   = ray_angle(horizontal, {u - 1, v}, {u + 1, v});
+        const Real d_theta = ray_angle(vertical, {u, v - 1}, {u, v + 1});
+        const Real d_phi_theta =
+            ray_angle(diagonal, {u - 1, v - 1}, {u + 1, v + 1});
 
         const auto [f_u, f_v, f_uu, f_vv, f_uv] = math::derivatives(
             d__1__1, d__1__0, d__1_1, d__0__1, d__0__0, d__0_1, d_1__1, d_1__0,
@@ -136,18 +352,24 @@ void gaussian_inner(const int                v,
     }
 }
 
-template <template <typename> typename Intrinsic, typename Real>
+template <typename Real,
+          typename Horizontal,
+          typename Vertical,
+          typename Diagonal,
+          typename Output>
 void mean_inner(const int                v,
                 const math::image<Real>& depth_image,
-                const Intrinsic<Real>&   intrinsic,
-                math::image<Real>&       target_img) noexcept {
+                const Horizontal&        horizontal,
+                const Vertical&          vertical,
+                const Diagonal&          diagonal,
+                Output&                  target_img) noexcept {
     for (int u = 1; u < depth_image.w() - 1; ++u) {
         DIFF_STAR(depth_image, target_img)
 
-        using camera_models::phi;
-        const Real d_phi       = phi(intrinsic, {u - 1, v}, {u + 1, v});
-        const Real d_theta     = phi(intrinsic, {u, v - 1}, {u, v + 1});
-        const Real d_phi_theta = phi(intrinsic, {u - 1, v - 1}, {u + 1, v + 1});
+        const Real d_phi   = ray_angle(horizontal, {u - 1, v}, {u + 1, v});
+        const Real d_theta = ray_angle(vertical, {u, v - 1}, {u, v + 1});
+        const Real d_phi_theta =
+            ray_angle(diagonal, {u - 1, v - 1}, {u + 1, v + 1});
 
         const auto [f_u, f_v, f_uu, f_vv, f_uv] = math::derivatives(
             d__1__1, d__1__0, d__1_1, d__0__1, d__0__0, d__0_1, d_1__1, d_1__0,
@@ -178,7 +400,8 @@ depth_to_gaussian_curvature(const math::image<Real>& depth_image,
     math::image<Real> gauss_image(std::move(gauss));
 
     for (int v = 1; v < depth_image.h() - 1; ++v)
-        detail::gaussian_inner(v, depth_image, intrinsic, gauss_image);
+        detail::gaussian_inner(v, depth_image, intrinsic, intrinsic, intrinsic,
+                               gauss_image);
 
     return gauss_image;
 }
@@ -200,11 +423,293 @@ depth_to_mean_curvature(const math::image<Real>& depth_image,
     math::image<Real> mean_image(std::move(mean));
 
     for (int v = 1; v < depth_image.h() - 1; ++v)
-        detail::mean_inner(v, depth_image, intrinsic, mean_image);
+        detail::mean_inner(v, depth_image, intrinsic, intrinsic, intrinsic,
+                           mean_image);
+
+    return mean_image;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline math::image<Real> depth_to_gaussian_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+
+    cv::Mat gauss(depth_image.h(), depth_image.w(),
+                  math::detail::get_opencv_type<Real>());
+    gauss = Real(0.);
+    math::image<Real> gauss_image(std::move(gauss));
+
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::gaussian_inner(v, depth_image, angles.horizontal,
+                               angles.vertical, angles.diagonal, gauss_image);
+
+    return gauss_image;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline math::image<Real> depth_to_mean_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+
+    cv::Mat mean(depth_image.h(), depth_image.w(),
+                 math::detail::get_opencv_type<Real>());
+    mean = Real(0.);
+    math::image<Real> mean_image(std::move(mean));
+
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::mean_inner(v, depth_image, angles.horizontal, angles.vertical,
+                           angles.diagonal, mean_image);
+
+    return mean_image;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline math::image<PixelType> depth_to_gaussian_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q) noexcept {
+    math::image<PixelType> gauss_image =
+        detail::quantized_target<PixelType>(depth_image);
+    depth_to_gaussian_curvature(depth_image, angles, q, gauss_image);
+    return gauss_image;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline void depth_to_gaussian_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        gauss_image) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(gauss_image.w() == depth_image.w());
+    Expects(gauss_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real, curvature_quantization<PixelType, Real>>
+        out(gauss_image, q, &depth_image);
+    out.clear();
+
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::gaussian_inner(v, depth_image, angles.horizontal,
+                               angles.vertical, angles.diagonal, out);
+}
 
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline math::image<PixelType> depth_to_mean_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q) noexcept {
+    math::image<PixelType> mean_image =
+        detail::quantized_target<PixelType>(depth_image);
+    depth_to_mean_curvature(depth_image, angles, q, mean_image);
     return mean_image;
 }
 
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline void depth_to_mean_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        mean_image) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(mean_image.w() == depth_image.w());
+    Expects(mean_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real, curvature_quantization<PixelType, Real>>
+        out(mean_image, q, &depth_image);
+    out.clear();
+
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::mean_inner(v, depth_image, angles.horizontal, angles.vertical,
+                           angles.diagonal, out);
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline std::pair<tf::Task, tf::Task> par_depth_to_gaussian_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        gauss_image,
+    tf::Taskflow&                                  flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(gauss_image.w() == depth_image.w());
+    Expects(gauss_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real, curvature_quantization<PixelType, Real>>
+         out(gauss_image, q, &depth_image);
+    auto sync_points = flow.parallel_for(
+        0, depth_image.h(), 1,
+        [&depth_image, &angles, out](int v) mutable noexcept {
+            out.clear_row(v);
+            if (v == 0 || v == depth_image.h() - 1)
+                return;
+            detail::gaussian_inner(v, depth_image, angles.horizontal,
+                                   angles.vertical, angles.diagonal, out);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline std::pair<tf::Task, tf::Task> par_depth_to_mean_curvature(
+    const math::image<Real>&                       depth_image,
+    const curvature_angles<Intrinsic<Real>>&       angles,
+    const curvature_quantization<PixelType, Real>& q,
+    math::image<PixelType>&                        mean_image,
+    tf::Taskflow&                                  flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(mean_image.w() == depth_image.w());
+    Expects(mean_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real, curvature_quantization<PixelType, Real>>
+         out(mean_image, q, &depth_image);
+    auto sync_points = flow.parallel_for(
+        0, depth_image.h(), 1,
+        [&depth_image, &angles, out](int v) mutable noexcept {
+            out.clear_row(v);
+            if (v == 0 || v == depth_image.h() - 1)
+                return;
+            detail::mean_inner(v, depth_image, angles.horizontal,
+                               angles.vertical, angles.diagonal, out);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task>
+par_depth_to_gaussian_curvature(const math::image<Real>& depth_image,
+                                const Intrinsic<Real>&   intrinsic,
+                                math::image<Real>&       gauss_image,
+                                tf::Taskflow&            flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == intrinsic.w());
+    Expects(depth_image.h() == intrinsic.h());
+    Expects(gauss_image.w() == depth_image.w());
+    Expects(gauss_image.h() == depth_image.h());
+
+    auto sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1, [&](int v) noexcept {
+            detail::gaussian_inner(v, depth_image, intrinsic, intrinsic,
+                                   intrinsic, gauss_image);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task>
+par_depth_to_mean_curvature(const math::image<Real>& depth_image,
+                            const Intrinsic<Real>&   intrinsic,
+                            math::image<Real>&       mean_image,
+                            tf::Taskflow&            flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == intrinsic.w());
+    Expects(depth_image.h() == intrinsic.h());
+    Expects(mean_image.w() == depth_image.w());
+    Expects(mean_image.h() == depth_image.h());
+
+    auto sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1, [&](int v) noexcept {
+            detail::mean_inner(v, depth_image, intrinsic, intrinsic, intrinsic,
+                               mean_image);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task> par_depth_to_gaussian_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles,
+    math::image<Real>&                       gauss_image,
+    tf::Taskflow&                            flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(gauss_image.w() == depth_image.w());
+    Expects(gauss_image.h() == depth_image.h());
+
+    auto sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1, [&](int v) noexcept {
+            detail::gaussian_inner(v, depth_image, angles.horizontal,
+                                   angles.vertical, angles.diagonal,
+                                   gauss_image);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task> par_depth_to_mean_curvature(
+    const math::image<Real>&                 depth_image,
+    const curvature_angles<Intrinsic<Real>>& angles,
+    math::image<Real>&                       mean_image,
+    tf::Taskflow&                            flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(mean_image.w() == depth_image.w());
+    Expects(mean_image.h() == depth_image.h());
+
+    auto sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1, [&](int v) noexcept {
+            detail::mean_inner(v, depth_image, angles.horizontal,
+                               angles.vertical, angles.diagonal, mean_image);
+        });
+
+    return sync_points;
+}
+
 namespace detail {
 
 /// Convert a curvature image to an image. This will scale the reals that
@@ -227,8 +732,7 @@ reals_to_image(const math::image<Real>& real_image,
     const Real source_min = clamp_min ? *clamp_min : *min_it;
     const Real source_max = clamp_max ? *clamp_max : *max_it;
 
-    const Real target_min = std::numeric_limits<PixelType>::min();
-    const Real target_max = std::numeric_limits<PixelType>::max();
+    const curvature_quantization<PixelType, Real> q{source_min, source_max};
 
     cv::Mat target_image(real_image.h(), real_image.w(),
                          math::detail::get_opencv_type<PixelType>());
@@ -236,11 +740,7 @@ reals_to_image(const math::image<Real>& real_image,
 
     std::transform(real_image.data().template begin<Real>(),
                    real_image.data().template end<Real>(),
-                   target_image.begin<PixelType>(), [&](Real value) {
-                       return gsl::narrow_cast<PixelType>(
-                           math::scale({source_min, source_max},
-                                       {target_min, target_max}, value));
-                   });
+                   target_image.begin<PixelType>(), q);
 
     Ensures(target_image.cols == real_image.w());
     Ensures(target_image.rows == real_image.h());
@@ -2,13 +2,18 @@
 #define DEPTH_TO_TRIPLE_H_Y021ENVZ
 
 #include <cmath>
+#include <gsl/gsl>
 #include <iostream>
 #include <limits>
 #include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/camera_models/ray_cache.h>
+#include <sens_loc/conversion/flexion_simd.h>
 #include <sens_loc/conversion/util.h>
 #include <sens_loc/math/eigen_types.h>
 #include <sens_loc/math/image.h>
+#include <sens_loc/util/simd.h>
 #include <taskflow/taskflow.hpp>
+#include <vector>
 
 namespace sens_loc::conversion {
 
@@ -32,6 +37,18 @@ template <template <typename> typename Intrinsic, typename Real = float>
 math::image<Real> depth_to_flexion(const math::image<Real>& depth_image,
                                    const Intrinsic<Real>&   intrinsic) noexcept;
 
+/// Convert range image to a flexion-image with precomputed lightrays.
+///
+/// This overload does not backproject any pixel but looks the rays up in
+/// \p rays. Reuse the same cache for all images of a sensor.
+/// \sa depth_to_flexion
+/// \sa camera_models::ray_cache
+/// \pre \p rays matches the dimension of \p depth_image
+template <template <typename> typename Intrinsic, typename Real = float>
+math::image<Real> depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays) noexcept;
+
 /// Convert range image to a flexion image in parallel
 //
 /// This function implements the same functionality but with row-parallelism.
@@ -52,6 +69,77 @@ par_depth_to_flexion(const math::image<Real>& depth_image,
                      math::image<Real>&       flexion_image,
                      tf::Taskflow&            flow) noexcept;
 
+/// Convert range image to a flexion image in parallel with precomputed
+/// lightrays.
+/// \sa par_depth_to_flexion
+/// \sa camera_models::ray_cache
+/// \pre \p rays outlives the execution of \p flow
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task> par_depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    math::image<Real>&                               flexion_image,
+    tf::Taskflow&                                    flow) noexcept;
+
+/// Convert range image to a flexion image and quantize each pixel to
+/// \p PixelType while it is calculated.
+///
+/// No intermediate image of \p Real is created. With
+/// \c flexion_quantization the result is the same as
+/// \c convert_flexion(depth_to_flexion(depth_image, rays)) up to rounding of
+/// the last bit.
+/// \param depth_image,rays same as in \c depth_to_flexion
+/// \param q transformation from flexion values to pixel values
+/// \sa flexion_quantization
+/// \sa quantized_image
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+math::image<PixelType> depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const quantization<PixelType, Real>&             q) noexcept;
+
+/// Convert the image \p depth_image to a quantized flexion image and write
+/// the result into \p flexion_image.
+///
+/// Reusing \p flexion_image for a sequence of images avoids the allocation of
+/// a new image for each conversion.
+/// \param[in] depth_image,rays,q same as in the allocating overload
+/// \param[out] flexion_image resulting image, every pixel is overwritten
+/// \pre \p flexion_image has the same dimension as \p depth_image
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+void depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const quantization<PixelType, Real>&             q,
+    math::image<PixelType>&                          flexion_image) noexcept;
+
+/// Parallel version of the quantized conversion that processes the rows of
+/// the image concurrently.
+/// \param[in] depth_image,rays,q,flexion_image same as in the serial version
+/// \param[inout] flow taskgraph that will be used for the parallel jobs
+/// \returns synchronization tasks before and after the conversion.
+/// \pre \p depth_image, \p rays and \p flexion_image outlive the execution
+/// of \p flow
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+std::pair<tf::Task, tf::Task> par_depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const quantization<PixelType, Real>&             q,
+    math::image<PixelType>&                          flexion_image,
+    tf::Taskflow&                                    flow) noexcept;
+
+/// Return the transformation of the flexion values \f$[0, 1]\f$ to the
+/// range \f$[PixelType_{min}, PixelType_{max}]\f$.
+/// \sa convert_flexion
+template <typename PixelType = ushort, typename Real = float>
+quantization<PixelType, Real> flexion_quantization() noexcept;
+
 /// Scale the flexion image to \p PixelType for normal image visualization.
 ///
 /// This function simply scales the image to the full possible range of
@@ -67,78 +155,116 @@ convert_flexion(const math::image<Real>& flexion_image) noexcept;
 
 namespace detail {
 using ::sens_loc::math::vec;
-template <template <typename> typename Intrinsic, typename Real = float>
-math::camera_coord<Real> to_camera(const Intrinsic<Real>&        intrinsic,
+/// Backproject the pixel \p p with depth \p d into camera coordinates.
+/// \tparam Model either a camera model or a \c camera_models::ray_cache.
+template <typename Model, typename Real = float>
+math::camera_coord<Real> to_camera(const Model&                  intrinsic,
                                    const math::pixel_coord<int>& p,
                                    Real                          d) noexcept {
-    const math::sphere_coord<Real> P_s = intrinsic.pixel_to_sphere(p);
+    const math::sphere_coord<Real>& P_s = intrinsic.pixel_to_sphere(p);
     return math::camera_coord<Real>(d * P_s.Xs(), d * P_s.Ys(), d * P_s.Zs());
 }
 
-template <template <typename> typename Intrinsic, typename Real = float>
+/// Calculate the flexion for the pixel (u, v) with the depths of its
+/// neighbourhood \p n.
+template <typename Model, typename Real = float>
+inline Real flexion_pixel(const Model&               intrinsic,
+                          const int                  u,
+                          const int                  v,
+                          const neighbourhood<Real>& n) noexcept {
+    // If any of the depths is zero, the resulting vector will be the
+    // null vector. This with then propagate through as zero and does not
+    // induce any undefined behaviour or other problems.
+    // Not short-circuiting results in easier vectorization / GPU
+    // acceleration.
+
+    using math::camera_coord;
+    using math::pixel_coord;
+
+    const camera_coord<Real> surface_pt0 =
+        to_camera(intrinsic, {u, v - 1}, n.d__1__0);
+    const camera_coord<Real> surface_pt1 =
+        to_camera(intrinsic, {u, v + 1}, n.d_1__0);
+    const camera_coord<Real> surface_dir0 = surface_pt1 - surface_pt0;
+
+    const camera_coord<Real> surface_pt2 =
+        to_camera(intrinsic, {u - 1, v}, n.d__0__1);
+    const camera_coord<Real> surface_pt3 =
+        to_camera(intrinsic, {u + 1, v}, n.d__0_1);
+    const camera_coord<Real> surface_dir1 = surface_pt3 - surface_pt2;
+
+    const camera_coord<Real> surface_pt4 =
+        to_camera(intrinsic, {u + 1, v - 1}, n.d__1_1);
+    const camera_coord<Real> surface_pt5 =
+        to_camera(intrinsic, {u - 1, v + 1}, n.d_1__1);
+    const camera_coord<Real> surface_dir2 = surface_pt5 - surface_pt4;
+
+    const camera_coord<Real> surface_pt6 =
+        to_camera(intrinsic, {u - 1, v - 1}, n.d__1__1);
+    const camera_coord<Real> surface_pt7 =
+        to_camera(intrinsic, {u + 1, v + 1}, n.d_1_1);
+    const camera_coord<Real> surface_dir3 = surface_pt7 - surface_pt6;
+
+    const auto cross0 =
+        surface_dir0.normalized().cross(surface_dir1.normalized());
+    const auto cross1 =
+        surface_dir2.normalized().cross(surface_dir3.normalized());
+
+    const auto flexion =
+        std::clamp(std::abs(cross0.dot(cross1)), Real(0.), Real(1.));
+
+    Ensures(flexion >= 0.);
+    Ensures(flexion <= 1.);
+
+    return flexion;
+}
+
+/// Calculate the flexion for the pixels of row \p v, starting at column
+/// \p u_start.
+template <typename Model, typename Output, typename Real = float>
 inline void flexion_inner(int                      v,
                           const math::image<Real>& depth_image,
-                          const Intrinsic<Real>&   intrinsic,
-                          math::image<Real>&       out) {
-    for (int u = 1; u < depth_image.w() - 1; ++u) {
-        const Real d__1__0 = depth_image.at({u, v - 1});
-        const Real d_1__0  = depth_image.at({u, v + 1});
-
-        const Real d__0__1 = depth_image.at({u - 1, v});
-        const Real d__0_1  = depth_image.at({u + 1, v});
-
-        const Real d__1_1 = depth_image.at({u + 1, v - 1});
-        const Real d_1__1 = depth_image.at({u - 1, v + 1});
-
-        const Real d__1__1 = depth_image.at({u - 1, v - 1});
-        const Real d_1_1   = depth_image.at({u + 1, v + 1});
-
-        // If any of the depths is zero, the resulting vector will be the
-        // null vector. This with then propagate through as zero and does not
-        // induce any undefined behaviour or other problems.
-        // Not short-circuiting results in easier vectorization / GPU
-        // acceleration.
-
-        using math::camera_coord;
-        using math::pixel_coord;
-
-        const camera_coord<Real> surface_pt0 =
-            to_camera(intrinsic, {u, v - 1}, d__1__0);
-        const camera_coord<Real> surface_pt1 =
-            to_camera(intrinsic, {u, v + 1}, d_1__0);
-        const camera_coord<Real> surface_dir0 = surface_pt1 - surface_pt0;
-
-        const camera_coord<Real> surface_pt2 =
-            to_camera(intrinsic, {u - 1, v}, d__0__1);
-        const camera_coord<Real> surface_pt3 =
-            to_camera(intrinsic, {u + 1, v}, d__0_1);
-        const camera_coord<Real> surface_dir1 = surface_pt3 - surface_pt2;
-
-        const camera_coord<Real> surface_pt4 =
-            to_camera(intrinsic, {u + 1, v - 1}, d__1_1);
-        const camera_coord<Real> surface_pt5 =
-            to_camera(intrinsic, {u - 1, v + 1}, d_1__1);
-        const camera_coord<Real> surface_dir2 = surface_pt5 - surface_pt4;
-
-        const camera_coord<Real> surface_pt6 =
-            to_camera(intrinsic, {u - 1, v - 1}, d__1__1);
-        const camera_coord<Real> surface_pt7 =
-            to_camera(intrinsic, {u + 1, v + 1}, d_1_1);
-        const camera_coord<Real> surface_dir3 = surface_pt7 - surface_pt6;
-
-        const auto cross0 =
-            surface_dir0.normalized().cross(surface_dir1.normalized());
-        const auto cross1 =
-            surface_dir2.normalized().cross(surface_dir3.normalized());
-
-        const auto flexion =
-            std::clamp(std::abs(cross0.dot(cross1)), Real(0.), Real(1.));
-
-        Ensures(flexion >= 0.);
-        Ensures(flexion <= 1.);
-
-        out.at({u, v}) = flexion;
-    }
+                          const Model&             intrinsic,
+                          Output&                  out,
+                          int                      u_start = 1) {
+    for (int u = u_start; u < depth_image.w() - 1; ++u)
+        out.at({u, v}) = flexion_pixel(
+            intrinsic, u, v, neighbourhood<Real>{depth_image, u, v});
+}
+
+/// Calculate the flexion for row \p v with the vectorized kernel for
+/// \p level and process the remaining pixels with the scalar implementation.
+template <typename Intrinsic, typename Real>
+inline void
+flexion_row(int                                        v,
+            const math::image<Real>&                   depth_image,
+            const camera_models::ray_cache<Intrinsic>& rays,
+            math::image<Real>&                         out,
+            util::simd_level                           level) noexcept {
+    const int u_start =
+        flexion_row_simd(v, depth_image, rays, &out.at({0, v}), level);
+    flexion_inner(v, depth_image, rays, out, u_start);
+}
+
+/// Calculate the flexion for row \p v into a quantized image.
+/// The vectorized kernel stores its results in \p buffer first, because it
+/// writes blocks of pixels at once.
+/// \pre \p buffer has at least as many elements as the image is wide
+template <typename Intrinsic, typename Real, typename Output>
+inline void
+flexion_row(int                                        v,
+            const math::image<Real>&                   depth_image,
+            const camera_models::ray_cache<Intrinsic>& rays,
+            Output&                                    out,
+            util::simd_level                           level,
+            gsl::span<Real>                            buffer) noexcept {
+    Expects(buffer.size() >= depth_image.w());
+
+    const int u_start =
+        flexion_row_simd(v, depth_image, rays, buffer.data(), level);
+    for (int u = 1; u < u_start; ++u)
+        out.at({u, v}) = buffer[u];
+    flexion_inner(v, depth_image, rays, out, u_start);
 }
 
 }  // namespace detail
@@ -153,12 +279,29 @@ depth_to_flexion(const math::image<Real>& depth_image,
     Expects(depth_image.w() == intrinsic.w());
     Expects(depth_image.h() == intrinsic.h());
 
+    // Each ray is used multiple times for neighbouring pixels. Precomputing
+    // them once is cheaper than backprojecting them on the fly.
+    return depth_to_flexion(
+        depth_image, camera_models::ray_cache<Intrinsic<Real>>{intrinsic});
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline math::image<Real> depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+
     cv::Mat flexion(depth_image.h(), depth_image.w(),
                     math::detail::get_opencv_type<Real>());
     flexion = Real(0.);
     math::image<Real> flexion_image(std::move(flexion));
+    const util::simd_level level = util::simd_support();
     for (int v = 1; v < depth_image.h() - 1; ++v)
-        detail::flexion_inner(v, depth_image, intrinsic, flexion_image);
+        detail::flexion_row(v, depth_image, rays, flexion_image, level);
 
     Ensures(flexion_image.w() == depth_image.w());
     Ensures(flexion_image.h() == depth_image.h());
@@ -190,6 +333,120 @@ par_depth_to_flexion(const math::image<Real>& depth_image,
     return sync_points;
 }
 
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task> par_depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    math::image<Real>&                               flexion_image,
+    tf::Taskflow&                                    flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+
+    Expects(flexion_image.w() == depth_image.w());
+    Expects(flexion_image.h() == depth_image.h());
+
+    // The flow runs after this function returned, so the level is copied.
+    const util::simd_level level       = util::simd_support();
+    auto                   sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1,
+        [&depth_image, &rays, &flexion_image, level](int v) noexcept {
+            detail::flexion_row(v, depth_image, rays, flexion_image, level);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline math::image<PixelType> depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const quantization<PixelType, Real>&             q) noexcept {
+    math::image<PixelType> flexion_image =
+        detail::quantized_target<PixelType>(depth_image);
+    depth_to_flexion(depth_image, rays, q, flexion_image);
+    return flexion_image;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline void depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const quantization<PixelType, Real>&             q,
+    math::image<PixelType>&                          flexion_image) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+    Expects(flexion_image.w() == depth_image.w());
+    Expects(flexion_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real> out(flexion_image, q);
+    out.clear();
+
+    // The row buffer is kept per thread, so that the repeated conversion of
+    // images with the same width does not allocate.
+    thread_local std::vector<Real> buffer;
+    buffer.resize(gsl::narrow_cast<std::size_t>(depth_image.w()));
+
+    const util::simd_level level = util::simd_support();
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::flexion_row(v, depth_image, rays, out, level,
+                            gsl::span<Real>{buffer});
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline std::pair<tf::Task, tf::Task> par_depth_to_flexion(
+    const math::image<Real>&                         depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const quantization<PixelType, Real>&             q,
+    math::image<PixelType>&                          flexion_image,
+    tf::Taskflow&                                    flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+    Expects(flexion_image.w() == depth_image.w());
+    Expects(flexion_image.h() == depth_image.h());
+
+    const util::simd_level           level = util::simd_support();
+    quantized_image<PixelType, Real> out(flexion_image, q);
+    auto                             sync_points = flow.parallel_for(
+        0, depth_image.h(), 1,
+        [&depth_image, &rays, out, level](int v) mutable noexcept {
+            out.clear_row(v);
+            if (v == 0 || v == depth_image.h() - 1)
+                return;
+
+            thread_local std::vector<Real> buffer;
+            buffer.resize(gsl::narrow_cast<std::size_t>(depth_image.w()));
+            detail::flexion_row(v, depth_image, rays, out, level,
+                                gsl::span<Real>{buffer});
+        });
+
+    return sync_points;
+}
+
+template <typename PixelType, typename Real>
+inline quantization<PixelType, Real> flexion_quantization() noexcept {
+    const Real scale = Real(std::numeric_limits<PixelType>::max()) -
+                       Real(std::numeric_limits<PixelType>::min());
+    const Real offset = std::numeric_limits<PixelType>::min();
+    return {scale, offset};
+}
+
 template <typename PixelType, typename Real>
 inline math::image<PixelType>
 convert_flexion(const math::image<Real>& flexion_image) noexcept {
@@ -199,12 +456,9 @@ convert_flexion(const math::image<Real>& flexion_image) noexcept {
     cv::Mat img(flexion_image.h(), flexion_image.w(),
                 math::detail::get_opencv_type<PixelType>());
 
-    const Real scale = Real(std::numeric_limits<PixelType>::max()) -
-                       Real(std::numeric_limits<PixelType>::min());
-    const Real offset = std::numeric_limits<PixelType>::min();
-
+    const auto q = flexion_quantization<PixelType, Real>();
     flexion_image.data().convertTo(
-        img, math::detail::get_opencv_type<PixelType>(), scale, offset);
+        img, math::detail::get_opencv_type<PixelType>(), q.scale, q.offset);
 
     Ensures(img.cols == flexion_image.w());
     Ensures(img.rows == flexion_image.h());
@@ -2,6 +2,7 @@
 #define DEPTH_TO_LASERSCAN_H_P8V9HAVF
 
 #include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/camera_models/ray_cache.h>
 #include <sens_loc/conversion/util.h>
 #include <sens_loc/math/image.h>
 #include <taskflow/taskflow.hpp>
@@ -30,6 +31,39 @@ template <typename Real      = float,
 math::image<Real> depth_to_laserscan(const math::image<PixelType>& depth_image,
                                      const Intrinsic<Real>& intrinsic) noexcept;
 
+/// This function converts an orthographic depth image to an laser-scan like
+/// depth image with the precomputed lightrays of the sensor.
+///
+/// Reusing \p rays for all images of a sensor avoids the recalculation of
+/// the same backprojection for each image.
+/// \sa conversion::depth_to_laserscan
+/// \sa camera_models::ray_cache
+/// \pre \p rays matches the dimension of \p depth_image
+template <typename Real      = float,
+          typename PixelType = ushort,
+          template <typename>
+          typename Intrinsic>
+math::image<Real> depth_to_laserscan(
+    const math::image<PixelType>&                    depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays) noexcept;
+
+/// Convert the orthographic depth image with precomputed lightrays and write
+/// the result into \p euclid_image.
+///
+/// Reusing \p euclid_image for a sequence of images avoids the allocation of
+/// a new image for each conversion.
+/// \param[in] depth_image,rays same as in the allocating overload
+/// \param[out] euclid_image resulting image, every pixel is overwritten
+/// \pre \p euclid_image has the same dimension as \p depth_image
+template <typename Real      = float,
+          typename PixelType = ushort,
+          template <typename>
+          typename Intrinsic>
+void depth_to_laserscan(
+    const math::image<PixelType>&                    depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    math::image<Real>&                               euclid_image) noexcept;
+
 /// This function is the parallel implementation for the conversions.
 /// \sa conversion::depth_to_laserscan
 /// \param[in] depth_image,intrinsic same as in serial case
@@ -46,14 +80,27 @@ par_depth_to_laserscan(const math::image<PixelType>& depth_image,
                        math::image<Real>&            out,
                        tf::Taskflow&                 flow) noexcept;
 
-namespace detail {
-template <typename Real,
-          typename PixelType,
+/// This function is the parallel implementation for the conversion with
+/// precomputed lightrays.
+/// \sa conversion::par_depth_to_laserscan
+/// \sa camera_models::ray_cache
+/// \pre \p rays outlives the execution of \p flow
+template <typename Real      = float,
+          typename PixelType = ushort,
           template <typename>
           typename Intrinsic>
+std::pair<tf::Task, tf::Task> par_depth_to_laserscan(
+    const math::image<PixelType>&                    depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    math::image<Real>&                               out,
+    tf::Taskflow&                                    flow) noexcept;
+
+namespace detail {
+/// \tparam Model either a camera model or a \c camera_models::ray_cache.
+template <typename Real, typename PixelType, typename Model>
 void laserscan_inner(const int                     v,
                      const math::image<PixelType>& depth_image,
-                     const Intrinsic<Real>&        intrinsic,
+                     const Model&                  intrinsic,
                      math::image<Real>&            euclid) {
     for (int u = 0; u < depth_image.w(); ++u) {
         const PixelType d_o = depth_image.at({u, v});
@@ -92,6 +139,56 @@ depth_to_laserscan(const math::image<PixelType>& depth_image,
     return euclid_image;
 }
 
+template <typename Real,
+          typename PixelType,
+          template <typename>
+          typename Intrinsic>
+inline math::image<Real> depth_to_laserscan(
+    const math::image<PixelType>&                    depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+
+    cv::Mat euclid(depth_image.h(), depth_image.w(),
+                   math::detail::get_opencv_type<Real>());
+    euclid = Real(0.);
+    math::image<Real> euclid_image(std::move(euclid));
+
+    for (int v = 0; v < depth_image.h(); ++v)
+        detail::laserscan_inner<Real, PixelType>(v, depth_image, rays,
+                                                 euclid_image);
+
+    Ensures(euclid_image.h() == depth_image.h());
+    Ensures(euclid_image.w() == depth_image.w());
+
+    return euclid_image;
+}
+
+template <typename Real,
+          typename PixelType,
+          template <typename>
+          typename Intrinsic>
+inline void depth_to_laserscan(
+    const math::image<PixelType>&                    depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    math::image<Real>&                               euclid_image) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+    Expects(euclid_image.w() == depth_image.w());
+    Expects(euclid_image.h() == depth_image.h());
+
+    for (int v = 0; v < depth_image.h(); ++v)
+        detail::laserscan_inner<Real, PixelType>(v, depth_image, rays,
+                                                 euclid_image);
+}
 
 template <typename Real,
           typename PixelType,
@@ -119,6 +216,32 @@ par_depth_to_laserscan(const math::image<PixelType>& depth_image,
 
     return sync_points;
 }
+
+template <typename Real,
+          typename PixelType,
+          template <typename>
+          typename Intrinsic>
+inline std::pair<tf::Task, tf::Task> par_depth_to_laserscan(
+    const math::image<PixelType>&                    depth_image,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    math::image<Real>&                               out,
+    tf::Taskflow&                                    flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+
+    Expects(out.h() == depth_image.h());
+    Expects(out.w() == depth_image.w());
+
+    auto sync_points = flow.parallel_for(0, depth_image.h(), 1, [&](int v) {
+        detail::laserscan_inner<Real, PixelType>(v, depth_image, rays, out);
+    });
+
+    return sync_points;
+}
 }  // namespace sens_loc::conversion
 
 #endif /* end of include guard: DEPTH_TO_LASERSCAN_H_P8V9HAVF */
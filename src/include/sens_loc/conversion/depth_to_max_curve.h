@@ -2,6 +2,7 @@
 #define DEPTH_TO_MAX_CURVE_H_XO6PUN8H
 
 #include <cmath>
+#include <sens_loc/camera_models/angle_table.h>
 #include <sens_loc/camera_models/pinhole.h>
 #include <sens_loc/camera_models/utility.h>
 #include <sens_loc/conversion/depth_to_bearing.h>
@@ -9,6 +10,7 @@
 #include <sens_loc/math/constants.h>
 #include <sens_loc/math/image.h>
 #include <sens_loc/math/triangles.h>
+#include <taskflow/taskflow.hpp>
 
 namespace sens_loc::conversion {
 
@@ -36,6 +38,110 @@ template <template <typename> typename Intrinsic, typename Real = float>
 math::image<Real> depth_to_max_curve(const math::image<Real>& depth_image,
                                      const Intrinsic<Real>& intrinsic) noexcept;
 
+/// This function provides a parallelized version of the max-curve
+/// conversion.
+///
+/// This function creates a taskflow for the row-wise parallel calculation
+/// of the max-curve image.
+/// Only differences are documented here.
+/// \param[in] depth_image,intrinsic the same
+/// \param[out] max_curve_image result image that will be created with
+/// parallel processing
+/// \param[inout] flow parallel flow type that is used to parallelize the outer
+/// for loop over all rows.
+/// \returns synchronization points before and after the calculation of the
+/// max-curve image.
+/// \pre \p max_curve_image has the same dimension as \p depth_image
+/// \note the border pixels of \p max_curve_image are not written.
+/// \sa depth_to_max_curve
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task>
+par_depth_to_max_curve(const math::image<Real>& depth_image,
+                       const Intrinsic<Real>&   intrinsic,
+                       math::image<Real>&       max_curve_image,
+                       tf::Taskflow&            flow) noexcept;
+
+/// Convert a range image to a max-curve image with precomputed angles
+/// between the lightrays.
+/// \param depth_image range image the calculations are made with
+/// \param angles angle tables for the sensor that took the image
+/// \sa depth_to_max_curve
+/// \sa bearing_angles
+template <template <typename> typename Intrinsic, typename Real = float>
+math::image<Real>
+depth_to_max_curve(const math::image<Real>&               depth_image,
+                   const bearing_angles<Intrinsic<Real>>& angles) noexcept;
+
+/// Parallel version of the max-curve conversion with precomputed angles.
+/// \sa par_depth_to_max_curve
+/// \pre \p angles outlives the execution of \p flow
+template <template <typename> typename Intrinsic, typename Real = float>
+std::pair<tf::Task, tf::Task>
+par_depth_to_max_curve(const math::image<Real>&               depth_image,
+                       const bearing_angles<Intrinsic<Real>>& angles,
+                       math::image<Real>&                     max_curve_image,
+                       tf::Taskflow&                          flow) noexcept;
+
+/// Convert a range image to a max-curve image and quantize each pixel to
+/// \p PixelType while it is calculated.
+///
+/// No intermediate image of \p Real is created. With
+/// \c max_curve_quantization the result is the same as
+/// \c convert_max_curve(depth_to_max_curve(depth_image, angles)) up to
+/// rounding of the last bit.
+/// \param depth_image,angles same as in \c depth_to_max_curve
+/// \param q transformation from angles to pixel values
+/// \sa max_curve_quantization
+/// \sa quantized_image
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+math::image<PixelType>
+depth_to_max_curve(const math::image<Real>&               depth_image,
+                   const bearing_angles<Intrinsic<Real>>& angles,
+                   const quantization<PixelType, Real>&   q) noexcept;
+
+/// Convert the image \p depth_image to a quantized max-curve image and write
+/// the result into \p max_curve_image.
+///
+/// Reusing \p max_curve_image for a sequence of images avoids the allocation
+/// of a new image for each conversion.
+/// \param[in] depth_image,angles,q same as in the allocating overload
+/// \param[out] max_curve_image resulting image, every pixel is overwritten
+/// \pre \p max_curve_image has the same dimension as \p depth_image
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+void depth_to_max_curve(
+    const math::image<Real>&               depth_image,
+    const bearing_angles<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&   q,
+    math::image<PixelType>&                max_curve_image) noexcept;
+
+/// Parallel version of the quantized conversion that processes the rows of
+/// the image concurrently.
+/// \param[in] depth_image,angles,q,max_curve_image same as in the serial
+/// version
+/// \param[inout] flow taskgraph that will be used for the parallel jobs
+/// \returns synchronization tasks before and after the conversion.
+/// \pre \p depth_image, \p angles and \p max_curve_image outlive the
+/// execution of \p flow
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+std::pair<tf::Task, tf::Task> par_depth_to_max_curve(
+    const math::image<Real>&               depth_image,
+    const bearing_angles<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&   q,
+    math::image<PixelType>&                max_curve_image,
+    tf::Taskflow&                          flow) noexcept;
+
+/// Return the transformation of the max-curve angles \f$[0, 2\pi)\f$ to the
+/// range \f$[PixelType_{min}, PixelType_{max}]\f$.
+/// \sa convert_max_curve
+template <typename PixelType = ushort, typename Real = float>
+quantization<PixelType, Real> max_curve_quantization() noexcept;
+
 /// The max-curve picture is not a normal image and needs to be converted to
 /// the classical integer range.
 ///
@@ -80,6 +186,74 @@ inline Real angle_formula(const Real d__1,
 
     return angle;
 }
+
+/// Calculate the max-curve angle for the pixel (u, v) with the depths of its
+/// neighbourhood \p n.
+template <typename Real,
+          typename Horizontal,
+          typename Vertical,
+          typename Diagonal,
+          typename Antidiagonal>
+inline Real max_curve_pixel(const int                  u,
+                            const int                  v,
+                            const neighbourhood<Real>& n,
+                            const Horizontal&          horizontal,
+                            const Vertical&            vertical,
+                            const Diagonal&            diagonal,
+                            const Antidiagonal&        antidiagonal) noexcept {
+    const Real cos_hor1  = cos_ray_angle(horizontal, {u - 1, v}, {u, v});
+    const Real cos_hor2  = cos_ray_angle(horizontal, {u, v}, {u + 1, v});
+    const Real angle_hor = angle_formula(n.d__0__1, n.d__0__0, n.d__0_1,
+                                         cos_hor1, cos_hor2);
+
+    // vertical angular resolution
+    const Real cos_ver1  = cos_ray_angle(vertical, {u, v - 1}, {u, v});
+    const Real cos_ver2  = cos_ray_angle(vertical, {u, v}, {u, v + 1});
+    const Real angle_ver = angle_formula(n.d__1__0, n.d__0__0, n.d_1__0,
+                                         cos_ver1, cos_ver2);
+
+    // diagonal angular resolution
+    const Real cos_dia1  = cos_ray_angle(diagonal, {u - 1, v - 1}, {u, v});
+    const Real cos_dia2  = cos_ray_angle(diagonal, {u, v}, {u + 1, v + 1});
+    const Real angle_dia = angle_formula(n.d__1__1, n.d__0__0, n.d_1_1,
+                                         cos_dia1, cos_dia2);
+
+    // antidiagonal angular resolution
+    // The first angle spans the same pixel pair as 'cos_dia2'.
+    const Real cos_ant1  = cos_ray_angle(diagonal, {u + 1, v + 1}, {u, v});
+    const Real cos_ant2  = cos_ray_angle(antidiagonal, {u, v}, {u + 1, v - 1});
+    const Real angle_ant = angle_formula(n.d_1__1, n.d__0__0, n.d__1_1,
+                                         cos_ant1, cos_ant2);
+
+    using std::max;
+    const Real max_angle =
+        max(angle_hor, max(angle_ver, max(angle_dia, angle_ant)));
+
+    Ensures(max_angle >= 0.);
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+    Ensures(max_angle < 2. * math::pi<Real>);
+
+    return max_angle;
+}
+
+template <typename Real,
+          typename Horizontal,
+          typename Vertical,
+          typename Diagonal,
+          typename Antidiagonal,
+          typename Output>
+inline void max_curve_inner(const int                v,
+                            const math::image<Real>& depth_image,
+                            const Horizontal&        horizontal,
+                            const Vertical&          vertical,
+                            const Diagonal&          diagonal,
+                            const Antidiagonal&      antidiagonal,
+                            Output&                  max_curve_image) noexcept {
+    for (int u = 1; u < depth_image.w() - 1; ++u)
+        max_curve_image.at({u, v}) = max_curve_pixel(
+            u, v, neighbourhood<Real>{depth_image, u, v}, horizontal,
+            vertical, diagonal, antidiagonal);
+}
 }  // namespace detail
 
 template <template <typename> typename Intrinsic, typename Real>
@@ -97,75 +271,174 @@ depth_to_max_curve(const math::image<Real>& depth_image,
     max_curve = Real(0.);
     math::image<Real> max_curve_image(std::move(max_curve));
 
-    for (int v = 1; v < depth_image.h() - 1; ++v) {
-        for (int u = 1; u < depth_image.w() - 1; ++u) {
-            const Real d__1__1 = depth_image.at({u - 1, v - 1});
-            const Real d__1__0 = depth_image.at({u, v - 1});
-            const Real d__1_1  = depth_image.at({u + 1, v - 1});
-
-            const Real d__0__1 = depth_image.at({u - 1, v});
-            const Real d__0__0 = depth_image.at({u, v});
-            const Real d__0_1  = depth_image.at({u + 1, v});
-
-            const Real d_1__1 = depth_image.at({u - 1, v + 1});
-            const Real d_1__0 = depth_image.at({u, v + 1});
-            const Real d_1_1  = depth_image.at({u + 1, v + 1});
-
-            using camera_models::phi;
-            using detail::angle_formula;
-            using math::pixel_coord;
-            using std::cos;
-            const Real phi_hor1  = phi(intrinsic, {u - 1, v}, {u, v});
-            const Real phi_hor2  = phi(intrinsic, {u, v}, {u + 1, v});
-            const Real angle_hor = angle_formula(d__0__1, d__0__0, d__0_1,
-                                                 cos(phi_hor1), cos(phi_hor2));
-
-            // vertical angular resolution
-            const Real phi_ver1  = phi(intrinsic, {u, v - 1}, {u, v});
-            const Real phi_ver2  = phi(intrinsic, {u, v}, {u, v + 1});
-            const Real angle_ver = angle_formula(d__1__0, d__0__0, d_1__0,
-                                                 cos(phi_ver1), cos(phi_ver2));
-
-            // diagonal angular resolution
-            const Real phi_dia1  = phi(intrinsic, {u - 1, v - 1}, {u, v});
-            const Real phi_dia2  = phi(intrinsic, {u, v}, {u + 1, v + 1});
-            const Real angle_dia = angle_formula(d__1__1, d__0__0, d_1_1,
-                                                 cos(phi_dia1), cos(phi_dia2));
-
-            // antidiagonal angular resolution
-            const Real phi_ant1  = phi(intrinsic, {u + 1, v + 1}, {u, v});
-            const Real phi_ant2  = phi(intrinsic, {u, v}, {u + 1, v - 1});
-            const Real angle_ant = angle_formula(d_1__1, d__0__0, d__1_1,
-                                                 cos(phi_ant1), cos(phi_ant2));
-
-            using std::max;
-            const Real max_angle =
-                max(angle_hor, max(angle_ver, max(angle_dia, angle_ant)));
-
-            Ensures(max_angle >= 0.);
-            // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-            Ensures(max_angle < 2. * math::pi<Real>);
-            max_curve_image.at({u, v}) = max_angle;
-        }
-    }
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::max_curve_inner(v, depth_image, intrinsic, intrinsic, intrinsic,
+                                intrinsic, max_curve_image);
 
     return max_curve_image;
 }
 
+template <template <typename> typename Intrinsic, typename Real>
+inline math::image<Real>
+depth_to_max_curve(const math::image<Real>&               depth_image,
+                   const bearing_angles<Intrinsic<Real>>& angles) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+
+    cv::Mat max_curve(depth_image.h(), depth_image.w(),
+                      math::detail::get_opencv_type<Real>());
+    max_curve = Real(0.);
+    math::image<Real> max_curve_image(std::move(max_curve));
+
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::max_curve_inner(v, depth_image, angles.horizontal,
+                                angles.vertical, angles.diagonal,
+                                angles.antidiagonal, max_curve_image);
+
+    return max_curve_image;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task>
+par_depth_to_max_curve(const math::image<Real>& depth_image,
+                       const Intrinsic<Real>&   intrinsic,
+                       math::image<Real>&       max_curve_image,
+                       tf::Taskflow&            flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == intrinsic.w());
+    Expects(depth_image.h() == intrinsic.h());
+    Expects(max_curve_image.w() == depth_image.w());
+    Expects(max_curve_image.h() == depth_image.h());
+
+    auto sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1, [&](int v) noexcept {
+            detail::max_curve_inner(v, depth_image, intrinsic, intrinsic,
+                                    intrinsic, intrinsic, max_curve_image);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic, typename Real>
+inline std::pair<tf::Task, tf::Task>
+par_depth_to_max_curve(const math::image<Real>&               depth_image,
+                       const bearing_angles<Intrinsic<Real>>& angles,
+                       math::image<Real>&                     max_curve_image,
+                       tf::Taskflow&                          flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(max_curve_image.w() == depth_image.w());
+    Expects(max_curve_image.h() == depth_image.h());
+
+    auto sync_points = flow.parallel_for(
+        1, depth_image.h() - 1, 1, [&](int v) noexcept {
+            detail::max_curve_inner(v, depth_image, angles.horizontal,
+                                    angles.vertical, angles.diagonal,
+                                    angles.antidiagonal, max_curve_image);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline math::image<PixelType>
+depth_to_max_curve(const math::image<Real>&               depth_image,
+                   const bearing_angles<Intrinsic<Real>>& angles,
+                   const quantization<PixelType, Real>&   q) noexcept {
+    math::image<PixelType> max_curve_image =
+        detail::quantized_target<PixelType>(depth_image);
+    depth_to_max_curve(depth_image, angles, q, max_curve_image);
+    return max_curve_image;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline void depth_to_max_curve(
+    const math::image<Real>&               depth_image,
+    const bearing_angles<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&   q,
+    math::image<PixelType>&                max_curve_image) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(max_curve_image.w() == depth_image.w());
+    Expects(max_curve_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real> out(max_curve_image, q);
+    out.clear();
+
+    for (int v = 1; v < depth_image.h() - 1; ++v)
+        detail::max_curve_inner(v, depth_image, angles.horizontal,
+                                angles.vertical, angles.diagonal,
+                                angles.antidiagonal, out);
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename PixelType>
+inline std::pair<tf::Task, tf::Task> par_depth_to_max_curve(
+    const math::image<Real>&               depth_image,
+    const bearing_angles<Intrinsic<Real>>& angles,
+    const quantization<PixelType, Real>&   q,
+    math::image<PixelType>&                max_curve_image,
+    tf::Taskflow&                          flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(max_curve_image.w() == depth_image.w());
+    Expects(max_curve_image.h() == depth_image.h());
+
+    quantized_image<PixelType, Real> out(max_curve_image, q);
+    auto                             sync_points = flow.parallel_for(
+        0, depth_image.h(), 1,
+        [&depth_image, &angles, out](int v) mutable noexcept {
+            out.clear_row(v);
+            if (v == 0 || v == depth_image.h() - 1)
+                return;
+            detail::max_curve_inner(v, depth_image, angles.horizontal,
+                                    angles.vertical, angles.diagonal,
+                                    angles.antidiagonal, out);
+        });
+
+    return sync_points;
+}
+
+template <typename PixelType, typename Real>
+inline quantization<PixelType, Real> max_curve_quantization() noexcept {
+    const auto [scale, offset] = detail::scaling_factor<Real, PixelType>(
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
+        /*max_angle = */ 2. * math::pi<Real>);
+    return {scale, offset};
+}
+
 template <typename PixelType, typename Real>
 inline math::image<PixelType>
 convert_max_curve(const math::image<Real>& max_curve) noexcept {
     static_assert(std::is_floating_point_v<Real>);
     static_assert(std::is_arithmetic_v<PixelType>);
 
-    using detail::scaling_factor;
     cv::Mat img(max_curve.h(), max_curve.w(),
                 math::detail::get_opencv_type<PixelType>());
-    const auto [scale, offset] =
-        // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers)
-        scaling_factor<Real, PixelType>(/*max_angle = */ 2. * math::pi<Real>);
+    const auto q = max_curve_quantization<PixelType, Real>();
     max_curve.data().convertTo(img, math::detail::get_opencv_type<PixelType>(),
-                               scale, offset);
+                               q.scale, q.offset);
 
     Ensures(img.cols == max_curve.w());
     Ensures(img.rows == max_curve.h());
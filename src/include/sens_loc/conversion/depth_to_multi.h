@@ -0,0 +1,345 @@
+#ifndef DEPTH_TO_MULTI_H_J5RDX2QE
+#define DEPTH_TO_MULTI_H_J5RDX2QE
+
+#include <gsl/gsl>
+#include <sens_loc/camera_models/concepts.h>
+#include <sens_loc/camera_models/ray_cache.h>
+#include <sens_loc/conversion/depth_to_bearing.h>
+#include <sens_loc/conversion/depth_to_flexion.h>
+#include <sens_loc/conversion/depth_to_max_curve.h>
+#include <sens_loc/conversion/util.h>
+#include <sens_loc/math/image.h>
+#include <taskflow/taskflow.hpp>
+
+namespace sens_loc::conversion {
+
+/// Result images for the fused conversion \c depth_to_multi.
+///
+/// Each member points to a caller-provided image that receives the
+/// corresponding derived image. A \c nullptr deselects the result and
+/// nothing is calculated for it.
+/// \tparam Image type of the result images, either \c math::image<Real> or
+/// a \c quantized_image to store the results as integers directly
+/// \sa depth_to_multi
+template <typename Real, typename Image = math::image<Real>>
+struct multi_images {
+    Image* horizontal   = nullptr;  ///< Bearing angles, horizontal.
+    Image* vertical     = nullptr;  ///< Bearing angles, vertical.
+    Image* diagonal     = nullptr;  ///< Bearing angles, diagonal.
+    Image* antidiagonal = nullptr;  ///< Bearing angles, antidiagonal.
+    Image* flexion      = nullptr;  ///< Flexion image.
+    Image* max_curve    = nullptr;  ///< Max-curve image.
+
+    /// Return \c true if no result image is selected.
+    [[nodiscard]] bool empty() const noexcept {
+        return !horizontal && !vertical && !diagonal && !antidiagonal &&
+               !flexion && !max_curve;
+    }
+};
+
+/// Calculate multiple derived images of \p depth_image in one pass.
+///
+/// The bearing angle images, the flexion image and the max-curve image
+/// all operate on the 3x3 neighbourhood of each pixel. Calculating them with
+/// separate conversions reads the range image once per result. This
+/// conversion loads the neighbourhood of each pixel once and writes every
+/// selected result.
+///
+/// The results are identical to the results of \c depth_to_bearing,
+/// \c depth_to_flexion and \c depth_to_max_curve with the same models.
+///
+/// \tparam Real precision of the calculation, floating-point
+/// \tparam Intrinsic camera model that projects pixel to the unit sphere
+/// \param depth_image range image that was taken by a sensor with the
+/// calibration from \p intrinsic
+/// \param intrinsic camera model of the sensor
+/// \param out selection of result images, see \c multi_images
+/// \pre \p depth_image is not empty
+/// \pre every selected image in \p out has the dimension of \p depth_image
+/// \note Pixels without the neighbours for a result are not written. Each
+/// selected image should be initialized with 0 to get the same result as the
+/// single conversions.
+/// \sa conversion::depth_to_bearing
+/// \sa conversion::depth_to_flexion
+/// \sa conversion::depth_to_max_curve
+template <template <typename> typename Intrinsic,
+          typename Real = float,
+          typename Image>
+void depth_to_multi(const math::image<Real>&         depth_image,
+                    const Intrinsic<Real>&           intrinsic,
+                    const multi_images<Real, Image>& out) noexcept;
+
+/// Fused conversion with precomputed angles and lightrays.
+/// \param depth_image range image
+/// \param angles angles between neighbouring pixels for the bearing angles
+/// and the max-curve image
+/// \param rays lightrays of each pixel for the flexion image
+/// \param out selection of result images
+/// \sa depth_to_multi
+/// \sa bearing_angles
+/// \sa camera_models::ray_cache
+template <template <typename> typename Intrinsic,
+          typename Real = float,
+          typename Image>
+void depth_to_multi(
+    const math::image<Real>&                         depth_image,
+    const bearing_angles<Intrinsic<Real>>&           angles,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const multi_images<Real, Image>&                 out) noexcept;
+
+/// Parallel version of the fused conversion that processes the rows
+/// of the image concurrently.
+/// \param[inout] flow parallel flow type that is used to parallelize the outer
+/// for loop over all rows.
+/// \returns synchronization points before and after the calculation.
+/// \pre \p intrinsic and the selected images outlive the execution of
+/// \p flow
+/// \sa depth_to_multi
+template <template <typename> typename Intrinsic,
+          typename Real = float,
+          typename Image>
+std::pair<tf::Task, tf::Task>
+par_depth_to_multi(const math::image<Real>&         depth_image,
+                   const Intrinsic<Real>&           intrinsic,
+                   const multi_images<Real, Image>& out,
+                   tf::Taskflow&                    flow) noexcept;
+
+/// Parallel version of the fused conversion with precomputed angles and
+/// lightrays.
+/// \pre \p angles, \p rays and the selected images outlive the execution of
+/// \p flow
+/// \sa depth_to_multi
+/// \sa par_depth_to_multi
+template <template <typename> typename Intrinsic,
+          typename Real = float,
+          typename Image>
+std::pair<tf::Task, tf::Task> par_depth_to_multi(
+    const math::image<Real>&                         depth_image,
+    const bearing_angles<Intrinsic<Real>>&           angles,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const multi_images<Real, Image>&                 out,
+    tf::Taskflow&                                    flow) noexcept;
+
+namespace detail {
+
+template <typename Real, typename Image>
+inline void expect_dimension(const Image*             img,
+                             const math::image<Real>& depth_image) noexcept {
+    if (img) {
+        Expects(img->w() == depth_image.w());
+        Expects(img->h() == depth_image.h());
+    }
+}
+
+template <typename Real, typename Image>
+inline void expect_dimensions(const multi_images<Real, Image>& out,
+                              const math::image<Real>& depth_image) noexcept {
+    expect_dimension(out.horizontal, depth_image);
+    expect_dimension(out.vertical, depth_image);
+    expect_dimension(out.diagonal, depth_image);
+    expect_dimension(out.antidiagonal, depth_image);
+    expect_dimension(out.flexion, depth_image);
+    expect_dimension(out.max_curve, depth_image);
+}
+
+/// Calculate the bearing angle of \p central into \p img if it is selected
+/// and the \p prior pixel is within the image.
+template <typename Real, typename Model, typename Image>
+inline void multi_bearing_border(const math::image<Real>&      depth_image,
+                                 const Model&                  angles,
+                                 const math::pixel_coord<int>& central,
+                                 const math::pixel_coord<int>& prior,
+                                 Image*                        img) noexcept {
+    if (!img || prior.u() < 0 || prior.u() >= depth_image.w() ||
+        prior.v() < 0 || prior.v() >= depth_image.h())
+        return;
+    img->at(central) =
+        bearing_pixel(depth_image.at(central), depth_image.at(prior), angles,
+                      central, prior);
+}
+
+/// Border pixels lack neighbours, only the bearing angles with a valid prior
+/// pixel exist there.
+template <typename Real,
+          typename Horizontal,
+          typename Vertical,
+          typename Diagonal,
+          typename Antidiagonal,
+          typename Image>
+inline void multi_border(const int                        u,
+                         const int                        v,
+                         const math::image<Real>&         depth_image,
+                         const Horizontal&                horizontal,
+                         const Vertical&                  vertical,
+                         const Diagonal&                  diagonal,
+                         const Antidiagonal&              antidiagonal,
+                         const multi_images<Real, Image>& out) noexcept {
+    const math::pixel_coord<int> central{u, v};
+    multi_bearing_border(depth_image, horizontal, central,
+                         pixel<Real, direction::horizontal>{}(central),
+                         out.horizontal);
+    multi_bearing_border(depth_image, vertical, central,
+                         pixel<Real, direction::vertical>{}(central),
+                         out.vertical);
+    multi_bearing_border(depth_image, diagonal, central,
+                         pixel<Real, direction::diagonal>{}(central),
+                         out.diagonal);
+    multi_bearing_border(depth_image, antidiagonal, central,
+                         pixel<Real, direction::antidiagonal>{}(central),
+                         out.antidiagonal);
+}
+
+/// Calculate all selected results for row \p v.
+template <typename Real,
+          typename Horizontal,
+          typename Vertical,
+          typename Diagonal,
+          typename Antidiagonal,
+          typename Rays,
+          typename Image>
+inline void multi_inner(const int                        v,
+                        const math::image<Real>&         depth_image,
+                        const Horizontal&                horizontal,
+                        const Vertical&                  vertical,
+                        const Diagonal&                  diagonal,
+                        const Antidiagonal&              antidiagonal,
+                        const Rays&                      rays,
+                        const multi_images<Real, Image>& out) noexcept {
+    const int w = depth_image.w();
+
+    if (v == 0 || v == depth_image.h() - 1) {
+        for (int u = 0; u < w; ++u)
+            multi_border(u, v, depth_image, horizontal, vertical, diagonal,
+                         antidiagonal, out);
+        return;
+    }
+
+    multi_border(0, v, depth_image, horizontal, vertical, diagonal,
+                 antidiagonal, out);
+
+    for (int u = 1; u < w - 1; ++u) {
+        const neighbourhood<Real> n{depth_image, u, v};
+
+        if (out.horizontal)
+            out.horizontal->at({u, v}) =
+                bearing_pixel(n.d__0__0, n.d__0__1, horizontal, {u, v},
+                              {u - 1, v});
+        if (out.vertical)
+            out.vertical->at({u, v}) = bearing_pixel(
+                n.d__0__0, n.d__1__0, vertical, {u, v}, {u, v - 1});
+        if (out.diagonal)
+            out.diagonal->at({u, v}) = bearing_pixel(
+                n.d__0__0, n.d__1__1, diagonal, {u, v}, {u - 1, v - 1});
+        if (out.antidiagonal)
+            out.antidiagonal->at({u, v}) =
+                bearing_pixel(n.d__0__0, n.d_1__1, antidiagonal, {u, v},
+                              {u - 1, v + 1});
+        if (out.flexion)
+            out.flexion->at({u, v}) = flexion_pixel(rays, u, v, n);
+        if (out.max_curve)
+            out.max_curve->at({u, v}) = max_curve_pixel(
+                u, v, n, horizontal, vertical, diagonal, antidiagonal);
+    }
+
+    if (w > 1)
+        multi_border(w - 1, v, depth_image, horizontal, vertical, diagonal,
+                     antidiagonal, out);
+}
+}  // namespace detail
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename Image>
+inline void depth_to_multi(const math::image<Real>&         depth_image,
+                           const Intrinsic<Real>&           intrinsic,
+                           const multi_images<Real, Image>& out) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == intrinsic.w());
+    Expects(depth_image.h() == intrinsic.h());
+    detail::expect_dimensions(out, depth_image);
+
+    for (int v = 0; v < depth_image.h(); ++v)
+        detail::multi_inner(v, depth_image, intrinsic, intrinsic, intrinsic,
+                            intrinsic, intrinsic, out);
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename Image>
+inline void depth_to_multi(
+    const math::image<Real>&                         depth_image,
+    const bearing_angles<Intrinsic<Real>>&           angles,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const multi_images<Real, Image>&                 out) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+    detail::expect_dimensions(out, depth_image);
+
+    for (int v = 0; v < depth_image.h(); ++v)
+        detail::multi_inner(v, depth_image, angles.horizontal, angles.vertical,
+                            angles.diagonal, angles.antidiagonal, rays, out);
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename Image>
+inline std::pair<tf::Task, tf::Task>
+par_depth_to_multi(const math::image<Real>&         depth_image,
+                   const Intrinsic<Real>&           intrinsic,
+                   const multi_images<Real, Image>& out,
+                   tf::Taskflow&                    flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == intrinsic.w());
+    Expects(depth_image.h() == intrinsic.h());
+    detail::expect_dimensions(out, depth_image);
+
+    auto sync_points = flow.parallel_for(
+        0, depth_image.h(), 1, [&depth_image, &intrinsic, out](int v) noexcept {
+            detail::multi_inner(v, depth_image, intrinsic, intrinsic,
+                                intrinsic, intrinsic, intrinsic, out);
+        });
+
+    return sync_points;
+}
+
+template <template <typename> typename Intrinsic,
+          typename Real,
+          typename Image>
+inline std::pair<tf::Task, tf::Task> par_depth_to_multi(
+    const math::image<Real>&                         depth_image,
+    const bearing_angles<Intrinsic<Real>>&           angles,
+    const camera_models::ray_cache<Intrinsic<Real>>& rays,
+    const multi_images<Real, Image>&                 out,
+    tf::Taskflow&                                    flow) noexcept {
+    static_assert(camera_models::is_intrinsic_v<Intrinsic, Real>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Expects(depth_image.w() == angles.horizontal.w());
+    Expects(depth_image.h() == angles.horizontal.h());
+    Expects(depth_image.w() == rays.w());
+    Expects(depth_image.h() == rays.h());
+    detail::expect_dimensions(out, depth_image);
+
+    auto sync_points = flow.parallel_for(
+        0, depth_image.h(), 1,
+        [&depth_image, &angles, &rays, out](int v) noexcept {
+            detail::multi_inner(v, depth_image, angles.horizontal,
+                                angles.vertical, angles.diagonal,
+                                angles.antidiagonal, rays, out);
+        });
+
+    return sync_points;
+}
+
+}  // namespace sens_loc::conversion
+
+#endif /* end of include guard: DEPTH_TO_MULTI_H_J5RDX2QE */
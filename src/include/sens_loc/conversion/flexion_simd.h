@@ -0,0 +1,273 @@
+#ifndef FLEXION_SIMD_H_W2NC7KDU
+#define FLEXION_SIMD_H_W2NC7KDU
+
+#include <gsl/gsl>
+#include <sens_loc/camera_models/ray_cache.h>
+#include <sens_loc/math/image.h>
+#include <sens_loc/util/simd.h>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) &&        \
+    (defined(SENS_LOC_SIMD_SSE42) || defined(SENS_LOC_SIMD_AVX2))
+#define SENS_LOC_FLEXION_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace sens_loc::conversion::detail {
+
+/// Vectorized flexion kernels for single precision images.
+///
+/// The kernels calculate exactly the same operations as \c flexion_inner, but
+/// for 4 (SSE4.2) or 8 (AVX2) consecutive pixels of a row at once. The rays
+/// are read from the structure-of-arrays storage of the
+/// \c camera_models::ray_cache.
+///
+/// The results are not bit-identical to the scalar implementation, because
+/// the compiler might order the floating point operations differently.
+/// The absolute difference per pixel is below \c flexion_simd_tolerance,
+/// which is far below the resolution of the 16-bit flexion images.
+constexpr float flexion_simd_tolerance = 1e-5F;
+
+#ifdef SENS_LOC_FLEXION_SIMD
+
+#define SENS_LOC_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define SENS_LOC_TARGET_AVX2 __attribute__((target("avx2")))
+
+/// Pointers to the depth values and ray components of one image row.
+struct flexion_row_data {
+    template <typename Intrinsic>
+    flexion_row_data(const math::image<float>&                  depth_image,
+                     const camera_models::ray_cache<Intrinsic>& rays,
+                     int                                        v) noexcept
+        : d{depth_image.data().template ptr<float>(v)}
+        , Xs{rays.row_Xs(v).data()}
+        , Ys{rays.row_Ys(v).data()}
+        , Zs{rays.row_Zs(v).data()} {}
+
+    const float* d;
+    const float* Xs;
+    const float* Ys;
+    const float* Zs;
+};
+
+struct vec3_sse {
+    __m128 x;
+    __m128 y;
+    __m128 z;
+};
+
+/// Backproject the pixels [u, u + lanes) of \p row into camera coordinates.
+SENS_LOC_TARGET_SSE42 inline vec3_sse point_sse(const flexion_row_data& row,
+                                                int                     u) {
+    const __m128 depth = _mm_loadu_ps(row.d + u);
+    return {_mm_mul_ps(depth, _mm_loadu_ps(row.Xs + u)),
+            _mm_mul_ps(depth, _mm_loadu_ps(row.Ys + u)),
+            _mm_mul_ps(depth, _mm_loadu_ps(row.Zs + u))};
+}
+
+SENS_LOC_TARGET_SSE42 inline vec3_sse sub_sse(const vec3_sse& a,
+                                              const vec3_sse& b) {
+    return {_mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z)};
+}
+
+SENS_LOC_TARGET_SSE42 inline __m128 dot_sse(const vec3_sse& a,
+                                            const vec3_sse& b) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)),
+                      _mm_mul_ps(a.z, b.z));
+}
+
+/// Same semantic as \c Eigen::normalized, null vectors stay untouched.
+SENS_LOC_TARGET_SSE42 inline vec3_sse normalized_sse(const vec3_sse& a) {
+    const __m128 sq_norm = dot_sse(a, a);
+    const __m128 valid   = _mm_cmpgt_ps(sq_norm, _mm_setzero_ps());
+    const __m128 norm =
+        _mm_blendv_ps(_mm_set1_ps(1.F), _mm_sqrt_ps(sq_norm), valid);
+    return {_mm_div_ps(a.x, norm), _mm_div_ps(a.y, norm),
+            _mm_div_ps(a.z, norm)};
+}
+
+SENS_LOC_TARGET_SSE42 inline vec3_sse cross_sse(const vec3_sse& a,
+                                                const vec3_sse& b) {
+    return {_mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+            _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+            _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x))};
+}
+
+/// Calculate the flexion for the pixels of row \p v in blocks of 4.
+/// \returns the first column that was not processed.
+template <typename Intrinsic>
+SENS_LOC_TARGET_SSE42 inline int
+flexion_row_sse42(int                                        v,
+                  const math::image<float>&                  depth_image,
+                  const camera_models::ray_cache<Intrinsic>& rays,
+                  float*                                     result) noexcept {
+    constexpr int lanes = 4;
+    const int     w     = depth_image.w();
+
+    const flexion_row_data above{depth_image, rays, v - 1};
+    const flexion_row_data center{depth_image, rays, v};
+    const flexion_row_data below{depth_image, rays, v + 1};
+
+    const __m128 sign_mask = _mm_set1_ps(-0.F);
+    const __m128 zero      = _mm_setzero_ps();
+    const __m128 one       = _mm_set1_ps(1.F);
+
+    int u = 1;
+    // The last block reads the depth at 'u + lanes' which must be in the image.
+    for (; u + lanes < w; u += lanes) {
+        const vec3_sse dir0 =
+            sub_sse(point_sse(below, u), point_sse(above, u));
+        const vec3_sse dir1 =
+            sub_sse(point_sse(center, u + 1), point_sse(center, u - 1));
+        const vec3_sse dir2 =
+            sub_sse(point_sse(below, u - 1), point_sse(above, u + 1));
+        const vec3_sse dir3 =
+            sub_sse(point_sse(below, u + 1), point_sse(above, u - 1));
+
+        const vec3_sse cross0 =
+            cross_sse(normalized_sse(dir0), normalized_sse(dir1));
+        const vec3_sse cross1 =
+            cross_sse(normalized_sse(dir2), normalized_sse(dir3));
+
+        const __m128 flexion =
+            _mm_andnot_ps(sign_mask, dot_sse(cross0, cross1));
+        _mm_storeu_ps(result + u, _mm_min_ps(_mm_max_ps(flexion, zero), one));
+    }
+    return u;
+}
+
+struct vec3_avx {
+    __m256 x;
+    __m256 y;
+    __m256 z;
+};
+
+/// Backproject the pixels [u, u + lanes) of \p row into camera coordinates.
+SENS_LOC_TARGET_AVX2 inline vec3_avx point_avx(const flexion_row_data& row,
+                                               int                     u) {
+    const __m256 depth = _mm256_loadu_ps(row.d + u);
+    return {_mm256_mul_ps(depth, _mm256_loadu_ps(row.Xs + u)),
+            _mm256_mul_ps(depth, _mm256_loadu_ps(row.Ys + u)),
+            _mm256_mul_ps(depth, _mm256_loadu_ps(row.Zs + u))};
+}
+
+SENS_LOC_TARGET_AVX2 inline vec3_avx sub_avx(const vec3_avx& a,
+                                             const vec3_avx& b) {
+    return {_mm256_sub_ps(a.x, b.x), _mm256_sub_ps(a.y, b.y),
+            _mm256_sub_ps(a.z, b.z)};
+}
+
+SENS_LOC_TARGET_AVX2 inline __m256 dot_avx(const vec3_avx& a,
+                                           const vec3_avx& b) {
+    return _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(a.x, b.x), _mm256_mul_ps(a.y, b.y)),
+        _mm256_mul_ps(a.z, b.z));
+}
+
+/// Same semantic as \c Eigen::normalized, null vectors stay untouched.
+SENS_LOC_TARGET_AVX2 inline vec3_avx normalized_avx(const vec3_avx& a) {
+    const __m256 sq_norm = dot_avx(a, a);
+    const __m256 valid =
+        _mm256_cmp_ps(sq_norm, _mm256_setzero_ps(), _CMP_GT_OQ);
+    const __m256 norm =
+        _mm256_blendv_ps(_mm256_set1_ps(1.F), _mm256_sqrt_ps(sq_norm), valid);
+    return {_mm256_div_ps(a.x, norm), _mm256_div_ps(a.y, norm),
+            _mm256_div_ps(a.z, norm)};
+}
+
+SENS_LOC_TARGET_AVX2 inline vec3_avx cross_avx(const vec3_avx& a,
+                                               const vec3_avx& b) {
+    return {_mm256_sub_ps(_mm256_mul_ps(a.y, b.z), _mm256_mul_ps(a.z, b.y)),
+            _mm256_sub_ps(_mm256_mul_ps(a.z, b.x), _mm256_mul_ps(a.x, b.z)),
+            _mm256_sub_ps(_mm256_mul_ps(a.x, b.y), _mm256_mul_ps(a.y, b.x))};
+}
+
+/// Calculate the flexion for the pixels of row \p v in blocks of 8.
+/// \returns the first column that was not processed.
+template <typename Intrinsic>
+SENS_LOC_TARGET_AVX2 inline int
+flexion_row_avx2(int                                        v,
+                 const math::image<float>&                  depth_image,
+                 const camera_models::ray_cache<Intrinsic>& rays,
+                 float*                                     result) noexcept {
+    constexpr int lanes = 8;
+    const int     w     = depth_image.w();
+
+    const flexion_row_data above{depth_image, rays, v - 1};
+    const flexion_row_data center{depth_image, rays, v};
+    const flexion_row_data below{depth_image, rays, v + 1};
+
+    const __m256 sign_mask = _mm256_set1_ps(-0.F);
+    const __m256 zero      = _mm256_setzero_ps();
+    const __m256 one       = _mm256_set1_ps(1.F);
+
+    int u = 1;
+    // The last block reads the depth at 'u + lanes' which must be in the image.
+    for (; u + lanes < w; u += lanes) {
+        const vec3_avx dir0 =
+            sub_avx(point_avx(below, u), point_avx(above, u));
+        const vec3_avx dir1 =
+            sub_avx(point_avx(center, u + 1), point_avx(center, u - 1));
+        const vec3_avx dir2 =
+            sub_avx(point_avx(below, u - 1), point_avx(above, u + 1));
+        const vec3_avx dir3 =
+            sub_avx(point_avx(below, u + 1), point_avx(above, u - 1));
+
+        const vec3_avx cross0 =
+            cross_avx(normalized_avx(dir0), normalized_avx(dir1));
+        const vec3_avx cross1 =
+            cross_avx(normalized_avx(dir2), normalized_avx(dir3));
+
+        const __m256 flexion =
+            _mm256_andnot_ps(sign_mask, dot_avx(cross0, cross1));
+        _mm256_storeu_ps(result + u,
+                         _mm256_min_ps(_mm256_max_ps(flexion, zero), one));
+    }
+    return u;
+}
+
+#undef SENS_LOC_TARGET_SSE42
+#undef SENS_LOC_TARGET_AVX2
+
+#endif  // SENS_LOC_FLEXION_SIMD
+
+/// Calculate the flexion of row \p v with the best kernel for \p level.
+/// Only single precision images are vectorized.
+/// \returns the first column that still needs to be processed by the scalar
+/// implementation.
+template <typename Intrinsic, typename Real>
+inline int
+flexion_row_simd(int                                        v,
+                 const math::image<Real>&                   depth_image,
+                 const camera_models::ray_cache<Intrinsic>& rays,
+                 Real*                                      result,
+                 util::simd_level                           level) noexcept {
+#ifdef SENS_LOC_FLEXION_SIMD
+    if constexpr (std::is_same_v<Real, float>) {
+        Expects(v >= 1);
+        Expects(v < depth_image.h() - 1);
+
+        switch (level) {
+#ifdef SENS_LOC_SIMD_AVX2
+        case util::simd_level::avx2:
+            return flexion_row_avx2(v, depth_image, rays, result);
+#endif
+#ifdef SENS_LOC_SIMD_SSE42
+        case util::simd_level::sse42:
+            return flexion_row_sse42(v, depth_image, rays, result);
+#endif
+        default: break;
+        }
+    }
+#endif
+    (void) v;
+    (void) depth_image;
+    (void) rays;
+    (void) result;
+    (void) level;
+    return 1;
+}
+
+}  // namespace sens_loc::conversion::detail
+
+#endif /* end of include guard: FLEXION_SIMD_H_W2NC7KDU */
@@ -1,11 +1,18 @@
 #ifndef UTIL_H_QNW3WCZL
 #define UTIL_H_QNW3WCZL
 
+#include <cmath>
 #include <opencv2/core/mat.hpp>
+#include <opencv2/core/saturate.hpp>
+#include <sens_loc/camera_models/angle_table.h>
 #include <sens_loc/camera_models/equirectangular.h>
 #include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/camera_models/ray_cache.h>
+#include <sens_loc/camera_models/utility.h>
 #include <sens_loc/math/coordinate.h>
+#include <sens_loc/math/image.h>
 #include <type_traits>
+#include <utility>
 
 namespace sens_loc {
 
@@ -26,8 +33,131 @@ enum class direction {
                    ///< direction (bottom-left to top-right).
 };
 
+/// Linear transformation of the calculated values of a conversion into the
+/// range of an image type.
+///
+/// Each value is transformed to
+/// \f$pixel = saturate(value \cdot scale + offset)\f$, which is the same
+/// operation as \c cv::Mat::convertTo.
+/// \tparam PixelType target type of the image, arithmetic
+/// \tparam Real type of the calculated values, floating-point
+/// \sa quantized_image
+template <typename PixelType, typename Real>
+struct quantization {
+    static_assert(std::is_arithmetic_v<PixelType>);
+    static_assert(std::is_floating_point_v<Real>);
+
+    Real scale  = Real(1.);
+    Real offset = Real(0.);
+
+    /// Transform \p value into the target range, rounding to the nearest
+    /// representable value.
+    [[nodiscard]] PixelType operator()(Real value) const noexcept {
+        return cv::saturate_cast<PixelType>(value * scale + offset);
+    }
+};
+
+/// Image of \p PixelType that quantizes the results of a conversion while
+/// they are written.
+///
+/// The conversion kernels store each result with \c out.at(p) = value.
+/// This class provides the same interface and applies the \p Quantizer
+/// immediately. No intermediate floating-point image needs to be created and
+/// converted afterwards.
+/// If a \c mask is given, pixels without depth in the mask are always 0.
+///
+/// \tparam Quantizer callable that maps a \p Real to a \p PixelType
+/// \note The referenced images must outlive this object.
+/// \sa quantization
+template <typename PixelType,
+          typename Real,
+          typename Quantizer = quantization<PixelType, Real>>
+class quantized_image {
+  public:
+    /// Proxy for a single pixel that quantizes assigned values.
+    class pixel_ref {
+      public:
+        pixel_ref(PixelType& pixel, const Quantizer& q, bool valid) noexcept
+            : _pixel{pixel}
+            , _q{q}
+            , _valid{valid} {}
+
+        pixel_ref& operator=(Real value) noexcept {
+            _pixel = _valid ? _q(value) : PixelType(0);
+            return *this;
+        }
+
+      private:
+        PixelType&       _pixel;
+        const Quantizer& _q;
+        bool             _valid;
+    };
+
+    /// \param image target image, its size defines the size of the result
+    /// \param q transformation that is applied to each result
+    /// \param mask optional depth image, pixels with zero depth are set to 0
+    /// \pre \p mask has the same dimension as \p image
+    quantized_image(math::image<PixelType>&  image,
+                    Quantizer                q,
+                    const math::image<Real>* mask = nullptr) noexcept
+        : _image{image}
+        , _q{std::move(q)}
+        , _mask{mask} {
+        Expects(!_mask || _mask->w() == _image.w());
+        Expects(!_mask || _mask->h() == _image.h());
+    }
+
+    [[nodiscard]] int w() const noexcept { return _image.w(); }
+    [[nodiscard]] int h() const noexcept { return _image.h(); }
+
+    [[nodiscard]] const Quantizer& q() const noexcept { return _q; }
+
+    /// Return a proxy that quantizes the values assigned to the pixel \p p.
+    [[nodiscard]] pixel_ref at(const math::pixel_coord<int>& p) noexcept {
+        return pixel_ref(_image.at(p), _q, valid(p));
+    }
+
+    /// Set each pixel to the quantized value of 0. Pixels without depth in
+    /// the mask are set to 0.
+    /// The kernels do not write border pixels, this function gives them the
+    /// same value as the conversion of a zero-initialized real image.
+    void clear() noexcept {
+        for (int v = 0; v < h(); ++v)
+            clear_row(v);
+    }
+
+    /// Same as \c clear for the pixels of row \p v only. The parallel
+    /// conversions clear each row in the task that calculates it.
+    /// \pre 0 <= \p v < \c h()
+    void clear_row(int v) noexcept {
+        Expects(v >= 0 && v < h());
+        const PixelType zero = _q(Real(0.));
+        for (int u = 0; u < w(); ++u)
+            _image.at({u, v}) = valid({u, v}) ? zero : PixelType(0);
+    }
+
+  private:
+    [[nodiscard]] bool valid(const math::pixel_coord<int>& p) const noexcept {
+        return !_mask || _mask->at(p) != Real(0.);
+    }
+
+    math::image<PixelType>&  _image;
+    Quantizer                _q;
+    const math::image<Real>* _mask;
+};
+
 namespace detail {
 
+/// Create an image of \p PixelType with the dimension of \p depth_image
+/// that will hold the quantized results of a conversion.
+template <typename PixelType, typename Real>
+inline math::image<PixelType>
+quantized_target(const math::image<Real>& depth_image) noexcept {
+    cv::Mat img(depth_image.h(), depth_image.w(),
+                math::detail::get_opencv_type<PixelType>());
+    return math::image<PixelType>(std::move(img));
+}
+
 /// Convert the orthografic depth of a pixel into the euclidian distance
 /// suggested by the pinhole model.
 template <typename Real = float, typename PixelType = ushort>
@@ -66,6 +196,118 @@ inline Real orthografic_to_euclidian(
     return d;
 }
 
+/// Convert the orthografic depth of a pixel into the euclidian distance with
+/// the precomputed lightray of the pixel.
+///
+/// The \f$Z_s\f$-component of the unit ray is the cosine between the ray and
+/// the optical axis, which is exactly the ratio of orthografic and euclidian
+/// depth.
+template <typename Real = float, typename PixelType = ushort>
+inline Real orthografic_to_euclidian(
+    math::pixel_coord<int>                                        p,
+    PixelType                                                     d,
+    const camera_models::ray_cache<camera_models::pinhole<Real>>& rays)
+    noexcept {
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    if (d == 0)
+        return Real(0.);
+
+    Expects(d > PixelType(0));
+
+    const Real cos_axis = rays.pixel_to_sphere(p).Zs();
+    Expects(cos_axis > Real(0.));
+
+    const Real euclid_distance = Real(d) / cos_axis;
+    Ensures(euclid_distance >= Real(d));
+
+    return euclid_distance;
+}
+
+template <typename Real = float, typename PixelType = ushort>
+inline Real orthografic_to_euclidian(
+    // NOLINTNEXTLINE(performance-unnecessary-value-param)
+    math::pixel_coord<int> /*unused*/,
+    PixelType d,
+    const camera_models::ray_cache<camera_models::equirectangular<Real>>&
+    /*unused*/) noexcept {
+    static_assert(std::is_floating_point_v<Real>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    return d;
+}
+
+/// Calculate the angle between the lightrays of \p p1 and \p p2 with the
+/// camera model.
+/// \sa camera_models::phi
+template <template <typename> typename Intrinsic, typename Real>
+inline Real ray_angle(const Intrinsic<Real>&        intrinsic,
+                      const math::pixel_coord<int>& p1,
+                      const math::pixel_coord<int>& p2) noexcept {
+    return camera_models::phi(intrinsic, p1, p2);
+}
+
+/// Lookup the precomputed angle between the lightrays of \p p1 and \p p2.
+template <typename Intrinsic>
+inline typename Intrinsic::real_type
+ray_angle(const camera_models::angle_table<Intrinsic>& angles,
+          const math::pixel_coord<int>&                p1,
+          const math::pixel_coord<int>&                p2) noexcept {
+    return angles.phi(p1, p2);
+}
+
+/// Calculate the cosine of the angle between the lightrays of \p p1 and
+/// \p p2 with the camera model.
+template <template <typename> typename Intrinsic, typename Real>
+inline Real cos_ray_angle(const Intrinsic<Real>&        intrinsic,
+                          const math::pixel_coord<int>& p1,
+                          const math::pixel_coord<int>& p2) noexcept {
+    return std::cos(camera_models::phi(intrinsic, p1, p2));
+}
+
+/// Lookup the precomputed cosine of the angle between the lightrays of \p p1
+/// and \p p2.
+template <typename Intrinsic>
+inline typename Intrinsic::real_type
+cos_ray_angle(const camera_models::angle_table<Intrinsic>& angles,
+              const math::pixel_coord<int>&                p1,
+              const math::pixel_coord<int>&                p2) noexcept {
+    return angles.cos_phi(p1, p2);
+}
+
+/// Depth values of the 3x3 neighbourhood around the pixel (u, v).
+///
+/// The names of the members follow the naming of the conversions,
+/// \c d_<row>_<column> with \c __1 as previous, \c __0 as same and \c _1 as
+/// next row or column relative to the central pixel.
+/// Loading the whole neighbourhood once allows calculating multiple derived
+/// values for a pixel without accessing the image again.
+/// \pre (u, v) is not a border pixel of \p depth_image
+template <typename Real>
+struct neighbourhood {
+    neighbourhood(const math::image<Real>& depth_image, int u, int v) noexcept
+        : d__1__1{depth_image.at({u - 1, v - 1})}
+        , d__1__0{depth_image.at({u, v - 1})}
+        , d__1_1{depth_image.at({u + 1, v - 1})}
+        , d__0__1{depth_image.at({u - 1, v})}
+        , d__0__0{depth_image.at({u, v})}
+        , d__0_1{depth_image.at({u + 1, v})}
+        , d_1__1{depth_image.at({u - 1, v + 1})}
+        , d_1__0{depth_image.at({u, v + 1})}
+        , d_1_1{depth_image.at({u + 1, v + 1})} {}
+
+    Real d__1__1;
+    Real d__1__0;
+    Real d__1_1;
+    Real d__0__1;
+    Real d__0__0;
+    Real d__0_1;
+    Real d_1__1;
+    Real d_1__0;
+    Real d_1_1;
+};
+
 /// Return the scaling factor for bearing angle conversion.
 template <typename Real, typename PixelType>
 inline constexpr std::pair<Real, Real> scaling_factor(Real max_angle) {
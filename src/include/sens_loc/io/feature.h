@@ -1,29 +1,128 @@
 #ifndef FEATURE_H_9IGYEWVQ
 #define FEATURE_H_9IGYEWVQ
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <opencv2/core/mat.hpp>
 #include <opencv2/core/persistence.hpp>
+#include <opencv2/core/types.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace sens_loc::io {
 
-inline cv::FileStorage open_feature_file(const std::string& f_path) {
-    using cv::FileStorage;
-    const FileStorage fs{f_path, FileStorage::READ | FileStorage::FORMAT_YAML};
-    return fs;
+/// File formats of the feature files.
+enum class feature_format {
+    yaml,    ///< Text format of \c cv::FileStorage, optionally compressed.
+    binary,  ///< Memory-mappable binary format, \sa feature_header
+};
+
+/// \returns the format of a feature file written to \p path.
+/// Files with the extensions ".yml", ".yaml" and ".gz" are written as YAML,
+/// all other files, e.g. ".feature", in the binary format.
+feature_format feature_format_for(std::string_view path) noexcept;
+
+/// Fixed size header at the beginning of a binary feature file.
+///
+/// The file has the following layout. All numbers are stored in the byte
+/// order of the host that wrote the file and each section is aligned to 64
+/// bytes. The version does not match on hosts with a different byte order,
+/// so these files are rejected.
+/// ```
+/// feature_header
+/// source path      (source_size bytes, not null-terminated)
+/// keypoints        (keypoint_count elements of each array in this order:
+///                   x, y, size, angle, response as float,
+///                   octave, class_id as int32)
+/// descriptors      (descriptor_rows rows with descriptor_cols elements of
+///                   the single channel OpenCV type descriptor_type,
+///                   row-major)
+/// ```
+/// The arrays of the keypoints (structure of arrays) and the contiguous
+/// descriptor rows are read with single copies. Each section is only touched
+/// if it is loaded.
+struct feature_header {
+    char          magic[4]           = {'S', 'F', 'E', 'A'};
+    std::uint32_t version            = 1;
+    std::uint32_t keypoint_count     = 0;
+    std::uint32_t descriptor_rows    = 0;
+    std::uint32_t descriptor_cols    = 0;
+    std::int32_t  descriptor_type    = 0;
+    std::uint32_t source_size        = 0;
+    std::uint32_t reserved           = 0;
+    std::uint64_t source_offset      = 0;
+    std::uint64_t keypoints_offset   = 0;
+    std::uint64_t descriptors_offset = 0;
+};
+static_assert(sizeof(feature_header) == 56);
+
+/// Read access to a feature file in either format.
+///
+/// Binary files are memory-mapped and only the requested sections are read.
+/// All other files are parsed as YAML with \c cv::FileStorage, which keeps
+/// the files of older versions readable.
+/// \sa feature_header, write_features
+class feature_file {
+  public:
+    /// Open the feature file \p path. The format is detected by the content
+    /// of the file.
+    /// \throws std::runtime_error if a binary file is corrupted.
+    /// \note A file that can not be opened is parsed as YAML and contains
+    /// no data, like with \c cv::FileStorage.
+    explicit feature_file(const std::string& path);
+
+    feature_file(const feature_file&) = delete;
+    feature_file(feature_file&& other) noexcept;
+    feature_file& operator=(const feature_file&) = delete;
+    feature_file& operator=(feature_file&& other) noexcept;
+    ~feature_file();
+
+    /// \returns \c false if the file could not be opened.
+    [[nodiscard]] bool is_open() const noexcept {
+        return _data != nullptr || _yaml->isOpened();
+    }
+    [[nodiscard]] feature_format format() const noexcept {
+        return _data != nullptr ? feature_format::binary
+                                : feature_format::yaml;
+    }
+
+    /// Path of the image the features were detected on, may be empty.
+    [[nodiscard]] std::string source_path() const;
+    [[nodiscard]] std::vector<cv::KeyPoint> keypoints() const;
+    [[nodiscard]] cv::Mat                   descriptors() const;
+
+  private:
+    /// Check the header and the sections against the size of the file.
+    [[nodiscard]] bool valid() const noexcept;
+
+    const uchar*                     _data = nullptr;
+    std::size_t                      _size = 0;
+    feature_header                   _header;
+    std::unique_ptr<cv::FileStorage> _yaml;
+};
+
+/// Write the features of one image to \p path in the format
+/// \c feature_format_for(path).
+/// \param source_path path of the image the features were detected on
+/// \returns \c false if the file could not be written, e.g. because the
+/// binary format requires single channel descriptors.
+bool write_features(const std::string&               path,
+                    std::string_view                 source_path,
+                    const std::vector<cv::KeyPoint>& keypoints,
+                    const cv::Mat&                   descriptors);
+
+inline feature_file open_feature_file(const std::string& f_path) {
+    return feature_file{f_path};
 }
 
-inline std::vector<cv::KeyPoint> load_keypoints(const cv::FileStorage& fs) {
-    const cv::FileNode        descriptors_node = fs["keypoints"];
-    std::vector<cv::KeyPoint> k;
-    cv::read(descriptors_node, k);
-    return k;
+inline std::vector<cv::KeyPoint> load_keypoints(const feature_file& f) {
+    return f.keypoints();
 }
 
-inline cv::Mat load_descriptors(const cv::FileStorage& fs) {
-    const cv::FileNode descriptors_node = fs["descriptors"];
-    cv::Mat            d;
-    cv::read(descriptors_node, d);
-    return d;
+inline cv::Mat load_descriptors(const feature_file& f) {
+    return f.descriptors();
 }
 
 }  // namespace sens_loc::io
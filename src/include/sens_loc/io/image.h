@@ -1,12 +1,19 @@
 #ifndef IMAGE_H_WIIAQPH0
 #define IMAGE_H_WIIAQPH0
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <gsl/gsl>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include <optional>
 #include <sens_loc/math/image.h>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace sens_loc {
 
@@ -30,6 +37,103 @@ std::optional<math::image<PixelType>> load_image(Arg&&... args) {
     return {math::image<PixelType>(std::move(result))};
 }
 
+/// Load the image \p name into \p target and reuse the memory of \p target
+/// and \p file_buffer.
+///
+/// The file is read into \p file_buffer and decoded into \p target.
+/// A new image is only allocated if \p target is empty or has a different
+/// dimension than the image in the file. Loading a sequence of images with the
+/// same dimension does not allocate after the first image.
+/// \param name,flags same as for \c cv::imread
+/// \param[inout] file_buffer storage for the encoded file content
+/// \param[inout] target decoded image
+/// \returns \c false if the file can not be read or decoded or does not
+/// contain pixels of \p PixelType, \p target is unspecified in that case.
+template <typename PixelType>
+bool load_image(const std::string&      name,
+                int                     flags,
+                std::vector<uchar>&     file_buffer,
+                math::image<PixelType>& target) {
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    std::ifstream file(name, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    const std::streamsize size = file.tellg();
+    if (size <= 0)
+        return false;
+    file_buffer.resize(gsl::narrow_cast<std::size_t>(size));
+    file.seekg(0);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!file.read(reinterpret_cast<char*>(file_buffer.data()), size))
+        return false;
+
+    // 'result' shares the memory of 'target'. 'cv::imdecode' only allocates
+    // if the decoded image does not fit into it.
+    cv::Mat result = target.data();
+    cv::imdecode(file_buffer, flags, &result);
+    if (result.data == nullptr)
+        return false;
+    if (result.type() != math::detail::get_opencv_type<PixelType>())
+        return false;
+
+    target = std::move(result);
+    return true;
+}
+
+namespace detail {
+/// Return \c true if \p file_name ends with \p extension, ignoring the case.
+inline bool has_extension(std::string_view file_name,
+                          std::string_view extension) noexcept {
+    if (file_name.size() < extension.size())
+        return false;
+    return std::equal(extension.begin(), extension.end(),
+                      file_name.end() - extension.size(),
+                      [](char e, char f) {
+                          return e == std::tolower(static_cast<uchar>(f));
+                      });
+}
+}  // namespace detail
+
+/// Return the parameters for \c cv::imwrite and \c cv::imencode that select
+/// the compression for the codec of \p file_name.
+///
+/// OpenCV chooses the codec by the file extension. Encoding is usually the
+/// most expensive step of a conversion and PNG spends most of it in zlib.
+/// The lossless containers ".pgm" (a header followed by the raw pixels) and
+/// uncompressed ".tif" support 16-bit images as well and trade disk space for
+/// encoding speed.
+///
+/// \param file_name output file, only its extension is relevant
+/// \param compression zlib level in [0, 9] for ".png", \c 0 disables the
+/// compression of ".tif" and ".tiff". Negative values keep the default of the
+/// codec. Other codecs ignore the compression.
+/// \returns parameter list in the form \c {flag, value, ...}
+inline std::vector<int> write_parameters(std::string_view file_name,
+                                         int              compression) {
+    if (compression < 0)
+        return {};
+
+    if (detail::has_extension(file_name, ".png"))
+        return {cv::IMWRITE_PNG_COMPRESSION, std::min(compression, 9)};
+
+    // The TIFF-codec has no levels, it can only switch the compression off.
+    if (compression == 0 && (detail::has_extension(file_name, ".tif") ||
+                             detail::has_extension(file_name, ".tiff")))
+        return {cv::IMWRITE_TIFF_COMPRESSION, /*COMPRESSION_NONE=*/1};
+
+    return {};
+}
+
+/// Write \p image to \p name with the codec for the file extension of
+/// \p name and the compression level \p compression.
+/// \sa write_parameters
+/// \returns \c true on success
+inline bool
+write_image(const std::string& name, const cv::Mat& image, int compression) {
+    return cv::imwrite(name, image, write_parameters(name, compression));
+}
+
 /// Expects to load a 16bit grayscale image.
 /// It converts those images to 8bit grayscale images that will be processed.
 inline std::optional<math::image<uchar>>
@@ -0,0 +1,89 @@
+#ifndef MANIFEST_H_W7DJ3QPE
+#define MANIFEST_H_W7DJ3QPE
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sens_loc/util/thread_analysis.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sens_loc::io {
+
+/// Record of the finished indices of a batch and their output files.
+///
+/// The manifest is a text file that is kept next to the outputs of a batch.
+/// Its first line identifies the configuration of the tool with a hash, e.g.
+/// of its command line options. Each finished index appends one line with
+/// its output files, so that an interrupted batch keeps the record of all
+/// indices it finished.
+/// ```
+/// sens_loc-manifest <tab> 1 <tab> <hash in hex>
+/// <index> <tab> <output> <tab> <output> ...
+/// ```
+///
+/// An index is up to date if
+/// - the manifest was created with the same configuration,
+/// - a record of the index exists and
+/// - all its outputs exist and are not older than its input and the
+///   dependencies of the batch, e.g. the calibration file.
+///
+/// \note \c up_to_date and \c record may be called concurrently.
+class batch_manifest {
+  public:
+    /// Open the manifest \p path for a batch with the configuration
+    /// \p configuration. The records of a manifest with another configuration
+    /// are discarded. The manifest is created if it does not exist.
+    /// \param dependencies files that all outputs depend on besides their
+    /// input
+    /// \returns \c nullptr if the manifest can not be written.
+    static std::unique_ptr<batch_manifest>
+    open(const std::string&       path,
+         std::string_view         configuration,
+         std::vector<std::string> dependencies = {}) noexcept;
+
+    batch_manifest(const batch_manifest&) = delete;
+    batch_manifest(batch_manifest&&)      = delete;
+    batch_manifest& operator=(const batch_manifest&) = delete;
+    batch_manifest& operator=(batch_manifest&&) = delete;
+    ~batch_manifest()                           = default;
+
+    /// \returns \c true if the outputs of \p idx are up to date with its
+    /// \p input file.
+    [[nodiscard]] bool up_to_date(int idx, const std::string& input) const
+        noexcept;
+
+    /// Record that \p idx finished with the files \p outputs.
+    /// The record is written immediately.
+    /// \returns \c false if the manifest could not be written.
+    [[nodiscard]] bool record(int                             idx,
+                              const std::vector<std::string>& outputs) noexcept;
+
+    /// \returns the hash of \p configuration that identifies the manifest.
+    static std::uint64_t hash(std::string_view configuration) noexcept;
+
+    /// \returns the modification time of \p file in nanoseconds since the
+    /// epoch or \c std::nullopt if the file does not exist.
+    static std::optional<std::int64_t>
+    modification_time(const std::string& file) noexcept;
+
+  private:
+    batch_manifest() = default;
+
+    /// Records of a previous batch with the same configuration.
+    std::map<int, std::vector<std::string>> _records;
+    /// Newest modification time of the dependencies, \c std::nullopt if one
+    /// of them is missing.
+    std::optional<std::int64_t> _dependency_time;
+
+    std::mutex    _mutex;
+    std::ofstream _file GUARDED_BY(_mutex);
+};
+
+}  // namespace sens_loc::io
+
+#endif /* end of include guard: MANIFEST_H_W7DJ3QPE */
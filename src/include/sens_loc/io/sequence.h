@@ -0,0 +1,179 @@
+#ifndef SEQUENCE_H_R2VXK7MD
+#define SEQUENCE_H_R2VXK7MD
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <sens_loc/math/image.h>
+#include <sens_loc/math/pointcloud.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sens_loc::io {
+
+/// Storage of the frames in a depth sequence archive.
+enum class sequence_encoding : std::uint32_t {
+    raw   = 0,  ///< Uncompressed pixels, frames are accessed without copies.
+    delta = 1,  ///< Lossless delta coding of the pixels in each row.
+};
+
+/// Fixed size header at the beginning of a depth sequence archive.
+///
+/// The archive has the following layout. All numbers are stored in the byte
+/// order of the host that wrote the archive. The version does not match on
+/// hosts with a different byte order, so these archives are rejected.
+/// ```
+/// sequence_header
+/// intrinsic         (intrinsic_size bytes, same format as the calibration
+///                    files, e.g. \c io::camera<>::load_intrinsic)
+/// poses             (optional, frame_count * 12 floats, row-major 3x4)
+/// frame offsets     (frame_count + 1 uint64, from the beginning of the file)
+/// frames            (each aligned to 64 bytes)
+/// ```
+/// A frame \c i spans the bytes from \c offsets[i] to \c offsets[i + 1],
+/// including the zero padding to the next frame.
+/// Raw frames contain the \c ushort pixels row by row. Delta coded frames
+/// contain the difference of each pixel to its left neighbour (the first pixel
+/// of a row is coded as is). The differences are zig-zag coded and stored as
+/// variable-length integers with 7 bits per byte. Small differences, that are
+/// common in depth images, need a single byte.
+struct sequence_header {
+    char              magic[4]       = {'D', 'S', 'E', 'Q'};
+    std::uint32_t     version        = 1;
+    std::uint32_t     width          = 0;
+    std::uint32_t     height         = 0;
+    std::uint32_t     frame_count    = 0;
+    sequence_encoding encoding       = sequence_encoding::raw;
+    std::uint32_t     intrinsic_size = 0;
+    std::uint32_t     has_poses      = 0;
+};
+static_assert(sizeof(sequence_header) == 32);
+
+/// Read-only access to a depth sequence archive (".dseq").
+///
+/// An archive stores a sequence of 16-bit depth images with the same
+/// dimension, the intrinsic of the sensor and optionally the pose of each
+/// frame in a single file. Processing an archive avoids opening and decoding
+/// a file for each frame, which dominates on network-mounted storage.
+///
+/// The archive is memory-mapped. Frames of raw archives are returned as views
+/// into the mapping without any copy. Delta coded frames are decoded into
+/// a buffer provided by the caller.
+///
+/// \note All functions are thread-safe.
+/// \sa sequence_header, depth_sequence_writer
+class depth_sequence {
+  public:
+    /// Map the archive \p path into memory.
+    /// \returns \c std::nullopt if the file can not be mapped or is not a
+    /// valid archive.
+    static std::optional<depth_sequence>
+    open(const std::string& path) noexcept;
+
+    depth_sequence(const depth_sequence&) = delete;
+    depth_sequence(depth_sequence&& other) noexcept;
+    depth_sequence& operator=(const depth_sequence&) = delete;
+    depth_sequence& operator=(depth_sequence&& other) noexcept;
+    ~depth_sequence();
+
+    /// Number of frames in the archive.
+    [[nodiscard]] int size() const noexcept {
+        return static_cast<int>(_header.frame_count);
+    }
+    [[nodiscard]] int w() const noexcept {
+        return static_cast<int>(_header.width);
+    }
+    [[nodiscard]] int h() const noexcept {
+        return static_cast<int>(_header.height);
+    }
+    [[nodiscard]] sequence_encoding encoding() const noexcept {
+        return _header.encoding;
+    }
+
+    /// Calibration of the sensor in the format of the calibration files.
+    /// The content is empty if the archive was written without intrinsic.
+    [[nodiscard]] std::string_view intrinsic() const noexcept;
+
+    /// \returns the pose of frame \p idx or \c std::nullopt if the archive
+    /// does not contain poses.
+    /// \pre 0 <= \p idx < \c size()
+    [[nodiscard]] std::optional<math::pose_t> pose(int idx) const noexcept;
+
+    /// Return frame \p idx of a raw archive without copying it.
+    /// \note The image is only valid as long as the archive is alive.
+    /// Modifying it does not modify the archive file.
+    /// \pre \c encoding() == \c sequence_encoding::raw
+    /// \pre 0 <= \p idx < \c size()
+    [[nodiscard]] math::image<ushort> view(int idx) const noexcept;
+
+    /// Read frame \p idx into \p target.
+    ///
+    /// Raw frames are not copied, \p target becomes a view like with \c view.
+    /// Delta coded frames are decoded into the memory of \p target, which is
+    /// only reallocated if its dimension does not match.
+    /// \pre 0 <= \p idx < \c size()
+    /// \returns \c false if the frame is corrupted.
+    [[nodiscard]] bool read(int idx, math::image<ushort>& target) const
+        noexcept;
+
+  private:
+    depth_sequence(uchar* data, std::size_t size) noexcept;
+
+    /// Check the header and the frame offsets against the size of the file.
+    [[nodiscard]] bool valid() const noexcept;
+    [[nodiscard]] const std::uint64_t* offsets() const noexcept;
+
+    uchar*          _data = nullptr;
+    std::size_t     _size = 0;
+    sequence_header _header;
+};
+
+/// Write a depth sequence archive frame by frame.
+///
+/// \code
+/// depth_sequence_writer w("depth.dseq", 100, sequence_encoding::delta,
+///                         intrinsic_text);
+/// for (int i = 0; i < 100; ++i)
+///     w.add(depth_image(i));
+/// bool success = w.finish();
+/// \endcode
+/// \sa depth_sequence
+class depth_sequence_writer {
+  public:
+    /// Open \p path for writing an archive with \p frame_count frames.
+    /// \param intrinsic content of a calibration file, may be empty
+    /// \param with_poses \c true if the poses of the frames are stored as well
+    /// \pre \p frame_count is positive
+    depth_sequence_writer(const std::string& path,
+                          int                frame_count,
+                          sequence_encoding  encoding,
+                          std::string_view   intrinsic,
+                          bool               with_poses = false);
+
+    /// Append the next frame and its \p pose.
+    /// \pre all frames have the same dimension
+    /// \pre less than \c frame_count frames were added
+    /// \returns \c false on write errors.
+    [[nodiscard]] bool
+    add(const math::image<ushort>& frame,
+        const math::pose_t&        pose = math::pose_t::Identity()) noexcept;
+
+    /// Write the header and the index of the archive.
+    /// \pre exactly \c frame_count frames were added
+    /// \returns \c false on write errors.
+    [[nodiscard]] bool finish() noexcept;
+
+  private:
+    std::ofstream              _out;
+    sequence_header            _header;
+    std::string                _intrinsic;
+    std::vector<float>         _poses;
+    std::vector<std::uint64_t> _offsets;
+    std::vector<uchar>         _buffer;
+};
+
+}  // namespace sens_loc::io
+
+#endif /* end of include guard: SEQUENCE_H_R2VXK7MD */
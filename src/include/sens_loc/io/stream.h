@@ -0,0 +1,121 @@
+#ifndef STREAM_H_B8TK1NWE
+#define STREAM_H_B8TK1NWE
+
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+#include <optional>
+#include <string>
+
+namespace sens_loc::io {
+
+/// Header in front of each image of a frame stream.
+///
+/// Frame streams transfer images over pipes, FIFOs and sockets. Each image
+/// is the header followed by the pixels row by row without padding, i.e.
+/// \c width * \c height * \c cv::Mat::elemSize() bytes. All numbers and
+/// pixels are stored in the byte order of the host, because both ends of a
+/// stream run on the same machine.
+///
+/// A tool that converts a stream answers each input image with \c parts
+/// result images that carry the \c sequence number of the input.
+struct stream_header {
+    char          magic[4] = {'D', 'F', 'R', 'M'};
+    std::uint32_t sequence = 0;  ///< Number of the input image.
+    std::uint32_t part     = 0;  ///< Index within the results of an input.
+    std::uint32_t parts    = 1;  ///< Number of results of an input.
+    std::uint32_t width    = 0;
+    std::uint32_t height   = 0;
+    std::int32_t  type     = 0;  ///< OpenCV type of the pixels, e.g. CV_16UC1.
+    std::uint32_t reserved = 0;
+};
+static_assert(sizeof(stream_header) == 32);
+
+/// Direction of a \c frame_stream.
+enum class stream_mode { read, write };
+
+/// Behaviour of a \c frame_stream for Unix-domain sockets.
+enum class socket_role {
+    listen,   ///< Create the socket and wait for one client.
+    connect,  ///< Connect to the socket of another process.
+};
+
+/// Result of reading an image from a \c frame_stream.
+enum class stream_status {
+    frame,  ///< An image was read.
+    end,    ///< The stream was closed by the other side.
+    error,  ///< The stream is broken or contains invalid data.
+};
+
+/// Endpoint of a frame stream.
+///
+/// \note \c read and \c write may be called concurrently from two threads,
+/// e.g. to receive and answer images on the same socket.
+/// \sa stream_header
+class frame_stream {
+  public:
+    /// Open the endpoint \p spec.
+    ///
+    /// - \c "-" is \c stdin for reading and \c stdout for writing
+    /// - \c "unix:PATH" is the Unix-domain socket \c PATH, which is created
+    ///   or connected to depending on \p role
+    /// - every other \p spec is a file or FIFO
+    ///
+    /// Connecting retries for a few seconds, so that the listening process
+    /// can be started at the same time.
+    /// \returns \c std::nullopt if the endpoint can not be opened.
+    static std::optional<frame_stream>
+    open(const std::string& spec,
+         stream_mode        mode,
+         socket_role        role = socket_role::listen) noexcept;
+
+    /// \returns \c true if \p spec refers to a Unix-domain socket.
+    static bool is_socket(const std::string& spec) noexcept;
+
+    frame_stream(const frame_stream&) = delete;
+    frame_stream(frame_stream&& other) noexcept;
+    frame_stream& operator=(const frame_stream&) = delete;
+    frame_stream& operator=(frame_stream&& other) noexcept;
+    ~frame_stream();
+
+    /// Read the next image into \p image, whose memory is reused if the
+    /// dimension and type match.
+    /// Only single channel images and 8-bit color images with at most
+    /// \c max_dimension pixels per side are accepted.
+    [[nodiscard]] stream_status read(stream_header& header,
+                                     cv::Mat&       image) noexcept;
+
+    /// Write \p image as result \p part of \p parts of the input
+    /// \p sequence.
+    /// A reader that closed the stream does not raise \c SIGPIPE, the write
+    /// fails and \c peer_closed is set instead.
+    /// \returns \c false if the stream is closed or broken.
+    [[nodiscard]] bool write(std::uint32_t  sequence,
+                             std::uint32_t  part,
+                             std::uint32_t  parts,
+                             const cv::Mat& image) noexcept;
+
+    /// \returns \c true if a write failed, because the reading side closed
+    /// the stream (\c EPIPE).
+    [[nodiscard]] bool peer_closed() const noexcept { return _peer_closed; }
+
+    /// Close the writing direction of a socket, so that the other side
+    /// reads the end of the stream while it can still answer.
+    void shutdown_write() noexcept;
+
+    constexpr static std::uint32_t max_dimension = 1U << 14U;
+
+  private:
+    frame_stream(int fd, bool owned, bool socket) noexcept;
+
+    bool read_bytes(void* data, std::size_t size, bool& closed) noexcept;
+    bool write_bytes(const void* data, std::size_t size) noexcept;
+
+    int  _fd          = -1;
+    bool _owned       = false;
+    bool _socket      = false;
+    bool _peer_closed = false;
+};
+
+}  // namespace sens_loc::io
+
+#endif /* end of include guard: STREAM_H_B8TK1NWE */
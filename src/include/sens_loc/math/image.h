@@ -127,6 +127,22 @@ image<TargetType> convert(const image<PixelType>& img) noexcept {
     return math::image<TargetType>(std::move(tmp));
 }
 
+/// Convert the pixels of \p img to \p TargetType and write them into
+/// \p target, which allows reusing \p target for multiple conversions.
+/// \pre \p target has the same dimension as \p img
+template <typename TargetType, typename PixelType>
+void convert(const image<PixelType>& img, image<TargetType>& target) noexcept {
+    static_assert(std::is_arithmetic_v<TargetType>);
+    static_assert(std::is_arithmetic_v<PixelType>);
+    Expects(target.w() == img.w());
+    Expects(target.h() == img.h());
+
+    // 'out' shares the memory of 'target'. 'convertTo' does not reallocate,
+    // because the dimension and type of 'out' match already.
+    cv::Mat out = target.data();
+    img.data().convertTo(out, detail::get_opencv_type<TargetType>());
+}
+
 }  // namespace sens_loc::math
 
 #endif /* end of include guard: IMAGE_H_YQCE0AWR */
@@ -0,0 +1,176 @@
+#ifndef PADDED_IMAGE_H_M3KQ7TZA
+#define PADDED_IMAGE_H_M3KQ7TZA
+
+#include <algorithm>
+#include <gsl/gsl>
+#include <opencv2/core/mat.hpp>
+#include <sens_loc/math/coordinate.h>
+#include <sens_loc/math/image.h>
+#include <type_traits>
+
+namespace sens_loc::math {
+
+/// Image with a halo of additional pixels around it and aligned rows.
+///
+/// The conversions access the neighbourhood of each pixel. With a normal
+/// \c image the pixels at the border need special loop bounds, because their
+/// neighbours do not exist. This class stores \c border() additional pixels
+/// on each side of the image, so that every pixel has a full neighbourhood.
+/// Kernels iterate over the rows with \c row(v) and access the neighbours
+/// with pointer arithmetic, without bounds checks or branches.
+///
+/// The first pixel of each row is aligned to \c alignment() bytes, which
+/// allows aligned vector loads and stores in vectorized kernels.
+///
+/// \c interior() provides the pixels without the halo as \c image, that
+/// shares the memory and serves as the checked interface.
+///
+/// \invariant the image has only 1 channel
+/// \invariant \c stride() >= \c w() + 2 * \c border()
+/// \tparam PixelType the underlying type of the pixels
+/// \sa math::image
+template <typename PixelType = ushort>
+class padded_image {
+  public:
+    static_assert(std::is_arithmetic_v<PixelType>);
+
+    /// Largest supported alignment in bytes. OpenCV allocates the memory of
+    /// each \c cv::Mat with this alignment.
+    static constexpr int max_alignment = 64;
+
+    /// Create an image of \p w x \p h pixels with a halo of \p border pixels.
+    /// All pixels, including the halo, are set to \p value.
+    /// \pre \p w and \p h are positive, \p border is not negative
+    /// \pre \p alignment is a power of two and a multiple of the pixel size
+    /// \pre \p alignment is at most \c max_alignment
+    padded_image(int       w,
+                 int       h,
+                 int       border    = 1,
+                 PixelType value     = PixelType(0),
+                 int       alignment = 32) noexcept
+        : _w{w}
+        , _h{h}
+        , _border{border}
+        , _alignment{alignment} {
+        Expects(w > 0);
+        Expects(h > 0);
+        Expects(border >= 0);
+        Expects(alignment > 0);
+        Expects((alignment & (alignment - 1)) == 0);
+        Expects(alignment <= max_alignment);
+        Expects(alignment % int(sizeof(PixelType)) == 0);
+
+        const int elements = alignment / int(sizeof(PixelType));
+        _lead              = round_up(border, elements);
+        _stride            = round_up(_lead + w + border, elements);
+
+        _data = cv::Mat(h + 2 * border, _stride,
+                        detail::get_opencv_type<PixelType>());
+        _data = value;
+
+        Ensures(_stride >= _w + 2 * _border);
+    }
+
+    /// Copy the pixels of \p img into a padded image and set the halo to
+    /// \p border_value.
+    /// \sa padded_image(int, int, int, PixelType, int)
+    explicit padded_image(const image<PixelType>& img,
+                          int                     border       = 1,
+                          PixelType               border_value = PixelType(0),
+                          int                     alignment    = 32) noexcept
+        : padded_image(img.w(), img.h(), border, border_value, alignment) {
+        for (int v = 0; v < _h; ++v) {
+            const PixelType* source = img.data().template ptr<PixelType>(v);
+            std::copy(source, source + _w, row(v).data());
+        }
+    }
+
+    /// Return the width of the image without the halo.
+    [[nodiscard]] int w() const noexcept { return _w; }
+    /// Return the height of the image without the halo.
+    [[nodiscard]] int h() const noexcept { return _h; }
+    /// Return the number of additional pixels on each side of the image.
+    [[nodiscard]] int border() const noexcept { return _border; }
+    /// Return the distance between two rows in elements.
+    [[nodiscard]] int stride() const noexcept { return _stride; }
+    /// Return the alignment of the first pixel of each row in bytes.
+    [[nodiscard]] int alignment() const noexcept { return _alignment; }
+
+    /// Return the \c w() pixels of row \p v.
+    ///
+    /// The halo around the row can be accessed with pointer arithmetic, e.g.
+    /// \c row(v).data()[-1] is the left neighbour of the first pixel and
+    /// \c row(v).data()[-stride()] is the pixel above it.
+    /// \pre \f$-border \leq v < h + border\f$
+    [[nodiscard]] gsl::span<PixelType> row(int v) noexcept {
+        Expects(v >= -_border);
+        Expects(v < _h + _border);
+        return {_data.template ptr<PixelType>(v + _border) + _lead, _w};
+    }
+    /// \sa row
+    [[nodiscard]] gsl::span<const PixelType> row(int v) const noexcept {
+        Expects(v >= -_border);
+        Expects(v < _h + _border);
+        return {_data.template ptr<PixelType>(v + _border) + _lead, _w};
+    }
+
+    /// Read-Access in the image for some pixel \p p, the halo is accessible
+    /// with negative coordinates or coordinates beyond the dimension.
+    [[nodiscard]] PixelType at(const pixel_coord<int>& p) const noexcept {
+        expect_in_halo(p);
+        return _data.template at<PixelType>(p.v() + _border, p.u() + _lead);
+    }
+    /// Write-Access in the image for some pixel \p p.
+    /// \sa at
+    [[nodiscard]] PixelType& at(const pixel_coord<int>& p) noexcept {
+        expect_in_halo(p);
+        return _data.template at<PixelType>(p.v() + _border, p.u() + _lead);
+    }
+
+    /// Set all pixels of the halo to \p value.
+    void fill_border(PixelType value) noexcept {
+        for (int v = 0; v < _data.rows; ++v) {
+            PixelType* r = _data.template ptr<PixelType>(v);
+            if (v < _border || v >= _h + _border) {
+                std::fill(r, r + _stride, value);
+                continue;
+            }
+            std::fill(r, r + _lead, value);
+            std::fill(r + _lead + _w, r + _stride, value);
+        }
+    }
+
+    /// Return the pixels without the halo as normal image.
+    /// The result shares the memory with this image.
+    [[nodiscard]] image<PixelType> interior() const noexcept {
+        return image<PixelType>(_data(cv::Rect(_lead, _border, _w, _h)));
+    }
+
+    /// Get access to the underlying data, including the halo and the padding
+    /// of each row.
+    [[nodiscard]] const cv::Mat& data() const noexcept { return _data; }
+
+  private:
+    static int round_up(int value, int multiple) noexcept {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    void expect_in_halo(const pixel_coord<int>& p) const noexcept {
+        Expects(p.u() >= -_border);
+        Expects(p.u() < _w + _border);
+        Expects(p.v() >= -_border);
+        Expects(p.v() < _h + _border);
+    }
+
+    int     _w;
+    int     _h;
+    int     _border;
+    int     _alignment;
+    int     _lead   = 0;  ///< Elements in front of the first pixel of a row.
+    int     _stride = 0;  ///< Elements per row.
+    cv::Mat _data;
+};
+
+}  // namespace sens_loc::math
+
+#endif /* end of include guard: PADDED_IMAGE_H_M3KQ7TZA */
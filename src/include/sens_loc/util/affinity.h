@@ -0,0 +1,33 @@
+#ifndef AFFINITY_H_M3KZ8QWE
+#define AFFINITY_H_M3KZ8QWE
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace sens_loc::util {
+
+/// Parse a list of CPUs like \c "0-7,16,18-19".
+///
+/// The list contains single CPU numbers and inclusive ranges separated by
+/// commas. This is the format of \c taskset and \c /sys/devices/system/node.
+/// \returns the sorted CPU numbers without duplicates or \c std::nullopt if
+/// \p list is not a valid, non-empty CPU list.
+[[nodiscard]] std::optional<std::vector<int>>
+parse_cpu_list(std::string_view list) noexcept;
+
+/// Restrict the calling thread to the CPUs \p cpus.
+///
+/// Threads inherit the affinity of the thread that creates them. Calling this
+/// function on the main thread before any worker is started pins all threads
+/// of the process, e.g. to the cores of one NUMA node.
+/// \returns \c false if \p cpus is empty or the affinity can not be set.
+[[nodiscard]] bool set_cpu_affinity(const std::vector<int>& cpus) noexcept;
+
+/// \returns the number of CPUs the calling thread may run on. This is less
+/// than the number of hardware threads if the affinity is restricted.
+[[nodiscard]] int available_cpus() noexcept;
+
+}  // namespace sens_loc::util
+
+#endif /* end of include guard: AFFINITY_H_M3KZ8QWE */
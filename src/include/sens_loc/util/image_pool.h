@@ -0,0 +1,73 @@
+#ifndef IMAGE_POOL_H_V4TQ8NRB
+#define IMAGE_POOL_H_V4TQ8NRB
+
+#include <gsl/gsl>
+#include <opencv2/core/mat.hpp>
+#include <sens_loc/math/image.h>
+#include <vector>
+
+namespace sens_loc::util {
+
+/// Pool of image buffers that are reused for a sequence of conversions.
+///
+/// The buffers are identified by their dimension and pixel type. \c get
+/// returns a buffer that was not handed out since the last \c recycle and
+/// allocates a new buffer only if no such buffer exists.
+/// Processing a sequence of images with the same dimension reaches a steady
+/// state after the first image, where no memory is allocated anymore.
+///
+/// \note The pool is not thread-safe, each worker uses its own pool.
+/// \warning Images from \c get share the memory with the pool. They must not
+/// be used after the next \c recycle, because their buffer is handed out
+/// again.
+class image_pool {
+  public:
+    /// Return an image of \p w x \p h pixels with undefined content.
+    /// \pre \p w and \p h are positive
+    template <typename PixelType>
+    [[nodiscard]] math::image<PixelType> get(int w, int h) noexcept {
+        Expects(w > 0);
+        Expects(h > 0);
+        const int type = math::detail::get_opencv_type<PixelType>();
+
+        // The pool holds only a few buffers, a linear search is cheaper than
+        // any associative container.
+        for (auto& b : _buffers) {
+            if (!b.in_use && b.data.cols == w && b.data.rows == h &&
+                b.data.type() == type) {
+                b.in_use = true;
+                return math::image<PixelType>(b.data);
+            }
+        }
+
+        _buffers.push_back({cv::Mat(h, w, type), true});
+        ++_allocations;
+        return math::image<PixelType>(_buffers.back().data);
+    }
+
+    /// Mark all buffers as unused. Call this function once all images that
+    /// were returned by \c get are not used anymore.
+    void recycle() noexcept {
+        for (auto& b : _buffers)
+            b.in_use = false;
+    }
+
+    /// Return the number of buffers in the pool.
+    [[nodiscard]] int size() const noexcept {
+        return gsl::narrow_cast<int>(_buffers.size());
+    }
+    /// Return how often the pool needed to allocate a new buffer.
+    [[nodiscard]] int allocations() const noexcept { return _allocations; }
+
+  private:
+    struct buffer {
+        cv::Mat data;
+        bool    in_use;
+    };
+    std::vector<buffer> _buffers;
+    int                 _allocations = 0;
+};
+
+}  // namespace sens_loc::util
+
+#endif /* end of include guard: IMAGE_POOL_H_V4TQ8NRB */
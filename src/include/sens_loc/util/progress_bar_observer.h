@@ -1,44 +1,126 @@
 #ifndef PROGRESS_BAR_OBSERVER_H_0L8ZR7QT
 #define PROGRESS_BAR_OBSERVER_H_0L8ZR7QT
 
-#include "rang.hpp"
-
+#include <array>
 #include <atomic>
-#include <cmath>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <gsl/gsl>
-#include <iomanip>
-#include <sens_loc/util/console.h>
+#include <mutex>
 #include <taskflow/core/observer.hpp>
+#include <thread>
+#include <vector>
 
 namespace sens_loc::util {
 
+/// Lock-free histogram of durations with logarithmic buckets.
+///
+/// Each power of two is split into \c sub_buckets buckets, which bounds the
+/// relative error of the percentiles to about 20%. That is good enough to
+/// show the latency of a task and allows \c add to be a single atomic
+/// increment.
+class latency_histogram {
+  public:
+    using duration = std::chrono::nanoseconds;
+
+    /// Count one sample. Thread-safe and wait-free.
+    void add(duration d) noexcept;
+
+    /// \returns the number of all samples.
+    [[nodiscard]] std::uint64_t count() const noexcept;
+
+    /// \returns an estimate for the \p p-percentile of the samples or zero
+    /// if there are no samples.
+    /// \pre 0 <= \p p <= 1
+    [[nodiscard]] duration percentile(double p) const noexcept;
+
+  private:
+    constexpr static int sub_buckets = 4;
+    constexpr static int buckets     = 64 * sub_buckets;
+
+    [[nodiscard]] static int      bucket(std::uint64_t ns) noexcept;
+    [[nodiscard]] static duration lower_bound(int bucket) noexcept;
+
+    std::array<std::atomic<std::uint64_t>, buckets> _counts{};
+};
+
+/// Progress bar for the tasks of a batch.
+///
+/// The workers only update atomic counters and never wait for each other.
+/// A separate thread renders the progress at a fixed rate, including the
+/// throughput, the estimated time until the batch is done and the latency of
+/// the tasks.
+/// If \c stdout is not a terminal, a log line is written every
+/// \c log_interval instead of redrawing a bar.
+///
+/// The observer can be installed in a \c tf::Executor or be fed manually
+/// with \c finish_task.
 class progress_bar_observer : public tf::ExecutorObserverInterface {
   public:
     constexpr static int max_bars = 50;
 
-    progress_bar_observer(std::int64_t total_tasks)
-        : _total_tasks{total_tasks}
-        , _done{0} {
-        Expects(total_tasks >= 1);
-    }
+    /// Time between two redraws of the progress bar.
+    constexpr static std::chrono::milliseconds redraw_interval{100};
+    /// Time between two log lines if \c stdout is not a terminal.
+    constexpr static std::chrono::seconds log_interval{5};
+
+    /// \pre \p total_tasks is positive
+    explicit progress_bar_observer(std::int64_t total_tasks);
 
     progress_bar_observer(const progress_bar_observer&) = delete;
     progress_bar_observer(progress_bar_observer&&)      = delete;
     progress_bar_observer& operator=(const progress_bar_observer&) = delete;
     progress_bar_observer& operator=(progress_bar_observer&&) = delete;
-    ~progress_bar_observer() override                         = default;
 
-    void set_up(unsigned /*num_workers*/) override {}
-    void on_entry(unsigned /*worker_id*/, tf::TaskView /*task_view*/) override;
-    void on_exit(unsigned /*worker_id*/, tf::TaskView /*task_view*/) override;
+    /// Stop the rendering and print the final state.
+    ~progress_bar_observer() override;
+
+    void set_up(unsigned num_workers) override;
+    void on_entry(unsigned worker_id, tf::TaskView /*task_view*/) override;
+    void on_exit(unsigned worker_id, tf::TaskView /*task_view*/) override;
+
+    /// Count one finished task that was not run by a taskflow executor,
+    /// e.g. one index that left a processing pipeline.
+    /// \param latency time the task took from start to end
+    void finish_task(latency_histogram::duration latency) noexcept;
+
+    /// \returns the number of finished tasks.
+    [[nodiscard]] std::int64_t done() const noexcept { return _done; }
+    /// \returns the latency of the finished tasks.
+    [[nodiscard]] const latency_histogram& latency() const noexcept {
+        return _latency;
+    }
 
   private:
-    void print_bar(bool increment) noexcept;
+    using clock = std::chrono::steady_clock;
+
+    /// Start time of the current task of each worker. Each worker accesses
+    /// only its own slot, the padding avoids false sharing.
+    struct alignas(64) worker_slot {
+        clock::time_point start;
+    };
+
+    void render_loop() noexcept;
+    /// Print the state once all tasks are done. Later calls do nothing.
+    void print_final() noexcept;
+    /// Print the intermediate state, unless the final state was printed.
+    void print_status() noexcept;
+    /// Print the bar or the log line without synchronization.
+    void print_line() noexcept;
+
+    const std::int64_t        _total_tasks;
+    const clock::time_point   _begin;
+    const bool                _terminal;
+    std::vector<worker_slot>  _workers;
+    std::atomic<std::int64_t> _done{0};
+    latency_histogram         _latency;
+    std::atomic<bool>         _finished{false};
 
-    std::int64_t      _total_tasks;
-    std::int64_t      _done;
-    std::atomic<bool> _inital_output = false;
+    std::mutex              _stop_mutex;
+    std::condition_variable _stop_signal;
+    bool                    _stop = false;
+    std::thread             _renderer;
 };
 }  // namespace sens_loc::util
 
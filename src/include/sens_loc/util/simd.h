@@ -0,0 +1,41 @@
+#ifndef SIMD_H_R7VQ2MXE
+#define SIMD_H_R7VQ2MXE
+
+namespace sens_loc::util {
+
+/// Instruction set extensions that have specialized conversion kernels.
+///
+/// Support for each level is compiled in with the \c WITH_SSE42 and
+/// \c WITH_AVX2 build options, that define \c SENS_LOC_SIMD_SSE42 and
+/// \c SENS_LOC_SIMD_AVX2. The kernels are compiled with function-level target
+/// attributes, so the binary still runs on processors without these
+/// extensions. The actual kernel is selected at runtime.
+enum class simd_level {
+    none,   ///< Use the portable scalar implementation.
+    sse42,  ///< Process 4 single-precision values per instruction.
+    avx2,   ///< Process 8 single-precision values per instruction.
+};
+
+/// Return the best instruction set that is compiled in and supported by the
+/// executing processor.
+/// The detection with \c CPUID happens once, later calls are cheap.
+inline simd_level simd_support() noexcept {
+    static const simd_level level = []() noexcept {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#if defined(SENS_LOC_SIMD_AVX2)
+        if (__builtin_cpu_supports("avx2"))
+            return simd_level::avx2;
+#endif
+#if defined(SENS_LOC_SIMD_SSE42)
+        if (__builtin_cpu_supports("sse4.2"))
+            return simd_level::sse42;
+#endif
+#endif
+        return simd_level::none;
+    }();
+    return level;
+}
+
+}  // namespace sens_loc::util
+
+#endif /* end of include guard: SIMD_H_R7VQ2MXE */
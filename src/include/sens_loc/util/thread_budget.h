@@ -0,0 +1,47 @@
+#ifndef THREAD_BUDGET_H_P5XW2HRC
+#define THREAD_BUDGET_H_P5XW2HRC
+
+namespace sens_loc::util {
+
+/// Distribution of the threads between the batch processing and the
+/// parallel algorithms of OpenCV.
+///
+/// Filters, feature detectors and the odometry of OpenCV start their own
+/// threads. OpenCV has a single thread pool for the whole process, whose size
+/// is shared by all callers. Calling the parallel OpenCV functions from
+/// multiple "TaskFlow" workers introduces data races, so OpenCV only runs in
+/// parallel if the images are processed one after another.
+enum class thread_policy {
+    outer,   ///< Each worker processes one image, OpenCV runs sequentially.
+    inner,   ///< The images are processed one after another and OpenCV uses
+             ///< all threads.
+    hybrid,  ///< \c outer for batches that occupy all threads, \c inner
+             ///< for smaller batches.
+};
+
+/// Number of threads on both levels of parallelism.
+/// Either \c workers or \c opencv_threads is 1, so \c workers *
+/// \c opencv_threads does not exceed the total budget.
+struct thread_budget {
+    int workers;         ///< Workers of the batch processing.
+    int opencv_threads;  ///< Size of the process-wide thread pool of OpenCV.
+};
+
+/// Split \p threads between the workers and OpenCV for \p tasks images.
+///
+/// The hybrid policy processes batches with at least \p threads images in
+/// parallel and smaller batches one image at a time with parallel OpenCV
+/// functions.
+/// \pre \p threads and \p tasks are positive
+[[nodiscard]] thread_budget
+split_threads(thread_policy policy, int threads, int tasks) noexcept;
+
+/// Set the number of threads of OpenCV to \c budget.opencv_threads.
+/// A single thread disables the threading of OpenCV completely.
+/// \pre OpenCV runs sequentially if there are multiple workers
+/// \sa cv::setNumThreads
+void apply_opencv_threads(const thread_budget& budget) noexcept;
+
+}  // namespace sens_loc::util
+
+#endif /* end of include guard: THREAD_BUDGET_H_P5XW2HRC */
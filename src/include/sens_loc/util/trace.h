@@ -0,0 +1,107 @@
+#ifndef TRACE_H_J6WR0QZE
+#define TRACE_H_J6WR0QZE
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace sens_loc::util {
+
+/// One finished span of a traced stage.
+struct trace_event {
+    const char*   name;    ///< Name of the stage, a string literal.
+    std::uint32_t thread;  ///< Sequential number of the recording thread.
+    std::int64_t  begin;   ///< Start in nanoseconds since \c enable_tracing.
+    std::int64_t  end;     ///< End in nanoseconds since \c enable_tracing.
+};
+
+namespace detail {
+extern std::atomic<bool> tracing_active;
+}  // namespace detail
+
+/// Start recording the spans of all threads.
+void enable_tracing() noexcept;
+
+/// \returns \c true if spans are recorded.
+inline bool tracing_enabled() noexcept {
+    return detail::tracing_active.load(std::memory_order_relaxed);
+}
+
+/// Record the span \p name of the calling thread from \p begin to \p end.
+///
+/// Each thread appends to its own buffer, the threads never wait for each
+/// other.
+/// \pre \p name is a string literal or lives until the trace is written.
+void record_span(const char*                           name,
+                 std::chrono::steady_clock::time_point begin,
+                 std::chrono::steady_clock::time_point end) noexcept;
+
+/// \returns the spans of all threads recorded so far, sorted by their start.
+[[nodiscard]] std::vector<trace_event> recorded_spans();
+
+/// Write \p events in the trace event format of Chrome, that can be loaded
+/// with 'chrome://tracing' or 'ui.perfetto.dev'.
+/// \returns \c false if the file could not be written.
+[[nodiscard]] bool write_chrome_trace(const std::string&              path,
+                                      const std::vector<trace_event>& events);
+
+/// Print the number of spans and their total, mean and maximum duration per
+/// stage as a table.
+void print_trace_summary(std::ostream&                   os,
+                         const std::vector<trace_event>& events);
+
+/// Records the lifetime of the object as span \p name, if tracing is enabled.
+///
+/// \code
+/// {
+///     SENS_LOC_TRACE_SCOPE("load");
+///     load_the_file();
+/// }
+/// \endcode
+/// Without tracing the span costs a single atomic load.
+/// \sa SENS_LOC_TRACE_SCOPE
+class trace_span {
+  public:
+    explicit trace_span(const char* name) noexcept
+        : _name{tracing_enabled() ? name : nullptr} {
+        if (_name != nullptr)
+            _begin = std::chrono::steady_clock::now();
+    }
+
+    trace_span(const trace_span&) = delete;
+    trace_span(trace_span&&)      = delete;
+    trace_span& operator=(const trace_span&) = delete;
+    trace_span& operator=(trace_span&&) = delete;
+
+    ~trace_span() {
+        if (_name != nullptr)
+            record_span(_name, _begin, std::chrono::steady_clock::now());
+    }
+
+  private:
+    const char*                           _name;
+    std::chrono::steady_clock::time_point _begin;
+};
+
+}  // namespace sens_loc::util
+
+#define SENS_LOC_TRACE_CONCAT_IMPL(a, b) a##b
+#define SENS_LOC_TRACE_CONCAT(a, b) SENS_LOC_TRACE_CONCAT_IMPL(a, b)
+
+/// Trace the rest of the enclosing scope as the span \p NAME.
+/// Compiles to nothing if the build disables tracing with
+/// 'WITH_TRACING=OFF'.
+#if SENS_LOC_TRACING
+#define SENS_LOC_TRACE_SCOPE(NAME)                                             \
+    const ::sens_loc::util::trace_span SENS_LOC_TRACE_CONCAT(                  \
+        sens_loc_trace_span_, __LINE__) {                                      \
+        NAME                                                                   \
+    }
+#else
+#define SENS_LOC_TRACE_SCOPE(NAME) static_cast<void>(0)
+#endif
+
+#endif /* end of include guard: TRACE_H_J6WR0QZE */
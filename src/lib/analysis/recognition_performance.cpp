@@ -6,6 +6,7 @@
 #include <sens_loc/io/image.h>
 #include <sens_loc/io/pose.h>
 #include <sens_loc/math/rounding.h>
+#include <stdexcept>
 #include <unordered_set>
 
 using namespace std;
@@ -160,28 +161,11 @@ element_categories::element_categories(const math::imagepoints_t& query_data,
 
 void recognition_statistic::account(
     const element_categories& classification) noexcept {
-    // Relevant elements
-    n_true_pos += classification.true_positives.size();
-    t_p_per_image.emplace_back(classification.true_positives.size());
-    n_false_neg += classification.false_negatives.size();
-    f_n_per_image.emplace_back(classification.false_negatives.size());
-
-    // Irrelevant elements
-    n_false_pos += classification.false_positives.size();
-    f_p_per_image.emplace_back(classification.false_positives.size());
-    n_true_neg += classification.true_negatives.size();
-    t_n_per_image.emplace_back(classification.true_negatives.size());
-
-    // Keep track for interesting statistical insights and finally
-    // histogramming.
     using gsl::narrow_cast;
-    _relevant_elements.stat(
-        narrow_cast<int64_t>(classification.true_positives.size()) +
-        narrow_cast<int64_t>(classification.false_negatives.size()));
-    _true_positives.stat(
-        narrow_cast<int64_t>(classification.true_positives.size()));
-    _false_positives.stat(
-        narrow_cast<int64_t>(classification.false_positives.size()));
+    account_image(narrow_cast<int64_t>(classification.true_positives.size()),
+                  narrow_cast<int64_t>(classification.false_positives.size()),
+                  narrow_cast<int64_t>(classification.true_negatives.size()),
+                  narrow_cast<int64_t>(classification.false_negatives.size()));
 
     // Keep track of the descriptor distances.
     transform(classification.true_positives.begin(),
@@ -192,6 +176,90 @@ void recognition_statistic::account(
               [](const keypoint_correspondence& c) { return c.distance; });
 }
 
+void recognition_statistic::account_image(int64_t true_pos,
+                                          int64_t false_pos,
+                                          int64_t true_neg,
+                                          int64_t false_neg) noexcept {
+    // Relevant elements
+    n_true_pos += true_pos;
+    t_p_per_image.emplace_back(true_pos);
+    n_false_neg += false_neg;
+    f_n_per_image.emplace_back(false_neg);
+
+    // Irrelevant elements
+    n_false_pos += false_pos;
+    f_p_per_image.emplace_back(false_pos);
+    n_true_neg += true_neg;
+    t_n_per_image.emplace_back(true_neg);
+
+    // Keep track for interesting statistical insights and finally
+    // histogramming.
+    _relevant_elements.stat(true_pos + false_neg);
+    _true_positives.stat(true_pos);
+    _false_positives.stat(false_pos);
+}
+
+void recognition_statistic::merge(const recognition_statistic& other) noexcept {
+    Expects(size(other.t_p_per_image) == size(other.f_p_per_image));
+    Expects(size(other.t_p_per_image) == size(other.t_n_per_image));
+    Expects(size(other.t_p_per_image) == size(other.f_n_per_image));
+
+    for (size_t i = 0; i < other.t_p_per_image.size(); ++i)
+        account_image(other.t_p_per_image[i], other.f_p_per_image[i],
+                      other.t_n_per_image[i], other.f_n_per_image[i]);
+
+    tp_distance.insert(tp_distance.end(), other.tp_distance.begin(),
+                       other.tp_distance.end());
+    fp_distance.insert(fp_distance.end(), other.fp_distance.begin(),
+                       other.fp_distance.end());
+}
+
+void recognition_statistic::write_tallies(cv::FileStorage&   fs,
+                                          const std::string& name) const {
+    // 'FileStorage' does not store 64-bit integers, but the tallies of a
+    // single image fit into an 'int'.
+    const auto to_int = [](const vector<int64_t>& v) {
+        vector<int> r(v.size());
+        transform(v.begin(), v.end(), r.begin(),
+                  [](int64_t e) { return gsl::narrow<int>(e); });
+        return r;
+    };
+    fs << name << "{";
+    fs << "true_positives" << to_int(t_p_per_image);
+    fs << "false_positives" << to_int(f_p_per_image);
+    fs << "true_negatives" << to_int(t_n_per_image);
+    fs << "false_negatives" << to_int(f_n_per_image);
+    fs << "true_positive_distances" << tp_distance;
+    fs << "false_positive_distances" << fp_distance;
+    fs << "}";
+}
+
+recognition_statistic
+recognition_statistic::read_tallies(const cv::FileNode& node) {
+    if (!node.isMap())
+        throw runtime_error{"Tallies of the recognition statistic missing"};
+
+    vector<int> t_p;
+    vector<int> f_p;
+    vector<int> t_n;
+    vector<int> f_n;
+    cv::read(node["true_positives"], t_p);
+    cv::read(node["false_positives"], f_p);
+    cv::read(node["true_negatives"], t_n);
+    cv::read(node["false_negatives"], f_n);
+    if (t_p.size() != f_p.size() || t_p.size() != t_n.size() ||
+        t_p.size() != f_n.size())
+        throw runtime_error{"Inconsistent tallies of the recognition "
+                            "statistic"};
+
+    recognition_statistic s;
+    for (size_t i = 0; i < t_p.size(); ++i)
+        s.account_image(t_p[i], f_p[i], t_n[i], f_n[i]);
+    cv::read(node["true_positive_distances"], s.tp_distance);
+    cv::read(node["false_positive_distances"], s.fp_distance);
+    return s;
+}
+
 void recognition_statistic::make_histogram() {
     using namespace std;
 
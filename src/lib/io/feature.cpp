@@ -0,0 +1,262 @@
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <gsl/gsl>
+#include <sens_loc/io/feature.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace sens_loc::io {
+
+namespace {
+constexpr std::size_t section_alignment = 64;
+/// Number of float and int32 arrays of the keypoints.
+constexpr std::size_t keypoint_arrays = 7;
+
+std::size_t align(std::size_t offset) noexcept {
+    return (offset + section_alignment - 1) / section_alignment *
+           section_alignment;
+}
+
+std::size_t keypoints_size(const feature_header& h) noexcept {
+    return keypoint_arrays * h.keypoint_count * sizeof(float);
+}
+
+std::size_t descriptors_size(const feature_header& h) noexcept {
+    return std::size_t(h.descriptor_rows) * h.descriptor_cols *
+           CV_ELEM_SIZE(h.descriptor_type);
+}
+
+/// Descriptors are matrices with a single channel of the OpenCV depths up to
+/// \c CV_64F, e.g. \c CV_8U for binary and \c CV_32F for float descriptors.
+bool valid_descriptor_type(std::int32_t type) noexcept {
+    return type == CV_8UC1 || type == CV_8SC1 || type == CV_16UC1 ||
+           type == CV_16SC1 || type == CV_32SC1 || type == CV_32FC1 ||
+           type == CV_64FC1;
+}
+
+bool ends_with(std::string_view s, std::string_view suffix) noexcept {
+    return s.size() >= suffix.size() &&
+           s.substr(s.size() - suffix.size()) == suffix;
+}
+
+/// Fill the file with zeros up to the next section at \p offset.
+void write_padding(std::ofstream& out, std::size_t offset) {
+    static constexpr std::array<char, section_alignment> zeros{};
+    if (!out)
+        return;
+    const auto pos = gsl::narrow_cast<std::size_t>(out.tellp());
+    Expects(pos <= offset && offset - pos < section_alignment);
+    out.write(zeros.data(), gsl::narrow_cast<std::streamsize>(offset - pos));
+}
+
+bool write_binary(const std::string&               path,
+                  std::string_view                 source_path,
+                  const std::vector<cv::KeyPoint>& keypoints,
+                  const cv::Mat&                   descriptors) {
+    if (!descriptors.empty() && !valid_descriptor_type(descriptors.type()))
+        return false;
+
+    feature_header h;
+    h.keypoint_count     = gsl::narrow<std::uint32_t>(keypoints.size());
+    h.descriptor_rows    = gsl::narrow<std::uint32_t>(descriptors.rows);
+    h.descriptor_cols    = gsl::narrow<std::uint32_t>(descriptors.cols);
+    h.descriptor_type    = descriptors.type();
+    h.source_size        = gsl::narrow<std::uint32_t>(source_path.size());
+    h.source_offset      = align(sizeof(feature_header));
+    h.keypoints_offset   = align(h.source_offset + h.source_size);
+    h.descriptors_offset = align(h.keypoints_offset + keypoints_size(h));
+
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    write_padding(out, h.source_offset);
+    out.write(source_path.data(),
+              gsl::narrow_cast<std::streamsize>(source_path.size()));
+    write_padding(out, h.keypoints_offset);
+
+    // Each member of the keypoints is stored in its own array.
+    const auto write_array = [&](auto member) {
+        for (const cv::KeyPoint& kp : keypoints) {
+            const auto value = member(kp);
+            static_assert(sizeof(value) == sizeof(float));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+    };
+    write_array([](const cv::KeyPoint& kp) { return kp.pt.x; });
+    write_array([](const cv::KeyPoint& kp) { return kp.pt.y; });
+    write_array([](const cv::KeyPoint& kp) { return kp.size; });
+    write_array([](const cv::KeyPoint& kp) { return kp.angle; });
+    write_array([](const cv::KeyPoint& kp) { return kp.response; });
+    write_array(
+        [](const cv::KeyPoint& kp) { return std::int32_t{kp.octave}; });
+    write_array(
+        [](const cv::KeyPoint& kp) { return std::int32_t{kp.class_id}; });
+
+    write_padding(out, h.descriptors_offset);
+    const std::size_t row_size = descriptors.cols * descriptors.elemSize();
+    for (int row = 0; row < descriptors.rows; ++row)
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        out.write(reinterpret_cast<const char*>(descriptors.ptr(row)),
+                  gsl::narrow_cast<std::streamsize>(row_size));
+
+    out.close();
+    return !out.fail();
+}
+}  // namespace
+
+feature_format feature_format_for(std::string_view path) noexcept {
+    if (ends_with(path, ".yml") || ends_with(path, ".yaml") ||
+        ends_with(path, ".gz"))
+        return feature_format::yaml;
+    return feature_format::binary;
+}
+
+feature_file::feature_file(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY);  // NOLINT
+    if (fd >= 0) {
+        auto close_file = gsl::finally([fd]() { ::close(fd); });
+
+        const feature_header reference;
+        feature_header       h;
+        struct stat          info {};
+        if (::fstat(fd, &info) == 0 &&
+            static_cast<std::size_t>(info.st_size) >= sizeof(h) &&
+            ::pread(fd, &h, sizeof(h), 0) == sizeof(h) &&
+            std::memcmp(h.magic, reference.magic, sizeof(h.magic)) == 0) {
+            _size = static_cast<std::size_t>(info.st_size);
+            void* data =
+                ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)  // NOLINT
+                throw std::runtime_error{"Could not map the feature file " +
+                                         path};
+            _data   = static_cast<const uchar*>(data);
+            _header = h;
+
+            if (!valid()) {
+                ::munmap(const_cast<uchar*>(_data), _size);  // NOLINT
+                _data = nullptr;
+                throw std::runtime_error{"Corrupted feature file " + path};
+            }
+            return;
+        }
+    }
+
+    // Text files of all versions, including compressed files.
+    _yaml = std::make_unique<cv::FileStorage>(
+        path, cv::FileStorage::READ | cv::FileStorage::FORMAT_YAML);
+}
+
+feature_file::feature_file(feature_file&& other) noexcept
+    : _data{std::exchange(other._data, nullptr)}
+    , _size{std::exchange(other._size, 0)}
+    , _header{other._header}
+    , _yaml{std::move(other._yaml)} {}
+
+feature_file& feature_file::operator=(feature_file&& other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_header, other._header);
+    std::swap(_yaml, other._yaml);
+    return *this;
+}
+
+feature_file::~feature_file() {
+    if (_data != nullptr)
+        ::munmap(const_cast<uchar*>(_data), _size);  // NOLINT
+}
+
+bool feature_file::valid() const noexcept {
+    const feature_header reference;
+    if (_header.version != reference.version)
+        return false;
+    if (_header.descriptor_rows != 0U && _header.descriptor_cols == 0U)
+        return false;
+    // The size of the descriptors depends on a known type.
+    if (!valid_descriptor_type(_header.descriptor_type))
+        return false;
+
+    const auto section_fits = [this](std::uint64_t offset,
+                                     std::size_t   length) {
+        return offset % section_alignment == 0 && offset <= _size &&
+               length <= _size - offset;
+    };
+    return section_fits(_header.source_offset, _header.source_size) &&
+           section_fits(_header.keypoints_offset, keypoints_size(_header)) &&
+           section_fits(_header.descriptors_offset, descriptors_size(_header));
+}
+
+std::string feature_file::source_path() const {
+    if (_data == nullptr) {
+        std::string p;
+        cv::read((*_yaml)["source_path"], p, "");
+        return p;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return {reinterpret_cast<const char*>(_data + _header.source_offset),
+            _header.source_size};
+}
+
+std::vector<cv::KeyPoint> feature_file::keypoints() const {
+    std::vector<cv::KeyPoint> k;
+    if (_data == nullptr) {
+        cv::read((*_yaml)["keypoints"], k);
+        return k;
+    }
+
+    const std::size_t n = _header.keypoint_count;
+    // The sections are aligned, so the arrays are accessed in place.
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* f = reinterpret_cast<const float*>(_data +
+                                                   _header.keypoints_offset);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* i = reinterpret_cast<const std::int32_t*>(f + 5 * n);
+
+    k.reserve(n);
+    for (std::size_t p = 0; p < n; ++p)
+        k.emplace_back(cv::Point2f{f[p], f[n + p]}, f[2 * n + p],
+                       f[3 * n + p], f[4 * n + p], i[p], i[n + p]);
+    return k;
+}
+
+cv::Mat feature_file::descriptors() const {
+    cv::Mat d;
+    if (_data == nullptr) {
+        cv::read((*_yaml)["descriptors"], d);
+        return d;
+    }
+    if (_header.descriptor_rows == 0U)
+        return d;
+
+    // The mapping ends with the object, the rows are copied at once.
+    d.create(gsl::narrow<int>(_header.descriptor_rows),
+             gsl::narrow<int>(_header.descriptor_cols),
+             _header.descriptor_type);
+    std::memcpy(d.data, _data + _header.descriptors_offset,
+                descriptors_size(_header));
+    return d;
+}
+
+bool write_features(const std::string&               path,
+                    std::string_view                 source_path,
+                    const std::vector<cv::KeyPoint>& keypoints,
+                    const cv::Mat&                   descriptors) {
+    if (feature_format_for(path) == feature_format::binary)
+        return write_binary(path, source_path, keypoints, descriptors);
+
+    cv::FileStorage fs{path,
+                       cv::FileStorage::WRITE | cv::FileStorage::FORMAT_YAML};
+    if (!fs.isOpened())
+        return false;
+    cv::write(fs, "source_path", std::string(source_path));
+    cv::write(fs, "keypoints", keypoints);
+    cv::write(fs, "descriptors", descriptors);
+    return true;
+}
+
+}  // namespace sens_loc::io
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <iomanip>
+#include <ios>
+#include <sens_loc/io/manifest.h>
+#include <sstream>
+#include <sys/stat.h>
+#include <utility>
+
+namespace sens_loc::io {
+
+namespace {
+constexpr std::string_view manifest_magic   = "sens_loc-manifest";
+constexpr int              manifest_version = 1;
+
+std::string header_line(std::string_view configuration) {
+    std::ostringstream s;
+    s << manifest_magic << '\t' << manifest_version << '\t' << std::hex
+      << std::setw(16) << std::setfill('0')
+      << batch_manifest::hash(configuration);
+    return s.str();
+}
+
+std::vector<std::string> split_fields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::istringstream       s{line};
+    std::string              field;
+    while (std::getline(s, field, '\t'))
+        fields.emplace_back(std::move(field));
+    return fields;
+}
+
+std::map<int, std::vector<std::string>> read_records(std::istream& in) {
+    std::map<int, std::vector<std::string>> records;
+    std::string                             line;
+    while (std::getline(in, line)) {
+        // A batch that was killed might have left a partial last line
+        // without line break.
+        if (in.eof())
+            break;
+        std::vector<std::string> fields = split_fields(line);
+        if (fields.size() < 2)
+            continue;
+        std::size_t parsed = 0;
+        int         idx    = 0;
+        try {
+            idx = std::stoi(fields[0], &parsed);
+        } catch (...) { continue; }
+        if (parsed != fields[0].size())
+            continue;
+        // Later records of an index replace the earlier ones.
+        fields.erase(fields.begin());
+        records[idx] = std::move(fields);
+    }
+    return records;
+}
+}  // namespace
+
+std::unique_ptr<batch_manifest>
+batch_manifest::open(const std::string&       path,
+                     std::string_view         configuration,
+                     std::vector<std::string> dependencies) noexcept {
+    try {
+        std::unique_ptr<batch_manifest> m{new batch_manifest()};
+        const std::string               header = header_line(configuration);
+
+        {
+            std::ifstream previous{path};
+            std::string   line;
+            if (previous && std::getline(previous, line) && line == header)
+                m->_records = read_records(previous);
+        }
+
+        std::int64_t newest = 0;
+        bool         exist  = true;
+        for (const std::string& d : dependencies) {
+            const auto t = modification_time(d);
+            exist &= t.has_value();
+            newest = std::max(newest, t.value_or(0));
+        }
+        if (exist)
+            m->_dependency_time = newest;
+
+        // The manifest is rewritten with one record per index, so that it
+        // does not grow with each batch.
+        std::lock_guard l{m->_mutex};
+        m->_file.open(path, std::ios::out | std::ios::trunc);
+        m->_file << header << '\n';
+        for (const auto& [idx, outputs] : m->_records) {
+            m->_file << idx;
+            for (const std::string& o : outputs)
+                m->_file << '\t' << o;
+            m->_file << '\n';
+        }
+        m->_file.flush();
+        if (!m->_file)
+            return nullptr;
+        return m;
+    } catch (...) { return nullptr; }
+}
+
+bool batch_manifest::up_to_date(int idx, const std::string& input) const
+    noexcept {
+    if (!_dependency_time)
+        return false;
+
+    const auto record = _records.find(idx);
+    if (record == _records.end())
+        return false;
+
+    const auto input_time = modification_time(input);
+    if (!input_time)
+        return false;
+    const std::int64_t newest_input = std::max(*input_time, *_dependency_time);
+
+    return std::all_of(record->second.begin(), record->second.end(),
+                       [newest_input](const std::string& output) {
+                           const auto t = modification_time(output);
+                           return t && *t >= newest_input;
+                       });
+}
+
+bool batch_manifest::record(int                             idx,
+                            const std::vector<std::string>& outputs) noexcept {
+    try {
+        std::lock_guard l{_mutex};
+        _file << idx;
+        for (const std::string& o : outputs)
+            _file << '\t' << o;
+        _file << '\n';
+        // An interrupted batch keeps all records that are flushed.
+        _file.flush();
+        return static_cast<bool>(_file);
+    } catch (...) { return false; }
+}
+
+std::uint64_t batch_manifest::hash(std::string_view configuration) noexcept {
+    // 64-bit FNV-1a, which is stable between runs and platforms.
+    std::uint64_t h = 14695981039346656037ULL;
+    for (const char c : configuration) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+std::optional<std::int64_t>
+batch_manifest::modification_time(const std::string& file) noexcept {
+    struct stat s {};
+    if (::stat(file.c_str(), &s) != 0)
+        return std::nullopt;
+    constexpr std::int64_t ns_per_s = 1'000'000'000;
+    return static_cast<std::int64_t>(s.st_mtim.tv_sec) * ns_per_s +
+           static_cast<std::int64_t>(s.st_mtim.tv_nsec);
+}
+
+}  // namespace sens_loc::io
@@ -0,0 +1,314 @@
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <gsl/gsl>
+#include <sens_loc/io/sequence.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace sens_loc::io {
+
+namespace {
+constexpr std::size_t frame_alignment = 64;
+constexpr std::size_t pose_floats     = 12;
+
+std::size_t align(std::size_t offset) noexcept {
+    return (offset + frame_alignment - 1) / frame_alignment * frame_alignment;
+}
+
+/// Byte offset of the poses and the frame offsets in an archive.
+std::size_t poses_begin(const sequence_header& h) noexcept {
+    return sizeof(sequence_header) + h.intrinsic_size;
+}
+std::size_t offsets_begin(const sequence_header& h) noexcept {
+    const std::size_t poses = h.has_poses != 0U
+                                  ? h.frame_count * pose_floats * sizeof(float)
+                                  : 0U;
+    // The offsets are aligned to be accessed in place.
+    return align(poses_begin(h) + poses);
+}
+std::size_t frames_begin(const sequence_header& h) noexcept {
+    return align(offsets_begin(h) +
+                 (h.frame_count + 1) * sizeof(std::uint64_t));
+}
+
+void delta_encode(const cv::Mat& frame, std::vector<uchar>& out) {
+    out.clear();
+    for (int v = 0; v < frame.rows; ++v) {
+        const auto* row   = frame.ptr<ushort>(v);
+        ushort      prior = 0;
+        for (int u = 0; u < frame.cols; ++u) {
+            // The difference wraps around, which keeps the coding lossless.
+            const auto delta = static_cast<std::uint32_t>(
+                static_cast<std::uint16_t>(row[u] - prior));
+            prior = row[u];
+
+            // Zig-zag coding maps small negative and positive differences to
+            // small unsigned numbers.
+            const std::uint32_t sign = (delta & 0x8000U) != 0U ? 0xFFFFU : 0U;
+            std::uint32_t       z    = ((delta << 1U) & 0xFFFFU) ^ sign;
+            while (z >= 0x80U) {
+                out.push_back(static_cast<uchar>(z | 0x80U));
+                z >>= 7U;
+            }
+            out.push_back(static_cast<uchar>(z));
+        }
+    }
+}
+
+bool delta_decode(const uchar* in, const uchar* end, cv::Mat& frame) noexcept {
+    for (int v = 0; v < frame.rows; ++v) {
+        auto*  row   = frame.ptr<ushort>(v);
+        ushort prior = 0;
+        for (int u = 0; u < frame.cols; ++u) {
+            std::uint32_t z     = 0;
+            unsigned      shift = 0;
+            do {
+                if (in == end || shift > 14)
+                    return false;
+                z |= static_cast<std::uint32_t>(*in & 0x7FU) << shift;
+                shift += 7;
+            } while ((*in++ & 0x80U) != 0U);
+
+            const auto delta = static_cast<std::int16_t>(
+                (z >> 1U) ^ (~(z & 1U) + 1U));
+            prior  = static_cast<ushort>(prior + delta);
+            row[u] = prior;
+        }
+    }
+    // Only the padding to the next frame may follow.
+    return end - in < std::ptrdiff_t(frame_alignment);
+}
+}  // namespace
+
+depth_sequence::depth_sequence(uchar* data, std::size_t size) noexcept
+    : _data{data}
+    , _size{size} {
+    if (_size >= sizeof(sequence_header))
+        std::memcpy(&_header, _data, sizeof(sequence_header));
+}
+
+depth_sequence::depth_sequence(depth_sequence&& other) noexcept
+    : _data{std::exchange(other._data, nullptr)}
+    , _size{std::exchange(other._size, 0)}
+    , _header{other._header} {}
+
+depth_sequence& depth_sequence::operator=(depth_sequence&& other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    std::swap(_header, other._header);
+    return *this;
+}
+
+depth_sequence::~depth_sequence() {
+    if (_data != nullptr)
+        ::munmap(_data, _size);
+}
+
+std::optional<depth_sequence>
+depth_sequence::open(const std::string& path) noexcept {
+    const int fd = ::open(path.c_str(), O_RDONLY);  // NOLINT
+    if (fd < 0)
+        return std::nullopt;
+    auto close_file = gsl::finally([fd]() { ::close(fd); });
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+        return std::nullopt;
+    const auto size = static_cast<std::size_t>(info.st_size);
+
+    // A private, writable mapping allows to hand out modifiable views of the
+    // frames. Modifications are copied on write and never reach the file.
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                        fd, 0);
+    if (data == MAP_FAILED)  // NOLINT
+        return std::nullopt;
+    // The frames are usually processed in order.
+    ::madvise(data, size, MADV_SEQUENTIAL);
+
+    depth_sequence s{static_cast<uchar*>(data), size};
+    if (!s.valid())
+        return std::nullopt;
+    return s;
+}
+
+bool depth_sequence::valid() const noexcept {
+    const sequence_header reference;
+    if (_size < sizeof(sequence_header) ||
+        std::memcmp(_header.magic, reference.magic, sizeof(reference.magic)) !=
+            0 ||
+        _header.version != reference.version)
+        return false;
+    if (_header.width == 0U || _header.height == 0U ||
+        _header.frame_count == 0U)
+        return false;
+    if (_header.encoding != sequence_encoding::raw &&
+        _header.encoding != sequence_encoding::delta)
+        return false;
+    if (frames_begin(_header) > _size)
+        return false;
+
+    const std::uint64_t* o = offsets();
+    if (o[0] != frames_begin(_header) || o[_header.frame_count] > _size)
+        return false;
+    const std::size_t raw_size =
+        align(std::size_t(_header.width) * _header.height * sizeof(ushort));
+    for (std::uint32_t i = 0; i < _header.frame_count; ++i) {
+        if (o[i] > o[i + 1] || o[i + 1] % frame_alignment != 0)
+            return false;
+        if (_header.encoding == sequence_encoding::raw &&
+            o[i + 1] - o[i] != raw_size)
+            return false;
+    }
+    return true;
+}
+
+const std::uint64_t* depth_sequence::offsets() const noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return reinterpret_cast<const std::uint64_t*>(_data +
+                                                  offsets_begin(_header));
+}
+
+std::string_view depth_sequence::intrinsic() const noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return {reinterpret_cast<const char*>(_data + sizeof(sequence_header)),
+            _header.intrinsic_size};
+}
+
+std::optional<math::pose_t> depth_sequence::pose(int idx) const noexcept {
+    Expects(idx >= 0 && idx < size());
+    if (_header.has_poses == 0U)
+        return std::nullopt;
+
+    float values[pose_floats];
+    std::memcpy(values,
+                _data + poses_begin(_header) + idx * sizeof(values),
+                sizeof(values));
+
+    math::pose_t p = math::pose_t::Identity();
+    for (int row = 0; row < 3; ++row)
+        for (int col = 0; col < 4; ++col)
+            p(row, col) = values[row * 4 + col];
+    return p;
+}
+
+math::image<ushort> depth_sequence::view(int idx) const noexcept {
+    Expects(encoding() == sequence_encoding::raw);
+    Expects(idx >= 0 && idx < size());
+    return math::image<ushort>(
+        cv::Mat(h(), w(), CV_16U, _data + offsets()[idx]));
+}
+
+bool depth_sequence::read(int idx, math::image<ushort>& target) const
+    noexcept {
+    Expects(idx >= 0 && idx < size());
+
+    if (encoding() == sequence_encoding::raw) {
+        target = view(idx);
+        return true;
+    }
+
+    // Decoding must not overwrite a view into the archive, that 'target'
+    // might still hold.
+    cv::Mat out = target.data();
+    if (out.data >= _data && out.data < _data + _size)
+        out = cv::Mat();
+    out.create(h(), w(), CV_16U);
+
+    const uchar* begin = _data + offsets()[idx];
+    const uchar* end   = _data + offsets()[idx + 1];
+    if (!delta_decode(begin, end, out))
+        return false;
+
+    target = std::move(out);
+    return true;
+}
+
+depth_sequence_writer::depth_sequence_writer(const std::string& path,
+                                             int                frame_count,
+                                             sequence_encoding  encoding,
+                                             std::string_view   intrinsic,
+                                             bool               with_poses)
+    : _out{path, std::ios::binary | std::ios::trunc}
+    , _intrinsic{intrinsic} {
+    Expects(frame_count > 0);
+    _header.frame_count    = static_cast<std::uint32_t>(frame_count);
+    _header.encoding       = encoding;
+    _header.intrinsic_size = static_cast<std::uint32_t>(_intrinsic.size());
+    _header.has_poses      = with_poses ? 1U : 0U;
+    _offsets.reserve(_header.frame_count + 1);
+    _offsets.push_back(frames_begin(_header));
+    if (with_poses)
+        _poses.reserve(_header.frame_count * pose_floats);
+
+    // The header and the index are written in 'finish', once the frames are
+    // known. The frames start after the space for them.
+    _out.seekp(gsl::narrow_cast<std::streamoff>(_offsets.front()));
+}
+
+bool depth_sequence_writer::add(const math::image<ushort>& frame,
+                                const math::pose_t&        pose) noexcept {
+    Expects(_offsets.size() <= _header.frame_count);
+    if (_offsets.size() == 1) {
+        _header.width  = static_cast<std::uint32_t>(frame.w());
+        _header.height = static_cast<std::uint32_t>(frame.h());
+    }
+    Expects(frame.w() == static_cast<int>(_header.width));
+    Expects(frame.h() == static_cast<int>(_header.height));
+
+    try {
+        const cv::Mat& data = frame.data();
+        if (_header.encoding == sequence_encoding::raw) {
+            for (int v = 0; v < data.rows; ++v)
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                _out.write(reinterpret_cast<const char*>(data.ptr<ushort>(v)),
+                           data.cols * sizeof(ushort));
+        } else {
+            delta_encode(data, _buffer);
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            _out.write(reinterpret_cast<const char*>(_buffer.data()),
+                       gsl::narrow_cast<std::streamsize>(_buffer.size()));
+        }
+        // Pad to the alignment of the next frame.
+        const auto        end = static_cast<std::size_t>(_out.tellp());
+        const char        zeros[frame_alignment] = {};
+        const std::size_t padding                = align(end) - end;
+        _out.write(zeros, gsl::narrow_cast<std::streamsize>(padding));
+        _offsets.push_back(align(end));
+
+        if (_header.has_poses != 0U)
+            for (int row = 0; row < 3; ++row)
+                for (int col = 0; col < 4; ++col)
+                    _poses.push_back(pose(row, col));
+
+        return _out.good();
+    } catch (...) { return false; }
+}
+
+bool depth_sequence_writer::finish() noexcept {
+    Expects(_offsets.size() == _header.frame_count + 1);
+
+    try {
+        // All numbers are written in the byte order of the host.
+        _out.seekp(0);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _out.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+        _out.write(_intrinsic.data(),
+                   gsl::narrow_cast<std::streamsize>(_intrinsic.size()));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _out.write(reinterpret_cast<const char*>(_poses.data()),
+                   gsl::narrow_cast<std::streamsize>(_poses.size() *
+                                                     sizeof(float)));
+        _out.seekp(gsl::narrow_cast<std::streamoff>(offsets_begin(_header)));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        _out.write(reinterpret_cast<const char*>(_offsets.data()),
+                   gsl::narrow_cast<std::streamsize>(_offsets.size() *
+                                                     sizeof(std::uint64_t)));
+        _out.close();
+        return !_out.fail();
+    } catch (...) { return false; }
+}
+
+}  // namespace sens_loc::io
@@ -0,0 +1,271 @@
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <csignal>
+#include <ctime>
+#include <gsl/gsl>
+#include <pthread.h>
+#include <sens_loc/io/stream.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+namespace sens_loc::io {
+
+namespace {
+constexpr std::string_view socket_prefix = "unix:";
+
+bool make_address(const std::string& path, sockaddr_un& address) noexcept {
+    address            = {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+/// Create the socket \p path and accept the first client.
+int listen_socket(const std::string& path) noexcept {
+    sockaddr_un address;
+    if (!make_address(path, address))
+        return -1;
+
+    const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0)
+        return -1;
+    // A socket file of a previous run would block the address.
+    ::unlink(path.c_str());
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* a = reinterpret_cast<const sockaddr*>(&address);
+    if (::bind(server, a, sizeof(address)) != 0 || ::listen(server, 1) != 0) {
+        ::close(server);
+        return -1;
+    }
+
+    int client = -1;
+    do {
+        client = ::accept(server, nullptr, nullptr);
+    } while (client < 0 && errno == EINTR);
+    ::close(server);
+    ::unlink(path.c_str());
+    return client;
+}
+
+/// Connect to the socket \p path, which might not exist yet.
+int connect_socket(const std::string& path) noexcept {
+    sockaddr_un address;
+    if (!make_address(path, address))
+        return -1;
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto* a = reinterpret_cast<const sockaddr*>(&address);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        if (::connect(fd, a, sizeof(address)) == 0)
+            return fd;
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return -1;
+}
+
+/// Blocks \c SIGPIPE in the calling thread while it exists, so that writing
+/// to a pipe without reader fails with \c EPIPE instead of terminating the
+/// process. A signal that is raised meanwhile is discarded.
+class sigpipe_block {
+  public:
+    sigpipe_block() noexcept {
+        sigemptyset(&_pipe);
+        sigaddset(&_pipe, SIGPIPE);
+        sigset_t pending;
+        sigpending(&pending);
+        _was_pending = sigismember(&pending, SIGPIPE) == 1;
+        pthread_sigmask(SIG_BLOCK, &_pipe, &_previous);
+    }
+    sigpipe_block(const sigpipe_block&) = delete;
+    sigpipe_block(sigpipe_block&&)      = delete;
+    sigpipe_block& operator=(const sigpipe_block&) = delete;
+    sigpipe_block& operator=(sigpipe_block&&) = delete;
+    ~sigpipe_block() {
+        if (!_was_pending) {
+            const timespec no_wait{};
+            while (sigtimedwait(&_pipe, nullptr, &no_wait) < 0 &&
+                   errno == EINTR) {
+            }
+        }
+        pthread_sigmask(SIG_SETMASK, &_previous, nullptr);
+    }
+
+  private:
+    sigset_t _pipe;
+    sigset_t _previous;
+    bool     _was_pending = false;
+};
+
+bool valid_type(int type) noexcept {
+    return type == CV_8UC1 || type == CV_8UC3 || type == CV_16UC1 ||
+           type == CV_32FC1;
+}
+}  // namespace
+
+frame_stream::frame_stream(int fd, bool owned, bool socket) noexcept
+    : _fd{fd}
+    , _owned{owned}
+    , _socket{socket} {}
+
+frame_stream::frame_stream(frame_stream&& other) noexcept
+    : _fd{std::exchange(other._fd, -1)}
+    , _owned{std::exchange(other._owned, false)}
+    , _socket{other._socket}
+    , _peer_closed{other._peer_closed} {}
+
+frame_stream& frame_stream::operator=(frame_stream&& other) noexcept {
+    std::swap(_fd, other._fd);
+    std::swap(_owned, other._owned);
+    std::swap(_socket, other._socket);
+    std::swap(_peer_closed, other._peer_closed);
+    return *this;
+}
+
+frame_stream::~frame_stream() {
+    if (_owned && _fd >= 0)
+        ::close(_fd);
+}
+
+bool frame_stream::is_socket(const std::string& spec) noexcept {
+    return spec.compare(0, socket_prefix.size(), socket_prefix) == 0;
+}
+
+std::optional<frame_stream> frame_stream::open(const std::string& spec,
+                                               stream_mode        mode,
+                                               socket_role role) noexcept {
+    try {
+        if (spec == "-")
+            return frame_stream{mode == stream_mode::read ? STDIN_FILENO
+                                                          : STDOUT_FILENO,
+                                /*owned=*/false, /*socket=*/false};
+
+        if (is_socket(spec)) {
+            const std::string path = spec.substr(socket_prefix.size());
+            const int         fd   = role == socket_role::listen
+                                   ? listen_socket(path)
+                                   : connect_socket(path);
+            if (fd < 0)
+                return std::nullopt;
+            return frame_stream{fd, /*owned=*/true, /*socket=*/true};
+        }
+
+        const int flags = mode == stream_mode::read
+                              ? O_RDONLY
+                              : O_WRONLY | O_CREAT | O_TRUNC;  // NOLINT
+        const int fd    = ::open(spec.c_str(), flags, 0644);   // NOLINT
+        if (fd < 0)
+            return std::nullopt;
+        return frame_stream{fd, /*owned=*/true, /*socket=*/false};
+    } catch (...) { return std::nullopt; }
+}
+
+stream_status frame_stream::read(stream_header& header,
+                                 cv::Mat&       image) noexcept {
+    bool closed = false;
+    if (!read_bytes(&header, sizeof(header), closed))
+        return closed ? stream_status::end : stream_status::error;
+
+    const stream_header reference;
+    if (std::memcmp(header.magic, reference.magic, sizeof(header.magic)) !=
+            0 ||
+        !valid_type(header.type) || header.width == 0U ||
+        header.height == 0U || header.width > max_dimension ||
+        header.height > max_dimension)
+        return stream_status::error;
+
+    try {
+        image.create(static_cast<int>(header.height),
+                     static_cast<int>(header.width), header.type);
+    } catch (...) { return stream_status::error; }
+
+    // A stream that ends within an image is broken.
+    const std::size_t row_bytes = image.cols * image.elemSize();
+    for (int v = 0; v < image.rows; ++v)
+        if (!read_bytes(image.ptr(v), row_bytes, closed))
+            return stream_status::error;
+    return stream_status::frame;
+}
+
+bool frame_stream::write(std::uint32_t  sequence,
+                         std::uint32_t  part,
+                         std::uint32_t  parts,
+                         const cv::Mat& image) noexcept {
+    Expects(valid_type(image.type()));
+
+    // Sockets are written without raising SIGPIPE in the first place.
+    std::optional<sigpipe_block> block;
+    if (!_socket)
+        block.emplace();
+
+    stream_header header;
+    header.sequence = sequence;
+    header.part     = part;
+    header.parts    = parts;
+    header.width    = static_cast<std::uint32_t>(image.cols);
+    header.height   = static_cast<std::uint32_t>(image.rows);
+    header.type     = image.type();
+    if (!write_bytes(&header, sizeof(header)))
+        return false;
+
+    const std::size_t row_bytes = image.cols * image.elemSize();
+    for (int v = 0; v < image.rows; ++v)
+        if (!write_bytes(image.ptr(v), row_bytes))
+            return false;
+    return true;
+}
+
+void frame_stream::shutdown_write() noexcept {
+    if (_socket)
+        ::shutdown(_fd, SHUT_WR);
+}
+
+bool frame_stream::read_bytes(void*       data,
+                              std::size_t size,
+                              bool&       closed) noexcept {
+    auto*       out  = static_cast<char*>(data);
+    std::size_t done = 0;
+    while (done < size) {
+        const ssize_t r = ::read(_fd, out + done, size - done);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            // Only a stream that ends between two images is closed cleanly.
+            closed = r == 0 && done == 0;
+            return false;
+        }
+        done += static_cast<std::size_t>(r);
+    }
+    return true;
+}
+
+bool frame_stream::write_bytes(const void* data, std::size_t size) noexcept {
+    const auto* in   = static_cast<const char*>(data);
+    std::size_t done = 0;
+    while (done < size) {
+        // Sockets report a closed peer as error instead of raising SIGPIPE.
+        const ssize_t w =
+            _socket ? ::send(_fd, in + done, size - done, MSG_NOSIGNAL)
+                    : ::write(_fd, in + done, size - done);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0) {
+            _peer_closed = w < 0 && errno == EPIPE;
+            return false;
+        }
+        done += static_cast<std::size_t>(w);
+    }
+    return true;
+}
+
+}  // namespace sens_loc::io
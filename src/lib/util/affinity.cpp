@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <charconv>
+#include <sched.h>
+#include <sens_loc/util/affinity.h>
+#include <thread>
+
+namespace sens_loc::util {
+
+namespace {
+/// Parse a CPU number that spans all of \p s.
+std::optional<int> parse_cpu(std::string_view s) noexcept {
+    const char* end   = s.data() + s.size();  // NOLINT
+    int         value = 0;
+    const auto  r     = std::from_chars(s.data(), end, value);
+    if (s.empty() || r.ec != std::errc() || r.ptr != end || value < 0 ||
+        value >= CPU_SETSIZE)
+        return std::nullopt;
+    return value;
+}
+}  // namespace
+
+std::optional<std::vector<int>> parse_cpu_list(std::string_view list) noexcept {
+    try {
+        std::vector<int> cpus;
+        for (;;) {
+            const std::size_t      comma   = list.find(',');
+            const std::string_view element = list.substr(0, comma);
+
+            const std::size_t dash  = element.find('-');
+            const auto        first = parse_cpu(element.substr(0, dash));
+            const auto        last  = dash == std::string_view::npos
+                                   ? first
+                                   : parse_cpu(element.substr(dash + 1));
+            if (!first || !last || *first > *last)
+                return std::nullopt;
+            for (int cpu = *first; cpu <= *last; ++cpu)
+                cpus.push_back(cpu);
+
+            if (comma == std::string_view::npos)
+                break;
+            list.remove_prefix(comma + 1);
+        }
+
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    } catch (...) { return std::nullopt; }
+}
+
+bool set_cpu_affinity(const std::vector<int>& cpus) noexcept {
+    if (cpus.empty())
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+            return false;
+        CPU_SET(cpu, &set);
+    }
+    return ::sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+int available_cpus() noexcept {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0)
+        return std::max(1, CPU_COUNT(&set));
+    return std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+}  // namespace sens_loc::util
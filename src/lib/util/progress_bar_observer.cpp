@@ -1,48 +1,221 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <rang.hpp>
+#include <sens_loc/util/console.h>
 #include <sens_loc/util/progress_bar_observer.h>
+#include <sstream>
+#include <string>
 
 namespace sens_loc::util {
-void progress_bar_observer::on_entry(unsigned /*worker_id*/,
-                                     tf::TaskView /*task_view*/) {
-    if (!_inital_output) {
-        _inital_output = true;
-        print_bar(/*increment=*/false);
+
+namespace {
+/// Short human readable form of a latency, e.g. "850us" or "12ms".
+std::string format_latency(latency_histogram::duration d) {
+    using namespace std::chrono;
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(1);
+    if (d < microseconds(1000))
+        s << duration<double, std::micro>(d).count() << "us";
+    else if (d < milliseconds(1000))
+        s << duration<double, std::milli>(d).count() << "ms";
+    else
+        s << duration<double>(d).count() << "s";
+    return s.str();
+}
+
+/// Remaining time in the form "m:ss" or "h:mm:ss".
+std::string format_eta(double seconds) {
+    const auto total   = static_cast<long>(std::lround(seconds));
+    const long hours   = total / 3600;
+    const long minutes = (total / 60) % 60;
+    std::ostringstream s;
+    s << std::setfill('0');
+    if (hours > 0)
+        s << hours << ":" << std::setw(2) << minutes;
+    else
+        s << minutes;
+    s << ":" << std::setw(2) << total % 60;
+    return s.str();
+}
+}  // namespace
+
+void latency_histogram::add(duration d) noexcept {
+    const auto ns = static_cast<std::uint64_t>(std::max(d.count(), 0L));
+    _counts[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t latency_histogram::count() const noexcept {
+    std::uint64_t sum = 0;
+    for (const auto& c : _counts)
+        sum += c.load(std::memory_order_relaxed);
+    return sum;
+}
+
+latency_histogram::duration latency_histogram::percentile(double p) const
+    noexcept {
+    Expects(p >= 0. && p <= 1.);
+
+    const std::uint64_t samples = count();
+    if (samples == 0U)
+        return duration::zero();
+
+    const auto rank = std::max<std::uint64_t>(
+        1U, static_cast<std::uint64_t>(std::ceil(p * double(samples))));
+    std::uint64_t seen = 0;
+    for (int b = 0; b < buckets; ++b) {
+        seen += _counts[b].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return lower_bound(b);
+    }
+    // Samples were added while counting.
+    return lower_bound(buckets - 1);
+}
+
+int latency_histogram::bucket(std::uint64_t ns) noexcept {
+    if (ns < sub_buckets)
+        return static_cast<int>(ns);
+
+    int msb = 63;
+    while ((ns >> unsigned(msb)) == 0U)
+        --msb;
+    // The two bits after the most significant bit select the sub-bucket.
+    const auto sub = static_cast<int>((ns >> unsigned(msb - 2)) & 3U);
+    return msb * sub_buckets + sub;
+}
+
+latency_histogram::duration
+latency_histogram::lower_bound(int bucket) noexcept {
+    if (bucket < sub_buckets)
+        return duration(bucket);
+    const int  msb = bucket / sub_buckets;
+    const auto sub = static_cast<std::uint64_t>(bucket % sub_buckets);
+    return duration(static_cast<duration::rep>((sub_buckets + sub)
+                                               << unsigned(msb - 2)));
+}
+
+progress_bar_observer::progress_bar_observer(std::int64_t total_tasks)
+    : _total_tasks{total_tasks}
+    , _begin{clock::now()}
+    , _terminal{rang::rang_implementation::isTerminal(std::cout.rdbuf())} {
+    Expects(total_tasks >= 1);
+    _renderer = std::thread([this]() { render_loop(); });
+}
+
+progress_bar_observer::~progress_bar_observer() {
+    {
+        std::lock_guard<std::mutex> l{_stop_mutex};
+        _stop = true;
     }
+    _stop_signal.notify_all();
+    _renderer.join();
+
+    // A batch that did not finish all tasks still reports how far it got.
+    if (!_finished)
+        print_final();
+}
+
+void progress_bar_observer::set_up(unsigned num_workers) {
+    _workers.resize(num_workers);
 }
 
-void progress_bar_observer::on_exit(unsigned /*worker_id*/,
+void progress_bar_observer::on_entry(unsigned worker_id,
+                                     tf::TaskView /*task_view*/) {
+    Expects(worker_id < _workers.size());
+    _workers[worker_id].start = clock::now();
+}
+
+void progress_bar_observer::on_exit(unsigned worker_id,
                                     tf::TaskView /*task_view*/) {
-    print_bar(/*increment=*/true);
+    Expects(worker_id < _workers.size());
+    finish_task(clock::now() - _workers[worker_id].start);
+}
+
+void progress_bar_observer::finish_task(
+    latency_histogram::duration latency) noexcept {
+    _latency.add(latency);
+    // Only the last task prints, so that the final state is visible before
+    // the batch returns.
+    if (++_done == _total_tasks)
+        print_final();
 }
 
-void progress_bar_observer::print_bar(bool increment) noexcept {
+void progress_bar_observer::render_loop() noexcept {
+    std::unique_lock<std::mutex> l{_stop_mutex};
+    clock::time_point            next_log = _begin + log_interval;
+
+    while (!_stop_signal.wait_for(l, redraw_interval,
+                                  [this]() { return _stop; })) {
+        if (_terminal)
+            print_status();
+        else if (clock::now() >= next_log) {
+            print_status();
+            next_log += log_interval;
+        }
+    }
+}
+
+void progress_bar_observer::print_final() noexcept {
     auto s = synced();
+    if (_finished.exchange(true))
+        return;
+    print_line();
+    std::cout << std::endl;
+}
 
-    if (increment)
-        _done++;
+void progress_bar_observer::print_status() noexcept {
+    auto s = synced();
+    if (_finished)
+        return;
+    print_line();
+    if (!_terminal)
+        std::cout << std::endl;
+}
 
-    std::cout << "\r" << rang::fg::green << rang::style::bold << std::setw(5)
-              << _done << " ";
+void progress_bar_observer::print_line() noexcept {
+    const std::int64_t done = std::min<std::int64_t>(_done, _total_tasks);
+    const double       seconds =
+        std::chrono::duration<double>(clock::now() - _begin).count();
+    const double rate = seconds > 0. ? double(done) / seconds : 0.;
 
-    auto progress =
-        gsl::narrow_cast<float>(_done) / gsl::narrow_cast<float>(_total_tasks);
+    if (_terminal) {
+        std::cout << "\r" << rang::fg::green << rang::style::bold
+                  << std::setw(5) << done << " ";
 
-    int bar_elements =
-        gsl::narrow_cast<int>(progress * gsl::narrow_cast<float>(max_bars));
-    Ensures(bar_elements <= max_bars);
-    Ensures(bar_elements >= 0);
-    int empty_elements = max_bars - bar_elements;
+        auto progress = gsl::narrow_cast<float>(done) /
+                        gsl::narrow_cast<float>(_total_tasks);
+        int bar_elements =
+            gsl::narrow_cast<int>(progress * gsl::narrow_cast<float>(max_bars));
+        Ensures(bar_elements <= max_bars);
+        Ensures(bar_elements >= 0);
+        int empty_elements = max_bars - bar_elements;
 
-    std::cout << rang::style::reset << rang::bg::green << rang::fg::green;
-    for (int i = 0; i < bar_elements; ++i) {
-        std::cout << "#";
+        std::cout << rang::style::reset << rang::bg::green << rang::fg::green;
+        for (int i = 0; i < bar_elements; ++i) {
+            std::cout << "#";
+        }
+        std::cout << rang::bg::blue << rang::fg::blue;
+        for (int i = 0; i < empty_elements; ++i) {
+            std::cout << ".";
+        }
+        std::cout << rang::style::reset;
+    } else {
+        std::cout << "progress: " << done << "/" << _total_tasks;
     }
-    std::cout << rang::bg::blue << rang::fg::blue;
-    for (int i = 0; i < empty_elements; ++i) {
-        std::cout << ".";
-    }
-    std::cout << rang::style::reset << std::flush;
 
-    if (_done == _total_tasks)
-        std::cout << std::endl;
+    std::cout << "  " << std::fixed << std::setprecision(1) << rate
+              << " images/s";
+    if (done < _total_tasks)
+        std::cout << "  ETA "
+                  << (rate > 0. ? format_eta(double(_total_tasks - done) / rate)
+                                : std::string{"-:--"});
+    if (_latency.count() > 0U)
+        std::cout << "  p50 " << format_latency(_latency.percentile(0.5))
+                  << "  p99 " << format_latency(_latency.percentile(0.99));
+    // Erase the remainder of a longer, previous line.
+    if (_terminal)
+        std::cout << "\033[K";
+    std::cout << std::flush;
 }
 }  // namespace sens_loc::util
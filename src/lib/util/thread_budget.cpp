@@ -0,0 +1,30 @@
+#include <gsl/gsl>
+#include <opencv2/core.hpp>
+#include <sens_loc/util/thread_budget.h>
+
+namespace sens_loc::util {
+
+thread_budget
+split_threads(thread_policy policy, int threads, int tasks) noexcept {
+    Expects(threads > 0);
+    Expects(tasks > 0);
+
+    switch (policy) {
+    case thread_policy::outer: return {threads, 1};
+    case thread_policy::inner: return {1, threads};
+    // Batches that can not occupy all workers leave the threads to OpenCV.
+    case thread_policy::hybrid:
+        return tasks >= threads ? thread_budget{threads, 1}
+                                : thread_budget{1, threads};
+    }
+    return {threads, 1};
+}
+
+void apply_opencv_threads(const thread_budget& budget) noexcept {
+    Expects(budget.opencv_threads > 0);
+    Expects(budget.workers == 1 || budget.opencv_threads == 1);
+    // '0' runs all functions sequentially without starting any thread.
+    cv::setNumThreads(budget.opencv_threads == 1 ? 0 : budget.opencv_threads);
+}
+
+}  // namespace sens_loc::util
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sens_loc/util/trace.h>
+#include <string_view>
+
+namespace sens_loc::util {
+
+namespace detail {
+std::atomic<bool> tracing_active{false};
+}  // namespace detail
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+/// Spans of one thread. The mutex is only contended while the spans are
+/// collected.
+struct thread_buffer {
+    std::mutex               mutex;
+    std::vector<trace_event> events;
+    std::uint32_t            thread = 0;
+};
+
+/// All buffers, they outlive their threads to be collected at the end.
+struct buffer_registry {
+    std::mutex                                  mutex;
+    std::vector<std::unique_ptr<thread_buffer>> buffers;
+};
+buffer_registry& registry() {
+    static buffer_registry r;
+    return r;
+}
+
+clock::time_point epoch;
+
+thread_buffer& local_buffer() {
+    thread_local thread_buffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        buffer_registry&            r = registry();
+        std::lock_guard<std::mutex> l{r.mutex};
+        r.buffers.push_back(std::make_unique<thread_buffer>());
+        buffer         = r.buffers.back().get();
+        buffer->thread = static_cast<std::uint32_t>(r.buffers.size());
+    }
+    return *buffer;
+}
+
+std::int64_t since_epoch(clock::time_point t) noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch)
+        .count();
+}
+
+/// Escape \p s for a JSON string.
+void write_json_string(std::ostream& os, std::string_view s) {
+    os << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+}  // namespace
+
+void enable_tracing() noexcept {
+    epoch = clock::now();
+    detail::tracing_active.store(true, std::memory_order_release);
+}
+
+void record_span(const char*       name,
+                 clock::time_point begin,
+                 clock::time_point end) noexcept {
+    try {
+        thread_buffer&              b = local_buffer();
+        std::lock_guard<std::mutex> l{b.mutex};
+        b.events.push_back(
+            {name, b.thread, since_epoch(begin), since_epoch(end)});
+    } catch (...) {
+        // A span that can not be stored is dropped, the trace is only
+        // diagnostic output.
+    }
+}
+
+std::vector<trace_event> recorded_spans() {
+    std::vector<trace_event> all;
+    {
+        buffer_registry&            r = registry();
+        std::lock_guard<std::mutex> l{r.mutex};
+        for (const auto& b : r.buffers) {
+            std::lock_guard<std::mutex> lb{b->mutex};
+            all.insert(all.end(), b->events.begin(), b->events.end());
+        }
+    }
+    std::sort(all.begin(), all.end(),
+              [](const trace_event& e1, const trace_event& e2) {
+                  return e1.begin < e2.begin;
+              });
+    return all;
+}
+
+bool write_chrome_trace(const std::string&              path,
+                        const std::vector<trace_event>& events) {
+    std::ofstream out{path};
+    if (!out)
+        return false;
+
+    // Complete events ("ph": "X") with timestamps in microseconds.
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (const trace_event& e : events) {
+        if (!first)
+            out << ",\n";
+        first = false;
+        out << "{\"name\": ";
+        write_json_string(out, e.name);
+        out << ", \"cat\": \"sens_loc\", \"ph\": \"X\", \"pid\": 1, "
+            << "\"tid\": " << e.thread << ", \"ts\": " << (e.begin / 1e3)
+            << ", \"dur\": " << ((e.end - e.begin) / 1e3) << "}";
+    }
+    out << "\n]}\n";
+    out.close();
+    return !out.fail();
+}
+
+void print_trace_summary(std::ostream&                   os,
+                         const std::vector<trace_event>& events) {
+    struct stage {
+        std::int64_t spans = 0;
+        std::int64_t total = 0;
+        std::int64_t max   = 0;
+    };
+    std::map<std::string_view, stage> stages;
+    for (const trace_event& e : events) {
+        stage& s = stages[e.name];
+        const std::int64_t d = e.end - e.begin;
+        s.spans++;
+        s.total += d;
+        s.max = std::max(s.max, d);
+    }
+
+    // The most expensive stages come first.
+    std::vector<std::pair<std::string_view, stage>> sorted(stages.begin(),
+                                                           stages.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& s1, const auto& s2) {
+                  return s1.second.total > s2.second.total;
+              });
+
+    os << std::left << std::setw(20) << "Stage" << std::right << std::setw(10)
+       << "Spans" << std::setw(14) << "Total [ms]" << std::setw(12)
+       << "Mean [ms]" << std::setw(12) << "Max [ms]" << "\n";
+    os << std::fixed << std::setprecision(2);
+    for (const auto& [name, s] : sorted) {
+        os << std::left << std::setw(20) << name << std::right << std::setw(10)
+           << s.spans << std::setw(14) << (s.total / 1e6) << std::setw(12)
+           << (double(s.total) / double(s.spans) / 1e6) << std::setw(12)
+           << (s.max / 1e6) << "\n";
+    }
+}
+
+}  // namespace sens_loc::util
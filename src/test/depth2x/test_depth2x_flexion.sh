@@ -73,5 +73,48 @@ if  [ ! -f batch-flexion-laserscan-0.png ] || \
     exit 1
 fi
 
+# Faster codecs and compression levels for the output images.
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --output-compression 0 \
+    flexion \
+    --output "batch-flexion-uncompressed-{}.png"
+then
+    print_error "Could not create uncompressed flexion images."
+    exit 1
+fi
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    flexion \
+    --output "batch-flexion-raw-{}.pgm"
+then
+    print_error "Could not create raw flexion images."
+    exit 1
+fi
+if  [ ! -f batch-flexion-uncompressed-0.png ] || \
+    [ ! -f batch-flexion-uncompressed-1.png ] || \
+    [ ! -f batch-flexion-raw-0.pgm ] || \
+    [ ! -f batch-flexion-raw-1.pgm ]; then
+    print_error "Did not create expected output files with other codecs."
+    exit 1
+fi
+if [ "$(wc -c < batch-flexion-uncompressed-0.png)" -le \
+     "$(wc -c < batch-flexion-0.png)" ]; then
+    print_error "Uncompressed images are expected to be larger."
+    exit 1
+fi
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --output-compression 10 \
+    flexion \
+    --output "batch-flexion-invalid-{}.png"
+then
+    print_error "Expected failure for an invalid compression level."
+    exit 1
+fi
+
 print_info "Test successful!"
 exit 0
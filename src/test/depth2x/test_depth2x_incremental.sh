@@ -0,0 +1,129 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-incremental-*
+
+# Old inputs and calibration, so that the age of the outputs tells if they
+# were written again.
+cp data0-depth.png batch-incremental-input-0.png
+cp data1-depth.png batch-incremental-input-1.png
+cp kinect_intrinsic.txt batch-incremental-intrinsic.txt
+touch -d "2000-01-01" batch-incremental-input-0.png \
+                      batch-incremental-input-1.png \
+                      batch-incremental-intrinsic.txt
+
+run_incremental() {
+    ${exe} -c "batch-incremental-intrinsic.txt" \
+        -i "batch-incremental-input-{}.png" \
+        --incremental --manifest "batch-incremental-flexion.manifest" \
+        "$@" \
+        flexion \
+        --output "batch-incremental-{}.png"
+}
+
+# Outputs that were not written since 2001 are skipped.
+is_skipped() {
+    [ -f "$1" ] && [ -z "$(find . -name "$1" -newermt "2002-01-01")" ]
+}
+
+if ! run_incremental -s 0 -e 1; then
+    print_error "Could not create the images incrementally."
+    exit 1
+fi
+if  [ ! -f batch-incremental-0.png ] || \
+    [ ! -f batch-incremental-1.png ] || \
+    [ ! -f batch-incremental-flexion.manifest ]; then
+    print_error "Did not create the images and the manifest."
+    exit 1
+fi
+touch -d "2001-01-01" batch-incremental-0.png batch-incremental-1.png
+
+# The index range and the threads do not change the results.
+if ! run_incremental -s 1 -e 0 --threads 2 --pipeline; then
+    print_error "Could not skip up to date images."
+    exit 1
+fi
+if ! is_skipped batch-incremental-0.png || \
+   ! is_skipped batch-incremental-1.png; then
+    print_error "Up to date images were written again."
+    exit 1
+fi
+
+# Missing outputs and changed inputs are processed again.
+rm batch-incremental-1.png
+touch batch-incremental-input-0.png
+if ! run_incremental -s 0 -e 1; then
+    print_error "Could not update the images."
+    exit 1
+fi
+if is_skipped batch-incremental-0.png || \
+   [ ! -f batch-incremental-1.png ]; then
+    print_error "Outdated images were not written again."
+    exit 1
+fi
+
+# A changed configuration or calibration invalidates all outputs.
+touch -d "2001-01-01" batch-incremental-0.png batch-incremental-1.png
+if ! run_incremental -s 0 -e 1 --output-compression 1; then
+    print_error "Could not convert with another configuration."
+    exit 1
+fi
+if is_skipped batch-incremental-0.png || \
+   is_skipped batch-incremental-1.png; then
+    print_error "The configuration change did not invalidate the images."
+    exit 1
+fi
+
+touch -d "2001-01-01" batch-incremental-0.png batch-incremental-1.png
+touch batch-incremental-intrinsic.txt
+if ! run_incremental -s 0 -e 1 --output-compression 1; then
+    print_error "Could not convert with a newer calibration."
+    exit 1
+fi
+if is_skipped batch-incremental-0.png || \
+   is_skipped batch-incremental-1.png; then
+    print_error "The calibration change did not invalidate the images."
+    exit 1
+fi
+
+# Failed indices are not recorded and are retried.
+if run_incremental -s 0 -e 2 --output-compression 1; then
+    print_error "Missing input is expected to fail."
+    exit 1
+fi
+if grep -q "^2	" batch-incremental-flexion.manifest; then
+    print_error "A failed index was recorded in the manifest."
+    exit 1
+fi
+
+if ${exe} -c "kinect_intrinsic.txt" \
+    --stream-input "batch-incremental-stream.bin" \
+    --incremental \
+    flexion \
+    --output "batch-incremental-{}.png"
+then
+    print_error "Streams can not be processed incrementally."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,97 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-intra-*
+
+# Splitting the rows of each image between threads must not change the
+# results of any conversion.
+for intra in off on; do
+    for conversion in flexion max-curve mean-curvature gauss-curvature; do
+        if ! ${exe} -c "kinect_intrinsic.txt" \
+            -i "data{}-depth.png" \
+            -s 0 -e 1 \
+            --intra-image-parallel ${intra} \
+            ${conversion} \
+            --output "batch-intra-${intra}-{}-${conversion}.png"
+        then
+            print_error "Could not create ${conversion} images (${intra})."
+            exit 1
+        fi
+    done
+
+    if ! ${exe} -c "kinect_intrinsic.txt" \
+        -i "data{}-depth.png" \
+        -s 0 -e 1 \
+        --intra-image-parallel ${intra} \
+        multi \
+        --horizontal "batch-intra-${intra}-{}-horizontal.png" \
+        --diagonal "batch-intra-${intra}-{}-diagonal.png"
+    then
+        print_error "Could not create multi images (${intra})."
+        exit 1
+    fi
+done
+
+for idx in 0 1; do
+    for type in flexion max-curve mean-curvature gauss-curvature \
+                horizontal diagonal; do
+        if ! cmp -s "batch-intra-on-${idx}-${type}.png" \
+                    "batch-intra-off-${idx}-${type}.png"; then
+            print_error "Row-parallel result differs for ${type} ${idx}."
+            exit 1
+        fi
+    done
+done
+
+# The rows are split in the pipelined batch processing as well.
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --pipeline \
+    --intra-image-parallel on \
+    flexion \
+    --output "batch-intra-pipeline-{}-flexion.png"
+then
+    print_error "Could not create flexion images in the pipeline."
+    exit 1
+fi
+for idx in 0 1; do
+    if ! cmp -s "batch-intra-pipeline-${idx}-flexion.png" \
+                "batch-intra-off-${idx}-flexion.png"; then
+        print_error "Row-parallel pipeline result differs for ${idx}."
+        exit 1
+    fi
+done
+
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --intra-image-parallel sometimes \
+    flexion \
+    --output "batch-intra-invalid-{}.png"
+then
+    print_error "Expected failure for an invalid option."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,88 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-multi-*
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    multi \
+    --horizontal "batch-multi-{}-horizontal.png" \
+    --anti-diagonal "batch-multi-{}-anti-diagonal.png" \
+    --flexion "batch-multi-{}-flexion.png" \
+    --max-curve "batch-multi-{}-max-curve.png"
+then
+    print_error "Could not create all images in one pass."
+    exit 1
+fi
+
+if  [ ! -f batch-multi-0-horizontal.png ] || \
+    [ ! -f batch-multi-0-anti-diagonal.png ] || \
+    [ ! -f batch-multi-0-flexion.png ] || \
+    [ ! -f batch-multi-0-max-curve.png ] || \
+    [ ! -f batch-multi-1-horizontal.png ] || \
+    [ ! -f batch-multi-1-anti-diagonal.png ] || \
+    [ ! -f batch-multi-1-flexion.png ] || \
+    [ ! -f batch-multi-1-max-curve.png ]; then
+    print_error "Did not create expected output files."
+    exit 1
+fi
+
+if [ -f batch-multi-0-vertical.png ] || \
+   [ -f batch-multi-0-diagonal.png ]; then
+    print_error "Created output files that were not requested."
+    exit 1
+fi
+
+# Test that equirectangular images are converted properly as well
+if ! ${exe} \
+    -m "equirectangular" \
+    -c "laser_intrinsic.txt" \
+    -i "laserscan-{}-depth.png" \
+    -s 0 -e 1 \
+    multi \
+    --vertical "batch-multi-laserscan-{}-vertical.png" \
+    --flexion "batch-multi-laserscan-{}-flexion.png"
+then
+    print_error "Could not create all equirectangular images in one pass."
+    exit 1
+fi
+if  [ ! -f batch-multi-laserscan-0-vertical.png ] || \
+    [ ! -f batch-multi-laserscan-0-flexion.png ] || \
+    [ ! -f batch-multi-laserscan-1-vertical.png ] || \
+    [ ! -f batch-multi-laserscan-1-flexion.png ]; then
+    print_error "Did not create expected equirectangular output files."
+    exit 1
+fi
+
+# At least one output is required.
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    multi
+then
+    print_error "Expected failure without any output pattern."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
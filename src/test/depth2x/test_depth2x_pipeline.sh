@@ -0,0 +1,76 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-pipeline-*
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    multi \
+    --horizontal "batch-pipeline-{}-horizontal-ref.png" \
+    --flexion "batch-pipeline-{}-flexion-ref.png"
+then
+    print_error "Could not create reference images."
+    exit 1
+fi
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --pipeline \
+    multi \
+    --horizontal "batch-pipeline-{}-horizontal.png" \
+    --flexion "batch-pipeline-{}-flexion.png"
+then
+    print_error "Could not create images with the pipeline."
+    exit 1
+fi
+
+for idx in 0 1; do
+    for type in horizontal flexion; do
+        if ! cmp -s "batch-pipeline-${idx}-${type}.png" \
+                    "batch-pipeline-${idx}-${type}-ref.png"; then
+            print_error "Pipeline result differs for ${type} ${idx}."
+            exit 1
+        fi
+    done
+done
+
+# A missing input file fails the batch, but does not stop the pipeline.
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 2 \
+    --pipeline \
+    multi \
+    --flexion "batch-pipeline-missing-{}-flexion.png"
+then
+    print_error "Expected failure for the missing input file."
+    exit 1
+fi
+if  [ ! -f batch-pipeline-missing-0-flexion.png ] || \
+    [ ! -f batch-pipeline-missing-1-flexion.png ]; then
+    print_error "Did not create the output files of the existing inputs."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,81 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-shard-*
+
+# $1: name of the outputs, $@: further options
+run_shard() {
+    name="$1"
+    shift
+    ${exe} -c "kinect_intrinsic.txt" \
+        -i "data{}-depth.png" \
+        -s 0 -e 1 \
+        "$@" \
+        flexion \
+        --output "batch-shard-${name}-{}.png"
+}
+
+if ! run_shard whole; then
+    print_error "Could not convert the whole batch."
+    exit 1
+fi
+
+# Each shard converts its own part of the indices.
+if ! run_shard first --shard 0/2; then
+    print_error "Could not convert the first shard."
+    exit 1
+fi
+if [ ! -f batch-shard-first-0.png ] || [ -f batch-shard-first-1.png ]; then
+    print_error "The first shard did not convert only the first index."
+    exit 1
+fi
+if ! run_shard second --shard 1/2 --pipeline; then
+    print_error "Could not convert the second shard."
+    exit 1
+fi
+if [ -f batch-shard-second-0.png ] || [ ! -f batch-shard-second-1.png ]; then
+    print_error "The second shard did not convert only the second index."
+    exit 1
+fi
+if ! cmp batch-shard-whole-0.png batch-shard-first-0.png ||
+   ! cmp batch-shard-whole-1.png batch-shard-second-1.png; then
+    print_error "The shards converted other images than the whole batch."
+    exit 1
+fi
+
+# More shards than indices leave some shards empty.
+if ! run_shard empty --shard 0/3; then
+    print_error "An empty shard is not an error."
+    exit 1
+fi
+if [ -f batch-shard-empty-0.png ] || [ -f batch-shard-empty-1.png ]; then
+    print_error "The empty shard converted images."
+    exit 1
+fi
+
+if run_shard invalid --shard 2/2; then
+    print_error "The shard 2/2 is expected to be invalid."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,97 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+# The client is built next to depth2x.
+client="$(dirname "${exe}")/depth_stream"
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-stream-* stream-test.sock
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    multi \
+    --flexion "batch-stream-{}-flexion.png" \
+    --max-curve "batch-stream-{}-max-curve.png"
+then
+    print_error "Could not create reference images."
+    exit 1
+fi
+
+# Both results of each image are streamed back as parts 0 and 1.
+if ! ${client} -i "data{}-depth.png" -s 0 -e 1 | \
+     ${exe} -c "kinect_intrinsic.txt" \
+        --stream-input - \
+        multi \
+        --flexion "unused-{}.png" \
+        --max-curve "unused-{}.png" | \
+     ${client} -o "batch-stream-{}-pipe-{}.png"
+then
+    print_error "Could not convert the images through a pipe."
+    exit 1
+fi
+
+# depth2x creates the socket and answers on the same connection.
+${exe} -c "kinect_intrinsic.txt" \
+    --stream-input "unix:stream-test.sock" \
+    --stream-output "unix:stream-test.sock" \
+    multi \
+    --flexion "unused-{}.png" \
+    --max-curve "unused-{}.png" &
+server=$!
+
+if ! ${client} -i "data{}-depth.png" -s 0 -e 1 \
+        --connect "unix:stream-test.sock" \
+        -o "batch-stream-{}-socket-{}.png"
+then
+    print_error "Could not convert the images through a socket."
+    kill ${server}
+    exit 1
+fi
+
+if ! wait ${server}; then
+    print_error "depth2x failed to serve the socket."
+    exit 1
+fi
+
+for idx in 0 1; do
+    for variant in pipe socket; do
+        if ! cmp -s "batch-stream-${idx}-${variant}-0.png" \
+                    "batch-stream-${idx}-flexion.png" || \
+           ! cmp -s "batch-stream-${idx}-${variant}-1.png" \
+                    "batch-stream-${idx}-max-curve.png"; then
+            print_error "Streamed result through ${variant} differs for ${idx}."
+            exit 1
+        fi
+    done
+done
+
+# Streams are an alternative to a batch of files.
+if ${exe} -c "kinect_intrinsic.txt" \
+    flexion \
+    --output "batch-stream-invalid-{}.png"
+then
+    print_error "Expected failure without input."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
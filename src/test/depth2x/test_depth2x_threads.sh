@@ -0,0 +1,87 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-threads-*
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    flexion \
+    --output "batch-threads-{}-ref.png"
+then
+    print_error "Could not create reference images."
+    exit 1
+fi
+
+# The number of workers and their CPUs do not change the results.
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --threads 1 \
+    flexion \
+    --output "batch-threads-{}-single.png"
+then
+    print_error "Could not create images with a single worker."
+    exit 1
+fi
+
+# The first CPU of the current affinity is always allowed.
+cpu=$(grep Cpus_allowed_list /proc/self/status | awk '{print $2}' | \
+      cut -d ',' -f 1 | cut -d '-' -f 1)
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --threads 2 \
+    --cpu-affinity "${cpu}" \
+    --pipeline \
+    flexion \
+    --output "batch-threads-{}-pinned.png"
+then
+    print_error "Could not create images with pinned workers."
+    exit 1
+fi
+
+for idx in 0 1; do
+    for variant in single pinned; do
+        if ! cmp -s "batch-threads-${idx}-${variant}.png" \
+                    "batch-threads-${idx}-ref.png"; then
+            print_error "Result with ${variant} workers differs for ${idx}."
+            exit 1
+        fi
+    done
+done
+
+for option in "--threads -1" "--cpu-affinity 3-1" "--cpu-affinity x"; do
+    if ${exe} -c "kinect_intrinsic.txt" \
+        -i "data{}-depth.png" \
+        -s 0 -e 1 \
+        ${option} \
+        flexion \
+        --output "batch-threads-invalid-{}.png"
+    then
+        print_error "Expected failure for \"${option}\"."
+        exit 1
+    fi
+done
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,63 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f batch-trace-* trace-depth2x.json
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --trace "trace-depth2x.json" \
+    flexion \
+    --output "batch-trace-{}.png"
+then
+    print_error "Could not convert the images with tracing."
+    exit 1
+fi
+
+if [ ! -f "trace-depth2x.json" ] ; then
+    print_error "The trace was not written."
+    exit 1
+fi
+
+# Builds without tracing write an empty trace.
+if grep --silent "\"name\"" "trace-depth2x.json" ; then
+    for stage in load preprocess convert write index ; do
+        if ! grep --silent "\"name\": \"${stage}\"" "trace-depth2x.json" ; then
+            print_error "The stage ${stage} is missing in the trace."
+            exit 1
+        fi
+    done
+fi
+
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --trace \
+    flexion \
+    --output "batch-trace-{}.png"
+then
+    print_error "The trace option requires a file."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,93 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f archive-*
+
+for encoding in delta raw; do
+    if ! ${exe} create \
+        -i "data{}-depth.png" \
+        -s 0 -e 1 \
+        -c "kinect_intrinsic.txt" \
+        --encoding ${encoding} \
+        -o "archive-${encoding}.dseq"
+    then
+        print_error "Could not create the ${encoding} archive."
+        exit 1
+    fi
+
+    if ! ${exe} extract \
+        -i "archive-${encoding}.dseq" \
+        -o "archive-${encoding}-{}.png"
+    then
+        print_error "Could not extract the ${encoding} archive."
+        exit 1
+    fi
+    if  [ ! -f "archive-${encoding}-0.png" ] || \
+        [ ! -f "archive-${encoding}-1.png" ]; then
+        print_error "Did not extract all frames of the ${encoding} archive."
+        exit 1
+    fi
+
+    # Packing the extracted frames again must result in the same archive,
+    # because the archives are lossless.
+    if ! ${exe} create \
+        -i "archive-${encoding}-{}.png" \
+        -s 0 -e 1 \
+        -c "kinect_intrinsic.txt" \
+        --encoding ${encoding} \
+        -o "archive-${encoding}-repacked.dseq"
+    then
+        print_error "Could not repack the ${encoding} archive."
+        exit 1
+    fi
+    if ! cmp -s "archive-${encoding}.dseq" \
+                "archive-${encoding}-repacked.dseq"; then
+        print_error "Repacked ${encoding} archive differs."
+        exit 1
+    fi
+done
+
+if [ "$(wc -c < archive-delta.dseq)" -ge "$(wc -c < archive-raw.dseq)" ]; then
+    print_error "Delta coded archives are expected to be smaller."
+    exit 1
+fi
+
+# Missing input images are an error.
+if ${exe} create \
+    -i "data{}-depth.png" \
+    -s 0 -e 2 \
+    -o "archive-missing.dseq"
+then
+    print_error "Expected failure for missing input images."
+    exit 1
+fi
+
+if ${exe} extract \
+    -i "kinect_intrinsic.txt" \
+    -o "archive-invalid-{}.png"
+then
+    print_error "Expected failure for an invalid archive."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
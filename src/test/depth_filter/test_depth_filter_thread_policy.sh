@@ -0,0 +1,56 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+rm -f policy-*-?.png
+
+for policy in outer inner hybrid ; do
+    if ! ${exe} \
+        -i "data{}-depth.png" \
+        -o "policy-${policy}-{}.png" \
+        -s 0 -e 1 \
+        --thread-policy ${policy} \
+        bilateral --sigma-color 20. --distance 5 ; then
+        print_error "Filtering with the thread policy ${policy} failed"
+        exit 1
+    fi
+done
+
+# The distribution of the threads must not change the result.
+for idx in 0 1 ; do
+    if ! cmp policy-outer-${idx}.png policy-inner-${idx}.png || \
+       ! cmp policy-outer-${idx}.png policy-hybrid-${idx}.png ; then
+        print_error "The thread policy changed the filtered image ${idx}"
+        exit 1
+    fi
+done
+
+if ${exe} \
+    -i "data{}-depth.png" \
+    -o "policy-invalid-{}.png" \
+    -s 0 -e 1 \
+    --thread-policy everything \
+    median-blur ; then
+    print_error "Unknown thread policies must be rejected"
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
@@ -0,0 +1,111 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+if grep --silent "Precise Pangolin" /etc/os-release ; then
+    print_warning "Skipping Tests on old linux - See #8 for more information!"
+    exit 0
+fi
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f pipeline-* pipeline.ini
+
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1
+then
+    print_error "A pipeline without any output must fail."
+    exit 1
+fi
+
+if ! ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --filter median-blur \
+    --feature flexion \
+    --detector orb --descriptor orb \
+    --filtered-output "pipeline-filtered-{}.png" \
+    --feature-output "pipeline-flexion-{}.png" \
+    --keypoint-output "pipeline-orb-{}.yaml" \
+    --plot-output "pipeline-plot-{}.png" \
+    --distribution-output "pipeline-distribution.yaml" \
+    --min-distance-output "pipeline-min-distance.yaml"
+then
+    print_error "Could not run the whole pipeline."
+    exit 1
+fi
+
+if  [ ! -f pipeline-filtered-0.png ] || \
+    [ ! -f pipeline-filtered-1.png ] || \
+    [ ! -f pipeline-flexion-0.png ] || \
+    [ ! -f pipeline-flexion-1.png ] || \
+    [ ! -f pipeline-orb-0.yaml ] || \
+    [ ! -f pipeline-orb-1.yaml ] || \
+    [ ! -f pipeline-plot-0.png ] || \
+    [ ! -f pipeline-plot-1.png ] || \
+    [ ! -f pipeline-distribution.yaml ] || \
+    [ ! -f pipeline-min-distance.yaml ]; then
+    print_error "Did not create all requested artifacts."
+    exit 1
+fi
+
+if ${exe} -c "kinect_intrinsic.txt" \
+    -i "data{}-depth.png" \
+    -s 0 -e 1 \
+    --detector orb --descriptor none \
+    --min-distance-output "pipeline-no-descriptor.yaml"
+then
+    print_error "The minimal descriptor distance requires a descriptor."
+    exit 1
+fi
+
+# The same pipeline is configured with a file and runs overlapped with the
+# IO. The results must not change.
+cat > pipeline.ini <<INI
+calibration = kinect_intrinsic.txt
+input = data{}-depth.png
+start = 0
+end = 1
+filter = median-blur
+feature = flexion
+detector = orb
+descriptor = orb
+keypoint-output = pipeline-config-orb-{}.yaml
+feature-output = pipeline-config-flexion-{}.png
+INI
+
+if ! ${exe} --config pipeline.ini --pipeline
+then
+    print_error "Could not run the pipeline from the configuration file."
+    exit 1
+fi
+
+# The keypoint files refer to their flexion image, which has another name.
+for i in 0 1; do
+    sed '/source_path/d' "pipeline-orb-${i}.yaml" > "pipeline-cmp-a-${i}.yaml"
+    sed '/source_path/d' "pipeline-config-orb-${i}.yaml" \
+        > "pipeline-cmp-b-${i}.yaml"
+done
+
+if ! cmp pipeline-flexion-0.png pipeline-config-flexion-0.png || \
+   ! cmp pipeline-flexion-1.png pipeline-config-flexion-1.png || \
+   ! cmp pipeline-cmp-a-0.yaml pipeline-cmp-b-0.yaml || \
+   ! cmp pipeline-cmp-a-1.yaml pipeline-cmp-b-1.yaml; then
+    print_error "The configuration file changed the results."
+    exit 1
+fi
+
+print_info "Test successful!"
+exit 0
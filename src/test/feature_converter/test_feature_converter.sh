@@ -0,0 +1,72 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+print_info "Cleaning old artifacts"
+rm -f binary-* yaml-* again-* compressed-*
+
+set -v
+
+if ! ${exe} \
+    --input sift-{}.feature \
+    --output binary-{}.feature \
+    --start 0 --end 1 ; then
+    print_error "Could not convert YAML feature files to the binary format"
+    exit 1
+fi
+if [ "$(head -c 4 binary-0.feature)" != "SFEA" ] || \
+   [ "$(head -c 4 binary-1.feature)" != "SFEA" ] ; then
+    print_error "Expected binary feature files"
+    exit 1
+fi
+
+if ! ${exe} \
+    --input binary-{}.feature \
+    --output yaml-{}.yml \
+    --start 0 --end 1 ; then
+    print_error "Could not convert binary feature files to YAML"
+    exit 1
+fi
+if ! ${exe} \
+    --input yaml-{}.yml \
+    --output again-{}.feature \
+    --start 0 --end 1 ; then
+    print_error "Could not convert the YAML feature files back"
+    exit 1
+fi
+if ! cmp binary-0.feature again-0.feature || \
+   ! cmp binary-1.feature again-1.feature ; then
+    print_error "The conversion changed the features"
+    exit 1
+fi
+
+if ! ${exe} \
+    --input binary-{}.feature \
+    --output compressed-{}.feature.gz \
+    --start 0 --end 1 ; then
+    print_error "Could not convert to compressed YAML"
+    exit 1
+fi
+if [ ! -f compressed-0.feature.gz ] || \
+   [ ! -f compressed-1.feature.gz ] ; then
+    print_error "Expected files not created"
+    exit 1
+fi
+
+if ${exe} \
+    --input does-not-exist-{}.feature \
+    --output binary-missing-{}.feature \
+    --start 0 --end 1 ; then
+    print_error "Converting missing files must fail"
+    exit 1
+fi
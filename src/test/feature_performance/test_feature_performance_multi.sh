@@ -0,0 +1,112 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f multi-*
+
+input="surf-1-octave-{}.feature.gz"
+
+# Arguments of each analysis, the output files are appended with a prefix.
+# $1: prefix of the output files
+min_distance() {
+    echo "min-distance --norm L2 --output $1-min.stat \
+          --min-distance-histo $1-min.dat"
+}
+keypoint_distribution() {
+    echo "keypoint-distribution --image-width 960 --image-height 540 \
+          --output $1-kp.stat --kp-distance-histo $1-kp.dat"
+}
+matching() {
+    echo "matching --distance-norm L2 --output $1-match.stat \
+          --matched-distance-histo $1-match.dat"
+}
+recognition_performance() {
+    echo "recognition-performance --depth-image filtered-{}.png \
+          --pose-file pose-{}.pose --intrinsic kinect_intrinsic.txt \
+          --match-norm L2 --output $1-rec.stat \
+          --backprojection-selected-histo $1-rec.dat"
+}
+
+print_info "Run each analysis on its own"
+for analysis in min_distance keypoint_distribution matching \
+                recognition_performance; do
+    if ! ${exe} --input "${input}" --start 0 --end 1 \
+        $(${analysis} multi-single) ; then
+        print_error "Could not run ${analysis} on its own"
+        exit 1
+    fi
+done
+
+print_info "Run all analyses in a single traversal"
+if ! ${exe} --input "${input}" --start 0 --end 1 \
+    $(min_distance multi-all) \
+    $(keypoint_distribution multi-all) \
+    $(matching multi-all) \
+    $(recognition_performance multi-all) ; then
+    print_error "Could not run all analyses in a single traversal"
+    exit 1
+fi
+
+for result in min.stat min.dat kp.stat kp.dat match.stat match.dat \
+              rec.stat rec.dat; do
+    if ! cmp "multi-single-${result}" "multi-all-${result}" ; then
+        print_error "Result ${result} of the single traversal differs"
+        exit 1
+    fi
+done
+
+print_info "A global statistics file requires a single analysis"
+if ${exe} --input "${input}" --start 0 --end 1 \
+    --output multi-global.stat \
+    min-distance --norm L2 \
+    matching --distance-norm L2 ; then
+    print_error "Expected a failure for a global statistics file"
+    exit 1
+fi
+
+print_info "Partial results require a single analysis"
+if ${exe} --input "${input}" --start 0 --end 1 \
+    --shard 0/2 --partial multi-partial.yml \
+    min-distance --norm L2 \
+    matching --distance-norm L2 ; then
+    print_error "Expected a failure for partial results of multiple analyses"
+    exit 1
+fi
+
+print_info "A missing predecessor only skips the pairwise analyses"
+# The frame 0 of the sift features does not exist. Frame 1 is still analyzed
+# by the analyses that work on single frames.
+if ! ${exe} --input "sift-{}.feature" --start 0 --end 1 \
+    $(min_distance multi-missing-single) \
+    $(keypoint_distribution multi-missing-single) ; then
+    print_error "Could not run the single frame analyses with a missing frame"
+    exit 1
+fi
+if ! ${exe} --input "sift-{}.feature" --start 0 --end 1 \
+    $(min_distance multi-missing-all) \
+    $(keypoint_distribution multi-missing-all) \
+    $(matching multi-missing-all) ; then
+    print_error "Could not run all analyses with a missing frame"
+    exit 1
+fi
+
+for result in min.stat min.dat kp.stat kp.dat; do
+    if ! cmp "multi-missing-single-${result}" \
+             "multi-missing-all-${result}" ; then
+        print_error "Result ${result} differs with a missing predecessor"
+        exit 1
+    fi
+done
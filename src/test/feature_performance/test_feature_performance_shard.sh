@@ -0,0 +1,138 @@
+#!/bin/sh
+
+if [ $# -ne 2 ]; then
+    echo "Incorrect call!"
+    exit 1
+fi
+
+exe="$1"
+helpers="$2"
+
+. "${helpers}"
+
+print_info "Using \"${exe}\" as driver executable"
+
+set -v
+
+print_info "Clearing test directory from old test result files."
+rm -f shard-*
+
+# Analyze the whole batch in one process and in two shards, whose partial
+# results are merged. Both reports must be identical.
+# $1: input pattern, $2: name of the histogram option, $@: analysis
+compare_sharded() {
+    input="$1"
+    histo="$2"
+    shift 2
+
+    if ! ${exe} --input "${input}" --start 0 --end 1 \
+        --output shard-single.stat "$@" "${histo}" shard-single.dat ; then
+        print_error "Could not analyze the whole batch with $1"
+        exit 1
+    fi
+    for i in 0 1; do
+        if ! ${exe} --input "${input}" --start 0 --end 1 \
+            --shard "${i}/2" --partial "shard-${i}.yml" "$@" ; then
+            print_error "Could not analyze shard ${i} with $1"
+            exit 1
+        fi
+    done
+    if ! ${exe} --input "${input}" --start 0 --end 1 \
+        --output shard-merged.stat \
+        merge shard-0.yml shard-1.yml \
+        "$@" "${histo}" shard-merged.dat ; then
+        print_error "Could not merge the shards of $1"
+        exit 1
+    fi
+    if ! cmp shard-single.stat shard-merged.stat ||
+       ! cmp shard-single.dat shard-merged.dat ; then
+        print_error "Merged report of $1 differs from the whole batch"
+        exit 1
+    fi
+}
+
+compare_sharded "orb-{}.feature" --min-distance-histo \
+    min-distance --norm HAMMING
+compare_sharded "sift-{}.feature" --kp-distance-histo \
+    keypoint-distribution --image-width 960 --image-height 540
+compare_sharded "sift-{}.feature" --matched-distance-histo \
+    matching
+compare_sharded "surf-1-octave-{}.feature.gz" \
+    --backprojection-selected-histo \
+    recognition-performance \
+    --depth-image "filtered-{}.png" \
+    --pose-file "pose-{}.pose" \
+    --intrinsic "kinect_intrinsic.txt" \
+    --match-norm "L2"
+
+print_info "Merge partial results into a partial result"
+if ! ${exe} --input "surf-1-octave-{}.feature.gz" --start 0 --end 1 \
+    --partial shard-combined.yml \
+    merge shard-0.yml \
+    recognition-performance \
+    --depth-image "filtered-{}.png" \
+    --pose-file "pose-{}.pose" \
+    --intrinsic "kinect_intrinsic.txt" ; then
+    print_error "Could not merge a partial result into a partial result"
+    exit 1
+fi
+if ! ${exe} --input "surf-1-octave-{}.feature.gz" --start 0 --end 1 \
+    merge shard-combined.yml shard-1.yml \
+    recognition-performance \
+    --depth-image "filtered-{}.png" \
+    --pose-file "pose-{}.pose" \
+    --intrinsic "kinect_intrinsic.txt" ; then
+    print_error "Could not merge the combined partial result"
+    exit 1
+fi
+
+print_info "Test failure for missing shards"
+if ${exe} --input "surf-1-octave-{}.feature.gz" --start 0 --end 1 \
+    merge shard-0.yml \
+    recognition-performance \
+    --depth-image "filtered-{}.png" \
+    --pose-file "pose-{}.pose" \
+    --intrinsic "kinect_intrinsic.txt" ; then
+    print_error "Did not detect the missing shard"
+    exit 1
+fi
+
+print_info "Test failure for shards that are merged twice"
+if ${exe} --input "surf-1-octave-{}.feature.gz" --start 0 --end 1 \
+    merge shard-0.yml shard-0.yml shard-1.yml \
+    recognition-performance \
+    --depth-image "filtered-{}.png" \
+    --pose-file "pose-{}.pose" \
+    --intrinsic "kinect_intrinsic.txt" ; then
+    print_error "Did not detect the shard that is merged twice"
+    exit 1
+fi
+
+print_info "Test failure for partial results of another analysis"
+if ${exe} --input "surf-1-octave-{}.feature.gz" --start 0 --end 1 \
+    merge shard-0.yml shard-1.yml \
+    matching ; then
+    print_error "Did not detect the partial result of another analysis"
+    exit 1
+fi
+
+print_info "Test failure for a shard without partial result"
+if ${exe} --input "orb-{}.feature" --start 0 --end 1 \
+    --shard 0/2 min-distance ; then
+    print_error "Did not require a partial result for a shard"
+    exit 1
+fi
+
+print_info "Test failure for an invalid shard"
+if ${exe} --input "orb-{}.feature" --start 0 --end 1 \
+    --shard 2/2 --partial shard-invalid.yml min-distance ; then
+    print_error "Did not detect the invalid shard"
+    exit 1
+fi
+
+print_info "Test failure for a merge without analysis"
+if ${exe} --input "orb-{}.feature" --start 0 --end 1 \
+    merge shard-0.yml ; then
+    print_error "Did not require an analysis for the merge"
+    exit 1
+fi
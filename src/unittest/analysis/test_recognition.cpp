@@ -138,3 +138,64 @@ TEST_CASE("writing result with filestorage") {
                        "   rand_index: 1.\n"
                        "   youden_index: 0.\n");
 }
+
+TEST_CASE("merging statistics") {
+    const vector<DMatch> some_matches{{0, 0, 1.5F}, {1, 2, 2.0F}};
+    element_categories   ec1{some_points, some_points, some_matches, threshold};
+    element_categories   ec2{some_points, bad_points, matches, threshold};
+
+    recognition_statistic whole;
+    whole.account(ec1);
+    whole.account(ec2);
+
+    recognition_statistic first;
+    first.account(ec1);
+    recognition_statistic second;
+    second.account(ec2);
+
+    auto check_equal = [&whole](recognition_statistic& merged) {
+        CHECK(merged.true_positives() == whole.true_positives());
+        CHECK(merged.false_positives() == whole.false_positives());
+        CHECK(merged.true_negatives() == whole.true_negatives());
+        CHECK(merged.false_negatives() == whole.false_negatives());
+
+        whole.make_histogram();
+        merged.make_histogram();
+        CHECK(merged.true_positive_distribution().histo ==
+              whole.true_positive_distribution().histo);
+        CHECK(merged.false_positive_distribution().histo ==
+              whole.false_positive_distribution().histo);
+        CHECK(merged.relevant_element_distribution().histo ==
+              whole.relevant_element_distribution().histo);
+        CHECK(merged.true_positive_distance().histogram() ==
+              whole.true_positive_distance().histogram());
+        CHECK(merged.false_positive_distance().count() ==
+              whole.false_positive_distance().count());
+    };
+
+    SUBCASE("merge in memory") {
+        first.merge(second);
+        REQUIRE(first.true_positives() == 1);
+        REQUIRE(first.false_positives() == 1);
+        REQUIRE(first.true_negatives() == 3);
+        REQUIRE(first.false_negatives() == 1);
+        check_equal(first);
+    }
+
+    SUBCASE("merge written tallies") {
+        cv::FileStorage out{"tallies.yml", cv::FileStorage::MEMORY |
+                                               cv::FileStorage::WRITE |
+                                               cv::FileStorage::FORMAT_YAML};
+        second.write_tallies(out, "classification");
+        const std::string written = out.releaseAndGetString();
+
+        cv::FileStorage in{written, cv::FileStorage::MEMORY |
+                                        cv::FileStorage::READ |
+                                        cv::FileStorage::FORMAT_YAML};
+        first.merge(recognition_statistic::read_tallies(in["classification"]));
+        check_equal(first);
+
+        REQUIRE_THROWS_AS(recognition_statistic::read_tallies(in["missing"]),
+                          std::runtime_error);
+    }
+}
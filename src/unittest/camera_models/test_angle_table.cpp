@@ -0,0 +1,69 @@
+#include <doctest/doctest.h>
+#include <sens_loc/camera_models/angle_table.h>
+#include <sens_loc/camera_models/equirectangular.h>
+#include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/camera_models/utility.h>
+#include <sens_loc/math/angle_conversion.h>
+
+using namespace sens_loc::camera_models;
+using namespace sens_loc::math;
+using namespace std;
+using doctest::Approx;
+
+TEST_CASE("angle table matches phi") {
+    SUBCASE("pinhole") {
+        const pinhole<double> p = {
+            /*w=*/960,      /*h=*/540,     /*fx=*/519.226,
+            /*fy=*/479.462, /*cx=*/522.23, /*cy=*/272.737,
+        };
+
+        for (const pixel_coord<int>& offset :
+             {pixel_coord<int>{-1, 0}, pixel_coord<int>{0, -1},
+              pixel_coord<int>{-1, -1}, pixel_coord<int>{-1, 1},
+              pixel_coord<int>{2, 2}}) {
+            const angle_table<pinhole<double>> angles{p, offset};
+            CHECK(angles.w() == p.w());
+            CHECK(angles.h() == p.h());
+
+            for (const pixel_coord<int>& px :
+                 {pixel_coord<int>{2, 2}, pixel_coord<int>{957, 2},
+                  pixel_coord<int>{2, 537}, pixel_coord<int>{522, 272},
+                  pixel_coord<int>{42, 420}}) {
+                const pixel_coord<int> n{px.u() + offset.u(),
+                                         px.v() + offset.v()};
+                const double expected = phi(p, px, n);
+
+                CHECK(angles.phi(px, n) == expected);
+                // The angle is symmetric.
+                CHECK(angles.phi(n, px) == expected);
+                CHECK(angles.cos_phi(px, n) == std::cos(expected));
+            }
+        }
+    }
+    SUBCASE("equirectangular closed form") {
+        const equirectangular<double> e{
+            /*width=*/1799,
+            /*height=*/397,
+            /*theta_range=*/{deg_to_rad(50.), deg_to_rad(130.)}};
+
+        for (const pixel_coord<int>& offset :
+             {pixel_coord<int>{-1, 0}, pixel_coord<int>{0, -1},
+              pixel_coord<int>{-1, -1}, pixel_coord<int>{-1, 1},
+              pixel_coord<int>{2, 0}}) {
+            const angle_table<equirectangular<double>> angles{e, offset};
+
+            for (const pixel_coord<int>& px :
+                 {pixel_coord<int>{2, 2}, pixel_coord<int>{1796, 2},
+                  pixel_coord<int>{2, 394}, pixel_coord<int>{900, 198},
+                  pixel_coord<int>{42, 300}}) {
+                const pixel_coord<int> n{px.u() + offset.u(),
+                                         px.v() + offset.v()};
+                const double expected = phi(e, px, n);
+
+                CHECK(angles.phi(px, n) == Approx(expected));
+                CHECK(angles.phi(n, px) == Approx(expected));
+                CHECK(angles.cos_phi(px, n) == Approx(std::cos(expected)));
+            }
+        }
+    }
+}
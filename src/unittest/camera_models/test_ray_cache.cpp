@@ -0,0 +1,97 @@
+#include <doctest/doctest.h>
+#include <sens_loc/camera_models/equirectangular.h>
+#include <sens_loc/camera_models/pinhole.h>
+#include <sens_loc/camera_models/projection.h>
+#include <sens_loc/camera_models/ray_cache.h>
+#include <sens_loc/math/pointcloud.h>
+
+using namespace sens_loc::camera_models;
+using namespace sens_loc::math;
+using namespace std;
+using doctest::Approx;
+
+TEST_CASE("ray cache matches the camera model") {
+    SUBCASE("pinhole") {
+        const pinhole<double> p = {
+            /*w=*/960,      /*h=*/540,     /*fx=*/519.226,
+            /*fy=*/479.462, /*cx=*/522.23, /*cy=*/272.737,
+        };
+        const ray_cache<pinhole<double>> rays{p};
+
+        CHECK(rays.w() == p.w());
+        CHECK(rays.h() == p.h());
+
+        for (const pixel_coord<int>& px :
+             {pixel_coord<int>{0, 0}, pixel_coord<int>{959, 0},
+              pixel_coord<int>{0, 539}, pixel_coord<int>{959, 539},
+              pixel_coord<int>{522, 272}, pixel_coord<int>{42, 420}}) {
+            const sphere_coord<double> expected = p.pixel_to_sphere(px);
+            const sphere_coord<double> cached   = rays.pixel_to_sphere(px);
+
+            CHECK(cached.Xs() == expected.Xs());
+            CHECK(cached.Ys() == expected.Ys());
+            CHECK(cached.Zs() == expected.Zs());
+            CHECK(cached.norm() == Approx(1.0));
+        }
+    }
+    SUBCASE("equirectangular") {
+        const equirectangular<float>            e{1000, 500};
+        const ray_cache<equirectangular<float>> rays{e};
+
+        CHECK(rays.w() == e.w());
+        CHECK(rays.h() == e.h());
+
+        for (const pixel_coord<int>& px :
+             {pixel_coord<int>{0, 0}, pixel_coord<int>{999, 0},
+              pixel_coord<int>{250, 250}, pixel_coord<int>{999, 499}}) {
+            const sphere_coord<float> expected = e.pixel_to_sphere(px);
+            const sphere_coord<float> cached   = rays.pixel_to_sphere(px);
+
+            CHECK(cached.Xs() == expected.Xs());
+            CHECK(cached.Ys() == expected.Ys());
+            CHECK(cached.Zs() == expected.Zs());
+        }
+    }
+}
+
+TEST_CASE("project image points to sphere with ray cache") {
+    const auto p = pinhole<double>{/*w=*/1080,    /*h=*/1080,   /*fx=*/2220.0,
+                                   /*fy=*/2220.0, /*cx=*/540.0, /*cy=*/540.0};
+    const ray_cache<pinhole<double>> rays{p};
+
+    // Mix of pixel-exact and subpixel coordinates.
+    const auto i =
+        imagepoints<double>{{540.0, 250.0}, {270.5, 270.25}, {810.0, 250.0}};
+
+    const pointcloud<double> expected{project_to_sphere(p, i)};
+    const pointcloud<double> cached{project_to_sphere(rays, i)};
+
+    REQUIRE(cached.size() == expected.size());
+    for (std::size_t idx = 0; idx < cached.size(); ++idx) {
+        CHECK(cached[idx].X() == Approx(expected[idx].X()));
+        CHECK(cached[idx].Y() == Approx(expected[idx].Y()));
+        CHECK(cached[idx].Z() == Approx(expected[idx].Z()));
+    }
+}
+
+TEST_CASE("ray cache rows") {
+    const equirectangular<float>            e{100, 50};
+    const ray_cache<equirectangular<float>> rays{e};
+
+    for (int v : {0, 25, 49}) {
+        const auto Xs = rays.row_Xs(v);
+        const auto Ys = rays.row_Ys(v);
+        const auto Zs = rays.row_Zs(v);
+
+        REQUIRE(Xs.size() == e.w());
+        REQUIRE(Ys.size() == e.w());
+        REQUIRE(Zs.size() == e.w());
+
+        for (int u : {0, 42, 99}) {
+            const sphere_coord<float> expected = rays.pixel_to_sphere({u, v});
+            CHECK(Xs[u] == expected.Xs());
+            CHECK(Ys[u] == expected.Ys());
+            CHECK(Zs[u] == expected.Zs());
+        }
+    }
+}
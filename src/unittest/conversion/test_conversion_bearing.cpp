@@ -119,6 +119,69 @@ TEST_CASE("Convert depth image to vertical bearing angle image in parallel") {
     REQUIRE(util::average_pixel_error(converted, *ref_vert) < 0.5);
 }
 
+TEST_CASE("Convert depth image to vertical bearing angle with angle table") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+    auto laser = depth_to_laserscan<double, ushort>(*depth_image, p_double);
+
+    auto ref_vert = io::load_image<uchar>("conversion/bearing-vertical.png",
+                                          cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_vert);
+
+    const bearing_angles<camera_models::pinhole<double>> angles{p_double};
+
+    SUBCASE("serial") {
+        auto vertical_bearing =
+            depth_to_bearing<direction::vertical>(laser, angles.vertical);
+        auto converted = convert_bearing<double, uchar>(vertical_bearing);
+        REQUIRE(util::average_pixel_error(converted, *ref_vert) < 0.5);
+    }
+    SUBCASE("parallel") {
+        cv::Mat             out(laser.h(), laser.w(), laser.data().type());
+        out = 0.;
+        math::image<double> out_img(std::move(out));
+        {
+            tf::Taskflow flow;
+            par_depth_to_bearing<direction::vertical>(
+                laser, angles.get<direction::vertical>(), out_img, flow);
+            tf::Executor().run(flow).wait();
+        }
+        auto converted = convert_bearing<double, uchar>(out_img);
+        REQUIRE(util::average_pixel_error(converted, *ref_vert) < 0.5);
+    }
+    SUBCASE("padded") {
+        const math::padded_image<double> padded(laser);
+        auto                             padded_bearing =
+            depth_to_bearing<direction::vertical>(padded, angles.vertical);
+        auto vertical_bearing =
+            depth_to_bearing<direction::vertical>(laser, angles.vertical);
+        REQUIRE(util::average_pixel_error(padded_bearing, vertical_bearing) ==
+                0.);
+    }
+}
+
+TEST_CASE("Convert depth image to quantized bearing angle image") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+    auto laser = depth_to_laserscan<double, ushort>(*depth_image, p_double);
+
+    auto ref_vert = io::load_image<uchar>("conversion/bearing-vertical.png",
+                                          cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_vert);
+
+    const bearing_angles<camera_models::pinhole<double>> angles{p_double};
+
+    const auto quantized = depth_to_bearing<direction::vertical>(
+        laser, angles.vertical, bearing_quantization<uchar, double>());
+    REQUIRE(util::average_pixel_error(quantized, *ref_vert) < 0.5);
+
+    const auto converted = convert_bearing<double, uchar>(
+        depth_to_bearing<direction::vertical>(laser, angles.vertical));
+    REQUIRE(util::average_pixel_error(quantized, converted) < 0.01);
+}
+
 TEST_CASE("Convert depth image to diagonal bearing angle image") {
     auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
                                               cv::IMREAD_UNCHANGED);
@@ -194,3 +257,23 @@ TEST_CASE("convert laserscan to horizontal bearing angle") {
 
     REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
 }
+
+TEST_CASE("convert laserscan to horizontal bearing angle with angle table") {
+    auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const auto laser_double = math::convert<double>(*depth_image);
+    const bearing_angles<camera_models::equirectangular<double>> angles{
+        e_double};
+    const auto bearing = conversion::depth_to_bearing<direction::horizontal>(
+        laser_double, angles.horizontal);
+    const auto converted = conversion::convert_bearing<double, ushort>(bearing);
+
+    auto ref_image = io::load_image<ushort>(
+        "conversion/bearing-horizontal-laserscan-reference.png",
+        cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_image);
+
+    REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
+}
@@ -65,6 +65,53 @@ TEST_CASE("mean curvature") {
     }
 }
 
+TEST_CASE("curvature in parallel") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto laser_double =
+        conversion::depth_to_laserscan<double, ushort>(*depth_image, p);
+
+    cv::Mat out(laser_double.h(), laser_double.w(),
+                laser_double.data().type());
+    out = 0.;
+    math::image<double> out_img(std::move(out));
+
+    SUBCASE("gaussian curvature") {
+        {
+            tf::Taskflow flow;
+            conversion::par_depth_to_gaussian_curvature(laser_double, p,
+                                                        out_img, flow);
+            tf::Executor().run(flow).wait();
+        }
+        const auto converted = conversion::curvature_to_image(
+            out_img, *depth_image, {-20.}, {20.});
+        cv::imwrite("conversion/test_gauss_parallel.png", converted.data());
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/gauss-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 5.);
+    }
+    SUBCASE("mean curvature") {
+        {
+            tf::Taskflow flow;
+            conversion::par_depth_to_mean_curvature(laser_double, p, out_img,
+                                                    flow);
+            tf::Executor().run(flow).wait();
+        }
+        const auto converted = conversion::curvature_to_image(
+            out_img, *depth_image, {-20.}, {20.});
+        cv::imwrite("conversion/test_mean_parallel.png", converted.data());
+
+        auto ref_image = io::load_image<ushort>("conversion/mean-reference.png",
+                                                cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 5.);
+    }
+}
+
 TEST_CASE("gaussian curvature equirectangular") {
     auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
                                               cv::IMREAD_UNCHANGED);
@@ -117,3 +164,176 @@ TEST_CASE("mean curvature equirectangular") {
                     converted.data());
     }
 }
+
+TEST_CASE("curvature with angle tables") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto laser_double =
+        conversion::depth_to_laserscan<double, ushort>(*depth_image, p);
+    const conversion::curvature_angles<camera_models::pinhole<double>> angles{
+        p};
+
+    SUBCASE("gaussian curvature") {
+        const auto gauss =
+            conversion::depth_to_gaussian_curvature(laser_double, angles);
+        const auto converted =
+            conversion::curvature_to_image(gauss, *depth_image, {-20.}, {20.});
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/gauss-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 5.);
+    }
+    SUBCASE("mean curvature") {
+        const auto mean =
+            conversion::depth_to_mean_curvature(laser_double, angles);
+        const auto converted =
+            conversion::curvature_to_image(mean, *depth_image, {-20.}, {20.});
+
+        auto ref_image = io::load_image<ushort>("conversion/mean-reference.png",
+                                                cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 5.);
+    }
+}
+
+TEST_CASE("quantized curvature with angle tables") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto laser_double =
+        conversion::depth_to_laserscan<double, ushort>(*depth_image, p);
+    const conversion::curvature_angles<camera_models::pinhole<double>> angles{
+        p};
+    const conversion::curvature_quantization<ushort, double> q{-20., 20.};
+
+    SUBCASE("gaussian curvature") {
+        const auto quantized =
+            conversion::depth_to_gaussian_curvature(laser_double, angles, q);
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/gauss-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(quantized, *ref_image) < 5.);
+
+        // Quantizing on write applies exactly the same transformation.
+        const auto gauss =
+            conversion::depth_to_gaussian_curvature(laser_double, angles);
+        const auto converted =
+            conversion::curvature_to_image(gauss, *depth_image, {-20.}, {20.});
+        REQUIRE(util::average_pixel_error(quantized, converted) == 0.);
+
+        math::image<ushort> parallel(
+            cv::Mat(depth_image->h(), depth_image->w(), CV_16U));
+        tf::Taskflow flow;
+        conversion::par_depth_to_gaussian_curvature(laser_double, angles, q,
+                                                    parallel, flow);
+        tf::Executor().run(flow).wait();
+        REQUIRE(util::average_pixel_error(quantized, parallel) == 0.);
+    }
+    SUBCASE("mean curvature") {
+        const auto quantized =
+            conversion::depth_to_mean_curvature(laser_double, angles, q);
+
+        auto ref_image = io::load_image<ushort>("conversion/mean-reference.png",
+                                                cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(quantized, *ref_image) < 5.);
+
+        const auto mean =
+            conversion::depth_to_mean_curvature(laser_double, angles);
+        const auto converted =
+            conversion::curvature_to_image(mean, *depth_image, {-20.}, {20.});
+        REQUIRE(util::average_pixel_error(quantized, converted) == 0.);
+
+        math::image<ushort> parallel(
+            cv::Mat(depth_image->h(), depth_image->w(), CV_16U));
+        tf::Taskflow flow;
+        conversion::par_depth_to_mean_curvature(laser_double, angles, q,
+                                                parallel, flow);
+        tf::Executor().run(flow).wait();
+        REQUIRE(util::average_pixel_error(quantized, parallel) == 0.);
+    }
+}
+
+TEST_CASE("curvature equirectangular with angle tables") {
+    auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const auto laser_double = math::convert<double>(*depth_image);
+    const conversion::curvature_angles<camera_models::equirectangular<double>>
+        angles{e_double};
+
+    SUBCASE("gaussian curvature") {
+        const auto gauss =
+            conversion::depth_to_gaussian_curvature(laser_double, angles);
+        const auto converted =
+            conversion::curvature_to_image(gauss, *depth_image, {-20.}, {20.});
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/gauss-laserscan-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 2.5);
+    }
+    SUBCASE("mean curvature") {
+        const auto mean =
+            conversion::depth_to_mean_curvature(laser_double, angles);
+        const auto converted =
+            conversion::curvature_to_image(mean, *depth_image, {-20.}, {20.});
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/mean-laserscan-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 2.5);
+    }
+}
+
+TEST_CASE("curvature equirectangular in parallel with angle tables") {
+    auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const auto laser_double = math::convert<double>(*depth_image);
+    const conversion::curvature_angles<camera_models::equirectangular<double>>
+        angles{e_double};
+
+    cv::Mat out(laser_double.h(), laser_double.w(),
+                laser_double.data().type());
+    out = 0.;
+    math::image<double> out_img(std::move(out));
+
+    SUBCASE("gaussian curvature") {
+        {
+            tf::Taskflow flow;
+            conversion::par_depth_to_gaussian_curvature(laser_double, angles,
+                                                        out_img, flow);
+            tf::Executor().run(flow).wait();
+        }
+        const auto converted = conversion::curvature_to_image(
+            out_img, *depth_image, {-20.}, {20.});
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/gauss-laserscan-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 2.5);
+    }
+    SUBCASE("mean curvature") {
+        {
+            tf::Taskflow flow;
+            conversion::par_depth_to_mean_curvature(laser_double, angles,
+                                                    out_img, flow);
+            tf::Executor().run(flow).wait();
+        }
+        const auto converted = conversion::curvature_to_image(
+            out_img, *depth_image, {-20.}, {20.});
+
+        auto ref_image = io::load_image<ushort>(
+            "conversion/mean-laserscan-reference.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_image);
+        REQUIRE(util::average_pixel_error(converted, *ref_image) < 2.5);
+    }
+}
@@ -8,9 +8,20 @@
 #include <sens_loc/conversion/depth_to_laserscan.h>
 #include <sens_loc/io/image.h>
 #include <sens_loc/util/correctness_util.h>
+#include <sens_loc/util/simd.h>
 
 using namespace sens_loc;
 
+namespace {
+/// Overwrite the stack below the caller, e.g. a returned stack frame.
+[[gnu::noinline]] void clobber_stack() {
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays)
+    volatile unsigned char garbage[4096];
+    for (volatile unsigned char& b : garbage)
+        b = 0xFFU;
+}
+}  // namespace
+
 TEST_CASE("flexion image pinhole") {
     auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
                                               cv::IMREAD_UNCHANGED);
@@ -46,3 +57,182 @@ TEST_CASE("flexion image equirectangular") {
 
     REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
 }
+
+TEST_CASE("flexion image with ray cache") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto ref_image = io::load_image<ushort>("conversion/flexion-reference.png",
+                                            cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_image);
+
+    const camera_models::ray_cache<camera_models::pinhole<double>> rays{p};
+
+    auto laser_double =
+        conversion::depth_to_laserscan<double, ushort>(*depth_image, rays);
+
+    SUBCASE("serial") {
+        const auto flexion   = conversion::depth_to_flexion(laser_double, rays);
+        const auto converted = conversion::convert_flexion<ushort>(flexion);
+
+        REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
+    }
+    SUBCASE("parallel") {
+        cv::Mat out(laser_double.h(), laser_double.w(), CV_64F);
+        out = 0.;
+        math::image<double> flexion(std::move(out));
+        {
+            tf::Taskflow flow;
+            conversion::par_depth_to_flexion(laser_double, rays, flexion,
+                                             flow);
+            tf::Executor().run(flow).wait();
+        }
+        const auto converted = conversion::convert_flexion<ushort>(flexion);
+
+        REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
+    }
+    SUBCASE("parallel flow runs after the call returned") {
+        const auto serial = conversion::depth_to_flexion(laser_double, rays);
+
+        cv::Mat out(laser_double.h(), laser_double.w(), CV_64F);
+        out = 0.;
+        math::image<double> flexion(std::move(out));
+
+        tf::Taskflow flow;
+        conversion::par_depth_to_flexion(laser_double, rays, flexion, flow);
+        // The stack frame of the call is reused before the flow runs. Every
+        // state that the tasks need must be captured by value.
+        clobber_stack();
+        tf::Executor().run(flow).wait();
+
+        REQUIRE(cv::norm(serial.data(), flexion.data(), cv::NORM_INF) == 0.);
+    }
+}
+
+TEST_CASE("quantized flexion image") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto ref_image = io::load_image<ushort>("conversion/flexion-reference.png",
+                                            cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_image);
+
+    SUBCASE("double") {
+        const camera_models::ray_cache<camera_models::pinhole<double>> rays{p};
+        auto laser_double =
+            conversion::depth_to_laserscan<double, ushort>(*depth_image, rays);
+
+        const auto quantized = conversion::depth_to_flexion(
+            laser_double, rays,
+            conversion::flexion_quantization<ushort, double>());
+        REQUIRE(util::average_pixel_error(*ref_image, quantized) < 0.5);
+
+        const auto converted = conversion::convert_flexion<ushort>(
+            conversion::depth_to_flexion(laser_double, rays));
+        REQUIRE(util::average_pixel_error(converted, quantized) < 0.01);
+    }
+    SUBCASE("float") {
+        // Single precision uses the vectorized kernels, if available.
+        const camera_models::ray_cache<camera_models::pinhole<float>> rays{
+            p_float};
+        auto laser_float =
+            conversion::depth_to_laserscan<float, ushort>(*depth_image, rays);
+
+        const auto quantized = conversion::depth_to_flexion(
+            laser_float, rays,
+            conversion::flexion_quantization<ushort, float>());
+        REQUIRE(util::average_pixel_error(*ref_image, quantized) < 0.5);
+
+        const auto converted = conversion::convert_flexion<ushort>(
+            conversion::depth_to_flexion(laser_float, rays));
+        REQUIRE(util::average_pixel_error(converted, quantized) < 0.01);
+    }
+    SUBCASE("into existing images") {
+        const camera_models::ray_cache<camera_models::pinhole<float>> rays{
+            p_float};
+        math::image<float> laser_float(
+            cv::Mat(depth_image->h(), depth_image->w(), CV_32F));
+        conversion::depth_to_laserscan(*depth_image, rays, laser_float);
+        REQUIRE(util::average_pixel_error(
+                    laser_float, conversion::depth_to_laserscan<float, ushort>(
+                                     *depth_image, rays)) == 0.);
+
+        const auto q = conversion::flexion_quantization<ushort, float>();
+        math::image<ushort> flexion(
+            cv::Mat(depth_image->h(), depth_image->w(), CV_16U));
+        const uchar* memory = flexion.data().data;
+
+        // Converting multiple times into the same image overwrites every
+        // pixel and does not reallocate.
+        for (int i = 0; i < 2; ++i) {
+            conversion::depth_to_flexion(laser_float, rays, q, flexion);
+            REQUIRE(flexion.data().data == memory);
+            REQUIRE(util::average_pixel_error(
+                        flexion, conversion::depth_to_flexion(laser_float,
+                                                              rays, q)) == 0.);
+        }
+
+        // The parallel conversion gives the same result.
+        math::image<ushort> parallel(
+            cv::Mat(depth_image->h(), depth_image->w(), CV_16U));
+        tf::Taskflow flow;
+        conversion::par_depth_to_flexion(laser_float, rays, q, parallel, flow);
+        tf::Executor().run(flow).wait();
+        REQUIRE(util::average_pixel_error(flexion, parallel) == 0.);
+    }
+}
+
+TEST_CASE("vectorized flexion kernels") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto ref_image = io::load_image<ushort>("conversion/flexion-reference.png",
+                                            cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_image);
+
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{
+        p_float};
+
+    auto laser_float =
+        conversion::depth_to_laserscan<float, ushort>(*depth_image, rays);
+
+    cv::Mat scalar_out(laser_float.h(), laser_float.w(), CV_32F);
+    scalar_out = 0.F;
+    math::image<float> scalar(std::move(scalar_out));
+    for (int v = 1; v < laser_float.h() - 1; ++v)
+        conversion::detail::flexion_inner(v, laser_float, rays, scalar);
+
+    for (const util::simd_level level :
+         {util::simd_level::none, util::simd_level::sse42,
+          util::simd_level::avx2}) {
+        // Only the kernels the processor supports can be executed.
+        if (level > util::simd_support())
+            continue;
+        CAPTURE(static_cast<int>(level));
+
+        cv::Mat out(laser_float.h(), laser_float.w(), CV_32F);
+        out = 0.F;
+        math::image<float> flexion(std::move(out));
+        for (int v = 1; v < laser_float.h() - 1; ++v)
+            conversion::detail::flexion_row(v, laser_float, rays, flexion,
+                                            level);
+
+        float max_error = 0.F;
+        for (int v = 0; v < flexion.h(); ++v)
+            for (int u = 0; u < flexion.w(); ++u)
+                max_error = std::max(max_error, std::abs(flexion.at({u, v}) -
+                                                         scalar.at({u, v})));
+        REQUIRE(max_error <= conversion::detail::flexion_simd_tolerance);
+
+        const auto converted = conversion::convert_flexion<ushort>(flexion);
+        REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
+    }
+
+    // The public interface selects the kernel at runtime.
+    const auto flexion   = conversion::depth_to_flexion(laser_float, rays);
+    const auto converted = conversion::convert_flexion<ushort>(flexion);
+    REQUIRE(util::average_pixel_error(*ref_image, converted) < 0.5);
+}
@@ -66,3 +66,35 @@ TEST_CASE("convert depth image to laser-scan image parallel") {
     REQUIRE(util::average_pixel_error(laser_float_16u,
                                       ref_depth_laser_image->data()) < 5.);
 }
+
+TEST_CASE("convert depth image to laser-scan image with ray cache") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    auto ref_depth_laser_image = io::load_image<ushort>(
+        "conversion/data0-depth-laser.png", cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+    REQUIRE(ref_depth_laser_image);
+
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{
+        p_float};
+    auto laser_cached = depth_to_laserscan<float>(*depth_image, rays);
+    auto laser_direct = depth_to_laserscan<float>(*depth_image, p_float);
+
+    cv::Mat laser_float_16u;
+    laser_cached.data().convertTo(laser_float_16u, CV_16U);
+
+    REQUIRE(util::average_pixel_error(laser_float_16u,
+                                      ref_depth_laser_image->data()) < 0.5);
+    REQUIRE(util::average_pixel_error(laser_cached.data(),
+                                      laser_direct.data()) < 0.01);
+
+    cv::Mat            laser_out(depth_image->h(), depth_image->w(), CV_32F);
+    math::image<float> laser_img(std::move(laser_out));
+    {
+        tf::Taskflow flow;
+        par_depth_to_laserscan<float>(*depth_image, rays, laser_img, flow);
+        tf::Executor().run(flow).wait();
+    }
+    REQUIRE(util::average_pixel_error(laser_img.data(),
+                                      laser_direct.data()) < 0.01);
+}
@@ -85,6 +85,77 @@ TEST_CASE("depth image to max curve") {
                     curve_ushort.data());
         REQUIRE(util::average_pixel_error(*ref_double, curve_ushort) < 0.5);
     }
+
+    SUBCASE("double accuracy in parallel") {
+        auto ref_double = io::load_image<ushort>(
+            "conversion/max-curve-double.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_double);
+
+        const auto laser_double =
+            depth_to_laserscan<double, ushort>(*depth_image, p);
+
+        cv::Mat out(laser_double.h(), laser_double.w(),
+                    laser_double.data().type());
+        out = 0.;
+        math::image<double> curve_double(std::move(out));
+        {
+            tf::Taskflow flow;
+            par_depth_to_max_curve(laser_double, p, curve_double, flow);
+            tf::Executor().run(flow).wait();
+        }
+
+        const auto curve_ushort = convert_max_curve<ushort>(curve_double);
+        cv::imwrite("conversion/test_max_curve_double_parallel.png",
+                    curve_ushort.data());
+        REQUIRE(util::average_pixel_error(*ref_double, curve_ushort) < 0.5);
+    }
+
+    SUBCASE("double accuracy with angle tables") {
+        auto ref_double = io::load_image<ushort>(
+            "conversion/max-curve-double.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(ref_double);
+
+        const auto laser_double =
+            depth_to_laserscan<double, ushort>(*depth_image, p);
+        const bearing_angles<camera_models::pinhole<double>> angles{p};
+
+        const auto curve_double = depth_to_max_curve(laser_double, angles);
+        const auto curve_ushort = convert_max_curve<ushort>(curve_double);
+        REQUIRE(util::average_pixel_error(*ref_double, curve_ushort) < 0.5);
+    }
+}
+
+TEST_CASE("depth image to quantized max curve") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    auto ref_double = io::load_image<ushort>("conversion/max-curve-double.png",
+                                             cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_double);
+
+    const auto laser_double =
+        depth_to_laserscan<double, ushort>(*depth_image, p);
+    const bearing_angles<camera_models::pinhole<double>> angles{p};
+
+    const auto quantized = depth_to_max_curve(
+        laser_double, angles, max_curve_quantization<ushort, double>());
+    REQUIRE(util::average_pixel_error(*ref_double, quantized) < 0.5);
+
+    const auto converted =
+        convert_max_curve<ushort>(depth_to_max_curve(laser_double, angles));
+    REQUIRE(util::average_pixel_error(converted, quantized) < 0.01);
+
+    SUBCASE("parallel") {
+        math::image<ushort> parallel(
+            cv::Mat(depth_image->h(), depth_image->w(), CV_16U));
+        tf::Taskflow flow;
+        par_depth_to_max_curve(laser_double, angles,
+                               max_curve_quantization<ushort, double>(),
+                               parallel, flow);
+        tf::Executor().run(flow).wait();
+        REQUIRE(util::average_pixel_error(quantized, parallel) == 0.);
+    }
 }
 
 TEST_CASE("laserscan to max curve") {
@@ -102,3 +173,46 @@ TEST_CASE("laserscan to max curve") {
     REQUIRE(ref_double);
     REQUIRE(util::average_pixel_error(*ref_double, curve_ushort) < 0.5);
 }
+
+TEST_CASE("laserscan to max curve with angle tables") {
+    auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const bearing_angles<camera_models::equirectangular<double>> angles{
+        e_double};
+    const auto laser_double = math::convert<double>(*depth_image);
+    const auto curve_double = depth_to_max_curve(laser_double, angles);
+    const auto curve_ushort = convert_max_curve<ushort>(curve_double);
+
+    auto ref_double = io::load_image<ushort>(
+        "conversion/max-curve-laserscan.png", cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_double);
+    REQUIRE(util::average_pixel_error(*ref_double, curve_ushort) < 0.5);
+}
+
+TEST_CASE("laserscan to max curve in parallel with angle tables") {
+    auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const bearing_angles<camera_models::equirectangular<double>> angles{
+        e_double};
+    const auto laser_double = math::convert<double>(*depth_image);
+
+    cv::Mat out(laser_double.h(), laser_double.w(),
+                laser_double.data().type());
+    out = 0.;
+    math::image<double> curve_double(std::move(out));
+    {
+        tf::Taskflow flow;
+        par_depth_to_max_curve(laser_double, angles, curve_double, flow);
+        tf::Executor().run(flow).wait();
+    }
+    const auto curve_ushort = convert_max_curve<ushort>(curve_double);
+
+    auto ref_double = io::load_image<ushort>(
+        "conversion/max-curve-laserscan.png", cv::IMREAD_UNCHANGED);
+    REQUIRE(ref_double);
+    REQUIRE(util::average_pixel_error(*ref_double, curve_ushort) < 0.5);
+}
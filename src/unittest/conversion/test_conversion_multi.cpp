@@ -0,0 +1,177 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "intrinsic.h"
+
+#include <doctest/doctest.h>
+#include <sens_loc/conversion/depth_to_laserscan.h>
+#include <sens_loc/conversion/depth_to_multi.h>
+#include <sens_loc/io/image.h>
+#include <sens_loc/util/correctness_util.h>
+
+using namespace sens_loc;
+using namespace sens_loc::conversion;
+using namespace std;
+
+namespace {
+math::image<float> zero_image(const math::image<float>& depth_image) {
+    cv::Mat img(depth_image.h(), depth_image.w(), CV_32F);
+    img = 0.F;
+    return math::image<float>(std::move(img));
+}
+
+float max_difference(const math::image<float>& i1,
+                     const math::image<float>& i2) {
+    REQUIRE(i1.w() == i2.w());
+    REQUIRE(i1.h() == i2.h());
+
+    float max_diff = 0.F;
+    for (int v = 0; v < i1.h(); ++v)
+        for (int u = 0; u < i1.w(); ++u)
+            max_diff =
+                std::max(max_diff, std::abs(i1.at({u, v}) - i2.at({u, v})));
+    return max_diff;
+}
+
+void require_equal(const math::image<float>& i1, const math::image<float>& i2) {
+    REQUIRE(max_difference(i1, i2) == 0.F);
+}
+
+/// Compare the fused conversion against the single conversions.
+template <typename Intrinsic>
+void check_multi(const math::image<float>& depth_image,
+                 const Intrinsic&          intrinsic) {
+    const bearing_angles<Intrinsic>           angles{intrinsic};
+    const camera_models::ray_cache<Intrinsic> rays{intrinsic};
+
+    math::image<float> horizontal   = zero_image(depth_image);
+    math::image<float> vertical     = zero_image(depth_image);
+    math::image<float> diagonal     = zero_image(depth_image);
+    math::image<float> antidiagonal = zero_image(depth_image);
+    math::image<float> flexion      = zero_image(depth_image);
+    math::image<float> max_curve    = zero_image(depth_image);
+
+    const multi_images<float> out{&horizontal, &vertical, &diagonal,
+                                  &antidiagonal, &flexion,  &max_curve};
+
+    SUBCASE("intrinsic") {
+        depth_to_multi(depth_image, intrinsic, out);
+
+        require_equal(horizontal, depth_to_bearing<direction::horizontal>(
+                                      depth_image, intrinsic));
+        require_equal(vertical, depth_to_bearing<direction::vertical>(
+                                    depth_image, intrinsic));
+        require_equal(diagonal, depth_to_bearing<direction::diagonal>(
+                                    depth_image, intrinsic));
+        require_equal(antidiagonal, depth_to_bearing<direction::antidiagonal>(
+                                        depth_image, intrinsic));
+        require_equal(flexion, depth_to_flexion(depth_image, intrinsic));
+        require_equal(max_curve, depth_to_max_curve(depth_image, intrinsic));
+    }
+    SUBCASE("angle tables") {
+        depth_to_multi(depth_image, angles, rays, out);
+
+        require_equal(horizontal, depth_to_bearing<direction::horizontal>(
+                                      depth_image, angles.horizontal));
+        require_equal(vertical, depth_to_bearing<direction::vertical>(
+                                    depth_image, angles.vertical));
+        require_equal(diagonal, depth_to_bearing<direction::diagonal>(
+                                    depth_image, angles.diagonal));
+        require_equal(antidiagonal, depth_to_bearing<direction::antidiagonal>(
+                                        depth_image, angles.antidiagonal));
+        require_equal(max_curve, depth_to_max_curve(depth_image, angles));
+
+        // The single conversion uses vectorized kernels with the ray cache.
+        const auto flexion_single = depth_to_flexion(depth_image, rays);
+        REQUIRE(max_difference(flexion, flexion_single) <=
+                detail::flexion_simd_tolerance);
+    }
+    SUBCASE("parallel") {
+        {
+            tf::Taskflow flow;
+            par_depth_to_multi(depth_image, angles, rays, out, flow);
+            tf::Executor().run(flow).wait();
+        }
+        require_equal(horizontal, depth_to_bearing<direction::horizontal>(
+                                      depth_image, angles.horizontal));
+        require_equal(antidiagonal, depth_to_bearing<direction::antidiagonal>(
+                                        depth_image, angles.antidiagonal));
+        require_equal(max_curve, depth_to_max_curve(depth_image, angles));
+    }
+    SUBCASE("subset") {
+        const multi_images<float> subset{/*horizontal=*/nullptr, &vertical};
+        REQUIRE(!subset.empty());
+        depth_to_multi(depth_image, angles, rays, subset);
+
+        require_equal(vertical, depth_to_bearing<direction::vertical>(
+                                    depth_image, angles.vertical));
+        // Images that were not selected stay untouched.
+        REQUIRE(max_difference(horizontal, zero_image(depth_image)) == 0.F);
+        REQUIRE(max_difference(flexion, zero_image(depth_image)) == 0.F);
+    }
+}
+}  // namespace
+
+TEST_CASE("fused conversion pinhole") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const auto laser_float =
+        depth_to_laserscan<float, ushort>(*depth_image, p_float);
+    check_multi(laser_float, p_float);
+}
+
+TEST_CASE("fused conversion equirectangular") {
+    auto depth_image = io::load_image<ushort>("conversion/laserscan-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const auto laser_float = math::convert<float>(*depth_image);
+    check_multi(laser_float, e_float);
+}
+
+TEST_CASE("fused conversion with quantized results") {
+    auto depth_image = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth_image);
+
+    const auto laser_float =
+        depth_to_laserscan<float, ushort>(*depth_image, p_float);
+    const bearing_angles<camera_models::pinhole<float>> angles{p_float};
+    const camera_models::ray_cache<camera_models::pinhole<float>> rays{
+        p_float};
+
+    auto make_target = [&]() {
+        cv::Mat img(laser_float.h(), laser_float.w(), CV_16U);
+        return math::image<ushort>(std::move(img));
+    };
+    math::image<ushort> horizontal = make_target();
+    math::image<ushort> max_curve  = make_target();
+
+    const auto bearing_q   = bearing_quantization<ushort, float>();
+    const auto max_curve_q = max_curve_quantization<ushort, float>();
+
+    using target_image = quantized_image<ushort, float>;
+    target_image horizontal_target(horizontal, bearing_q);
+    target_image max_curve_target(max_curve, max_curve_q);
+    horizontal_target.clear();
+    max_curve_target.clear();
+
+    multi_images<float, target_image> out;
+    out.horizontal = &horizontal_target;
+    out.max_curve  = &max_curve_target;
+    depth_to_multi(laser_float, angles, rays, out);
+
+    const auto horizontal_single = depth_to_bearing<direction::horizontal>(
+        laser_float, angles.horizontal, bearing_q);
+    REQUIRE(util::average_pixel_error(horizontal, horizontal_single) == 0.);
+
+    const auto max_curve_single =
+        depth_to_max_curve(laser_float, angles, max_curve_q);
+    REQUIRE(util::average_pixel_error(max_curve, max_curve_single) == 0.);
+}
+
+TEST_CASE("empty selection") {
+    const multi_images<float> out;
+    REQUIRE(out.empty());
+}
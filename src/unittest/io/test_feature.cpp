@@ -0,0 +1,129 @@
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <opencv2/core.hpp>
+#include <sens_loc/io/feature.h>
+#include <stdexcept>
+#include <vector>
+
+using namespace sens_loc;
+
+namespace {
+std::vector<cv::KeyPoint> make_keypoints() {
+    std::vector<cv::KeyPoint> kps;
+    for (int i = 0; i < 5; ++i)
+        kps.emplace_back(cv::Point2f{10.5F * i, 3.25F * i}, 31.F + i,
+                         12.F * i, 0.01F * i, i % 3, i == 2 ? 7 : -1);
+    return kps;
+}
+
+cv::Mat make_descriptors(int type) {
+    cv::Mat d(5, 32, type);
+    cv::randu(d, 0, 255);
+    return d;
+}
+}  // namespace
+
+TEST_CASE("Feature file format by extension") {
+    REQUIRE(io::feature_format_for("sift-0.yml") == io::feature_format::yaml);
+    REQUIRE(io::feature_format_for("sift-0.yaml") == io::feature_format::yaml);
+    REQUIRE(io::feature_format_for("sift-0.feature.gz") ==
+            io::feature_format::yaml);
+    REQUIRE(io::feature_format_for("sift-0.feature") ==
+            io::feature_format::binary);
+    REQUIRE(io::feature_format_for("sift-0") == io::feature_format::binary);
+}
+
+TEST_CASE("Write and read feature files") {
+    const std::vector<cv::KeyPoint> kps = make_keypoints();
+
+    for (const char* file : {"io/test-features.feature", "io/test-features.yml",
+                             "io/test-features.yml.gz"}) {
+        for (const int type : {CV_8U, CV_32F}) {
+            CAPTURE(file);
+            CAPTURE(type);
+            const cv::Mat descriptors = make_descriptors(type);
+            REQUIRE(io::write_features(file, "flexion-0.png", kps,
+                                       descriptors));
+
+            const io::feature_file f = io::open_feature_file(file);
+            REQUIRE(f.is_open());
+            REQUIRE(f.format() == io::feature_format_for(file));
+            REQUIRE(f.source_path() == "flexion-0.png");
+
+            const std::vector<cv::KeyPoint> loaded = io::load_keypoints(f);
+            REQUIRE(loaded.size() == kps.size());
+            for (std::size_t i = 0; i < kps.size(); ++i) {
+                CAPTURE(i);
+                REQUIRE(loaded[i].pt == kps[i].pt);
+                REQUIRE(loaded[i].size == kps[i].size);
+                REQUIRE(loaded[i].angle == kps[i].angle);
+                REQUIRE(loaded[i].response == kps[i].response);
+                REQUIRE(loaded[i].octave == kps[i].octave);
+                REQUIRE(loaded[i].class_id == kps[i].class_id);
+            }
+
+            const cv::Mat d = io::load_descriptors(f);
+            REQUIRE(d.type() == type);
+            REQUIRE(d.rows == descriptors.rows);
+            REQUIRE(d.cols == descriptors.cols);
+            REQUIRE(cv::norm(d, descriptors, cv::NORM_INF) == 0.);
+        }
+    }
+
+    SUBCASE("Without descriptors") {
+        REQUIRE(io::write_features("io/test-no-descriptors.feature", "", kps,
+                                   cv::Mat()));
+        const io::feature_file f{"io/test-no-descriptors.feature"};
+        REQUIRE(f.format() == io::feature_format::binary);
+        REQUIRE(f.source_path().empty());
+        REQUIRE(f.keypoints().size() == kps.size());
+        REQUIRE(f.descriptors().empty());
+    }
+}
+
+TEST_CASE("Read invalid feature files") {
+    SUBCASE("Missing file") {
+        const io::feature_file f{"io/does-not-exist.feature"};
+        REQUIRE(!f.is_open());
+        REQUIRE(f.keypoints().empty());
+    }
+    SUBCASE("Corrupted binary file") {
+        const char* file = "io/test-corrupted.feature";
+        REQUIRE(io::write_features(file, "flexion-0.png", make_keypoints(),
+                                   make_descriptors(CV_8U)));
+        {
+            // Claim more keypoints than the file contains.
+            std::fstream out{file, std::ios::binary | std::ios::in |
+                                       std::ios::out};
+            const std::uint32_t count = 100000;
+            out.seekp(offsetof(io::feature_header, keypoint_count));
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        }
+        REQUIRE_THROWS_AS(io::feature_file{file}, std::runtime_error);
+    }
+    SUBCASE("Unknown descriptor type") {
+        const char* file = "io/test-descriptor-type.feature";
+        for (const std::int32_t type : {CV_8UC3, CV_32FC2, 7, -1, 4242}) {
+            CAPTURE(type);
+            REQUIRE(io::write_features(file, "flexion-0.png",
+                                       make_keypoints(),
+                                       make_descriptors(CV_8U)));
+            {
+                std::fstream out{file, std::ios::binary | std::ios::in |
+                                           std::ios::out};
+                out.seekp(offsetof(io::feature_header, descriptor_type));
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                out.write(reinterpret_cast<const char*>(&type), sizeof(type));
+            }
+            REQUIRE_THROWS_AS(io::feature_file{file}, std::runtime_error);
+        }
+    }
+    SUBCASE("Multi channel descriptors are not written") {
+        REQUIRE(!io::write_features("io/test-multi-channel.feature",
+                                    "flexion-0.png", make_keypoints(),
+                                    make_descriptors(CV_8UC3)));
+    }
+}
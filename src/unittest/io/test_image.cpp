@@ -1,5 +1,7 @@
 #include <doctest/doctest.h>
 #include <sens_loc/io/image.h>
+#include <sens_loc/util/correctness_util.h>
+#include <vector>
 
 using namespace sens_loc;
 
@@ -16,3 +18,62 @@ TEST_CASE("Loading Images") {
         REQUIRE(file);
     }
 }
+
+TEST_CASE("Loading Images into existing buffers") {
+    std::vector<uchar> file_buffer;
+    math::image<uchar> target;
+
+    SUBCASE("Non existing file") {
+        REQUIRE(!io::load_image("DoesNotExist", cv::IMREAD_UNCHANGED,
+                                file_buffer, target));
+    }
+    SUBCASE("Wrong pixel type") {
+        math::image<ushort> wrong_type;
+        REQUIRE(!io::load_image("io/example-image.png", cv::IMREAD_UNCHANGED,
+                                file_buffer, wrong_type));
+    }
+    SUBCASE("Repeated loading reuses the memory") {
+        REQUIRE(io::load_image("io/example-image.png", cv::IMREAD_UNCHANGED,
+                               file_buffer, target));
+        const uchar* first = target.data().data;
+
+        REQUIRE(io::load_image("io/example-image.png", cv::IMREAD_UNCHANGED,
+                               file_buffer, target));
+        REQUIRE(target.data().data == first);
+
+        const auto reference =
+            io::load_image<uchar>("io/example-image.png", cv::IMREAD_UNCHANGED);
+        REQUIRE(reference);
+        REQUIRE(util::average_pixel_error(*reference, target) == 0.);
+    }
+}
+
+TEST_CASE("Writing Images") {
+    SUBCASE("Parameters for the codecs") {
+        REQUIRE(io::write_parameters("depth.png", -1).empty());
+        REQUIRE(io::write_parameters("depth.png", 1) ==
+                std::vector<int>{cv::IMWRITE_PNG_COMPRESSION, 1});
+        REQUIRE(io::write_parameters("depth.PNG", 42) ==
+                std::vector<int>{cv::IMWRITE_PNG_COMPRESSION, 9});
+        REQUIRE(io::write_parameters("depth.tiff", 0) ==
+                std::vector<int>{cv::IMWRITE_TIFF_COMPRESSION, 1});
+        REQUIRE(io::write_parameters("depth.tif", 3).empty());
+        REQUIRE(io::write_parameters("depth.pgm", 0).empty());
+    }
+
+    const auto depth = io::load_image<ushort>("conversion/data0-depth.png",
+                                              cv::IMREAD_UNCHANGED);
+    REQUIRE(depth);
+
+    // All containers must store 16-bit depth images without loss.
+    for (const char* name : {"io/test-write-uncompressed.png",
+                             "io/test-write-uncompressed.tiff",
+                             "io/test-write-raw.pgm"}) {
+        CAPTURE(name);
+        REQUIRE(io::write_image(name, depth->data(), 0));
+
+        const auto loaded = io::load_image<ushort>(name, cv::IMREAD_UNCHANGED);
+        REQUIRE(loaded);
+        REQUIRE(util::average_pixel_error(*depth, *loaded) == 0.);
+    }
+}
@@ -0,0 +1,128 @@
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sens_loc/io/manifest.h>
+#include <string>
+#include <sys/stat.h>
+
+using namespace sens_loc;
+
+namespace {
+/// Create \p file with the modification time \p seconds since the epoch.
+void touch(const std::string& file, long seconds) {
+    { std::ofstream f{file}; }
+    timespec times[2];
+    times[0].tv_sec  = seconds;
+    times[0].tv_nsec = 0;
+    times[1]         = times[0];
+    REQUIRE(::utimensat(AT_FDCWD, file.c_str(), times, 0) == 0);
+}
+}  // namespace
+
+TEST_CASE("Manifest of a batch") {
+    const std::string manifest = "io/test-manifest.txt";
+    std::remove(manifest.c_str());
+    touch("io/manifest-input-0.png", 100);
+    touch("io/manifest-input-1.png", 100);
+    touch("io/manifest-output-0.png", 200);
+    touch("io/manifest-output-1.png", 200);
+    touch("io/manifest-second-0.png", 200);
+    touch("io/manifest-calibration.txt", 50);
+
+    SUBCASE("New manifest has no records") {
+        auto m = io::batch_manifest::open(manifest, "flexion");
+        REQUIRE(m);
+        CHECK(!m->up_to_date(0, "io/manifest-input-0.png"));
+    }
+
+    {
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        REQUIRE(m->record(0, {"io/manifest-output-0.png",
+                              "io/manifest-second-0.png"}));
+        REQUIRE(m->record(1, {"io/manifest-output-1.png"}));
+        // Records are only used by the next batch.
+        CHECK(!m->up_to_date(0, "io/manifest-input-0.png"));
+    }
+
+    SUBCASE("Outputs are up to date") {
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(m->up_to_date(0, "io/manifest-input-0.png"));
+        CHECK(m->up_to_date(1, "io/manifest-input-1.png"));
+        CHECK(!m->up_to_date(2, "io/manifest-input-1.png"));
+
+        // Reopening the manifest keeps the records.
+        m = io::batch_manifest::open(manifest, "flexion",
+                                     {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(m->up_to_date(0, "io/manifest-input-0.png"));
+    }
+
+    SUBCASE("Changed configuration discards the records") {
+        auto m = io::batch_manifest::open(manifest, "bearing",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(!m->up_to_date(0, "io/manifest-input-0.png"));
+        CHECK(!m->up_to_date(1, "io/manifest-input-1.png"));
+    }
+
+    SUBCASE("Newer input") {
+        touch("io/manifest-input-1.png", 300);
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(m->up_to_date(0, "io/manifest-input-0.png"));
+        CHECK(!m->up_to_date(1, "io/manifest-input-1.png"));
+    }
+
+    SUBCASE("Newer dependency") {
+        touch("io/manifest-calibration.txt", 300);
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(!m->up_to_date(0, "io/manifest-input-0.png"));
+    }
+
+    SUBCASE("Missing dependency") {
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/does-not-exist.txt"});
+        REQUIRE(m);
+        CHECK(!m->up_to_date(0, "io/manifest-input-0.png"));
+    }
+
+    SUBCASE("Missing output") {
+        std::remove("io/manifest-second-0.png");
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(!m->up_to_date(0, "io/manifest-input-0.png"));
+        CHECK(m->up_to_date(1, "io/manifest-input-1.png"));
+    }
+
+    SUBCASE("Partial record of an interrupted batch") {
+        {
+            std::ofstream f{manifest, std::ios::app};
+            f << "1";
+        }
+        auto m = io::batch_manifest::open(manifest, "flexion",
+                                          {"io/manifest-calibration.txt"});
+        REQUIRE(m);
+        CHECK(m->up_to_date(1, "io/manifest-input-1.png"));
+    }
+}
+
+TEST_CASE("Manifest that can not be written") {
+    CHECK(!io::batch_manifest::open("io/does-not-exist/manifest.txt", "a"));
+}
+
+TEST_CASE("Configuration hash") {
+    CHECK(io::batch_manifest::hash("") == 14695981039346656037ULL);
+    CHECK(io::batch_manifest::hash("flexion") ==
+          io::batch_manifest::hash("flexion"));
+    CHECK(io::batch_manifest::hash("flexion") !=
+          io::batch_manifest::hash("bearing"));
+}
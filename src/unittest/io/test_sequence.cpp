@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <iterator>
+#include <sens_loc/io/sequence.h>
+#include <sens_loc/util/correctness_util.h>
+#include <string>
+#include <vector>
+
+using namespace sens_loc;
+
+namespace {
+/// Depth images with smooth surfaces, holes and the full value range.
+math::image<ushort> make_frame(int i) {
+    cv::Mat m(7, 13, CV_16U);
+    for (int v = 0; v < m.rows; ++v)
+        for (int u = 0; u < m.cols; ++u)
+            m.at<ushort>(v, u) = ushort(1000 + 10 * i + 3 * u - 2 * v);
+    m.at<ushort>(2, 5) = 0;
+    m.at<ushort>(3, 5) = 65535;
+    m.at<ushort>(6, 0) = 65535;
+    return math::image<ushort>(std::move(m));
+}
+}  // namespace
+
+TEST_CASE("Depth sequence archive") {
+    const int frame_count = 3;
+
+    for (const auto encoding :
+         {io::sequence_encoding::raw, io::sequence_encoding::delta}) {
+        CAPTURE(int(encoding));
+        const std::string file = encoding == io::sequence_encoding::raw
+                                     ? "io/test-raw.dseq"
+                                     : "io/test-delta.dseq";
+        math::pose_t pose = math::pose_t::Identity();
+        pose(0, 3)        = 42.F;
+
+        {
+            io::depth_sequence_writer w(file, frame_count, encoding,
+                                        "960 540\n", /*with_poses=*/true);
+            for (int i = 0; i < frame_count; ++i)
+                REQUIRE(w.add(make_frame(i), i == 1 ? pose
+                                                    : math::pose_t::Identity()));
+            REQUIRE(w.finish());
+        }
+
+        const auto seq = io::depth_sequence::open(file);
+        REQUIRE(seq);
+        REQUIRE(seq->size() == frame_count);
+        REQUIRE(seq->w() == 13);
+        REQUIRE(seq->h() == 7);
+        REQUIRE(seq->encoding() == encoding);
+        REQUIRE(seq->intrinsic() == "960 540\n");
+        REQUIRE(seq->pose(1));
+        REQUIRE(seq->pose(1)->isApprox(pose));
+        REQUIRE(seq->pose(2)->isApprox(math::pose_t::Identity()));
+
+        math::image<ushort> target;
+        for (int i = 0; i < frame_count; ++i) {
+            REQUIRE(seq->read(i, target));
+            REQUIRE(util::average_pixel_error(target, make_frame(i)) == 0.);
+        }
+
+        if (encoding == io::sequence_encoding::raw) {
+            // Views point into the archive and are not copied.
+            const auto v0 = seq->view(0);
+            const auto v1 = seq->view(1);
+            REQUIRE(v1.data().data - v0.data().data >= 13 * 7 * 2);
+            REQUIRE(util::average_pixel_error(v1, make_frame(1)) == 0.);
+        } else {
+            // Decoding reuses the memory of the target.
+            const uchar* buffer = target.data().data;
+            REQUIRE(seq->read(0, target));
+            REQUIRE(target.data().data == buffer);
+        }
+    }
+
+    SUBCASE("Invalid archives") {
+        REQUIRE(!io::depth_sequence::open("DoesNotExist.dseq"));
+        REQUIRE(!io::depth_sequence::open("io/not_an_image.txt"));
+    }
+    SUBCASE("Archives of a host with a different byte order") {
+        std::string content;
+        {
+            std::ifstream archive{"io/test-raw.dseq", std::ios::binary};
+            content.assign(std::istreambuf_iterator<char>{archive}, {});
+        }
+        REQUIRE(content.size() > sizeof(io::sequence_header));
+        // The version is the first number after the magic bytes.
+        std::reverse(content.begin() + 4, content.begin() + 8);
+        const std::string file = "io/test-swapped.dseq";
+        std::ofstream{file, std::ios::binary} << content;
+
+        REQUIRE(!io::depth_sequence::open(file));
+        std::remove(file.c_str());
+    }
+}
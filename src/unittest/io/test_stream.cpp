@@ -0,0 +1,162 @@
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <sens_loc/io/stream.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace sens_loc;
+
+namespace {
+cv::Mat make_image(int i, int type) {
+    cv::Mat m(5 + i, 11, type);
+    auto*   bytes = m.ptr();
+    for (std::size_t b = 0; b < m.total() * m.elemSize(); ++b)
+        bytes[b] = static_cast<uchar>(b * 7 + i);
+    return m;
+}
+
+bool equal(const cv::Mat& m1, const cv::Mat& m2) {
+    if (m1.rows != m2.rows || m1.cols != m2.cols || m1.type() != m2.type())
+        return false;
+    for (int v = 0; v < m1.rows; ++v)
+        for (std::size_t b = 0; b < m1.cols * m1.elemSize(); ++b)
+            if (m1.ptr(v)[b] != m2.ptr(v)[b])
+                return false;
+    return true;
+}
+}  // namespace
+
+TEST_CASE("Frame stream through a file") {
+    const std::string file = "io/test-stream.bin";
+    {
+        auto out = io::frame_stream::open(file, io::stream_mode::write);
+        REQUIRE(out);
+        REQUIRE(out->write(0, 0, 1, make_image(0, CV_16UC1)));
+        REQUIRE(out->write(1, 0, 2, make_image(1, CV_8UC3)));
+        REQUIRE(out->write(1, 1, 2, make_image(2, CV_32FC1)));
+    }
+
+    auto in = io::frame_stream::open(file, io::stream_mode::read);
+    REQUIRE(in);
+    io::stream_header header;
+    cv::Mat           image;
+
+    REQUIRE(in->read(header, image) == io::stream_status::frame);
+    REQUIRE(header.sequence == 0);
+    REQUIRE(header.parts == 1);
+    REQUIRE(equal(image, make_image(0, CV_16UC1)));
+
+    REQUIRE(in->read(header, image) == io::stream_status::frame);
+    REQUIRE(header.sequence == 1);
+    REQUIRE(header.part == 0);
+    REQUIRE(header.parts == 2);
+    REQUIRE(equal(image, make_image(1, CV_8UC3)));
+
+    REQUIRE(in->read(header, image) == io::stream_status::frame);
+    REQUIRE(header.part == 1);
+    REQUIRE(equal(image, make_image(2, CV_32FC1)));
+
+    REQUIRE(in->read(header, image) == io::stream_status::end);
+    std::remove(file.c_str());
+}
+
+TEST_CASE("Broken frame streams") {
+    const std::string file = "io/test-stream-broken.bin";
+    io::stream_header header;
+    cv::Mat           image;
+
+    SUBCASE("Stream ends within an image") {
+        {
+            auto out = io::frame_stream::open(file, io::stream_mode::write);
+            REQUIRE(out);
+            REQUIRE(out->write(0, 0, 1, make_image(0, CV_16UC1)));
+        }
+        std::string content;
+        {
+            std::ifstream complete{file, std::ios::binary};
+            content.assign(std::istreambuf_iterator<char>{complete}, {});
+        }
+        std::ofstream{file, std::ios::binary}
+            << content.substr(0, sizeof(io::stream_header) + 10);
+
+        auto in = io::frame_stream::open(file, io::stream_mode::read);
+        REQUIRE(in);
+        REQUIRE(in->read(header, image) == io::stream_status::error);
+    }
+    SUBCASE("Invalid header") {
+        {
+            std::ofstream out{file, std::ios::binary};
+            out << "This is not a frame stream, but long enough for a header.";
+        }
+        auto in = io::frame_stream::open(file, io::stream_mode::read);
+        REQUIRE(in);
+        REQUIRE(in->read(header, image) == io::stream_status::error);
+    }
+    std::remove(file.c_str());
+
+    REQUIRE(!io::frame_stream::open("io/does-not-exist/stream.bin",
+                                    io::stream_mode::read));
+}
+
+TEST_CASE("Frame stream through a socket") {
+    const std::string spec = "unix:io/test-stream.sock";
+    REQUIRE(io::frame_stream::is_socket(spec));
+    REQUIRE(!io::frame_stream::is_socket("-"));
+
+    // The server answers each image on the same connection.
+    std::thread server([&spec]() {
+        auto s = io::frame_stream::open(spec, io::stream_mode::read,
+                                        io::socket_role::listen);
+        // Failing 'REQUIRE' would terminate the program from this thread.
+        CHECK(s);
+        if (!s)
+            return;
+        io::stream_header header;
+        cv::Mat           image;
+        while (s->read(header, image) == io::stream_status::frame)
+            CHECK(s->write(header.sequence, 0, 1, image));
+        s->shutdown_write();
+    });
+
+    auto client = io::frame_stream::open(spec, io::stream_mode::write,
+                                         io::socket_role::connect);
+    REQUIRE(client);
+    for (std::uint32_t i = 0; i < 3; ++i)
+        REQUIRE(client->write(i, 0, 1, make_image(int(i), CV_16UC1)));
+    client->shutdown_write();
+
+    io::stream_header header;
+    cv::Mat           image;
+    for (std::uint32_t i = 0; i < 3; ++i) {
+        REQUIRE(client->read(header, image) == io::stream_status::frame);
+        REQUIRE(header.sequence == i);
+        REQUIRE(equal(image, make_image(int(i), CV_16UC1)));
+    }
+    REQUIRE(client->read(header, image) == io::stream_status::end);
+    server.join();
+}
+
+TEST_CASE("Frame stream to a closed reader") {
+    const std::string fifo = "io/test-stream.fifo";
+    std::remove(fifo.c_str());
+    REQUIRE(::mkfifo(fifo.c_str(), 0600) == 0);
+
+    // Opening the writing end of a FIFO waits for a reader.
+    const int reader = ::open(fifo.c_str(), O_RDONLY | O_NONBLOCK);  // NOLINT
+    REQUIRE(reader >= 0);
+    auto out = io::frame_stream::open(fifo, io::stream_mode::write);
+    REQUIRE(out);
+    REQUIRE(out->write(0, 0, 1, make_image(0, CV_16UC1)));
+    REQUIRE(!out->peer_closed());
+    ::close(reader);
+
+    // SIGPIPE would terminate the test instead of failing the write.
+    REQUIRE(!out->write(1, 0, 1, make_image(1, CV_16UC1)));
+    REQUIRE(out->peer_closed());
+    std::remove(fifo.c_str());
+}
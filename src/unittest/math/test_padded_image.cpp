@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <sens_loc/math/padded_image.h>
+
+using namespace sens_loc::math;
+
+TEST_CASE("padded image layout") {
+    padded_image<float> img(13, 7, 2, 1.F);
+
+    CHECK(img.w() == 13);
+    CHECK(img.h() == 7);
+    CHECK(img.border() == 2);
+    CHECK(img.alignment() == 32);
+    CHECK(img.stride() >= img.w() + 2 * img.border());
+    CHECK(img.stride() % (img.alignment() / int(sizeof(float))) == 0);
+
+    for (int v = -img.border(); v < img.h() + img.border(); ++v) {
+        const auto r = img.row(v);
+        REQUIRE(r.size() == img.w());
+        // Each row starts at an aligned address.
+        REQUIRE(reinterpret_cast<std::uintptr_t>(r.data()) %
+                    std::uintptr_t(img.alignment()) ==
+                0);
+    }
+
+    SUBCASE("initial value") {
+        for (int v = -2; v < img.h() + 2; ++v)
+            for (int u = -2; u < img.w() + 2; ++u)
+                REQUIRE(img.at({u, v}) == 1.F);
+    }
+    SUBCASE("halo via pointer arithmetic") {
+        img.at({-1, 0})  = 2.F;
+        img.at({0, -1})  = 3.F;
+        img.at({13, 6})  = 4.F;
+        const float* row = img.row(0).data();
+        CHECK(row[-1] == 2.F);
+        CHECK(row[-img.stride()] == 3.F);
+        CHECK(img.row(6).data()[13] == 4.F);
+    }
+    SUBCASE("fill border") {
+        img.at({5, 5}) = 42.F;
+        img.fill_border(0.F);
+        for (int v = -2; v < img.h() + 2; ++v) {
+            for (int u = -2; u < img.w() + 2; ++u) {
+                const bool inside =
+                    u >= 0 && u < img.w() && v >= 0 && v < img.h();
+                const float expected =
+                    !inside ? 0.F : (u == 5 && v == 5) ? 42.F : 1.F;
+                REQUIRE(img.at({u, v}) == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("padded image from image") {
+    cv::Mat m(5, 9, CV_16U);
+    for (int v = 0; v < m.rows; ++v)
+        for (int u = 0; u < m.cols; ++u)
+            m.at<ushort>(v, u) = ushort(v * 10 + u);
+    const image<ushort> source(std::move(m));
+
+    padded_image<ushort> padded(source, 1, ushort(0), 16);
+    REQUIRE(padded.w() == source.w());
+    REQUIRE(padded.h() == source.h());
+
+    for (int v = 0; v < source.h(); ++v) {
+        const auto r = padded.row(v);
+        for (int u = 0; u < source.w(); ++u)
+            REQUIRE(r[u] == source.at({u, v}));
+        REQUIRE(r.data()[-1] == 0);
+        REQUIRE(r.data()[source.w()] == 0);
+    }
+
+    SUBCASE("interior shares memory") {
+        image<ushort> interior = padded.interior();
+        REQUIRE(interior.w() == source.w());
+        REQUIRE(interior.h() == source.h());
+        REQUIRE(interior.at({3, 2}) == 23);
+
+        interior.at({3, 2}) = 1000;
+        REQUIRE(padded.at({3, 2}) == 1000);
+    }
+}
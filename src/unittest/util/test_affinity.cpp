@@ -0,0 +1,53 @@
+#include <doctest/doctest.h>
+#include <sched.h>
+#include <sens_loc/util/affinity.h>
+#include <vector>
+
+using namespace sens_loc;
+using std::vector;
+
+TEST_CASE("parsing cpu lists") {
+    SUBCASE("single cpus and ranges") {
+        REQUIRE(util::parse_cpu_list("3") == vector<int>{3});
+        REQUIRE(util::parse_cpu_list("0-3") == vector<int>{0, 1, 2, 3});
+        REQUIRE(util::parse_cpu_list("0-1,4,6-7") ==
+                vector<int>{0, 1, 4, 6, 7});
+    }
+    SUBCASE("the result is sorted without duplicates") {
+        REQUIRE(util::parse_cpu_list("5,1-2,2,0") == vector<int>{0, 1, 2, 5});
+    }
+    SUBCASE("invalid lists") {
+        REQUIRE(!util::parse_cpu_list(""));
+        REQUIRE(!util::parse_cpu_list(","));
+        REQUIRE(!util::parse_cpu_list("1,"));
+        REQUIRE(!util::parse_cpu_list(",1"));
+        REQUIRE(!util::parse_cpu_list("1,,2"));
+        REQUIRE(!util::parse_cpu_list("3-1"));
+        REQUIRE(!util::parse_cpu_list("1-"));
+        REQUIRE(!util::parse_cpu_list("-1"));
+        REQUIRE(!util::parse_cpu_list("a"));
+        REQUIRE(!util::parse_cpu_list("1 "));
+        REQUIRE(!util::parse_cpu_list("1-2-3"));
+        REQUIRE(!util::parse_cpu_list("100000"));
+    }
+}
+
+TEST_CASE("cpu affinity") {
+    const int available = util::available_cpus();
+    REQUIRE(available >= 1);
+
+    REQUIRE(!util::set_cpu_affinity({}));
+    REQUIRE(!util::set_cpu_affinity({-1}));
+
+    cpu_set_t original;
+    REQUIRE(::sched_getaffinity(0, sizeof(original), &original) == 0);
+
+    // Pinning to the current CPU is always allowed.
+    const int current = ::sched_getcpu();
+    REQUIRE(current >= 0);
+    REQUIRE(util::set_cpu_affinity({current}));
+    REQUIRE(util::available_cpus() == 1);
+
+    REQUIRE(::sched_setaffinity(0, sizeof(original), &original) == 0);
+    REQUIRE(util::available_cpus() == available);
+}
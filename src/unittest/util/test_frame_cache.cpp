@@ -0,0 +1,110 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <doctest/doctest.h>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <util/frame_cache.h>
+#include <vector>
+
+using namespace sens_loc;
+using apps::frame_cache;
+
+namespace {
+/// Loader that counts the loads of each index and fails for index 3.
+class counting_loader {
+  public:
+    int operator()(int idx) {
+        ++(*_loads)[std::size_t(idx)];
+        // Concurrent requests arrive while the frame is loading.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (idx == 3)
+            throw std::runtime_error{"Could not load the frame"};
+        return 10 * idx;
+    }
+
+    [[nodiscard]] int loads(int idx) const {
+        return (*_loads)[std::size_t(idx)];
+    }
+
+  private:
+    std::shared_ptr<std::array<std::atomic<int>, 8>> _loads =
+        std::make_shared<std::array<std::atomic<int>, 8>>();
+};
+}  // namespace
+
+TEST_CASE("frame cache") {
+    counting_loader loader;
+
+    SUBCASE("frames are dropped after their uses") {
+        frame_cache<int> cache{loader, /*uses=*/2, /*capacity=*/4};
+        const auto       f1 = cache.get(0);
+        REQUIRE(*f1 == 0);
+        REQUIRE(cache.size() == 1UL);
+
+        const auto f2 = cache.get(0);
+        REQUIRE(f1 == f2);
+        REQUIRE(loader.loads(0) == 1);
+        REQUIRE(cache.size() == 0UL);
+
+        // The handles stay valid and a new request loads the frame again.
+        REQUIRE(*f1 == 0);
+        REQUIRE(*cache.get(0) == 0);
+        REQUIRE(loader.loads(0) == 2);
+    }
+    SUBCASE("concurrent requests load a frame once") {
+        const int        threads = 8;
+        frame_cache<int> cache{loader, /*uses=*/threads, /*capacity=*/4};
+
+        std::vector<frame_cache<int>::handle> frames(threads);
+        std::vector<std::thread>              workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&cache, &frames, t]() {
+                frames[std::size_t(t)] = cache.get(1);
+            });
+        for (auto& w : workers)
+            w.join();
+
+        REQUIRE(loader.loads(1) == 1);
+        for (const auto& f : frames)
+            REQUIRE(f == frames.front());
+        REQUIRE(*frames.front() == 10);
+        REQUIRE(cache.size() == 0UL);
+    }
+    SUBCASE("errors of the loader are passed to all requesters") {
+        frame_cache<int> cache{loader, /*uses=*/2, /*capacity=*/4};
+
+        std::atomic<int>         errors{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 2; ++t)
+            workers.emplace_back([&cache, &errors]() {
+                try {
+                    (void) cache.get(3);
+                } catch (const std::runtime_error&) { ++errors; }
+            });
+        for (auto& w : workers)
+            w.join();
+
+        REQUIRE(errors == 2);
+        REQUIRE(loader.loads(3) == 1);
+        REQUIRE(cache.size() == 0UL);
+        // Other frames are not affected.
+        REQUIRE(*cache.get(2) == 20);
+    }
+    SUBCASE("the capacity drops the oldest unused frames") {
+        frame_cache<int> cache{loader, /*uses=*/2, /*capacity=*/2};
+
+        const auto in_use = cache.get(0);
+        (void) cache.get(1);
+        (void) cache.get(2);
+        // Frame 0 is older, but still in use, so frame 1 is dropped.
+        REQUIRE(cache.size() == 2UL);
+
+        REQUIRE(*cache.get(0) == 0);
+        REQUIRE(loader.loads(0) == 1);
+        REQUIRE(*cache.get(1) == 10);
+        REQUIRE(loader.loads(1) == 2);
+    }
+}
@@ -0,0 +1,57 @@
+#include <doctest/doctest.h>
+#include <sens_loc/util/image_pool.h>
+
+using namespace sens_loc;
+
+TEST_CASE("image pool") {
+    util::image_pool pool;
+    REQUIRE(pool.size() == 0);
+
+    SUBCASE("buffers in use are not handed out twice") {
+        auto i1 = pool.get<ushort>(20, 10);
+        auto i2 = pool.get<ushort>(20, 10);
+        REQUIRE(pool.allocations() == 2);
+        REQUIRE(i1.data().data != i2.data().data);
+    }
+    SUBCASE("buffers are identified by dimension and type") {
+        auto i1 = pool.get<ushort>(20, 10);
+        auto i2 = pool.get<float>(20, 10);
+        auto i3 = pool.get<ushort>(10, 20);
+        REQUIRE(pool.allocations() == 3);
+        REQUIRE(i1.w() == 20);
+        REQUIRE(i1.h() == 10);
+        REQUIRE(i2.data().type() == CV_32F);
+        REQUIRE(i3.w() == 10);
+        REQUIRE(i3.h() == 20);
+    }
+    SUBCASE("steady state without allocations") {
+        const uchar* first_ushort = nullptr;
+        const uchar* first_float  = nullptr;
+
+        for (int i = 0; i < 5; ++i) {
+            pool.recycle();
+            math::image<ushort> in  = pool.get<ushort>(20, 10);
+            math::image<float>  pp  = pool.get<float>(20, 10);
+            math::image<ushort> out = pool.get<ushort>(20, 10);
+
+            if (i == 0) {
+                first_ushort = in.data().data;
+                first_float  = pp.data().data;
+            }
+            REQUIRE(in.data().data == first_ushort);
+            REQUIRE(pp.data().data == first_float);
+            REQUIRE(out.data().data != in.data().data);
+
+            // Writing to the image writes to the buffer of the pool.
+            out.at({3, 4}) = ushort(i);
+        }
+        REQUIRE(pool.size() == 3);
+        REQUIRE(pool.allocations() == 3);
+
+        pool.recycle();
+        // The buffers are handed out in the same order after recycling.
+        const auto first = pool.get<ushort>(20, 10);
+        REQUIRE(first.data().data == first_ushort);
+        REQUIRE(pool.get<ushort>(20, 10).at({3, 4}) == 4);
+    }
+}
@@ -0,0 +1,75 @@
+#include <atomic>
+#include <doctest/doctest.h>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <util/instance_pool.h>
+#include <vector>
+
+using namespace sens_loc;
+
+namespace {
+/// Instance that counts the threads using it at the same time.
+using counted = std::shared_ptr<std::atomic<int>>;
+}  // namespace
+
+TEST_CASE("instance pool") {
+    std::atomic<int>             created{0};
+    apps::instance_pool<counted> pool{[&created]() {
+        ++created;
+        return std::make_shared<std::atomic<int>>(0);
+    }};
+
+    SUBCASE("returned instances are reused") {
+        const std::atomic<int>* first = nullptr;
+        {
+            auto l = pool.acquire();
+            first  = l->get();
+        }
+        auto l = pool.acquire();
+        REQUIRE(created == 1);
+        REQUIRE(l->get() == first);
+    }
+    SUBCASE("leased instances are not handed out twice") {
+        auto l1 = pool.acquire();
+        auto l2 = pool.acquire();
+        REQUIRE(created == 2);
+        REQUIRE(l1->get() != l2->get());
+    }
+    SUBCASE("concurrent workers use an instance exclusively") {
+        const int                threads = 8;
+        std::atomic<bool>        shared{false};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&pool, &shared]() {
+                for (int i = 0; i < 1000; ++i) {
+                    auto l = pool.acquire();
+                    if ((**l)++ != 0)
+                        shared = true;
+                    --(**l);
+                }
+            });
+        for (auto& w : workers)
+            w.join();
+
+        REQUIRE(!shared);
+        REQUIRE(created >= 1);
+        REQUIRE(created <= threads);
+    }
+}
+
+TEST_CASE("instance pool with a failing factory") {
+    bool                     fail = true;
+    apps::instance_pool<int> pool{[&fail]() {
+        if (fail)
+            throw std::runtime_error{"Could not create the instance"};
+        return 42;
+    }};
+
+    REQUIRE_THROWS_AS((void) pool.acquire(), std::runtime_error);
+
+    // The pool stays usable.
+    fail   = false;
+    auto l = pool.acquire();
+    REQUIRE(*l == 42);
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <doctest/doctest.h>
+#include <feature_extractor/keypoint_selection.h>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <sens_loc/io/image.h>
+#include <vector>
+
+using namespace std;
+using namespace sens_loc;
+using apps::select_described_keypoints;
+
+TEST_CASE("select described keypoints") {
+    SUBCASE("descriptors follow their keypoints") {
+        vector<cv::KeyPoint> kps;
+        cv::Mat              descriptors(5, 4, CV_8U);
+        for (int i = 0; i < 5; ++i) {
+            kps.emplace_back(float(i), 0.F, 5.F, -1.F, float(i), 0, 42);
+            descriptors.row(i).setTo(i);
+        }
+
+        // Drop the weak keypoints and reverse the order of the others.
+        select_described_keypoints(
+            kps, descriptors, [](vector<cv::KeyPoint>& k) {
+                k.erase(remove_if(begin(k), end(k),
+                                  [](const cv::KeyPoint& kp) {
+                                      return kp.response < 2.F;
+                                  }),
+                        end(k));
+                reverse(begin(k), end(k));
+            });
+
+        REQUIRE(kps.size() == 3UL);
+        REQUIRE(descriptors.rows == 3);
+        for (int i = 0; i < 3; ++i) {
+            const auto& kp = kps[size_t(i)];
+            REQUIRE(kp.response == float(4 - i));
+            REQUIRE(kp.class_id == 42);
+            REQUIRE(descriptors.at<uchar>(i, 0) == uchar(4 - i));
+            REQUIRE(descriptors.at<uchar>(i, 3) == uchar(4 - i));
+        }
+    }
+    SUBCASE("without descriptors only the keypoints are selected") {
+        vector<cv::KeyPoint> kps{{1.F, 1.F, 5.F}, {2.F, 2.F, 5.F}};
+        cv::Mat              descriptors;
+        select_described_keypoints(
+            kps, descriptors, [](vector<cv::KeyPoint>& k) { k.pop_back(); });
+        REQUIRE(kps.size() == 1UL);
+        REQUIRE(descriptors.empty());
+    }
+    SUBCASE("single pass equals separate detection and description") {
+        const auto img = io::load_as_8bit_gray("util/flexion.png");
+        REQUIRE(img);
+        const cv::Ptr<cv::ORB> orb = cv::ORB::create();
+
+        vector<cv::KeyPoint> detected;
+        orb->detect(img->data(), detected, img->data());
+        REQUIRE(detected.size() > 100UL);
+
+        // Keep the stronger half of the keypoints, the decision for each
+        // keypoint does not depend on the others.
+        vector<float> responses;
+        for (const auto& kp : detected)
+            responses.push_back(kp.response);
+        auto median = begin(responses) + responses.size() / 2;
+        nth_element(begin(responses), median, end(responses));
+        const auto strong = [r = *median](vector<cv::KeyPoint>& k) {
+            k.erase(remove_if(begin(k), end(k),
+                              [r](const cv::KeyPoint& kp) {
+                                  return kp.response < r;
+                              }),
+                    end(k));
+        };
+
+        vector<cv::KeyPoint> two_pass = detected;
+        cv::Mat              two_pass_descriptors;
+        strong(two_pass);
+        orb->compute(img->data(), two_pass, two_pass_descriptors);
+
+        vector<cv::KeyPoint> single_pass;
+        cv::Mat              single_pass_descriptors;
+        orb->detectAndCompute(img->data(), img->data(), single_pass,
+                              single_pass_descriptors);
+        select_described_keypoints(single_pass, single_pass_descriptors,
+                                   strong);
+
+        REQUIRE(!single_pass.empty());
+        REQUIRE(single_pass.size() == two_pass.size());
+        for (size_t i = 0; i < single_pass.size(); ++i) {
+            REQUIRE(single_pass[i].pt == two_pass[i].pt);
+            REQUIRE(single_pass[i].response == two_pass[i].response);
+        }
+        REQUIRE(cv::norm(single_pass_descriptors, two_pass_descriptors,
+                         cv::NORM_HAMMING) == 0.);
+    }
+}
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <doctest/doctest.h>
+#include <sens_loc/util/progress_bar_observer.h>
+#include <thread>
+#include <vector>
+
+using namespace sens_loc;
+using namespace std::chrono;
+using util::latency_histogram;
+using util::progress_bar_observer;
+
+TEST_CASE("latency histogram") {
+    latency_histogram h;
+
+    SUBCASE("empty") {
+        REQUIRE(h.count() == 0U);
+        REQUIRE(h.percentile(0.5) == nanoseconds::zero());
+    }
+    SUBCASE("single sample") {
+        h.add(milliseconds(12));
+        REQUIRE(h.count() == 1U);
+        // The buckets have a relative width of at most 25%.
+        REQUIRE(h.percentile(0.5) <= milliseconds(12));
+        REQUIRE(h.percentile(0.5) > milliseconds(9));
+        REQUIRE(h.percentile(0.5) == h.percentile(1.0));
+    }
+    SUBCASE("small values are exact") {
+        h.add(nanoseconds(0));
+        h.add(nanoseconds(3));
+        REQUIRE(h.percentile(0.5) == nanoseconds(0));
+        REQUIRE(h.percentile(1.0) == nanoseconds(3));
+    }
+    SUBCASE("percentiles") {
+        for (int i = 0; i < 98; ++i)
+            h.add(microseconds(100));
+        h.add(milliseconds(10));
+        h.add(seconds(1));
+        REQUIRE(h.count() == 100U);
+
+        REQUIRE(h.percentile(0.5) <= microseconds(100));
+        REQUIRE(h.percentile(0.5) > microseconds(75));
+        REQUIRE(h.percentile(0.99) <= milliseconds(10));
+        REQUIRE(h.percentile(0.99) > milliseconds(7));
+        REQUIRE(h.percentile(1.0) <= seconds(1));
+        REQUIRE(h.percentile(1.0) > milliseconds(750));
+    }
+    SUBCASE("negative durations count as zero") {
+        h.add(nanoseconds(-5));
+        REQUIRE(h.percentile(1.0) == nanoseconds(0));
+    }
+    SUBCASE("concurrent samples") {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&h]() {
+                for (int i = 0; i < 1000; ++i)
+                    h.add(microseconds(i));
+            });
+        for (auto& t : threads)
+            t.join();
+        REQUIRE(h.count() == 4000U);
+    }
+}
+
+TEST_CASE("progress bar observer") {
+    SUBCASE("manual tasks") {
+        progress_bar_observer p{3};
+        p.finish_task(milliseconds(1));
+        p.finish_task(milliseconds(2));
+        REQUIRE(p.done() == 2);
+        p.finish_task(milliseconds(3));
+        REQUIRE(p.done() == 3);
+        REQUIRE(p.latency().count() == 3U);
+    }
+    SUBCASE("tasks of workers") {
+        progress_bar_observer p{2};
+        p.set_up(2);
+        std::thread other([&p]() {
+            p.on_entry(1, tf::TaskView{});
+            std::this_thread::sleep_for(milliseconds(2));
+            p.on_exit(1, tf::TaskView{});
+        });
+        p.on_entry(0, tf::TaskView{});
+        p.on_exit(0, tf::TaskView{});
+        other.join();
+
+        REQUIRE(p.done() == 2);
+        REQUIRE(p.latency().count() == 2U);
+        REQUIRE(p.latency().percentile(1.0) >= milliseconds(1));
+    }
+    SUBCASE("unfinished batches") {
+        progress_bar_observer p{10};
+        p.finish_task(milliseconds(1));
+        std::this_thread::sleep_for(2 * progress_bar_observer::redraw_interval);
+        REQUIRE(p.done() == 1);
+    }
+}
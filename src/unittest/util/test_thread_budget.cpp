@@ -0,0 +1,49 @@
+#include <doctest/doctest.h>
+#include <initializer_list>
+#include <sens_loc/util/thread_budget.h>
+
+using namespace sens_loc;
+using util::split_threads;
+using util::thread_policy;
+
+TEST_CASE("thread budget") {
+    SUBCASE("outer parallelism") {
+        const auto b = split_threads(thread_policy::outer, 16, 100);
+        REQUIRE(b.workers == 16);
+        REQUIRE(b.opencv_threads == 1);
+    }
+    SUBCASE("inner parallelism") {
+        const auto b = split_threads(thread_policy::inner, 16, 100);
+        REQUIRE(b.workers == 1);
+        REQUIRE(b.opencv_threads == 16);
+    }
+    SUBCASE("hybrid parallelism") {
+        auto b = split_threads(thread_policy::hybrid, 16, 100);
+        REQUIRE(b.workers == 16);
+        REQUIRE(b.opencv_threads == 1);
+
+        // Small batches give the threads to OpenCV.
+        b = split_threads(thread_policy::hybrid, 16, 2);
+        REQUIRE(b.workers == 1);
+        REQUIRE(b.opencv_threads == 16);
+
+        b = split_threads(thread_policy::hybrid, 1, 100);
+        REQUIRE(b.workers == 1);
+        REQUIRE(b.opencv_threads == 1);
+    }
+    SUBCASE("the budget is never exceeded") {
+        for (auto p : {thread_policy::outer, thread_policy::inner,
+                       thread_policy::hybrid}) {
+            for (int threads = 1; threads <= 64; ++threads) {
+                for (int tasks = 1; tasks <= 10; ++tasks) {
+                    const auto b = split_threads(p, threads, tasks);
+                    REQUIRE(b.workers >= 1);
+                    REQUIRE(b.opencv_threads >= 1);
+                    REQUIRE(b.workers * b.opencv_threads <= threads);
+                    // OpenCV must not run in parallel within the workers.
+                    REQUIRE((b.workers == 1 || b.opencv_threads == 1));
+                }
+            }
+        }
+    }
+}
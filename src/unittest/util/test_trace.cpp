@@ -0,0 +1,78 @@
+#include <chrono>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <sens_loc/util/trace.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sens_loc;
+using namespace std::chrono;
+
+TEST_CASE("trace spans") {
+    const std::size_t before = util::recorded_spans().size();
+
+    SUBCASE("disabled tracing records nothing") {
+        if (!util::tracing_enabled()) {
+            { util::trace_span s{"ignored"}; }
+            REQUIRE(util::recorded_spans().size() == before);
+        }
+    }
+
+    util::enable_tracing();
+    REQUIRE(util::tracing_enabled());
+
+    SUBCASE("spans of multiple threads") {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; ++t)
+            threads.emplace_back([]() {
+                util::trace_span outer{"outer"};
+                std::this_thread::sleep_for(milliseconds(1));
+                util::trace_span inner{"inner"};
+            });
+        for (auto& t : threads)
+            t.join();
+
+        const std::vector<util::trace_event> events = util::recorded_spans();
+        REQUIRE(events.size() == before + 6);
+        for (std::size_t i = 1; i < events.size(); ++i)
+            REQUIRE(events[i - 1].begin <= events[i].begin);
+
+        int outer = 0;
+        for (const auto& e : events) {
+            REQUIRE(e.begin <= e.end);
+            if (std::string{e.name} == "outer") {
+                outer++;
+                REQUIRE(e.end - e.begin >= 1'000'000);
+            }
+        }
+        REQUIRE(outer == 3);
+
+        std::ostringstream summary;
+        util::print_trace_summary(summary, events);
+        REQUIRE(summary.str().find("outer") != std::string::npos);
+        REQUIRE(summary.str().find("inner") != std::string::npos);
+    }
+    SUBCASE("chrome trace format") {
+        const std::vector<util::trace_event> events = {
+            {"load", 1, 1000, 3000},
+            {"say \"hi\"", 2, 2000, 2500},
+        };
+        REQUIRE(util::write_chrome_trace("test_trace.json", events));
+
+        std::ifstream     in{"test_trace.json"};
+        std::stringstream content;
+        content << in.rdbuf();
+        const std::string json = content.str();
+        REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+        REQUIRE(json.find("{\"name\": \"load\", \"cat\": \"sens_loc\", "
+                          "\"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                          "\"ts\": 1.000, \"dur\": 2.000}") !=
+                std::string::npos);
+        REQUIRE(json.find("\"say \\\"hi\\\"\"") != std::string::npos);
+
+        REQUIRE(!util::write_chrome_trace("not/existing/dir/trace.json",
+                                          events));
+    }
+}